@@ -0,0 +1,204 @@
+/// <summary>Benchmark of building and querying a BVH.</summary>
+///
+/// Times SAH builds and incremental growth of a BVH over random spheres,
+/// refitting as a share of them move, and frustum, ray and sphere queries
+/// against searches by brute force, checking that both find the same
+/// items.
+///
+/// \file bench_bvh.cpp
+
+#include <glge/common.h>
+#include <glge/renderer/camera.h>
+#include <glge/util/bvh.h>
+
+#include "bench_utils.h"
+
+#include <random>
+
+using namespace glge;
+using namespace glge::math;
+
+namespace
+{
+	constexpr size_t runs = 10;
+	constexpr size_t item_count = 100000;
+	constexpr size_t query_count = 200;
+
+	// Spheres scattered through a cube, as objects through a world
+	vector<BVH::Entry> random_entries(std::mt19937 & rng)
+	{
+		std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> radius(0.5f, 5.0f);
+
+		vector<BVH::Entry> entries;
+		for (size_t i = 0; i < item_count; i++)
+		{
+			entries.push_back(BVH::Entry{
+				Sphere{radius(rng),
+					   vec3(position(rng), position(rng), position(rng))},
+				static_cast<BVH::Item>(i)});
+		}
+
+		return entries;
+	}
+
+	vector<renderer::Camera> random_cameras(std::mt19937 & rng)
+	{
+		std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 6.28f);
+
+		vector<renderer::Camera> cameras;
+		for (size_t i = 0; i < query_count; i++)
+		{
+			const mat4 transform =
+				glm::translate(mat4(1.0f), vec3(position(rng), position(rng),
+												position(rng))) *
+				glm::toMat4(glm::angleAxis(angle(rng), vec3(0, 1, 0)));
+
+			cameras.emplace_back(renderer::CameraIntrinsics{
+									 Degrees(60.0f), 1.5f, 0.1f, 300.0f},
+								 util::Placement(transform));
+		}
+
+		return cameras;
+	}
+}   // namespace
+
+int main()
+{
+	std::mt19937 rng(1);
+	auto entries = random_entries(rng);
+	const auto cameras = random_cameras(rng);
+
+	vector<Ray> rays;
+	for (const auto & camera : cameras)
+	{
+		rays.push_back(camera.get_ray(1.0f, 1.0f, 0.5f, 0.5f));
+	}
+
+	BVH bvh;
+	auto leaves = bvh.build(entries);
+
+	// Check the queries against brute force before timing them
+	for (size_t i = 0; i < query_count; i++)
+	{
+		const Frustum frustum = cameras[i].get_view_frustum();
+		size_t found = 0, expected = 0;
+		bvh.query(frustum, [&](BVH::Item) { found++; });
+		for (const BVH::Entry & entry : entries)
+		{
+			expected += contains(frustum, entry.bounds) ? 1 : 0;
+		}
+
+		const auto hit = bvh.raycast(rays[i]);
+		std::optional<float> nearest;
+		for (const BVH::Entry & entry : entries)
+		{
+			const auto distance = intersect(rays[i], entry.bounds);
+			if (distance && (!nearest || *distance < *nearest))
+			{
+				nearest = distance;
+			}
+		}
+
+		if (found != expected || hit.has_value() != nearest.has_value() ||
+			(hit && hit->distance != *nearest))
+		{
+			std::printf("BVH and brute force queries differ\n");
+			return 1;
+		}
+	}
+
+	std::printf("%zu items, SAH cost %.1f\n", item_count, bvh.cost());
+	bench::report_header();
+
+	bench::report("build SAH",
+				  bench::time_runs([&] { bvh.build(entries); }, runs));
+	leaves = bvh.build(entries);
+
+	const auto grow = [&] {
+		BVH grown;
+		for (const auto & entry : entries)
+		{
+			grown.insert(entry.bounds, entry.item);
+		}
+	};
+	bench::report("build by insertion", bench::time_runs(grow, runs));
+
+	// A tenth of the items drift each frame
+	std::uniform_real_distribution<float> drift(-0.5f, 0.5f);
+	const auto move = [&] {
+		for (size_t i = 0; i < item_count; i += 10)
+		{
+			entries[i].bounds.origin +=
+				vec3(drift(rng), drift(rng), drift(rng));
+			bvh.update(leaves[i], entries[i].bounds);
+		}
+	};
+	bench::report("refit 10% moved", bench::time_runs(move, runs));
+	std::printf("SAH cost after refits %.1f\n", bvh.cost());
+
+	size_t sink = 0;
+	const auto count = [&](BVH::Item) { sink++; };
+
+	const auto frustums_bvh = [&] {
+		for (const auto & camera : cameras)
+		{
+			bvh.query(camera.get_view_frustum(), count);
+		}
+	};
+	const auto frustums_brute = [&] {
+		for (const auto & camera : cameras)
+		{
+			const Frustum frustum = camera.get_view_frustum();
+			for (const auto & entry : entries)
+			{
+				sink += contains(frustum, entry.bounds);
+			}
+		}
+	};
+	bench::report("frustum queries BVH", bench::time_runs(frustums_bvh, runs));
+	bench::report("frustum queries brute force",
+				  bench::time_runs(frustums_brute, runs));
+
+	const auto rays_bvh = [&] {
+		for (const Ray & ray : rays)
+		{
+			sink += bvh.raycast(ray).has_value();
+		}
+	};
+	const auto rays_brute = [&] {
+		for (const Ray & ray : rays)
+		{
+			for (const auto & entry : entries)
+			{
+				sink += intersect(ray, entry.bounds).has_value();
+			}
+		}
+	};
+	bench::report("ray queries BVH", bench::time_runs(rays_bvh, runs));
+	bench::report("ray queries brute force",
+				  bench::time_runs(rays_brute, runs));
+
+	const auto spheres_bvh = [&] {
+		for (const Ray & ray : rays)
+		{
+			bvh.query(Sphere{20.0f, ray.origin}, count);
+		}
+	};
+	const auto spheres_brute = [&] {
+		for (const Ray & ray : rays)
+		{
+			const Sphere sphere{20.0f, ray.origin};
+			for (const auto & entry : entries)
+			{
+				sink += intersects(entry.bounds, sphere);
+			}
+		}
+	};
+	bench::report("sphere queries BVH", bench::time_runs(spheres_bvh, runs));
+	bench::report("sphere queries brute force",
+				  bench::time_runs(spheres_brute, runs));
+
+	std::printf("(%zu items found)\n", sink);
+}
@@ -0,0 +1,177 @@
+/// <summary>Benchmark of the native image decoders against SOIL.</summary>
+///
+/// Decodes the test resources from memory with both decoders, checking
+/// that they produce the same pixels, then times the decode of a whole
+/// cubemap serially and in parallel, as the texture loaders do it.
+///
+/// \file bench_image_decoder.cpp
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/image_decoder.h>
+#include <glge/util/thread_pool.h>
+
+#include "bench_utils.h"
+
+#include <SOIL.h>
+
+#include <array>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <stdexcept>
+
+using namespace glge;
+using namespace glge::renderer::primitive;
+
+namespace
+{
+	constexpr size_t runs = 20;
+
+	struct ImageFile
+	{
+		string name;
+		vector<std::uint8_t> bytes;
+		bool tga;
+	};
+
+	ImageFile read_file(const string & name)
+	{
+		std::ifstream in(string(GLGE_RESOURCE_DIR) + "/" + name,
+						 std::ios::binary);
+		if (!in)
+		{
+			throw std::runtime_error("Failed to open " + name);
+		}
+
+		ImageFile file;
+		file.name = name;
+		file.bytes.assign(std::istreambuf_iterator<char>(in),
+						  std::istreambuf_iterator<char>());
+		file.tga = name.substr(name.size() - 4) == ".tga";
+
+		return file;
+	}
+
+	Image decode_native(const ImageFile & file)
+	{
+		auto image = file.tga ? decode_tga(file.bytes.data(),
+										   file.bytes.size())
+							  : decode_png(file.bytes.data(),
+										   file.bytes.size());
+		if (!image)
+		{
+			throw std::runtime_error(file.name + " is not decoded natively");
+		}
+
+		return std::move(*image);
+	}
+
+	Image decode_soil(const ImageFile & file)
+	{
+		int width = 0, height = 0, channels = 0;
+		unsigned char * data = SOIL_load_image_from_memory(
+			file.bytes.data(), static_cast<int>(file.bytes.size()), &width,
+			&height, &channels, SOIL_LOAD_AUTO);
+
+		if (!data)
+		{
+			throw std::runtime_error("SOIL failed to decode " + file.name);
+		}
+
+		Image image;
+		image.width = static_cast<size_t>(width);
+		image.height = static_cast<size_t>(height);
+		image.channels = static_cast<size_t>(channels);
+		image.pixels.assign(data, data + image.row_size() * image.height);
+
+		SOIL_free_image_data(data);
+
+		return image;
+	}
+}   // namespace
+
+int main()
+{
+	const std::array<string, 6> faces{
+		"cubemaps/test_rt.tga", "cubemaps/test_lf.tga", "cubemaps/test_up.tga",
+		"cubemaps/test_dn.tga", "cubemaps/test_bk.tga", "cubemaps/test_ft.tga"};
+
+	vector<ImageFile> files{read_file("textures/test.png")};
+	for (const string & face : faces)
+	{
+		files.emplace_back(read_file(face));
+	}
+
+	bench::report_header();
+
+	for (const ImageFile & file : files)
+	{
+		const Image native = decode_native(file);
+		const Image soil = decode_soil(file);
+
+		if (native.width != soil.width || native.height != soil.height ||
+			native.channels != soil.channels || native.pixels != soil.pixels)
+		{
+			std::printf("%s: native and SOIL pixels differ\n",
+						file.name.c_str());
+			return 1;
+		}
+
+		const size_t bytes = native.pixels.size();
+
+		bench::report(file.name + " native",
+					  bench::time_runs([&] { decode_native(file); }, runs),
+					  bytes);
+		bench::report(file.name + " SOIL",
+					  bench::time_runs([&] { decode_soil(file); }, runs),
+					  bytes);
+	}
+
+	const vector<ImageFile> cubemap(files.cbegin() + 1, files.cend());
+	size_t cubemap_bytes = 0;
+	for (const ImageFile & face : cubemap)
+	{
+		cubemap_bytes += decode_native(face).pixels.size();
+	}
+
+	auto parallel = [&](Image (*decode)(const ImageFile &)) {
+		vector<std::future<Image>> decoded;
+		for (const ImageFile & face : cubemap)
+		{
+			decoded.emplace_back(util::ThreadPool::shared().submit(
+				[&face, decode] { return decode(face); }));
+		}
+
+		for (auto & future : decoded)
+		{
+			future.get();
+		}
+	};
+
+	bench::report("cubemap native serial",
+				  bench::time_runs(
+					  [&] {
+						  for (const ImageFile & face : cubemap)
+						  {
+							  decode_native(face);
+						  }
+					  },
+					  runs),
+				  cubemap_bytes);
+	bench::report("cubemap native parallel",
+				  bench::time_runs([&] { parallel(decode_native); }, runs),
+				  cubemap_bytes);
+	bench::report("cubemap SOIL serial",
+				  bench::time_runs(
+					  [&] {
+						  for (const ImageFile & face : cubemap)
+						  {
+							  decode_soil(face);
+						  }
+					  },
+					  runs),
+				  cubemap_bytes);
+	bench::report("cubemap SOIL parallel",
+				  bench::time_runs([&] { parallel(decode_soil); }, runs),
+				  cubemap_bytes);
+}
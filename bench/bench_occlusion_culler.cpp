@@ -0,0 +1,148 @@
+/// <summary>Benchmark of occlusion culling on the CPU.</summary>
+///
+/// Draws a grid of box shaped buildings into the culler's depth buffer
+/// from street level, then tests the bounds of many small objects
+/// scattered between them, reporting how many are found hidden.
+///
+/// \file bench_occlusion_culler.cpp
+
+#include <glge/common.h>
+#include <glge/renderer/occlusion_culler.h>
+
+#include "bench_utils.h"
+
+#include <random>
+
+using namespace glge;
+using namespace glge::renderer;
+using namespace glge::renderer::primitive;
+
+namespace
+{
+	constexpr size_t runs = 20;
+
+	// Buildings along each side of the city, and the spacing between them
+	constexpr size_t city_size = 32;
+	constexpr float block_size = 20.0f;
+	constexpr size_t object_count = 50000;
+
+	// Unit box centered on the origin, as an occluder
+	EBOModelData box()
+	{
+		vector<vec3> corners;
+		for (int i = 0; i < 8; i++)
+		{
+			corners.emplace_back((i & 1) ? 0.5f : -0.5f,
+								 (i & 2) ? 0.5f : -0.5f,
+								 (i & 4) ? 0.5f : -0.5f);
+		}
+
+		Vertices vertices;
+		for (const vec3 & corner : corners)
+		{
+			vertices.push_back(model_parser::Vertex(corner));
+		}
+
+		Indices indices;
+		for (const unsigned face : {0u, 1u, 2u, 3u, 4u, 5u})
+		{
+			// The four corners of each face, by flipping two axes
+			const unsigned axis = face / 2, side = (face % 2) << axis;
+			const unsigned u = 1u << ((axis + 1) % 3);
+			const unsigned v = 1u << ((axis + 2) % 3);
+			for (const unsigned corner :
+				 {side, side | u, side | u | v, side, side | u | v, side | v})
+			{
+				indices.push_back(model_parser::Index(corner));
+			}
+		}
+
+		return EBOModelData(std::move(vertices), Normals{}, TexCoords{},
+							std::move(indices));
+	}
+
+	vector<mat4> buildings()
+	{
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<float> height(10.0f, 60.0f);
+
+		vector<mat4> placements;
+		for (size_t z = 0; z < city_size; z++)
+		{
+			for (size_t x = 0; x < city_size; x++)
+			{
+				const float h = height(rng);
+				mat4 M(1.0f);
+				M[0][0] = M[2][2] = block_size * 0.7f;
+				M[1][1] = h;
+				M[3] = vec4(float(x) * block_size, h * 0.5f,
+							-float(z) * block_size, 1.0f);
+				placements.push_back(M);
+			}
+		}
+
+		return placements;
+	}
+
+	vector<math::Sphere> objects()
+	{
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> position(
+			0.0f, float(city_size) * block_size);
+
+		vector<math::Sphere> spheres;
+		for (size_t i = 0; i < object_count; i++)
+		{
+			spheres.push_back(math::Sphere{
+				1.0f, vec3(position(rng), 1.0f, -position(rng))});
+		}
+
+		return spheres;
+	}
+}   // namespace
+
+int main()
+{
+	const EBOModelData occluder = box();
+	const vector<mat4> placements = buildings();
+	const vector<math::Sphere> spheres = objects();
+
+	// Standing in the street at the city's corner, looking across it
+	const float street = block_size * 0.5f;
+	const Camera camera(
+		CameraIntrinsics{math::Degrees(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f},
+		util::Placement(glm::inverse(glm::lookAt(
+			vec3(street, 2.0f, -street), vec3(300.0f, 2.0f, -400.0f),
+			vec3(0.0f, 1.0f, 0.0f)))));
+
+	OcclusionCuller culler(256, 144);
+
+	const auto draw = [&] {
+		culler.begin(camera);
+		for (const mat4 & M : placements)
+		{
+			culler.add_occluder(occluder, M);
+		}
+		culler.rasterize();
+	};
+
+	size_t hidden = 0;
+	const auto query = [&] {
+		hidden = 0;
+		for (const math::Sphere & sphere : spheres)
+		{
+			hidden += !culler.visible(sphere);
+		}
+	};
+
+	draw();
+	std::printf("%zu occluders, %zu triangles\n", placements.size(),
+				culler.triangle_count());
+	bench::report_header();
+
+	bench::report("bin and rasterize occluders",
+				  bench::time_runs(draw, runs));
+	bench::report("50k sphere queries", bench::time_runs(query, runs));
+
+	std::printf("(%zu of %zu objects hidden)\n", hidden, spheres.size());
+}
@@ -0,0 +1,215 @@
+/// <summary>Benchmark of culling while preparing a scene's Renderer.</summary>
+///
+/// Builds a city of blocks, each a group of small objects beside a
+/// building which occludes them, then prepares Renderers for a camera
+/// turning slowly between frames, with frustum and occlusion culling,
+/// each with and without making use of coherence between frames.
+///
+/// \file bench_scene_culling.cpp
+
+#include <glge/common.h>
+#include <glge/renderer/occlusion_culler.h>
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/scene_graph/scene.h>
+
+#include "bench_utils.h"
+
+#include <deque>
+
+using namespace glge;
+using namespace glge::renderer;
+using namespace glge::renderer::primitive;
+using namespace glge::renderer::scene_graph;
+
+namespace
+{
+	constexpr size_t runs = 10;
+
+	// Blocks along each side of the city, their spacing, and the objects
+	// in each
+	constexpr size_t city_size = 48;
+	constexpr float block_size = 20.0f;
+	constexpr size_t objects_per_block = 16;
+
+	// Frames prepared per run, and the camera's turn between them
+	constexpr size_t frames = 16;
+	constexpr float turn = 0.002f;
+
+	class BoundedRenderable : public Renderable
+	{
+	public:
+		void render() const override {}
+
+		std::optional<math::Sphere> bounds() const override
+		{
+			return math::Sphere{1.0f, vec3(0.0f)};
+		}
+	};
+
+	class NullShader : public ShaderBase
+	{
+	public:
+		util::UniqueHandle bind() override { return util::UniqueHandle(); }
+	};
+
+	struct NullInstance : public ShaderInstanceBase
+	{
+		explicit NullInstance(ShaderBase & shader) : ShaderInstanceBase(shader)
+		{}
+
+		void operator()(const RenderParameters &) const override {}
+	};
+
+	// Unit box centered on the origin, as an occluder
+	EBOModelData box()
+	{
+		Vertices vertices;
+		for (int i = 0; i < 8; i++)
+		{
+			vertices.push_back(model_parser::Vertex(
+				vec3((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f,
+					 (i & 4) ? 0.5f : -0.5f)));
+		}
+
+		Indices indices;
+		for (unsigned axis = 0; axis < 3; axis++)
+		{
+			const unsigned u = 1u << ((axis + 1) % 3);
+			const unsigned v = 1u << ((axis + 2) % 3);
+			for (const unsigned side : {0u, 1u << axis})
+			{
+				for (const unsigned corner : {side, side | u, side | u | v,
+											  side, side | u | v, side | v})
+				{
+					indices.push_back(model_parser::Index(corner));
+				}
+			}
+		}
+
+		return EBOModelData(std::move(vertices), Normals{}, TexCoords{},
+							std::move(indices));
+	}
+
+	// Scene whose placements outlive it, as nodes refer to them
+	struct City
+	{
+		BoundedRenderable renderable;
+		NullShader shader;
+		NullInstance instance{shader};
+		EBOModelData occluder = box();
+		OcclusionCuller culler{256, 144};
+
+		std::deque<util::Placement> placements;
+		util::Placement heading{mat4(1.0f)};
+		Scene scene;
+
+		City()
+		{
+			auto root = scene.get_root_handle();
+
+			for (size_t z = 0; z < city_size; z++)
+			{
+				for (size_t x = 0; x < city_size; x++)
+				{
+					const vec3 corner(float(x) * block_size, 0.0f,
+									  -float(z) * block_size);
+					auto block = root.add_transform(placements.emplace_back(
+						glm::translate(mat4(1.0f), corner)));
+
+					// A building filling the block's far corner
+					mat4 building(1.0f);
+					building[0][0] = building[2][2] = block_size * 0.6f;
+					building[1][1] = 30.0f;
+					building[3] = vec4(block_size * 0.5f, 15.0f,
+									   -block_size * 0.5f, 1.0f);
+					block.add_transform(placements.emplace_back(building))
+						.add_geometry(renderable, instance)
+						.set_occluder(occluder);
+
+					// Objects along the block's edges
+					for (size_t i = 0; i < objects_per_block; i++)
+					{
+						const float along =
+							float(i) * block_size / float(objects_per_block);
+						const vec3 offset = (i % 2)
+												? vec3(along, 1.0f, -1.0f)
+												: vec3(1.0f, 1.0f, -along);
+						block
+							.add_transform(placements.emplace_back(
+								glm::translate(mat4(1.0f), offset)))
+							.add_geometry(renderable, instance);
+					}
+				}
+			}
+
+			root.add_transform(heading)
+				.add_camera(CameraIntrinsics{math::Degrees(60.0f),
+											 16.0f / 9.0f, 0.1f, 2000.0f})
+				.activate();
+
+			scene.settings.enable_VF_culling = true;
+		}
+
+		// Prepares a run of frames, returning the objects drawn
+		size_t prepare_frames()
+		{
+			size_t drawn = 0;
+			for (size_t frame = 0; frame < frames; frame++)
+			{
+				const float angle = 0.6f + float(frame) * turn;
+				heading.set_transform(
+					glm::translate(mat4(1.0f),
+								   vec3(-block_size * 0.5f, 2.0f, 0.0f)) *
+					glm::toMat4(glm::angleAxis(angle, vec3(0, 1, 0))));
+				drawn += scene.prepare_renderer().target_count();
+			}
+			return drawn;
+		}
+	};
+}   // namespace
+
+int main()
+{
+	City city;
+	Scene & scene = city.scene;
+
+	size_t drawn = 0;
+	// Prepares frames with the given culling
+	const auto prepare = [&](bool occlusion, bool coherent) {
+		return [&, occlusion, coherent] {
+			scene.settings.occlusion_culler =
+				occlusion ? &city.culler : nullptr;
+			scene.settings.coherent_culling = coherent;
+			drawn = city.prepare_frames();
+		};
+	};
+
+	const auto frustum = prepare(false, false);
+	const auto frustum_coherent = prepare(false, true);
+	const auto occlusion = prepare(true, false);
+	const auto occlusion_coherent = prepare(true, true);
+
+	frustum();
+	const size_t frustum_drawn = drawn;
+	frustum_coherent();
+	if (drawn != frustum_drawn)
+	{
+		std::printf("coherent and full frustum culling differ\n");
+		return 1;
+	}
+
+	std::printf("%zu blocks, %zu objects each, %zu frames per run\n",
+				city_size * city_size, objects_per_block + 1, frames);
+	bench::report_header();
+
+	bench::report("frustum", bench::time_runs(frustum, runs));
+	bench::report("frustum coherent", bench::time_runs(frustum_coherent, runs));
+	std::printf("(%zu drawn)\n", drawn);
+
+	bench::report("frustum + occlusion", bench::time_runs(occlusion, runs));
+	std::printf("(%zu drawn)\n", drawn);
+	bench::report("frustum + occlusion coherent",
+				  bench::time_runs(occlusion_coherent, runs));
+	std::printf("(%zu drawn)\n", drawn);
+}
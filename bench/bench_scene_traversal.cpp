@@ -0,0 +1,205 @@
+/// <summary>
+/// Benchmark of virtual against static dispatch over a scene graph.
+/// </summary>
+///
+/// Builds a synthetic deep graph of transforms and geometry, then walks it
+/// depth first with the same visitor, dispatched once through Node::accept
+/// and once through visit(), checking that both agree.
+///
+/// \file bench_scene_traversal.cpp
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/util/motion.h>
+
+#include "bench_utils.h"
+
+#include <base_dispatcher.h>
+#include <node_store.h>
+#include <static_dispatch.h>
+
+#include <deque>
+
+using namespace glge;
+using namespace glge::renderer;
+using namespace glge::renderer::primitive;
+using namespace glge::renderer::scene_graph;
+
+namespace
+{
+	constexpr size_t runs = 20;
+
+	// Levels of the graph, and children of each transform
+	constexpr size_t depth = 7;
+	constexpr size_t branching = 4;
+
+	class NullRenderable : public Renderable
+	{
+	public:
+		void render() const override {}
+	};
+
+	class NullShader : public ShaderBase
+	{
+	public:
+		util::UniqueHandle bind() override { return util::UniqueHandle(); }
+	};
+
+	struct NullInstance : public ShaderInstanceBase
+	{
+		explicit NullInstance(ShaderBase & shader) : ShaderInstanceBase(shader)
+		{}
+
+		void operator()(const RenderParameters &) const override {}
+	};
+
+	// Sums the translations of the geometry, so that the traversal cannot
+	// be optimized away
+	class SummingVisitor
+	{
+		vec3 & sum;
+
+	public:
+		explicit SummingVisitor(vec3 & sum) : sum(sum) {}
+
+		mat4 dispatch(const Node &, mat4 cur_M) const { return cur_M; }
+
+		mat4 dispatch(const Geometry &, mat4 cur_M) const
+		{
+			sum += vec3(cur_M[3]);
+			return cur_M;
+		}
+
+		mat4 dispatch(const SceneTransform & transform, mat4 cur_M) const
+		{
+			return transform.placement.get_transform() * cur_M;
+		}
+
+		mat4 dispatch(const SceneCamera &, mat4 cur_M) const
+		{
+			return cur_M;
+		}
+
+		mat4 dispatch(const SceneLOD &, mat4 cur_M) const { return cur_M; }
+	};
+
+	// The same visitor behind the virtual interface
+	class VirtualVisitor : public BaseDispatcher
+	{
+		SummingVisitor visitor;
+
+	public:
+		explicit VirtualVisitor(vec3 & sum) : visitor(sum) {}
+
+		mat4 dispatch(const Node & node, mat4 cur_M) const override
+		{
+			return visitor.dispatch(node, cur_M);
+		}
+
+		mat4 dispatch(const Geometry & node, mat4 cur_M) const override
+		{
+			return visitor.dispatch(node, cur_M);
+		}
+
+		mat4 dispatch(const SceneTransform & node, mat4 cur_M) const override
+		{
+			return visitor.dispatch(node, cur_M);
+		}
+
+		mat4 dispatch(const SceneCamera & node, mat4 cur_M) const override
+		{
+			return visitor.dispatch(node, cur_M);
+		}
+
+		mat4 dispatch(const SceneLOD & node, mat4 cur_M) const override
+		{
+			return visitor.dispatch(node, cur_M);
+		}
+	};
+
+	struct Graph
+	{
+		NullRenderable renderable;
+		NullShader shader;
+		NullInstance instance{shader};
+		std::deque<util::Placement> placements;
+		NodeStore nodes;
+		Node & root = nodes.create<Node>();
+
+		// Each transform holds a group of geometry and further transforms
+		void grow(Node & parent, size_t level)
+		{
+			for (size_t i = 0; i < branching; i++)
+			{
+				auto & placement = placements.emplace_back(glm::translate(
+					mat4(1.0f), vec3(float(i), float(level), 1.0f)));
+				auto & transform = nodes.create<SceneTransform>(placement);
+				auto & group = nodes.create<Node>();
+				parent.add_child(transform);
+				transform.add_child(group);
+				group.add_child(nodes.create<Geometry>(renderable, instance));
+
+				if (level + 1 < depth)
+				{
+					grow(transform, level + 1);
+				}
+			}
+		}
+	};
+
+	template<typename Dispatch>
+	void traverse(const Node & root, Dispatch && dispatch)
+	{
+		vector<std::pair<observer_ptr<const Node>, mat4>> nodes{
+			{&root, mat4(1.0f)}};
+
+		while (!nodes.empty())
+		{
+			const auto [node, cur_M] = nodes.back();
+			nodes.pop_back();
+
+			const mat4 new_M = dispatch(*node, cur_M);
+			for (const Node & child : node->children())
+			{
+				nodes.emplace_back(&child, new_M);
+			}
+		}
+	}
+}   // namespace
+
+int main()
+{
+	Graph graph;
+	graph.grow(graph.root, 0);
+
+	vec3 virtual_sum(0.0f), static_sum(0.0f);
+	const VirtualVisitor virtual_visitor(virtual_sum);
+	const SummingVisitor static_visitor(static_sum);
+
+	const auto run_virtual = [&] {
+		traverse(graph.root, [&](const Node & node, mat4 cur_M) {
+			return node.accept(virtual_visitor, cur_M);
+		});
+	};
+	const auto run_static = [&] {
+		traverse(graph.root, [&](const Node & node, mat4 cur_M) {
+			return visit(node, static_visitor, cur_M);
+		});
+	};
+
+	run_virtual();
+	run_static();
+	if (virtual_sum != static_sum)
+	{
+		std::printf("virtual and static traversals differ\n");
+		return 1;
+	}
+
+	std::printf("%zu nodes, depth %zu\n", graph.nodes.size(), depth);
+	bench::report_header();
+	bench::report("traversal virtual dispatch",
+				  bench::time_runs(run_virtual, runs));
+	bench::report("traversal static dispatch",
+				  bench::time_runs(run_static, runs));
+}
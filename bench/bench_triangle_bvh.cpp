@@ -0,0 +1,169 @@
+/// <summary>Benchmark of ray queries against a mesh's triangles.</summary>
+///
+/// Builds a triangle BVH over a rolling terrain grid, then casts picking
+/// rays down onto it one at a time, as a batch and by brute force over
+/// every triangle, checking that the tree and brute force agree.
+///
+/// \file bench_triangle_bvh.cpp
+
+#include <glge/common.h>
+#include <glge/util/triangle_bvh.h>
+
+#include "bench_utils.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace glge;
+using namespace glge::math;
+
+namespace
+{
+	constexpr size_t runs = 10;
+
+	// Quads along each side of the terrain, two triangles each
+	constexpr size_t grid_size = 512;
+	constexpr size_t ray_count = 10000;
+
+	// Brute force is slow enough that fewer rays are cast with it
+	constexpr size_t brute_force_ray_count = 20;
+
+	vector<TriangleBVH::Triangle> terrain()
+	{
+		const auto height = [](size_t x, size_t z) {
+			return 8.0f * std::sin(float(x) * 0.05f) *
+				   std::cos(float(z) * 0.04f);
+		};
+		const auto point = [&](size_t x, size_t z) {
+			return vec3(float(x), height(x, z), float(z));
+		};
+
+		vector<TriangleBVH::Triangle> triangles;
+		for (size_t z = 0; z < grid_size; z++)
+		{
+			for (size_t x = 0; x < grid_size; x++)
+			{
+				const auto id = static_cast<std::uint32_t>(triangles.size());
+				triangles.push_back(TriangleBVH::Triangle{
+					point(x, z), point(x + 1, z), point(x, z + 1), id});
+				triangles.push_back(
+					TriangleBVH::Triangle{point(x + 1, z), point(x + 1, z + 1),
+										  point(x, z + 1), id + 1});
+			}
+		}
+
+		return triangles;
+	}
+
+	// Rays looking down onto the terrain from above, at an angle
+	vector<Ray> picking_rays()
+	{
+		std::mt19937 rng(5);
+		std::uniform_real_distribution<float> position(0.0f,
+														float(grid_size));
+		std::uniform_real_distribution<float> tilt(-0.5f, 0.5f);
+
+		vector<Ray> rays;
+		for (size_t i = 0; i < ray_count; i++)
+		{
+			rays.push_back(
+				Ray{vec3(position(rng), 40.0f, position(rng)),
+					glm::normalize(vec3(tilt(rng), -1.0f, tilt(rng)))});
+		}
+
+		return rays;
+	}
+
+	// Moller-Trumbore, as the tree tests the triangles of its leaves
+	std::optional<float> intersect(const Ray & ray,
+								   const TriangleBVH::Triangle & triangle)
+	{
+		const vec3 ab = triangle.b - triangle.a;
+		const vec3 ac = triangle.c - triangle.a;
+		const vec3 p = glm::cross(ray.direction, ac);
+		const float determinant = glm::dot(ab, p);
+		if (std::abs(determinant) < std::numeric_limits<float>::epsilon())
+		{
+			return std::nullopt;
+		}
+
+		const float inverse = 1.0f / determinant;
+		const vec3 offset = ray.origin - triangle.a;
+		const float u = glm::dot(offset, p) * inverse;
+		const vec3 q = glm::cross(offset, ab);
+		const float v = glm::dot(ray.direction, q) * inverse;
+		const float distance = glm::dot(ac, q) * inverse;
+		if (u < 0.0f || u > 1.0f || v < 0.0f || u + v > 1.0f ||
+			distance < 0.0f)
+		{
+			return std::nullopt;
+		}
+
+		return distance;
+	}
+
+	std::optional<float> brute_force(const vector<TriangleBVH::Triangle> & mesh,
+									 const Ray & ray)
+	{
+		std::optional<float> nearest;
+		for (const auto & triangle : mesh)
+		{
+			const auto distance = intersect(ray, triangle);
+			if (distance && (!nearest || *distance < *nearest))
+			{
+				nearest = distance;
+			}
+		}
+
+		return nearest;
+	}
+}   // namespace
+
+int main()
+{
+	const auto mesh = terrain();
+	const auto rays = picking_rays();
+
+	TriangleBVH bvh(mesh);
+
+	for (size_t i = 0; i < brute_force_ray_count; i++)
+	{
+		const auto hit = bvh.intersect(rays[i]);
+		const auto nearest = brute_force(mesh, rays[i]);
+		if (hit.has_value() != nearest.has_value() ||
+			(hit && hit->distance != *nearest))
+		{
+			std::printf("BVH and brute force ray queries differ\n");
+			return 1;
+		}
+	}
+
+	std::printf("%zu triangles, %zu nodes\n", mesh.size(),
+				bvh.get_nodes().size());
+	bench::report_header();
+
+	bench::report("build SAH",
+				  bench::time_runs([&] { TriangleBVH built(mesh); }, runs));
+
+	size_t sink = 0;
+	const auto cast_single = [&] {
+		for (const Ray & ray : rays)
+		{
+			sink += bvh.intersect(ray).has_value();
+		}
+	};
+	const auto cast_batch = [&] { sink += bvh.intersect(rays).size(); };
+	const auto cast_brute = [&] {
+		for (size_t i = 0; i < brute_force_ray_count; i++)
+		{
+			sink += brute_force(mesh, rays[i]).has_value();
+		}
+	};
+
+	bench::report("10k rays one by one", bench::time_runs(cast_single, runs));
+	bench::report("10k rays batched", bench::time_runs(cast_batch, runs));
+	bench::report("20 rays brute force", bench::time_runs(cast_brute, 1));
+
+	std::printf("(%zu hits)\n", sink);
+}
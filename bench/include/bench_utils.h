@@ -0,0 +1,85 @@
+/// <summary>
+/// Helpers for timing benchmarks and reporting their results.
+/// </summary>
+/// \file bench_utils.h
+
+#pragma once
+
+#include <glge/common.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+namespace glge::bench
+{
+	/// <summary>Times taken by the runs of a benchmark.</summary>
+	struct Timing
+	{
+		/// <summary>Mean time of a run in milliseconds.</summary>
+		double mean_ms = 0.0;
+		/// <summary>Fastest run in milliseconds.</summary>
+		double best_ms = 0.0;
+	};
+
+	/// <summary>Time repeated runs of a function.</summary>
+	/// The function is run once more beforehand, untimed, to warm caches.
+	/// <typeparam name="Fn">Type of function to run.</typeparam>
+	/// <param name="fn">Function to run.</param>
+	/// <param name="runs">Number of timed runs.</param>
+	/// <returns>Times taken by the runs.</returns>
+	template<typename Fn>
+	Timing time_runs(Fn && fn, size_t runs)
+	{
+		using clock = std::chrono::steady_clock;
+
+		fn();
+
+		Timing timing;
+		timing.best_ms = std::numeric_limits<double>::max();
+
+		for (size_t i = 0; i < runs; i++)
+		{
+			const auto start = clock::now();
+			fn();
+			const std::chrono::duration<double, std::milli> elapsed =
+				clock::now() - start;
+
+			timing.mean_ms += elapsed.count() / static_cast<double>(runs);
+			timing.best_ms = std::min(timing.best_ms, elapsed.count());
+		}
+
+		return timing;
+	}
+
+	/// <summary>Print a header for rows printed by report().</summary>
+	inline void report_header()
+	{
+		std::printf("%-40s %10s %10s %10s\n", "benchmark", "mean ms",
+					"best ms", "MB/s");
+	}
+
+	/// <summary>Print the result of a benchmark as a table row.</summary>
+	/// <param name="name">Name of the benchmark.</param>
+	/// <param name="timing">Times taken by its runs.</param>
+	/// <param name="bytes">
+	/// Bytes processed per run, for the throughput column, or 0 to leave
+	/// it out.
+	/// </param>
+	inline void report(const string & name, const Timing & timing,
+					   size_t bytes = 0)
+	{
+		if (bytes)
+		{
+			std::printf("%-40s %10.3f %10.3f %10.1f\n", name.c_str(),
+						timing.mean_ms, timing.best_ms,
+						static_cast<double>(bytes) / 1e3 / timing.best_ms);
+		}
+		else
+		{
+			std::printf("%-40s %10.3f %10.3f\n", name.c_str(),
+						timing.mean_ms, timing.best_ms);
+		}
+	}
+}   // namespace glge::bench
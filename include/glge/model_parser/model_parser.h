@@ -22,6 +22,8 @@ namespace glge::model_parser
 	/// <summary>
 	/// Write the given model data to a packed model file.
 	/// </summary>
+	/// The model's triangle BVH is stored too, if it has been built, so
+	/// that it need not be rebuilt on loading.
 	/// <param name="filepath">
 	/// Path to file to write to.
 	/// </param>
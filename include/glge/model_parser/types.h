@@ -7,8 +7,11 @@
 #pragma once
 
 #include <glge/common.h>
+#include <glge/util/triangle_bvh.h>
 #include <glge/util/util.h>
 
+#include <optional>
+
 /// <summary>
 /// Data representations for model files.
 /// </summary>
@@ -208,6 +211,17 @@ namespace glge::model_parser
 		NormalData normal_data;
 		/// <summary>Uvs and uv indices for the model.</summary>
 		UVData uv_data;
+		/// <summary>
+		/// Tree over the model's triangles for ray queries, if built.
+		/// </summary>
+		std::optional<math::TriangleBVH> triangle_bvh;
+
+		/// <summary>
+		/// Build triangle_bvh over the model's vertices.
+		/// </summary>
+		/// Triangles are identified by their position in the vertex
+		/// indices, which converting to EBOModelData preserves.
+		void build_triangle_bvh();
 
 		/// <summary>
 		/// Load a set of model data from the given file.
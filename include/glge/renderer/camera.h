@@ -96,7 +96,53 @@ namespace glge::renderer
 		/// <summary>
 		/// Computes the view frustum of this camera.
 		/// </summary>
+		/// The frustum is the region drawn with get_P() and get_V(), so
+		/// it opens along the negative z axis of the camera's placement.
+		/// Plane normals point into the frustum.
 		/// <returns>View frustum of the camera.</returns>
 		math::Frustum get_view_frustum() const;
+
+		/// <summary>
+		/// Estimates the size of a sphere in the image of this camera.
+		/// </summary>
+		/// The estimate depends only on the distance to the sphere, not on
+		/// where in the field of view it lies, so it also holds for
+		/// spheres just about to come into view.
+		/// <param name="sphere">Sphere in world space.</param>
+		/// <returns>
+		/// Height of the sphere as a fraction of the height of the image;
+		/// infinite if the camera is inside the sphere.
+		/// </returns>
+		float screen_size(math::Sphere sphere) const;
+
+		/// <summary>
+		/// Estimates the height in pixels of a length facing this camera.
+		/// </summary>
+		/// <param name="length">World space length.</param>
+		/// <param name="distance">
+		/// Distance of the length from the camera.
+		/// </param>
+		/// <param name="viewport_height">Height of the image in pixels.</param>
+		/// <returns>
+		/// Height in pixels; infinite if the length is not in front of the
+		/// camera.
+		/// </returns>
+		float pixel_size(float length, float distance,
+						 float viewport_height) const;
+
+		/// <summary>
+		/// Computes the ray through a point in the image of this camera.
+		/// </summary>
+		/// Points are given in window coordinates, as for
+		/// math::trackball_point, with y increasing downwards.
+		/// <param name="window_width">Width of the window.</param>
+		/// <param name="window_height">Height of the window.</param>
+		/// <param name="x">x-coordinate in window.</param>
+		/// <param name="y">y-coordinate in window.</param>
+		/// <returns>
+		/// World space ray from the camera through the point.
+		/// </returns>
+		math::Ray get_ray(float window_width, float window_height, float x,
+						  float y) const;
 	};
 }   // namespace glge::renderer
@@ -0,0 +1,225 @@
+/// <summary>Occlusion culling against a software depth buffer.</summary>
+///
+/// Contains a small CPU rasterizer drawing the depth of occluder meshes,
+/// against which the bounds of other objects are tested before they are
+/// drawn, with no readback from the GPU.
+///
+/// \file occlusion_culler.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/camera.h>
+#include <glge/renderer/primitives/primitive_data.h>
+#include <glge/util/math.h>
+
+#include <cstdint>
+
+namespace glge::util
+{
+	class ThreadPool;
+}
+
+namespace glge::renderer
+{
+	/// <summary>
+	/// Culls objects hidden behind occluder meshes, from the depth of the
+	/// occluders as drawn by the CPU.
+	/// </summary>
+	/// Each frame, begin() sets the camera, add_occluder() transforms the
+	/// triangles of low-poly occluder meshes and bins them into square
+	/// tiles of the depth buffer, and rasterize() draws the tiles on
+	/// worker threads, then reduces the buffer to a hierarchical-Z (HiZ)
+	/// pyramid whose every level holds the farthest depth of 2x2 texels
+	/// of the level above. visible() then tests the screen space bounds
+	/// of a Sphere against the level at which they span a few texels.
+	///
+	/// Occluders are drawn from both sides and their triangles are filled
+	/// at pixel centers, so meshes should lie within the objects they
+	/// stand for. The buffer covers the camera's whole image regardless
+	/// of its size, so need not match the aspect ratio of the camera.
+	///
+	/// As the camera tends to move little from frame to frame, results of
+	/// visible() may be kept in a CachedVisibility and reused for a few
+	/// frames, trading a little lag in revealing objects for fewer tests.
+	class OcclusionCuller
+	{
+	public:
+		/// <summary>Size of the square tiles of the depth buffer.</summary>
+		static constexpr size_t tile_size = 16;
+
+		/// <summary>
+		/// Limits on the camera's motion within which results of visible()
+		/// are reused.
+		/// </summary>
+		struct ReuseLimits
+		{
+			/// <summary>
+			/// Most frames to share a result, including the frame it was
+			/// found in; 1 reuses no results.
+			/// </summary>
+			size_t frames = 4;
+			/// <summary>
+			/// Farthest the camera may move from where a result was found.
+			/// </summary>
+			float distance = 0.05f;
+			/// <summary>
+			/// Largest angle the camera may turn from where a result was
+			/// found.
+			/// </summary>
+			math::Radians angle = math::Radians(0.01f);
+		};
+
+		/// <summary>Result of visible() kept for reuse.</summary>
+		/// Results are only reused for the same sphere, so that objects
+		/// which move are tested again, and by the culler which found
+		/// them, so that a cache may be shared between cullers.
+		struct CachedVisibility
+		{
+			/// <summary>
+			/// Run of frames the result was found in, or 0 if none.
+			/// </summary>
+			std::uint32_t epoch = 0;
+			/// <summary>Sphere tested.</summary>
+			math::Sphere sphere{0.0f, vec3(0.0f)};
+			/// <summary>Whether the sphere was visible.</summary>
+			bool visible = true;
+		};
+
+		/// <summary>
+		/// Limits on the camera's motion within which cached results are
+		/// reused; checked by begin().
+		/// </summary>
+		ReuseLimits reuse_limits;
+
+		/// <summary>Construct a culler.</summary>
+		/// <param name="width">
+		/// Width of the depth buffer; a multiple of tile_size.
+		/// </param>
+		/// <param name="height">
+		/// Height of the depth buffer; a multiple of tile_size.
+		/// </param>
+		/// <param name="pool">
+		/// Pool of worker threads to rasterize on; if null,
+		/// util::ThreadPool::shared() is used.
+		/// </param>
+		/// <exception cref="std::invalid_argument">
+		/// If the buffer is empty or not a whole number of tiles.
+		/// </exception>
+		OcclusionCuller(size_t width = 256, size_t height = 128,
+						observer_ptr<util::ThreadPool> pool = nullptr);
+
+		/// <summary>
+		/// Clear the occluders and depth buffer, and view from a camera.
+		/// </summary>
+		/// Cached results of visible() are dropped once the camera strays
+		/// beyond reuse_limits from where the first of them was found.
+		/// <param name="camera">Camera the scene is drawn from.</param>
+		void begin(const Camera & camera);
+
+		/// <summary>Add an occluder mesh to the depth buffer.</summary>
+		/// Triangles are clipped by the near plane, projected and binned
+		/// into the tiles they cover; they are only drawn by rasterize().
+		/// <param name="mesh">Vertices and indices of the occluder.</param>
+		/// <param name="M">Matrix from the mesh's space to world space.</param>
+		void add_occluder(const primitive::EBOModelData & mesh,
+						  const mat4 & M);
+
+		/// <summary>
+		/// Draw the occluders added since begin(), and build the HiZ
+		/// pyramid.
+		/// </summary>
+		/// Tiles are shared between workers by rows, so that no two
+		/// workers write to the same part of the buffer. Called from a
+		/// worker of the pool, drawing stays on that worker.
+		void rasterize();
+
+		/// <summary>
+		/// Test whether a Sphere may be seen past the occluders.
+		/// </summary>
+		/// Spheres reaching in front of the near plane or out of the image
+		/// are always visible, as are all spheres before rasterize().
+		/// <param name="sphere">World space bounds of an object.</param>
+		/// <returns>
+		/// False only if every occluder pixel covering the sphere is
+		/// nearer than the sphere's nearest point.
+		/// </returns>
+		bool visible(math::Sphere sphere) const;
+
+		/// <summary>
+		/// Test whether a Sphere may be seen past the occluders, reusing
+		/// a result cached in an earlier frame if the camera has kept
+		/// within reuse_limits since.
+		/// </summary>
+		/// <param name="sphere">World space bounds of an object.</param>
+		/// <param name="cache">
+		/// Result of an earlier test of the object, updated when tested
+		/// again.
+		/// </param>
+		/// <returns>As for visible(math::Sphere).</returns>
+		bool visible(math::Sphere sphere, CachedVisibility & cache) const;
+
+		/// <summary>Get the width of the depth buffer.</summary>
+		size_t width() const { return buffer_width; }
+
+		/// <summary>Get the height of the depth buffer.</summary>
+		size_t height() const { return buffer_height; }
+
+		/// <summary>Get the depth drawn at a pixel.</summary>
+		/// Rows run from the top of the image down.
+		/// <param name="x">Column of the pixel.</param>
+		/// <param name="y">Row of the pixel.</param>
+		/// <returns>
+		/// Distance along the camera's view direction to the nearest
+		/// occluder; infinite where none was drawn.
+		/// </returns>
+		float depth(size_t x, size_t y) const;
+
+		/// <summary>
+		/// Get the number of triangles binned since begin(), after
+		/// clipping.
+		/// </summary>
+		size_t triangle_count() const { return triangles.size(); }
+
+	private:
+		// Triangle in pixel coordinates, with the reciprocal of its view
+		// depth at each vertex; 1/w is linear in screen space
+		struct ScreenTriangle
+		{
+			vec3 vertices[3];
+		};
+
+		size_t buffer_width;
+		size_t buffer_height;
+		size_t tiles_x;
+		size_t tiles_y;
+		observer_ptr<util::ThreadPool> pool;
+
+		mat4 VP;
+		mat4 V;
+		mat4 P;
+		float near_distance;
+
+		vector<ScreenTriangle> triangles;
+		// Triangles overlapping each tile, row by row
+		vector<vector<std::uint32_t>> bins;
+
+		// Reciprocal view depth of the nearest occluder at each pixel of
+		// each level, 0 where none was drawn; level 0 is the depth buffer
+		vector<vector<float>> levels;
+		vector<std::pair<size_t, size_t>> level_sizes;
+		bool rasterized = false;
+
+		// Run of frames within reuse_limits of the camera at its start,
+		// unique across all cullers, and the frames and camera seen since
+		std::uint32_t epoch = 0;
+		size_t epoch_frames = 0;
+		vec3 epoch_position = vec3(0.0f);
+		vec3 epoch_direction = vec3(0.0f);
+		mat4 epoch_P = mat4(1.0f);
+
+		void bin(const ScreenTriangle & triangle);
+		void rasterize_tile(size_t tile_x, size_t tile_y);
+		void build_pyramid();
+	};
+}   // namespace glge::renderer
@@ -0,0 +1,78 @@
+/// <summary>Support for block-compressed textures.</summary>
+///
+/// Contains a CPU encoder for BC1 and BC3 blocks, and a writer for glge's
+/// precompressed texture files. Precompressed files hold every mip level
+/// of a texture or cubemap, and are loaded with
+/// Texture::from_compressed_file and Cubemap::from_compressed_file
+/// without decoding.
+///
+/// \file compressed_texture.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/image.h>
+
+#include <cstdint>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>Block compression formats.</summary>
+	enum class BlockFormat : std::uint32_t
+	{
+		/// <summary>
+		/// 8 bytes per 4x4 block, RGB; also known as DXT1.
+		/// </summary>
+		BC1,
+		/// <summary>
+		/// 16 bytes per 4x4 block, RGBA with interpolated alpha; also known
+		/// as DXT5.
+		/// </summary>
+		BC3
+	};
+
+	/// <summary>Get the size of a block of a compression format.</summary>
+	/// <param name="format">Compression format.</param>
+	/// <returns>Bytes per 4x4 block.</returns>
+	size_t block_bytes(BlockFormat format);
+
+	/// <summary>Get the compressed size of an image.</summary>
+	/// Partial blocks at the right and top edges count as whole blocks.
+	/// <param name="format">Compression format.</param>
+	/// <param name="width">Width of the image in pixels.</param>
+	/// <param name="height">Height of the image in pixels.</param>
+	/// <returns>Bytes needed to hold the compressed image.</returns>
+	size_t compressed_size(BlockFormat format, size_t width, size_t height);
+
+	/// <summary>Compress an image into blocks.</summary>
+	/// Endpoints are chosen from the bounding box of each block's colors,
+	/// which is fast and adequate for offline conversion.
+	/// <param name="image">RGB or RGBA image to compress.</param>
+	/// <param name="format">Compression format.</param>
+	/// <returns>Blocks in row order, starting from the first row.</returns>
+	vector<std::uint8_t> compress_image(const Image & image,
+										BlockFormat format);
+
+	/// <summary>Decompress blocks into an RGBA image.</summary>
+	/// <param name="blocks">Blocks in row order.</param>
+	/// <param name="width">Width of the image in pixels.</param>
+	/// <param name="height">Height of the image in pixels.</param>
+	/// <param name="format">Compression format of the blocks.</param>
+	/// <returns>The decompressed image, with 4 channels.</returns>
+	Image decompress_image(const std::uint8_t * blocks, size_t width,
+						   size_t height, BlockFormat format);
+
+	/// <summary>Write a precompressed texture file.</summary>
+	/// Levels are compressed in parallel. Each level starts at an offset
+	/// aligned to 16 bytes.
+	/// <param name="path">Path of the file to write.</param>
+	/// <param name="faces">
+	/// Mip chains of each face, finest level first; one face for a 2D
+	/// texture, or six in the order right, left, top, bottom, back, front
+	/// for a cubemap. All faces must have the same sizes.
+	/// </param>
+	/// <param name="format">Compression format.</param>
+	void write_compressed_texture(const string & path,
+								  const vector<vector<Image>> & faces,
+								  BlockFormat format);
+}   // namespace glge::renderer::primitive
@@ -32,5 +32,17 @@ namespace glge::renderer::primitive
 		/// <param name="file_info">Descriptor for the cubemap files.</param>
 		/// <returns>Pointer to created cubemap.</returns>
 		static unique_ptr<Cubemap> from_file(const CubemapFileInfo & file_info);
+
+		/// <summary>
+		/// Load a cubemap from a precompressed texture file.
+		/// </summary>
+		/// Compressed levels are uploaded as stored, with no decoding.
+		/// <param name="file_info">
+		/// Descriptor for a file written by write_compressed_texture with
+		/// six faces.
+		/// </param>
+		/// <returns>Pointer to created cubemap.</returns>
+		static unique_ptr<Cubemap>
+		from_compressed_file(const TextureFileInfo & file_info);
 	};
 }   // namespace glge::renderer::primitive
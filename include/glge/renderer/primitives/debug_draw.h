@@ -0,0 +1,149 @@
+/// <summary>Immediate-mode drawing of debug lines.</summary>
+///
+/// Contains a batcher which collects lines, spheres, boxes and frustums
+/// drawn for debugging over a frame, and draws them all at once.
+///
+/// \file debug_draw.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/util/math.h>
+
+#include <array>
+#include <cstdint>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>Vertex of a debug line.</summary>
+	struct DebugVertex
+	{
+		/// <summary>Position of the vertex.</summary>
+		vec3 position;
+		/// <summary>Color of the line at the vertex.</summary>
+		vec3 color;
+	};
+
+	/// <summary>Kinds of line drawn by a DebugDraw.</summary>
+	enum class DebugPrimitive
+	{
+		/// <summary>Separate segments, one per pair of vertices.</summary>
+		Lines,
+		/// <summary>Open polylines.</summary>
+		LineStrip,
+		/// <summary>Closed polylines.</summary>
+		LineLoop
+	};
+
+	/// <summary>Number of enumerators in DebugPrimitive.</summary>
+	constexpr size_t debug_primitive_count = 3;
+
+	/// <summary>Lines of one kind collected by a DebugDraw.</summary>
+	struct DebugBatch
+	{
+		/// <summary>Vertices of every line.</summary>
+		vector<DebugVertex> vertices;
+
+		/// <summary>
+		/// Indices of the vertices of each polyline, each polyline ended
+		/// by DebugDraw::restart_index; empty for separate segments, which
+		/// are drawn in order.
+		/// </summary>
+		vector<std::uint32_t> indices;
+	};
+
+	/// <summary>
+	/// Batcher of lines drawn for debugging, such as paths, bounds and
+	/// view frustums.
+	/// </summary>
+	/// Shapes are added to CPU-side batches, one per DebugPrimitive, and
+	/// stay until clear() is called, usually at the start of each frame.
+	/// Rendering streams the batches into a single buffer, uploaded only
+	/// when they have changed, and draws each with one draw call. Drawn
+	/// with VertexColorShader.
+	class DebugDraw : public Renderable
+	{
+	public:
+		/// <summary>Index ending each polyline of a batch.</summary>
+		static constexpr std::uint32_t restart_index = 0xffffffff;
+
+		DebugDraw() = default;
+
+		virtual ~DebugDraw() = default;
+
+		/// <summary>Add a line segment.</summary>
+		/// <param name="from">Start of the segment.</param>
+		/// <param name="to">End of the segment.</param>
+		/// <param name="color">Color of the segment.</param>
+		void line(vec3 from, vec3 to, vec3 color);
+
+		/// <summary>Add an open polyline.</summary>
+		/// <param name="points">Points of the polyline, in order.</param>
+		/// <param name="color">Color of the polyline.</param>
+		void strip(const vector<vec3> & points, vec3 color);
+
+		/// <summary>Add a closed polyline.</summary>
+		/// <param name="points">Points of the polyline, in order.</param>
+		/// <param name="color">Color of the polyline.</param>
+		void loop(const vector<vec3> & points, vec3 color);
+
+		/// <summary>Add a sphere, drawn as three orthogonal circles.</summary>
+		/// <param name="sphere">Sphere to draw.</param>
+		/// <param name="color">Color of the sphere.</param>
+		/// <param name="segments">Number of segments of each circle.</param>
+		void sphere(const math::Sphere & sphere, vec3 color,
+					size_t segments = 24);
+
+		/// <summary>Add an axis-aligned box.</summary>
+		/// <param name="min">Corner with the smallest coordinates.</param>
+		/// <param name="max">Corner with the largest coordinates.</param>
+		/// <param name="color">Color of the box.</param>
+		void box(vec3 min, vec3 max, vec3 color);
+
+		/// <summary>Add a transformed cube.</summary>
+		/// Draws the cube from -1 to 1 on each axis, transformed by a
+		/// matrix and then divided by w, so that projective matrices may
+		/// be used.
+		/// <param name="transform">Transformation of the cube.</param>
+		/// <param name="color">Color of the box.</param>
+		void box(const mat4 & transform, vec3 color);
+
+		/// <summary>Add the view frustum of a camera.</summary>
+		/// <param name="view_projection">
+		/// Product of the camera's projection and view matrices.
+		/// </param>
+		/// <param name="color">Color of the frustum.</param>
+		void frustum(const mat4 & view_projection, vec3 color);
+
+		/// <summary>Remove every line.</summary>
+		void clear();
+
+		/// <summary>Get the lines of one kind.</summary>
+		/// <param name="primitive">Kind of line.</param>
+		/// <returns>Batch of lines of that kind.</returns>
+		const DebugBatch & batch(DebugPrimitive primitive) const;
+
+		/// <summary>Get the number of vertices in every batch.</summary>
+		/// <returns>Total number of vertices.</returns>
+		size_t vertex_count() const;
+
+		/// <summary>Create a debug line batcher.</summary>
+		/// <returns>Pointer to created batcher.</returns>
+		static unique_ptr<DebugDraw> create();
+
+	protected:
+		/// <summary>Count of changes to the batches.</summary>
+		/// Lets implementations skip uploading unchanged batches.
+		/// <returns>Number of changes made since construction.</returns>
+		std::uint64_t generation() const { return changes; }
+
+	private:
+		std::array<DebugBatch, debug_primitive_count> batches;
+		std::uint64_t changes = 0;
+
+		DebugBatch & modify(DebugPrimitive primitive);
+		void polyline(DebugPrimitive primitive, const vector<vec3> & points,
+					  vec3 color);
+	};
+}   // namespace glge::renderer::primitive
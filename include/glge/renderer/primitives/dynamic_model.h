@@ -0,0 +1,107 @@
+/// <summary>Support for 3D models modified after loading.</summary>
+///
+/// Contains class for 3D models whose vertices may be updated in place,
+/// such as editable terrain or animated geometry.
+///
+/// \file dynamic_model.h
+
+#pragma once
+
+#include <glge/common.h>
+
+#include <glge/renderer/primitives/model.h>
+#include <glge/renderer/primitives/primitive_data.h>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>
+	/// Class representing a 3D model whose vertex attributes may be updated
+	/// a range at a time.
+	/// </summary>
+	/// The indices of the model are fixed; the positions, normals and uvs
+	/// of its vertices may be overwritten. Updates are collected as dirty
+	/// ranges and uploaded on the next render. The model keeps several
+	/// copies of its vertex storage and moves to the next copy on each
+	/// render after an update, so that uploads do not wait for the GPU to
+	/// finish drawing from the copy used last. Its bounds grow to take in
+	/// moved vertices, but never shrink.
+	class DynamicModel : public Model
+	{
+	public:
+		/// <summary>Default number of copies of the vertex storage.</summary>
+		static constexpr size_t default_buffer_count = 3;
+
+		DynamicModel() = default;
+
+		virtual ~DynamicModel() = default;
+
+		/// <summary>Overwrite a range of vertex positions.</summary>
+		/// Throws std::out_of_range if the range does not lie within the
+		/// model's vertices.
+		/// <param name="first">Index of the first vertex to overwrite.</param>
+		/// <param name="values">New positions, in order.</param>
+		/// <param name="count">Number of positions to overwrite.</param>
+		virtual void update_vertices(size_t first, const vec3 * values,
+									 size_t count) = 0;
+
+		/// <summary>Overwrite a range of vertex normals.</summary>
+		/// Throws std::out_of_range if the range does not lie within the
+		/// model's normals.
+		/// <param name="first">Index of the first normal to overwrite.</param>
+		/// <param name="values">New normals, in order.</param>
+		/// <param name="count">Number of normals to overwrite.</param>
+		virtual void update_normals(size_t first, const vec3 * values,
+									size_t count) = 0;
+
+		/// <summary>Overwrite a range of vertex uvs.</summary>
+		/// Throws std::out_of_range if the range does not lie within the
+		/// model's uvs.
+		/// <param name="first">Index of the first uv to overwrite.</param>
+		/// <param name="values">New uvs, in order.</param>
+		/// <param name="count">Number of uvs to overwrite.</param>
+		virtual void update_uvs(size_t first, const vec2 * values,
+								size_t count) = 0;
+
+		/// <summary>Overwrite a range of vertex positions.</summary>
+		/// <param name="first">Index of the first vertex to overwrite.</param>
+		/// <param name="values">New positions, in order.</param>
+		void update_vertices(size_t first, const vector<vec3> & values)
+		{
+			update_vertices(first, values.data(), values.size());
+		}
+
+		/// <summary>Overwrite a range of vertex normals.</summary>
+		/// <param name="first">Index of the first normal to overwrite.</param>
+		/// <param name="values">New normals, in order.</param>
+		void update_normals(size_t first, const vector<vec3> & values)
+		{
+			update_normals(first, values.data(), values.size());
+		}
+
+		/// <summary>Overwrite a range of vertex uvs.</summary>
+		/// <param name="first">Index of the first uv to overwrite.</param>
+		/// <param name="values">New uvs, in order.</param>
+		void update_uvs(size_t first, const vector<vec2> & values)
+		{
+			update_uvs(first, values.data(), values.size());
+		}
+
+		/// <summary>Get the number of vertices of the model.</summary>
+		/// <returns>Number of vertices.</returns>
+		virtual size_t vertex_count() const = 0;
+
+		/// <summary>
+		/// Load a dynamic model from a set of model data. Data is copied,
+		/// so that updated ranges may be uploaded to every copy of the
+		/// vertex storage.
+		/// </summary>
+		/// <param name="model_data">Set of model data to load from.</param>
+		/// <param name="buffer_count">
+		/// Number of copies of the vertex storage; at least one.
+		/// </param>
+		/// <returns>Pointer to created model.</returns>
+		static unique_ptr<DynamicModel>
+		from_data(const EBOModelData & model_data,
+				  size_t buffer_count = default_buffer_count);
+	};
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,125 @@
+/// <summary>Support for offscreen rendering.</summary>
+///
+/// Contains classes for rendering into offscreen framebuffers and reading
+/// their contents back to CPU memory, with or without stalling the GPU.
+///
+/// \file framebuffer.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/image.h>
+#include <glge/util/util.h>
+
+#include <optional>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>
+	/// Class representing an offscreen render target with color and depth
+	/// attachments.
+	/// </summary>
+	class Framebuffer
+	{
+	public:
+		Framebuffer() = default;
+
+		virtual ~Framebuffer() = default;
+
+		/// <summary>Get the width of the framebuffer.</summary>
+		/// <returns>Width in pixels.</returns>
+		virtual size_t width() const = 0;
+
+		/// <summary>Get the height of the framebuffer.</summary>
+		/// <returns>Height in pixels.</returns>
+		virtual size_t height() const = 0;
+
+		/// <summary>
+		/// Set this framebuffer as the target of rendering operations and
+		/// resize the viewport to match it.
+		/// </summary>
+		/// <returns>
+		/// Handle restoring the previous target and viewport.
+		/// </returns>
+		virtual util::UniqueHandle bind() = 0;
+
+		/// <summary>
+		/// Clear the color attachment to a color and the depth attachment
+		/// to the far plane.
+		/// </summary>
+		/// <param name="color">RGBA color to clear to.</param>
+		virtual void clear(vec4 color) = 0;
+
+		/// <summary>
+		/// Read the color attachment back to CPU memory, waiting for all
+		/// pending rendering to finish.
+		/// </summary>
+		/// <returns>RGBA image of the framebuffer's contents.</returns>
+		virtual Image read() const = 0;
+
+		/// <summary>
+		/// Create a framebuffer with an RGBA color attachment and a depth
+		/// attachment.
+		/// </summary>
+		/// <param name="width">Width in pixels.</param>
+		/// <param name="height">Height in pixels.</param>
+		/// <returns>Pointer to created framebuffer.</returns>
+		static unique_ptr<Framebuffer> from_size(size_t width, size_t height);
+	};
+
+	/// <summary>
+	/// Asynchronous reader of framebuffer contents.
+	/// </summary>
+	/// Copies into a ring of GPU-side buffers, so that the copy of one frame
+	/// completes while the next frame renders. Results are returned in the
+	/// order they were requested.
+	class AsyncReadback
+	{
+	public:
+		AsyncReadback() = default;
+
+		virtual ~AsyncReadback() = default;
+
+		/// <summary>
+		/// Start copying the current contents of a framebuffer.
+		/// </summary>
+		/// If every buffer in the ring is in use, first waits for the oldest
+		/// copy and keeps its result for poll() or wait().
+		/// <param name="source">
+		/// Framebuffer to read; must match the size of this reader.
+		/// </param>
+		virtual void request(const Framebuffer & source) = 0;
+
+		/// <summary>
+		/// Get the oldest requested image if its copy has completed.
+		/// </summary>
+		/// <returns>
+		/// The image if it is ready, else an empty optional. Never blocks.
+		/// </returns>
+		virtual std::optional<Image> poll() = 0;
+
+		/// <summary>
+		/// Get the oldest requested image, waiting for its copy to complete.
+		/// </summary>
+		/// <returns>The oldest requested image.</returns>
+		virtual Image wait() = 0;
+
+		/// <summary>
+		/// Get the number of requested images not yet returned.
+		/// </summary>
+		/// <returns>Number of outstanding requests.</returns>
+		virtual size_t pending() const = 0;
+
+		/// <summary>
+		/// Create a reader for framebuffers of the given size.
+		/// </summary>
+		/// <param name="width">Width of the framebuffers to read.</param>
+		/// <param name="height">Height of the framebuffers to read.</param>
+		/// <param name="ring_size">
+		/// Number of copies that may be in flight at once.
+		/// </param>
+		/// <returns>Pointer to created reader.</returns>
+		static unique_ptr<AsyncReadback>
+		create(size_t width, size_t height, size_t ring_size = 3);
+	};
+}   // namespace glge::renderer::primitive
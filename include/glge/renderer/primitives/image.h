@@ -0,0 +1,122 @@
+/// <summary>Support for images held in CPU memory.</summary>
+///
+/// Contains a data object for 8-bit-per-channel images, such as those
+/// read back from a framebuffer or decoded from a texture file, and
+/// functions for processing them on the CPU.
+///
+/// \file image.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/util/thread_pool.h>
+
+#include <cstdint>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>
+	/// An image with 8 bits per channel, stored row by row.
+	/// </summary>
+	/// Rows are tightly packed and ordered bottom to top, as in OpenGL.
+	struct Image
+	{
+		/// <summary>Width of the image in pixels.</summary>
+		size_t width = 0;
+		/// <summary>Height of the image in pixels.</summary>
+		size_t height = 0;
+		/// <summary>Number of channels per pixel.</summary>
+		size_t channels = 4;
+		/// <summary>Pixel data.</summary>
+		vector<std::uint8_t> pixels;
+
+		/// <summary>Get the size of a row of the image in bytes.</summary>
+		/// <returns>Bytes per row.</returns>
+		size_t row_size() const { return width * channels; }
+
+		/// <summary>Get a pointer to the first channel of a pixel.</summary>
+		/// <param name="x">Column of the pixel.</param>
+		/// <param name="y">Row of the pixel, counted from the bottom.</param>
+		/// <returns>Pointer to the pixel's channels.</returns>
+		const std::uint8_t * pixel(size_t x, size_t y) const
+		{
+			return pixels.data() + y * row_size() + x * channels;
+		}
+	};
+
+	/// <summary>Filters used to build mip chains.</summary>
+	enum class MipFilter
+	{
+		/// <summary>
+		/// Average of the texels each texel covers; fastest, but softest.
+		/// </summary>
+		Box,
+		/// <summary>
+		/// Kaiser-windowed sinc over 3 texels of the smaller level each way;
+		/// sharp, with little ringing.
+		/// </summary>
+		Kaiser,
+		/// <summary>
+		/// Lanczos-windowed sinc over 3 texels of the smaller level each
+		/// way; sharpest, with some ringing at hard edges.
+		/// </summary>
+		Lanczos
+	};
+
+	/// <summary>Settings for building a mip chain.</summary>
+	struct MipSettings
+	{
+		/// <summary>Filter used to build each level.</summary>
+		MipFilter filter = MipFilter::Box;
+		/// <summary>
+		/// Whether color channels hold sRGB-encoded values, which are then
+		/// filtered in linear space; alpha is always filtered as is.
+		/// </summary>
+		/// Should be set for color textures, and left unset for data such
+		/// as heightmaps or normal maps.
+		bool srgb = false;
+	};
+
+	/// <summary>Build the full mip chain of an image.</summary>
+	/// Each level halves the size of the previous one, rounding down, until
+	/// a 1x1 level is reached. Levels are computed in floating point from
+	/// the previous level before it was rounded, so error does not build up
+	/// down the chain.
+	/// <param name="base">Image to use as level 0.</param>
+	/// <param name="settings">Filter and color space to use.</param>
+	/// <param name="pool">
+	/// Pool to filter bands of rows on in parallel; if null, or if called
+	/// from one of its workers, levels are built on the calling thread.
+	/// </param>
+	/// <returns>Every level of the chain, finest first.</returns>
+	vector<Image>
+	build_mip_chain(Image base, const MipSettings & settings = {},
+					observer_ptr<util::ThreadPool> pool = nullptr);
+
+	/// <summary>Build the full mip chains of several images at once.</summary>
+	/// Equivalent to building each chain with build_mip_chain, but all
+	/// images are filtered in parallel as well as their rows, which suits
+	/// the faces of a cubemap.
+	/// <param name="bases">Images to use as level 0 of each chain.</param>
+	/// <param name="settings">Filter and color space to use.</param>
+	/// <param name="pool">
+	/// Pool to filter on in parallel; if null, or if called from one of its
+	/// workers, chains are built on the calling thread.
+	/// </param>
+	/// <returns>
+	/// Every level of each chain, in the order of the images.
+	/// </returns>
+	vector<vector<Image>>
+	build_mip_chains(vector<Image> bases, const MipSettings & settings = {},
+					 observer_ptr<util::ThreadPool> pool = nullptr);
+
+	/// <summary>
+	/// Remap the color channels of an image into the NTSC safe range.
+	/// </summary>
+	/// Channels are scaled from [0, 255] to about [16, 235], as SOIL's
+	/// SOIL_FLAG_NTSC_SAFE_RGB did; alpha, if present, is left as is.
+	/// Textures loaded from image files are remapped in this way, so
+	/// tools writing texture files ahead of time remap them too.
+	/// <param name="image">Image to remap in place.</param>
+	void make_ntsc_safe(Image & image);
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,72 @@
+/// <summary>Native decoders for common image file formats.</summary>
+///
+/// Contains decoders for TGA and PNG files, the formats textures and
+/// cubemaps are usually shipped in. They keep no state between calls, so
+/// any number may run at once on worker threads. Variants of the formats
+/// rarely used for textures are not handled, so that callers can fall
+/// back to a general purpose decoder for them.
+///
+/// \file image_decoder.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/image.h>
+
+#include <cstdint>
+#include <optional>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>Decode a TGA file held in memory.</summary>
+	/// Handles uncompressed and run-length encoded true-color images with
+	/// 24 or 32 bits per pixel, and grayscale images with 8 bits per pixel.
+	/// Throws std::runtime_error if the file is truncated or malformed.
+	/// <param name="data">Contents of the file.</param>
+	/// <param name="size">Size of the file in bytes.</param>
+	/// <param name="channels">
+	/// Number of channels to convert the image to, from 1 to 4, or 0 to
+	/// keep those of the file.
+	/// </param>
+	/// <returns>
+	/// The decoded image, or nothing if the file uses a variant of the
+	/// format which is not handled.
+	/// </returns>
+	std::optional<Image> decode_tga(const std::uint8_t * data, size_t size,
+									size_t channels = 0);
+
+	/// <summary>Decode a PNG file held in memory.</summary>
+	/// Handles non-interlaced images with 8 bits per channel of every color
+	/// type, including palettes with transparency. Throws
+	/// std::runtime_error if the file is truncated or malformed.
+	/// <param name="data">Contents of the file.</param>
+	/// <param name="size">Size of the file in bytes.</param>
+	/// <param name="channels">
+	/// Number of channels to convert the image to, from 1 to 4, or 0 to
+	/// keep those of the file.
+	/// </param>
+	/// <returns>
+	/// The decoded image, or nothing if the file uses a variant of the
+	/// format which is not handled.
+	/// </returns>
+	std::optional<Image> decode_png(const std::uint8_t * data, size_t size,
+									size_t channels = 0);
+
+	/// <summary>Decode a TGA or PNG file on disk.</summary>
+	/// The file is mapped rather than read. PNG files are recognized by
+	/// their signature and TGA files, which have none, by their extension.
+	/// Rows are returned in the order they are shown, top first, as SOIL
+	/// returns them, so textures keep their orientation whichever decoder
+	/// loads them. Throws std::runtime_error if the file cannot be mapped
+	/// or is malformed.
+	/// <param name="path">Path to the file.</param>
+	/// <param name="channels">
+	/// Number of channels to convert the image to, from 1 to 4, or 0 to
+	/// keep those of the file.
+	/// </param>
+	/// <returns>
+	/// The decoded image, or nothing if the file is in a format, or a
+	/// variant of one, which is not handled.
+	/// </returns>
+	std::optional<Image> load_image(const string & path, size_t channels = 0);
+}   // namespace glge::renderer::primitive
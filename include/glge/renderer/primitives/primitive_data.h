@@ -8,6 +8,7 @@
 
 #include <glge/common.h>
 #include <glge/model_parser/types.h>
+#include <glge/renderer/primitives/image.h>
 
 namespace glge::renderer::primitive
 {
@@ -43,6 +44,10 @@ namespace glge::renderer::primitive
 		TexCoords uvs;
 		/// <summary>Index list. Indexes into all collections.</summary>
 		Indices indices;
+		/// <summary>
+		/// Tree over the model's triangles for ray queries, if built.
+		/// </summary>
+		std::optional<math::TriangleBVH> triangle_bvh;
 
 		/// <summary>
 		/// Copy a set of EBOModelData.
@@ -56,6 +61,19 @@ namespace glge::renderer::primitive
 		/// <param name="other">EBOModelData to move from.</param>
 		EBOModelData(EBOModelData && other) = default;
 
+		/// <summary>
+		/// Construct an EBOModelData from attributes already sharing a
+		/// single index list, such as a heightmap mesh.
+		/// </summary>
+		/// <param name="vertices">Vertex list.</param>
+		/// <param name="normals">
+		/// Normal vector list; empty, or one per vertex.
+		/// </param>
+		/// <param name="uvs">Uv list; empty, or one per vertex.</param>
+		/// <param name="indices">Index list.</param>
+		EBOModelData(Vertices vertices, Normals normals, TexCoords uvs,
+					 Indices indices);
+
 		/// <summary>Convert a ModelData to an EBOModelData.</summary>
 		/// <param name="data">
 		/// ModelData to be converted. Data is copied.
@@ -65,6 +83,11 @@ namespace glge::renderer::primitive
 		/// <summary>Convert a ModelData to an EBOModelData.</summary>
 		/// <param name="data">ModelData to be converted. Data is moved.</param>
 		EBOModelData(ModelData && data);
+
+		/// <summary>
+		/// Build triangle_bvh over the model's vertices.
+		/// </summary>
+		void build_triangle_bvh();
 	};
 
 	/// <summary>
@@ -74,6 +97,32 @@ namespace glge::renderer::primitive
 	{
 		/// <summary>Path to the texture file.</summary>
 		string path;
+		/// <summary>
+		/// How the mip chain of the texture is built when it is decoded.
+		/// </summary>
+		MipSettings mip_settings;
+
+		TextureFileInfo() = default;
+
+		/// <summary>Constructs a new TextureFileInfo.</summary>
+		/// Implicit, so that the faces of a CubemapFileInfo can still be
+		/// initialized from their paths alone.
+		/// <param name="path">Path to the texture file.</param>
+		/// <param name="mip_settings">
+		/// How the mip chain of the texture is built.
+		/// </param>
+		TextureFileInfo(string path, MipSettings mip_settings = {}) :
+			path(std::move(path)), mip_settings(mip_settings)
+		{}
+
+		/// <summary>Constructs a new TextureFileInfo.</summary>
+		/// <param name="path">Path to the texture file.</param>
+		/// <param name="mip_settings">
+		/// How the mip chain of the texture is built.
+		/// </param>
+		TextureFileInfo(czstring path, MipSettings mip_settings = {}) :
+			TextureFileInfo(string(path), mip_settings)
+		{}
 	};
 
 	/// <summary>
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <glge/util/math.h>
+
+#include <optional>
+
 namespace glge::renderer::primitive
 {
 	/// <summary>
@@ -17,6 +21,18 @@ namespace glge::renderer::primitive
 		/// </summary>
 		virtual void render() const = 0;
 
+		/// <summary>
+		/// Get a sphere enclosing the object, in its model space.
+		/// </summary>
+		/// <returns>
+		/// Bounding sphere of the object, or nothing if it has no known
+		/// bounds.
+		/// </returns>
+		virtual std::optional<math::Sphere> bounds() const
+		{
+			return std::nullopt;
+		}
+
 		virtual ~Renderable() = default;
 	};
 }   // namespace glge::renderer::primitive
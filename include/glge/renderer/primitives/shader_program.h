@@ -12,6 +12,8 @@
 
 #include <glge/renderer/primitives/cubemap.h>
 #include <glge/renderer/primitives/texture.h>
+#include <glge/renderer/primitives/texture_array.h>
+#include <glge/renderer/primitives/virtual_texture.h>
 
 #include <typeindex>
 #include <unordered_map>
@@ -58,6 +60,15 @@ namespace glge::renderer::primitive
 		/// <returns>Pointer to the loaded shader.</returns>
 		static unique_ptr<Shader<DataT>> load();
 
+		/// <summary>
+		/// Start building the shader corresponding to the given data type
+		/// without waiting for the build to finish.
+		/// </summary>
+		/// Lets the driver build several shaders at once; a later call to
+		/// load() finishes the build and reports any errors. Shaders built
+		/// this way must be loaded on the same thread.
+		static void prepare();
+
 		Shader() = default;
 
 		/// <summary>
@@ -126,6 +137,15 @@ namespace glge::renderer::primitive
 	private:
 		std::unordered_map<std::type_index, unique_ptr<ShaderBase>> shaders;
 
+		template<typename ShaderT>
+		void prepare_if_missing()
+		{
+			if (!shaders.count(typeid(ShaderT)))
+			{
+				ShaderT::prepare();
+			}
+		}
+
 	public:
 		/// <summary>
 		/// Construct a new ShaderManager with no managed shaders.
@@ -135,19 +155,39 @@ namespace glge::renderer::primitive
 		/// <summary>
 		/// Load the shader with the given type.
 		/// </summary>
+		/// If the shader is already loaded, returns the loaded shader.
 		/// <typeparam name="ShaderT">Type of the Shader to load.</typeparam>
 		/// <returns>Reference to the loaded Shader.</returns>
 		template<typename ShaderT>
 		ShaderT & load()
 		{
-			unique_ptr<ShaderT> shader = std::make_unique<ShaderT>();
-			ShaderT & shader_ref = *shader;
+			if (auto iter = shaders.find(typeid(ShaderT));
+				iter != shaders.end())
+			{
+				return static_cast<ShaderT &>(*iter->second);
+			}
+
+			unique_ptr<ShaderBase> shader = ShaderT::load();
+			ShaderT & shader_ref = static_cast<ShaderT &>(*shader);
 
 			shaders.emplace(typeid(ShaderT), std::move(shader));
 
 			return shader_ref;
 		}
 
+		/// <summary>
+		/// Load all shaders with the given types.
+		/// </summary>
+		/// Starts building every shader before waiting on any of them, so
+		/// that the driver can build them in parallel.
+		/// <typeparam name="ShaderTs">Types of the Shaders to load.</typeparam>
+		template<typename... ShaderTs>
+		void load_all()
+		{
+			(prepare_if_missing<ShaderTs>(), ...);
+			(load<ShaderTs>(), ...);
+		}
+
 		/// <summary>
 		/// Get a reference to the loaded shader with the given type.
 		/// </summary>
@@ -156,7 +196,7 @@ namespace glge::renderer::primitive
 		template<typename ShaderT>
 		ShaderT & get()
 		{
-			return shaders.at(typeid(ShaderT));
+			return static_cast<ShaderT &>(*shaders.at(typeid(ShaderT)));
 		}
 
 		~ShaderManager();
@@ -191,9 +231,32 @@ namespace glge::renderer::primitive
         /// </param>
 		virtual void operator()(const RenderParameters & render) const = 0;
 
+		/// <summary>
+		/// Get the 2D texture sampled by this shader instance.
+		/// </summary>
+		/// Used to find the textures drawn by each object in a scene.
+		/// <returns>
+		/// Pointer to the sampled texture, or null if none is sampled.
+		/// </returns>
+		virtual observer_ptr<const Texture> sampled_texture() const
+		{
+			return nullptr;
+		}
+
 		virtual ~ShaderInstanceBase() = default;
 	};
 
+	/// <summary>
+	/// Get the 2D texture sampled with a set of shader parameters.
+	/// </summary>
+	/// Overloaded for each type of shader parameters holding a Texture.
+	/// <returns>Null; the parameters hold no texture.</returns>
+	template<typename DataT>
+	observer_ptr<const Texture> texture_of(const DataT &)
+	{
+		return nullptr;
+	}
+
 	/// <summary>
 	/// An instance of a shader; represents a binding of
 	/// shader parameters to a shader program.
@@ -251,6 +314,17 @@ namespace glge::renderer::primitive
 		{
 			static_cast<Shader<DataT> &>(shader).parameterize(render, data);
 		}
+
+		/// <summary>
+		/// Get the 2D texture sampled by this shader instance.
+		/// </summary>
+		/// <returns>
+		/// Pointer to the sampled texture, or null if none is sampled.
+		/// </returns>
+		observer_ptr<const Texture> sampled_texture() const override
+		{
+			return texture_of(data);
+		}
 	};
 
 	/// <summary>
@@ -260,6 +334,13 @@ namespace glge::renderer::primitive
 	{
 	};
 
+	/// <summary>
+	/// Parameters for a DepthShader.
+	/// </summary>
+	struct DepthShaderData
+	{
+	};
+
 	/// <summary>
 	/// Parameters for a ColorShader.
 	/// </summary>
@@ -272,6 +353,13 @@ namespace glge::renderer::primitive
 	};
 
 
+	/// <summary>
+	/// Parameters for a VertexColorShader.
+	/// </summary>
+	struct VertexColorShaderData
+	{
+	};
+
 	/// <summary>
 	/// Parameters for a TextureShader.
 	/// </summary>
@@ -283,6 +371,33 @@ namespace glge::renderer::primitive
 		Texture & texture;
 	};
 
+	/// <summary>
+	/// Get the 2D texture sampled with a set of TextureShader parameters.
+	/// </summary>
+	/// <param name="data">Parameters of the shader.</param>
+	/// <returns>Pointer to the sampled texture.</returns>
+	inline observer_ptr<const Texture>
+	texture_of(const TextureShaderData & data)
+	{
+		return &data.texture;
+	}
+
+	/// <summary>
+	/// Parameters for a TextureArrayShader.
+	/// </summary>
+	struct TextureArrayShaderData
+	{
+		/// <summary>
+		/// Texture array to sample from.
+		/// </summary>
+		TextureArray & textures;
+
+		/// <summary>
+		/// Layer of the array to sample from.
+		/// </summary>
+		unsigned layer;
+	};
+
 	/// <summary>
 	/// Parameters for a SkyboxShader.
 	/// </summary>
@@ -305,24 +420,75 @@ namespace glge::renderer::primitive
 		Cubemap & skybox;
 	};
 
+	/// <summary>
+	/// Parameters for a VirtualTextureShader.
+	/// </summary>
+	struct VirtualTextureShaderData
+	{
+		/// <summary>
+		/// Virtual texture to sample from.
+		/// </summary>
+		VirtualTexture & texture;
+	};
+
+	/// <summary>
+	/// Parameters for a VirtualTextureFeedbackShader.
+	/// </summary>
+	struct VirtualTextureFeedbackShaderData
+	{
+		/// <summary>
+		/// Virtual texture to find the pages of.
+		/// </summary>
+		VirtualTexture & texture;
+
+		/// <summary>
+		/// Size of the feedback framebuffer relative to the screen, e.g.
+		/// 0.25 for a framebuffer a quarter as wide and high.
+		/// </summary>
+		float resolution_scale;
+	};
+
 	/// <summary>
 	/// A normal shader.
 	/// </summary>
 	/// Colors points according to the value of their normal vector.
 	using NormalShader = Shader<NormalShaderData>;
 
+	/// <summary>
+	/// A depth-only shader.
+	/// </summary>
+	/// Writes depth without writing color while bound. Used by the Renderer
+	/// to draw a depth pre-pass.
+	using DepthShader = Shader<DepthShaderData>;
+
 	/// <summary>
 	/// A basic RGB color shader.
 	/// </summary>
 	/// Uniformly shades points a single RGB color.
 	using ColorShader = Shader<ColorShaderData>;
 
+	/// <summary>
+	/// A per-vertex RGB color shader.
+	/// </summary>
+	/// Shades points with the color of their vertices, interpolated;
+	/// used to draw a DebugDraw.
+	using VertexColorShader = Shader<VertexColorShaderData>;
+
 	/// <summary>
 	/// A basic 2D texture shader.
 	/// </summary>
 	/// Shades points by directly sampling a 2D texture.
 	using TextureShader = Shader<TextureShaderData>;
 
+	/// <summary>
+	/// A 2D texture shader sampling one layer of a texture array.
+	/// </summary>
+	/// Shades points by directly sampling a layer of a texture array. The
+	/// array is only rebound when consecutive draws use different arrays,
+	/// so objects with textures packed into the same array are drawn
+	/// without texture binds.
+	using TextureArrayShader = Shader<TextureArrayShaderData>;
+
 	/// <summary>
 	/// A cubic skybox shader.
 	/// </summary>
@@ -337,21 +503,52 @@ namespace glge::renderer::primitive
 	/// from the environment, supplied by a cubemap.
 	using EnvMapShader = Shader<EnvMapShaderData>;
 
+	/// <summary>
+	/// A virtual texture shader.
+	/// </summary>
+	/// Shades points by sampling a VirtualTexture, through its indirection
+	/// table, from the finest cached page covering them.
+	using VirtualTextureShader = Shader<VirtualTextureShaderData>;
+
+	/// <summary>
+	/// A virtual texture feedback shader.
+	/// </summary>
+	/// Shades points with the page of a VirtualTexture they need, encoded
+	/// as by encode_feedback, for reading back and passing to
+	/// VirtualTexture::submit_feedback.
+	using VirtualTextureFeedbackShader =
+		Shader<VirtualTextureFeedbackShaderData>;
+
 	/// <summary>
 	/// Instance of a NormalShader.
 	/// </summary>
 	using NormalShaderInstance = ShaderInstance<NormalShaderData>;
 
+	/// <summary>
+	/// Instance of a DepthShader.
+	/// </summary>
+	using DepthShaderInstance = ShaderInstance<DepthShaderData>;
+
 	/// <summary>
 	/// Instance of a ColorShader.
 	/// </summary>
 	using ColorShaderInstance = ShaderInstance<ColorShaderData>;
 
+	/// <summary>
+	/// Instance of a VertexColorShader.
+	/// </summary>
+	using VertexColorShaderInstance = ShaderInstance<VertexColorShaderData>;
+
 	/// <summary>
 	/// Instance of a TextureShader.
 	/// </summary>
 	using TextureShaderInstance = ShaderInstance<TextureShaderData>;
 
+	/// <summary>
+	/// Instance of a TextureArrayShader.
+	/// </summary>
+	using TextureArrayShaderInstance = ShaderInstance<TextureArrayShaderData>;
+
 	/// <summary>
 	/// Instance of a SkyboxShader.
 	/// </summary>
@@ -361,4 +558,16 @@ namespace glge::renderer::primitive
 	/// Instance of a EnvMapShader.
 	/// </summary>
 	using EnvMapShaderInstance = ShaderInstance<EnvMapShaderData>;
+
+	/// <summary>
+	/// Instance of a VirtualTextureShader.
+	/// </summary>
+	using VirtualTextureShaderInstance =
+		ShaderInstance<VirtualTextureShaderData>;
+
+	/// <summary>
+	/// Instance of a VirtualTextureFeedbackShader.
+	/// </summary>
+	using VirtualTextureFeedbackShaderInstance =
+		ShaderInstance<VirtualTextureFeedbackShaderData>;
 }   // namespace glge::renderer::primitive
@@ -34,5 +34,17 @@ namespace glge::renderer::primitive
 		/// <param name="file_info">Descriptor for the texture file.</param>
 		/// <returns>Pointer to created texture.</returns>
 		static unique_ptr<Texture> from_file(const TextureFileInfo & file_info);
+
+		/// <summary>
+		/// Load a texture from a precompressed texture file.
+		/// </summary>
+		/// Compressed levels are uploaded as stored, with no decoding.
+		/// <param name="file_info">
+		/// Descriptor for a file written by write_compressed_texture with
+		/// one face.
+		/// </param>
+		/// <returns>Pointer to created texture.</returns>
+		static unique_ptr<Texture>
+		from_compressed_file(const TextureFileInfo & file_info);
 	};
 }   // namespace glge::renderer::primitive
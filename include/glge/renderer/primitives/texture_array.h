@@ -0,0 +1,88 @@
+/// <summary>Support for arrays of 2D textures.</summary>
+///
+/// Contains a class for 2D texture arrays, and a builder packing textures
+/// of the same size and format into the layers of shared arrays, so that
+/// objects using different textures can be drawn without rebinding.
+///
+/// \file texture_array.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/image.h>
+#include <glge/renderer/primitives/primitive_data.h>
+
+namespace glge::renderer::primitive
+{
+	class TextureArray;
+
+	/// <summary>Location of a texture within a set of arrays.</summary>
+	struct TextureLayer
+	{
+		/// <summary>Index of the array holding the texture.</summary>
+		size_t array;
+		/// <summary>Layer of the array holding the texture.</summary>
+		unsigned layer;
+	};
+
+	/// <summary>Result of packing textures into arrays.</summary>
+	struct PackedTextures
+	{
+		/// <summary>Arrays the textures were packed into.</summary>
+		vector<unique_ptr<TextureArray>> arrays;
+		/// <summary>
+		/// Location of each packed texture, in the order the textures were
+		/// given.
+		/// </summary>
+		vector<TextureLayer> layers;
+	};
+
+	/// <summary>Choose the array and layer to pack each texture into.</summary>
+	/// Textures with the same size and number of channels share an array,
+	/// up to a maximum number of layers, taking layers in the order the
+	/// textures are given. Arrays are ordered by size and channels, so
+	/// that the result does not depend on the order of decoding. Throws
+	/// std::invalid_argument if max_layers is 0.
+	/// <param name="bases">Finest level of each texture.</param>
+	/// <param name="max_layers">Most layers allowed in one array.</param>
+	/// <returns>
+	/// Location of each texture, in the same order as the bases; arrays
+	/// are numbered from 0 with none left empty.
+	/// </returns>
+	vector<TextureLayer>
+	plan_texture_layers(const vector<observer_ptr<const Image>> & bases,
+						size_t max_layers);
+
+	/// <summary>
+	/// Class representing an array of 2D textures of the same size and
+	/// format.
+	/// </summary>
+	class TextureArray
+	{
+	public:
+		TextureArray() = default;
+
+		virtual ~TextureArray() = default;
+
+		/// <summary>
+		/// Set this array as the texture array to be sampled from.
+		/// </summary>
+		virtual void activate() const = 0;
+
+		/// <summary>Get the number of layers in this array.</summary>
+		/// <returns>Number of layers.</returns>
+		virtual size_t layer_count() const = 0;
+
+		/// <summary>
+		/// Pack textures from files on disk into texture arrays.
+		/// </summary>
+		/// Files are decoded in parallel. Textures with the same size and
+		/// number of channels share an array, up to the maximum number of
+		/// layers supported by the driver, as by plan_texture_layers.
+		/// <param name="file_info">Descriptors for the texture files.</param>
+		/// <returns>
+		/// The created arrays and the location of each texture.
+		/// </returns>
+		static PackedTextures pack(const vector<TextureFileInfo> & file_info);
+	};
+}   // namespace glge::renderer::primitive
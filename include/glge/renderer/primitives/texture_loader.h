@@ -0,0 +1,88 @@
+/// <summary>Asynchronous loading of textures and cubemaps.</summary>
+///
+/// Contains a loader which decodes texture files on worker threads and
+/// uploads them to the GPU a little at a time, so that loading many
+/// textures does not stall rendering.
+///
+/// \file texture_loader.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/cubemap.h>
+#include <glge/renderer/primitives/primitive_data.h>
+#include <glge/renderer/primitives/texture.h>
+#include <glge/util/thread_pool.h>
+
+#include <future>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>
+	/// Loader of textures and cubemaps in two stages.
+	/// </summary>
+	/// Files are decoded, and their mip chains built, on a thread pool;
+	/// all six faces of a cubemap are decoded in parallel. Decoded images
+	/// are then uploaded by update(), which must be called from the
+	/// rendering thread and uploads no more than a fixed number of bytes
+	/// per call.
+	class TextureLoader
+	{
+	public:
+		/// <summary>Default upload budget per call to update().</summary>
+		static constexpr size_t default_frame_budget = 4 * 1024 * 1024;
+
+		TextureLoader() = default;
+
+		virtual ~TextureLoader() = default;
+
+		/// <summary>Start loading a texture.</summary>
+		/// The future is only made ready by update(), so the rendering
+		/// thread must not wait on it.
+		/// <param name="file_info">Descriptor for the texture file.</param>
+		/// <returns>
+		/// Future holding the loaded texture, or the exception raised
+		/// while loading it.
+		/// </returns>
+		virtual std::future<unique_ptr<Texture>>
+		load(const TextureFileInfo & file_info) = 0;
+
+		/// <summary>Start loading a cubemap.</summary>
+		/// The future is only made ready by update(), so the rendering
+		/// thread must not wait on it.
+		/// <param name="file_info">Descriptor for the cubemap files.</param>
+		/// <returns>
+		/// Future holding the loaded cubemap, or the exception raised
+		/// while loading it.
+		/// </returns>
+		virtual std::future<unique_ptr<Cubemap>>
+		load(const CubemapFileInfo & file_info) = 0;
+
+		/// <summary>
+		/// Upload decoded images to the GPU, up to the frame budget.
+		/// </summary>
+		/// Must be called from the thread owning the rendering context,
+		/// usually once per frame. At least one image is uploaded per call
+		/// if any are ready, so images larger than the budget still load.
+		/// <returns>Number of bytes uploaded.</returns>
+		virtual size_t update() = 0;
+
+		/// <summary>
+		/// Get the number of loads which have not yet completed.
+		/// </summary>
+		/// <returns>Number of outstanding loads.</returns>
+		virtual size_t pending() const = 0;
+
+		/// <summary>Create a texture loader.</summary>
+		/// <param name="frame_budget">
+		/// Maximum number of bytes uploaded per call to update().
+		/// </param>
+		/// <param name="pool">
+		/// Pool to decode files on; if null, the shared pool is used.
+		/// </param>
+		/// <returns>Pointer to created loader.</returns>
+		static unique_ptr<TextureLoader>
+		create(size_t frame_budget = default_frame_budget,
+			   observer_ptr<util::ThreadPool> pool = nullptr);
+	};
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,182 @@
+/// <summary>Streaming of texture mip levels under a memory budget.</summary>
+///
+/// Contains a manager which keeps on the GPU only the mip levels of its
+/// textures that are fine enough for the size they are drawn at, and the
+/// functions it uses to choose those levels.
+///
+/// \file texture_residency.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/primitive_data.h>
+#include <glge/renderer/primitives/texture.h>
+#include <glge/util/thread_pool.h>
+
+#include <cstdint>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>
+	/// Compute the finest mip level needed to draw a texture at a size.
+	/// </summary>
+	/// Assumes the texture is mapped once across the object drawing it, so
+	/// that a level with about one texel per pixel is enough.
+	/// <param name="width">Width of the finest level, in texels.</param>
+	/// <param name="height">Height of the finest level, in texels.</param>
+	/// <param name="pixels">
+	/// Size of the object drawing the texture, in pixels; may be infinite.
+	/// </param>
+	/// <returns>
+	/// Index of the level, 0 being the finest, and no greater than the
+	/// index of the 1x1 level.
+	/// </returns>
+	unsigned required_mip_level(size_t width, size_t height, float pixels);
+
+	/// <summary>
+	/// Residency wanted for one texture, as input to plan_residency.
+	/// </summary>
+	struct ResidencyRequest
+	{
+		/// <summary>GPU memory held by each level, finest first.</summary>
+		vector<std::uint64_t> level_bytes;
+
+		/// <summary>
+		/// Finest level of the mip tail, the levels which are always
+		/// resident.
+		/// </summary>
+		unsigned tail_level;
+
+		/// <summary>Finest level wanted.</summary>
+		unsigned requested_level;
+
+		/// <summary>
+		/// Size in pixels of the largest object drawing the texture in
+		/// the current frame, or 0 if none drew it.
+		/// </summary>
+		float priority;
+	};
+
+	/// <summary>
+	/// Choose the levels to keep resident for a set of textures.
+	/// </summary>
+	/// The mip tails of all textures are kept, even if they exceed the
+	/// budget. The remainder of the budget is handed out one level at a
+	/// time, first to textures drawn in the current frame, then to those
+	/// furthest from the level they requested, then to the largest on
+	/// screen.
+	/// <param name="requests">Residency wanted for each texture.</param>
+	/// <param name="budget">Bytes of GPU memory available.</param>
+	/// <returns>
+	/// Finest level to keep resident for each texture, in the same order
+	/// as the requests.
+	/// </returns>
+	vector<unsigned> plan_residency(const vector<ResidencyRequest> & requests,
+									std::uint64_t budget);
+
+	/// <summary>Configuration for a TextureResidency.</summary>
+	struct ResidencySettings
+	{
+		/// <summary>Bytes of GPU memory all textures may hold.</summary>
+		std::uint64_t budget_bytes = 256 * 1024 * 1024;
+
+		/// <summary>Maximum bytes uploaded per call to update().</summary>
+		size_t frame_budget = 4 * 1024 * 1024;
+
+		/// <summary>
+		/// Height of the image textures are drawn to, in pixels.
+		/// </summary>
+		float viewport_height = 1080.0f;
+
+		/// <summary>
+		/// Size, in texels, of the largest levels kept resident whether or
+		/// not they are needed.
+		/// </summary>
+		size_t tail_size = 64;
+	};
+
+	/// <summary>Memory held and wanted by a TextureResidency.</summary>
+	struct ResidencyStats
+	{
+		/// <summary>Bytes of GPU memory held by resident levels.</summary>
+		std::uint64_t resident_bytes = 0;
+
+		/// <summary>
+		/// Bytes of GPU memory needed to hold every level requested in the
+		/// last frame, along with the mip tails of all textures.
+		/// </summary>
+		std::uint64_t requested_bytes = 0;
+
+		/// <summary>Bytes of GPU memory all textures may hold.</summary>
+		std::uint64_t budget_bytes = 0;
+
+		/// <summary>Number of textures still being decoded.</summary>
+		size_t decoding = 0;
+	};
+
+	/// <summary>
+	/// Manager of textures whose mip levels are streamed in and out of GPU
+	/// memory as needed.
+	/// </summary>
+	/// Textures are decoded on a thread pool and kept in system memory;
+	/// only their coarsest levels are on the GPU at first. Each frame, the
+	/// size on screen of the objects drawing each texture is reported with
+	/// request(), which a Scene does when its SceneSettings point to the
+	/// manager. update() then evicts levels that are no longer wanted or
+	/// do not fit in the budget, and streams in finer levels a few at a
+	/// time, so that textures sharpen over the following frames.
+	class TextureResidency
+	{
+	public:
+		TextureResidency() = default;
+
+		virtual ~TextureResidency() = default;
+
+		/// <summary>Start loading a texture.</summary>
+		/// The texture can be used at once, but samples as black until
+		/// its mip tail has been uploaded by update().
+		/// <param name="file_info">Descriptor for the texture file.</param>
+		/// <returns>
+		/// Reference to the texture, which lives as long as this manager.
+		/// </returns>
+		virtual Texture & add(const TextureFileInfo & file_info) = 0;
+
+		/// <summary>
+		/// Report that a texture is drawn at a size in the current frame.
+		/// </summary>
+		/// The largest size reported for a texture before the next call to
+		/// update() is used. Textures not added to this manager are
+		/// ignored.
+		/// <param name="texture">Texture drawn.</param>
+		/// <param name="screen_size">
+		/// Size of the object drawing the texture, as a fraction of the
+		/// height of the image.
+		/// </param>
+		virtual void request(const Texture & texture, float screen_size) = 0;
+
+		/// <summary>
+		/// Evict and upload levels to match the requests of the frame.
+		/// </summary>
+		/// Must be called from the thread owning the rendering context,
+		/// usually once per frame. Levels are evicted at once, but no more
+		/// than the frame budget is uploaded per call, apart from at least
+		/// one level if any are wanted. Throws std::runtime_error if a
+		/// texture failed to decode.
+		/// <returns>Number of bytes uploaded.</returns>
+		virtual size_t update() = 0;
+
+		/// <summary>Get the memory held and wanted by the textures.</summary>
+		/// <returns>Statistics as of the last call to update().</returns>
+		virtual ResidencyStats statistics() const = 0;
+
+		/// <summary>Create a texture residency manager.</summary>
+		/// <param name="settings">Configuration of the manager.</param>
+		/// <param name="pool">
+		/// Pool to decode files on; if null, the shared pool is used.
+		/// </param>
+		/// <returns>Pointer to created manager.</returns>
+		static unique_ptr<TextureResidency>
+		create(const ResidencySettings & settings = ResidencySettings(),
+			   observer_ptr<util::ThreadPool> pool = nullptr);
+	};
+}   // namespace glge::renderer::primitive
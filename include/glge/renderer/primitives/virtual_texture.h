@@ -0,0 +1,356 @@
+/// <summary>Software virtual texturing.</summary>
+///
+/// Contains a virtual texture, which samples images far larger than fit in
+/// GPU memory by keeping only the pages of them that are in view in a
+/// fixed-size cache texture, and the parts it is built from: a tiled page
+/// file on disk, an LRU cache of pages, an indirection table from virtual
+/// pages to cached ones, and the encoding of the feedback pass that finds
+/// the pages in view.
+///
+/// \file virtual_texture.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/image.h>
+#include <glge/util/thread_pool.h>
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace glge::renderer::primitive
+{
+	/// <summary>Identifies a page of one level of a virtual texture.</summary>
+	struct PageId
+	{
+		/// <summary>Mip level of the page, 0 being the finest.</summary>
+		std::uint32_t level;
+		/// <summary>Column of the page within its level.</summary>
+		std::uint32_t x;
+		/// <summary>Row of the page within its level.</summary>
+		std::uint32_t y;
+
+		/// <summary>Test for equality with another page.</summary>
+		/// <param name="other">Page to compare to.</param>
+		/// <returns>True if both identify the same page.</returns>
+		bool operator==(const PageId & other) const
+		{
+			return level == other.level && x == other.x && y == other.y;
+		}
+
+		/// <summary>Get a key unique to this page.</summary>
+		/// <returns>Level, row and column packed into one integer.</returns>
+		std::uint32_t key() const { return level << 24 | y << 12 | x; }
+	};
+
+	/// <summary>Maximum number of pages across a level.</summary>
+	constexpr size_t max_virtual_pages = 4096;
+
+	/// <summary>Layout of the pages of a virtual texture.</summary>
+	/// Every level is cut into square pages of page_size texels, each
+	/// stored with a border of texels copied from its neighbours, so that
+	/// pages can be filtered bilinearly without seams. Pages at the edges
+	/// of small levels repeat the edge texels.
+	struct PageLayout
+	{
+		/// <summary>Width of the finest level, in texels.</summary>
+		size_t width;
+		/// <summary>Height of the finest level, in texels.</summary>
+		size_t height;
+		/// <summary>Width and height of a page, without its border.</summary>
+		size_t page_size;
+		/// <summary>Width of the border around each page.</summary>
+		size_t border;
+		/// <summary>
+		/// Number of levels; the coarsest has a single row or column of
+		/// pages.
+		/// </summary>
+		size_t level_count;
+
+		/// <summary>Compute the layout of an image.</summary>
+		/// Throws std::invalid_argument unless the width and height are
+		/// each a power of two multiple of the page size, no more than
+		/// max_virtual_pages pages across.
+		/// <param name="width">Width of the finest level.</param>
+		/// <param name="height">Height of the finest level.</param>
+		/// <param name="page_size">Width and height of a page.</param>
+		/// <param name="border">Width of the border around each page.</param>
+		/// <returns>Layout of the image.</returns>
+		static PageLayout for_image(size_t width, size_t height,
+									size_t page_size, size_t border);
+
+		/// <summary>Get the number of columns of pages of a level.</summary>
+		/// <param name="level">Index of the level.</param>
+		/// <returns>Number of pages across the level.</returns>
+		size_t pages_x(size_t level) const;
+
+		/// <summary>Get the number of rows of pages of a level.</summary>
+		/// <param name="level">Index of the level.</param>
+		/// <returns>Number of pages down the level.</returns>
+		size_t pages_y(size_t level) const;
+
+		/// <summary>Get the size across of a page with its border.</summary>
+		/// <returns>Texels across a stored page.</returns>
+		size_t padded_size() const { return page_size + 2 * border; }
+
+		/// <summary>Get the size of a stored page.</summary>
+		/// <returns>Bytes of a stored RGBA page.</returns>
+		size_t page_bytes() const { return padded_size() * padded_size() * 4; }
+	};
+
+	/// <summary>Write a page file for a virtual texture.</summary>
+	/// Pages are stored as RGBA, level by level and row by row, so that
+	/// any page can be read with a single seek.
+	/// <param name="path">Path of the file to write.</param>
+	/// <param name="levels">
+	/// Mip chain of the image, finest level first, as built by
+	/// build_mip_chain; levels past those of the layout are ignored. RGB
+	/// levels are stored opaque.
+	/// </param>
+	/// <param name="page_size">Width and height of a page.</param>
+	/// <param name="border">Width of the border around each page.</param>
+	void write_page_file(const string & path, const vector<Image> & levels,
+						 size_t page_size = 128, size_t border = 4);
+
+	/// <summary>Encode a page as a pixel of a feedback image.</summary>
+	/// Matches the encoding written by VirtualTextureFeedbackShader. The
+	/// alpha channel holds the level plus one, so that pixels cleared to
+	/// zero hold no page.
+	/// <param name="page">Page to encode.</param>
+	/// <returns>RGBA bytes of the pixel.</returns>
+	std::array<std::uint8_t, 4> encode_feedback(PageId page);
+
+	/// <summary>Find the pages seen in a feedback image.</summary>
+	/// <param name="feedback">RGBA image drawn by the feedback pass.</param>
+	/// <returns>
+	/// Each page seen, once, ordered by how many pixels saw it, most seen
+	/// first.
+	/// </returns>
+	vector<PageId> decode_feedback(const Image & feedback);
+
+	/// <summary>
+	/// Assignment of pages to the slots of a cache, evicting the least
+	/// recently used page when full.
+	/// </summary>
+	class PageCache
+	{
+	public:
+		/// <summary>Result of adding a page to the cache.</summary>
+		struct Insertion
+		{
+			/// <summary>Slot assigned to the page.</summary>
+			size_t slot;
+			/// <summary>Page previously held by the slot, if any.</summary>
+			std::optional<PageId> evicted;
+		};
+
+		/// <summary>Construct an empty cache.</summary>
+		/// <param name="capacity">Number of slots.</param>
+		explicit PageCache(size_t capacity);
+
+		/// <summary>Find the slot of a page, marking it as used.</summary>
+		/// <param name="page">Page to find.</param>
+		/// <returns>Slot holding the page, if it is cached.</returns>
+		std::optional<size_t> find(PageId page);
+
+		/// <summary>Test whether a page is cached.</summary>
+		/// <param name="page">Page to find.</param>
+		/// <returns>True if the page is cached.</returns>
+		bool contains(PageId page) const;
+
+		/// <summary>Add a page which is not cached.</summary>
+		/// <param name="page">Page to add.</param>
+		/// <param name="pinned">
+		/// Whether the page may never be evicted.
+		/// </param>
+		/// <returns>
+		/// Slot assigned to the page and the page evicted from it, or
+		/// nothing if every slot holds a pinned page.
+		/// </returns>
+		std::optional<Insertion> insert(PageId page, bool pinned = false);
+
+		/// <summary>Get the number of cached pages.</summary>
+		/// <returns>Number of slots in use.</returns>
+		size_t size() const { return slots.size() - free_slots.size(); }
+
+		/// <summary>Get the number of slots.</summary>
+		/// <returns>Number of pages the cache can hold.</returns>
+		size_t capacity() const { return slots.size(); }
+
+	private:
+		struct Slot
+		{
+			PageId page;
+			bool pinned;
+			std::list<size_t>::iterator use;
+		};
+
+		vector<Slot> slots;
+		vector<size_t> free_slots;
+		// Unpinned slots in use, most recently used first
+		std::list<size_t> uses;
+		std::unordered_map<std::uint32_t, size_t> pages;
+	};
+
+	/// <summary>
+	/// Table from the pages of a virtual texture to the cached pages to
+	/// sample for them.
+	/// </summary>
+	/// Holds one entry per page of every level. Each entry names the
+	/// finest cached page covering its page, at its level or coarser, so
+	/// that pages which are not cached are drawn blurred rather than
+	/// missing.
+	class IndirectionTable
+	{
+	public:
+		/// <summary>Entry of the table; also its layout as a texel.</summary>
+		struct Entry
+		{
+			/// <summary>Column of the cache slot.</summary>
+			std::uint8_t slot_x;
+			/// <summary>Row of the cache slot.</summary>
+			std::uint8_t slot_y;
+			/// <summary>Level of the cached page.</summary>
+			std::uint8_t level;
+			/// <summary>255 if a page covers the entry, else 0.</summary>
+			std::uint8_t valid;
+		};
+
+		/// <summary>Construct a table with no pages cached.</summary>
+		/// <param name="layout">Layout of the virtual texture.</param>
+		explicit IndirectionTable(const PageLayout & layout);
+
+		/// <summary>Record that a page has been cached.</summary>
+		/// <param name="page">Page cached.</param>
+		/// <param name="slot_x">Column of the slot holding it.</param>
+		/// <param name="slot_y">Row of the slot holding it.</param>
+		void map(PageId page, size_t slot_x, size_t slot_y);
+
+		/// <summary>Record that a page has been evicted.</summary>
+		/// Entries naming it fall back to the page its parent's entry
+		/// names.
+		/// <param name="page">Page evicted.</param>
+		void unmap(PageId page);
+
+		/// <summary>Get an entry of the table.</summary>
+		/// <param name="page">Page to look up.</param>
+		/// <returns>Entry for the page.</returns>
+		Entry entry(PageId page) const;
+
+		/// <summary>Get the entries of a level, row by row.</summary>
+		/// <param name="level">Index of the level.</param>
+		/// <returns>Entries of the level.</returns>
+		const vector<Entry> & level(size_t level) const;
+
+		/// <summary>
+		/// Get and clear the flag marking a level as changed.
+		/// </summary>
+		/// <param name="level">Index of the level.</param>
+		/// <returns>
+		/// True if the level changed since the last call for it.
+		/// </returns>
+		bool take_dirty(size_t level);
+
+	private:
+		PageLayout layout;
+		vector<vector<Entry>> levels;
+		vector<bool> dirty;
+
+		template<typename F>
+		void for_footprint(PageId page, F && f);
+	};
+
+	/// <summary>Configuration for a VirtualTexture.</summary>
+	struct VirtualTextureSettings
+	{
+		/// <summary>
+		/// Number of pages across the cache texture, which holds the
+		/// square of this many pages; at most 256.
+		/// </summary>
+		size_t cache_pages = 32;
+
+		/// <summary>Maximum pages uploaded per call to update().</summary>
+		size_t pages_per_update = 16;
+
+		/// <summary>
+		/// Pool to read pages on; if null, the shared pool is used.
+		/// </summary>
+		observer_ptr<util::ThreadPool> pool = nullptr;
+	};
+
+	/// <summary>Page counts of a VirtualTexture.</summary>
+	struct VirtualTextureStats
+	{
+		/// <summary>Number of pages in the cache.</summary>
+		size_t resident_pages = 0;
+		/// <summary>Number of pages seen by the last feedback.</summary>
+		size_t requested_pages = 0;
+		/// <summary>Number of pages being read or waiting for upload.</summary>
+		size_t loading_pages = 0;
+		/// <summary>Number of pages the cache can hold.</summary>
+		size_t capacity = 0;
+	};
+
+	/// <summary>
+	/// Texture backed by a page file, of which only the pages in view are
+	/// held in GPU memory.
+	/// </summary>
+	/// Drawn with VirtualTextureShader. Each frame, the scene is also drawn
+	/// with VirtualTextureFeedbackShader into a small Framebuffer, cleared
+	/// to zero, and read back with an AsyncReadback; the images read back
+	/// are passed to submit_feedback(). Pages seen there are read from the
+	/// page file on a thread pool and uploaded by update(). The pages of
+	/// the coarsest level are always cached, so every part of the texture
+	/// can be drawn.
+	class VirtualTexture
+	{
+	public:
+		VirtualTexture() = default;
+
+		virtual ~VirtualTexture() = default;
+
+		/// <summary>
+		/// Set this texture as the one sampled by VirtualTextureShader.
+		/// </summary>
+		/// Binds the cache to texture unit 0 and the indirection table to
+		/// texture unit 1.
+		virtual void activate() const = 0;
+
+		/// <summary>Get the layout of the pages of this texture.</summary>
+		/// <returns>Layout of the page file.</returns>
+		virtual const PageLayout & layout() const = 0;
+
+		/// <summary>Get the number of pages across the cache.</summary>
+		/// <returns>Pages across the cache texture.</returns>
+		virtual size_t cache_pages() const = 0;
+
+		/// <summary>Request the pages seen by a feedback pass.</summary>
+		/// Pages already cached are marked as used; the others are read
+		/// from the page file in the background, most seen first.
+		/// <param name="feedback">Image read back by the feedback pass.</param>
+		virtual void submit_feedback(const Image & feedback) = 0;
+
+		/// <summary>Upload pages which have been read.</summary>
+		/// Must be called from the thread owning the rendering context,
+		/// usually once per frame.
+		/// <returns>Number of pages uploaded.</returns>
+		virtual size_t update() = 0;
+
+		/// <summary>Get the page counts of this texture.</summary>
+		/// <returns>Current page counts.</returns>
+		virtual VirtualTextureStats statistics() const = 0;
+
+		/// <summary>Open a virtual texture.</summary>
+		/// Throws std::runtime_error if the page file is invalid.
+		/// <param name="path">File written by write_page_file.</param>
+		/// <param name="settings">Configuration of the texture.</param>
+		/// <returns>Pointer to created texture.</returns>
+		static unique_ptr<VirtualTexture>
+		from_page_file(const string & path,
+					   const VirtualTextureSettings & settings =
+						   VirtualTextureSettings());
+	};
+}   // namespace glge::renderer::primitive
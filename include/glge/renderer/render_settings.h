@@ -12,6 +12,13 @@
 
 namespace glge::renderer
 {
+	namespace primitive
+	{
+		template<typename DataT>
+		class Shader;
+		struct DepthShaderData;
+	}   // namespace primitive
+
 	/// <summary>
 	/// Configuration object for a Renderer.
 	/// </summary>
@@ -21,6 +28,23 @@ namespace glge::renderer
 		/// Pointer to a Camera to use to render.
 		/// </summary>
 		unique_ptr<Camera> camera = nullptr;
+
+		/// <summary>
+		/// Flag controlling whether targets using the same shader are drawn
+		/// in order of increasing distance from the camera, to reduce
+		/// overdraw.
+		/// </summary>
+		bool sort_front_to_back = true;
+
+		/// <summary>
+		/// Shader used to draw a depth-only pre-pass before shading, or null
+		/// to skip the pre-pass.
+		/// </summary>
+		/// With the pre-pass enabled, each pixel is shaded at most once by
+		/// the main pass, at the cost of drawing all geometry twice. Worth
+		/// enabling when fragment shading dominates the cost of a frame.
+		observer_ptr<primitive::Shader<primitive::DepthShaderData>>
+			depth_prepass_shader = nullptr;
 	};
 
 	/// <summary>
@@ -44,6 +68,12 @@ namespace glge::renderer
 		/// </summary>
 		const mat4 MVP;
 
+		/// <summary>
+		/// Fraction of pixels drawn for the RenderTarget; see
+		/// RenderTarget::fade.
+		/// </summary>
+		const float fade;
+
 		/// <summary>
 		/// Construct a new parameter set with the given settings and Model
 		/// matrix.
@@ -54,6 +84,10 @@ namespace glge::renderer
         /// <param name="M">
         /// Model matrix to render with.
         /// </param>
-		RenderParameters(const RenderSettings & settings, mat4 M);
+        /// <param name="fade">
+        /// Fraction of pixels to draw.
+        /// </param>
+		RenderParameters(const RenderSettings & settings, mat4 M,
+						 float fade = 1.0f);
 	};
 }   // namespace glge::renderer
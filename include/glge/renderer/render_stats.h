@@ -0,0 +1,218 @@
+/// <summary>Counters describing the work done by the renderer.</summary>
+///
+/// Contains data objects for per-frame rendering statistics and GPU memory
+/// usage, and the functions used by the rendering backend to record them.
+/// Recording is enabled by the GLGE_RENDER_STATS build option; when it is
+/// disabled, every recording function compiles to nothing.
+///
+/// \file render_stats.h
+
+#pragma once
+
+#include <glge/common.h>
+
+#include <array>
+#include <cstdint>
+
+namespace glge::renderer
+{
+#ifdef GLGE_RENDER_STATS
+	/// <summary>Flag for builds that record rendering statistics.</summary>
+	constexpr bool render_stats_enabled = true;
+#else
+	/// <summary>Flag for builds that record rendering statistics.</summary>
+	constexpr bool render_stats_enabled = false;
+#endif
+
+	/// <summary>
+	/// Counters for the work submitted to the rendering backend.
+	/// </summary>
+	struct FrameStats
+	{
+		/// <summary>Number of draw calls issued.</summary>
+		std::uint64_t draw_calls = 0;
+		/// <summary>Number of triangles submitted by draw calls.</summary>
+		std::uint64_t triangles = 0;
+		/// <summary>Number of vertices submitted by draw calls.</summary>
+		std::uint64_t vertices = 0;
+		/// <summary>Number of shader program binds.</summary>
+		std::uint64_t shader_binds = 0;
+		/// <summary>Number of vertex array object binds.</summary>
+		std::uint64_t vao_binds = 0;
+		/// <summary>Number of texture and cubemap binds.</summary>
+		std::uint64_t texture_binds = 0;
+		/// <summary>Number of shader uniform uploads.</summary>
+		std::uint64_t uniform_uploads = 0;
+		/// <summary>Number of objects rejected by culling.</summary>
+		std::uint64_t culled_objects = 0;
+		/// <summary>Number of objects enqueued for rendering.</summary>
+		std::uint64_t visible_objects = 0;
+		/// <summary>Number of bytes of data uploaded to the GPU.</summary>
+		std::uint64_t bytes_uploaded = 0;
+
+		/// <summary>Add another set of counters to this one.</summary>
+		/// <param name="other">Counters to add.</param>
+		/// <returns>Reference to this object.</returns>
+		FrameStats & operator+=(const FrameStats & other);
+
+		/// <summary>Subtract another set of counters from this one.</summary>
+		/// <param name="other">Counters to subtract.</param>
+		/// <returns>Reference to this object.</returns>
+		FrameStats & operator-=(const FrameStats & other);
+	};
+
+	/// <summary>Sum two sets of counters.</summary>
+	/// <param name="a">First set of counters.</param>
+	/// <param name="b">Second set of counters.</param>
+	/// <returns>Counter-wise sum.</returns>
+	FrameStats operator+(FrameStats a, const FrameStats & b);
+
+	/// <summary>Compute the difference of two sets of counters.</summary>
+	/// <param name="a">Set of counters to subtract from.</param>
+	/// <param name="b">Set of counters to subtract.</param>
+	/// <returns>Counter-wise difference.</returns>
+	FrameStats operator-(FrameStats a, const FrameStats & b);
+
+	/// <summary>Kinds of resources holding GPU memory.</summary>
+	enum class GPUResource
+	{
+		Model,
+		Lines,
+		Texture,
+		Cubemap,
+		Framebuffer
+	};
+
+	/// <summary>Number of enumerators in GPUResource.</summary>
+	constexpr size_t gpu_resource_count = 5;
+
+	/// <summary>
+	/// Amount of GPU memory currently held by glge, by resource type.
+	/// </summary>
+	struct MemoryStats
+	{
+		/// <summary>Bytes held, indexed by GPUResource.</summary>
+		std::array<std::uint64_t, gpu_resource_count> bytes{};
+
+		/// <summary>Get the bytes held by a type of resource.</summary>
+		/// <param name="resource">Type of resource to query.</param>
+		/// <returns>Bytes held by resources of the given type.</returns>
+		std::uint64_t operator[](GPUResource resource) const
+		{
+			return bytes[static_cast<size_t>(resource)];
+		}
+
+		/// <summary>Get the bytes held by all resources.</summary>
+		/// <returns>Total bytes held.</returns>
+		std::uint64_t total() const;
+	};
+
+	/// <summary>
+	/// Recording of rendering statistics by the rendering backend.
+	/// </summary>
+	/// Frame counters are kept per thread, so recording never synchronizes;
+	/// memory counters are shared between threads and updated atomically.
+	namespace stats
+	{
+		/// <summary>
+		/// Get the running frame counters for the calling thread.
+		/// </summary>
+		/// <returns>Reference to the calling thread's counters.</returns>
+		FrameStats & thread_counters();
+
+		/// <summary>
+		/// Adjust the GPU memory held by a type of resource.
+		/// </summary>
+		/// <param name="resource">Type of resource.</param>
+		/// <param name="delta">Change in bytes held.</param>
+		void adjust_memory(GPUResource resource, std::int64_t delta);
+
+		/// <summary>
+		/// Get the GPU memory currently held by glge resources.
+		/// </summary>
+		/// <returns>Snapshot of the memory counters.</returns>
+		MemoryStats memory();
+
+		/// <summary>Record a draw call.</summary>
+		/// <param name="vertices">Number of vertices drawn.</param>
+		/// <param name="triangles">Number of triangles drawn.</param>
+		inline void record_draw(std::uint64_t vertices, std::uint64_t triangles)
+		{
+			if constexpr (render_stats_enabled)
+			{
+				auto & counters = thread_counters();
+				counters.draw_calls++;
+				counters.vertices += vertices;
+				counters.triangles += triangles;
+			}
+		}
+
+		/// <summary>Record a shader program bind.</summary>
+		inline void record_shader_bind()
+		{
+			if constexpr (render_stats_enabled)
+			{
+				thread_counters().shader_binds++;
+			}
+		}
+
+		/// <summary>Record a vertex array object bind.</summary>
+		inline void record_vao_bind()
+		{
+			if constexpr (render_stats_enabled)
+			{
+				thread_counters().vao_binds++;
+			}
+		}
+
+		/// <summary>Record a texture bind.</summary>
+		inline void record_texture_bind()
+		{
+			if constexpr (render_stats_enabled)
+			{
+				thread_counters().texture_binds++;
+			}
+		}
+
+		/// <summary>Record a shader uniform upload.</summary>
+		inline void record_uniform_upload()
+		{
+			if constexpr (render_stats_enabled)
+			{
+				thread_counters().uniform_uploads++;
+			}
+		}
+
+		/// <summary>Record a transfer of data to the GPU.</summary>
+		/// <param name="bytes">Number of bytes transferred.</param>
+		inline void record_upload(std::uint64_t bytes)
+		{
+			if constexpr (render_stats_enabled)
+			{
+				thread_counters().bytes_uploaded += bytes;
+			}
+		}
+
+		/// <summary>Record the allocation of GPU memory.</summary>
+		/// <param name="resource">Type of resource allocated.</param>
+		/// <param name="bytes">Number of bytes allocated.</param>
+		inline void record_allocation(GPUResource resource, std::uint64_t bytes)
+		{
+			if constexpr (render_stats_enabled)
+			{
+				adjust_memory(resource, static_cast<std::int64_t>(bytes));
+			}
+		}
+
+		/// <summary>Record the release of GPU memory.</summary>
+		/// <param name="resource">Type of resource released.</param>
+		/// <param name="bytes">Number of bytes released.</param>
+		inline void record_release(GPUResource resource, std::uint64_t bytes)
+		{
+			if constexpr (render_stats_enabled)
+			{
+				adjust_memory(resource, -static_cast<std::int64_t>(bytes));
+			}
+		}
+	}   // namespace stats
+}   // namespace glge::renderer
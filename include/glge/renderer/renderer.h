@@ -9,9 +9,10 @@
 
 #include <glge/common.h>
 #include <glge/renderer/render_settings.h>
+#include <glge/renderer/render_stats.h>
 
-#include <map>
-#include <typeindex>
+#include <cstdint>
+#include <utility>
 
 namespace glge::renderer
 {
@@ -28,6 +29,22 @@ namespace glge::renderer
 	/// </summary>
 	void configure_environment();
 
+	/// <summary>
+	/// Enable caching of linked shader programs on disk.
+	/// </summary>
+	/// Shaders loaded after this call reuse program binaries saved by
+	/// earlier runs on the same driver, instead of compiling their source.
+	/// Binaries rejected by the driver are recompiled from source and
+	/// replaced. Has no effect if the driver supports no binary formats.
+	/// <param name="directory">
+	/// Directory to store binaries in, created if missing; an empty string
+	/// disables the cache.
+	/// </param>
+	/// <exception cref="std::runtime_error">
+	/// Thrown if the directory cannot be created.
+	/// </exception>
+	void configure_shader_cache(const string & directory);
+
 	/// <summary>
 	/// A target to be rendered along with its shader and Model matrix.
 	/// </summary>
@@ -47,8 +64,25 @@ namespace glge::renderer
 		/// Model matrix of the target.
 		/// </summary>
 		mat4 M;
+
+		/// <summary>
+		/// Fraction of the target's pixels drawn, for dithered cross-fades
+		/// between levels of detail.
+		/// </summary>
+		/// Pixels are left out by an ordered dither pattern. A negative
+		/// fade draws exactly the pixels a fade of 1 + fade leaves out, so
+		/// that the levels fading in and out together cover every pixel
+		/// once.
+		float fade = 1.0f;
 	};
 
+	/// <summary>
+	/// Sequence of render targets recorded independently of a Renderer.
+	/// </summary>
+	/// Allows rendering tasks to be recorded on several threads at once,
+	/// then merged into a Renderer with a single call.
+	using CommandList = vector<RenderTarget>;
+
 	/// <summary>
 	/// Container and runner for rendering jobs.
 	/// </summary>
@@ -57,7 +91,11 @@ namespace glge::renderer
 	/// current rendering context.
 	class Renderer
 	{
-		std::multimap<std::type_index, RenderTarget> render_targets;
+		CommandList render_targets;
+		vector<std::pair<std::uint64_t, size_t>> draw_order;
+		FrameStats frame_stats;
+
+		void sort_targets();
 
 	public:
 		/// <summary>
@@ -88,9 +126,22 @@ namespace glge::renderer
 					 const primitive::ShaderInstanceBase & shader_instance,
 					 mat4 M);
 
+		/// <summary>
+		/// Add all render tasks in a CommandList.
+		/// </summary>
+		/// <param name="commands">
+		/// Render tasks to add; moved from if this Renderer has no tasks.
+		/// </param>
+		void enqueue(CommandList && commands);
+
 		/// <summary>
 		/// Run all render tasks.
 		/// </summary>
+		/// Tasks are grouped by shader, so that each shader is bound once.
+		/// Within a group, tasks run front to back if
+		/// RenderSettings::sort_front_to_back is set, else in the order they
+		/// were added. If RenderSettings::depth_prepass_shader is set, all
+		/// tasks are first drawn with it to fill the depth buffer.
 		void render();
 
 		/// <summary>
@@ -98,5 +149,21 @@ namespace glge::renderer
 		/// </summary>
 		/// <returns>Number of rendering tasks in this Renderer.</returns>
 		size_t target_count() const;
+
+		/// <summary>
+		/// Record that objects were rejected by culling before they could be
+		/// enqueued in this Renderer.
+		/// </summary>
+		/// <param name="count">Number of culled objects.</param>
+		void record_culled(std::uint64_t count);
+
+		/// <summary>
+		/// Get the statistics recorded for this Renderer.
+		/// </summary>
+		/// Includes the objects enqueued in and culled before reaching this
+		/// Renderer, and the work submitted by all calls to render(). All
+		/// counters are zero if glge was built without GLGE_RENDER_STATS.
+		/// <returns>Statistics recorded for this Renderer.</returns>
+		const FrameStats & statistics() const;
 	};
 }   // namespace glge::renderer
@@ -7,6 +7,15 @@
 #include <glge/common.h>
 #include <glge/renderer/renderer.h>
 #include <glge/renderer/scene_graph/scene_settings.h>
+#include <glge/util/math.h>
+
+#include <cstdint>
+#include <optional>
+
+namespace glge::renderer::primitive
+{
+	struct EBOModelData;
+}
 
 namespace glge::renderer::scene_graph
 {
@@ -14,35 +23,107 @@ namespace glge::renderer::scene_graph
 	struct SceneCamera;
 	class Scene;
 	class CameraHandle;
+	class FlatScene;
+	class NodeStore;
+
+	/// <summary>
+	/// Generational reference to a node within a Scene.
+	/// </summary>
+	/// Nodes are kept in pooled slots which are reused once their nodes
+	/// are removed; the generation of the slot tells a reference to a
+	/// removed node from a reference to the node reusing its slot.
+	struct NodeId
+	{
+		/// <summary>Kind of node, choosing the pool holding it.</summary>
+		std::uint8_t kind;
+		/// <summary>Slot of the node in its pool.</summary>
+		std::uint32_t slot;
+		/// <summary>Generation of the slot when referenced.</summary>
+		std::uint32_t generation;
+	};
+
+	/// <summary>One level of detail drawn by a LOD node.</summary>
+	struct DetailLevel
+	{
+		/// <summary>Renderable object drawn at this level.</summary>
+		primitive::Renderable & renderable;
+
+		/// <summary>Shader used to draw this level.</summary>
+		primitive::ShaderInstanceBase & shader;
+
+		/// <summary>
+		/// Geometric error of this level in model space: the farthest its
+		/// surface strays from the finest level's; 0 for the finest level.
+		/// </summary>
+		float error;
+	};
+
+	/// <summary>Options for choosing the level a LOD node draws.</summary>
+	struct LODSettings
+	{
+		/// <summary>
+		/// Largest error in pixels a level may show on screen; the
+		/// coarsest level within it is drawn.
+		/// </summary>
+		float max_screen_error = 1.0f;
+
+		/// <summary>
+		/// Fraction of max_screen_error by which a coarser level's error
+		/// must fall within it before the node switches to that level, so
+		/// that levels do not flicker at the threshold.
+		/// </summary>
+		float hysteresis = 0.25f;
+
+		/// <summary>
+		/// Frames over which a new level is cross-faded in by dithering,
+		/// drawing both levels; 0 switches levels at once.
+		/// </summary>
+		/// See RenderTarget::fade.
+		std::uint32_t fade_frames = 0;
+	};
 
 	/// <summary>
 	/// Object allowing manipulation of nodes within a Scene
 	/// </summary>
+	/// Handles outlive the nodes they refer to; using the handle of a
+	/// removed node throws std::logic_error.
 	class NodeHandle
 	{
 	protected:
-		/// <summary>Parent of the pointed-to node.</summary>
-		observer_ptr<Node> parent;
-		/// <summary>The node being pointed to.</summary>
-		Node & node;
+		/// <summary>Reference to the node being pointed to.</summary>
+		NodeId id;
 		/// <summary>The Scene this node belongs to.</summary>
 		Scene & scene;
 
+		/// <summary>Get the node being pointed to.</summary>
+		/// <returns>The pointed-to node.</returns>
+		Node & get() const;
+
 	public:
 		/// <summary>
-		/// Constructs a new NodeHandle with the given parent,
-		/// node, and scene.
+		/// Constructs a new NodeHandle with the given node and scene.
 		/// </summary>
-        /// <param name="parent">
-        /// Pointer to parent of the pointed-to node.
-        /// </param>
-        /// <param name="node">
-        /// The pointed-to node.
-        /// </param>
-        /// <param name="scene">
-        /// The scene containing the node.
-        /// </param>
-		NodeHandle(observer_ptr<Node> parent, Node & node, Scene & scene);
+		/// <param name="id">
+		/// Reference to the pointed-to node.
+		/// </param>
+		/// <param name="scene">
+		/// The scene containing the node.
+		/// </param>
+		NodeHandle(NodeId id, Scene & scene);
+
+		/// <summary>
+		/// Check whether the node is still in the scene.
+		/// </summary>
+		/// <returns>False once the node has been removed.</returns>
+		bool valid() const;
+
+		/// <summary>
+		/// Remove this node and its descendants from the scene.
+		/// </summary>
+		/// Their storage is returned to the scene's pools for reuse, and
+		/// every handle to them becomes stale. The root may not be
+		/// removed.
+		void remove();
 
 		/// <summary>
 		/// Add geometry to the scene under this node.
@@ -57,12 +138,36 @@ namespace glge::renderer::scene_graph
 		NodeHandle add_geometry(primitive::Renderable & renderable,
 								primitive::ShaderInstanceBase & shader);
 
+		/// <summary>
+		/// Add a level of detail (LOD) node to the scene under this node,
+		/// drawing one of several renderables chosen by its error on
+		/// screen.
+		/// </summary>
+		/// Each traversal, the node draws the coarsest level whose error,
+		/// scaled by the node's world matrix and projected at the distance
+		/// of the finest level's bounds from the active camera, stays
+		/// within LODSettings::max_screen_error. Errors are measured in
+		/// pixels of a viewport SceneSettings::viewport_height high. The
+		/// node is culled by the bounds of its finest level.
+		/// <param name="levels">
+		/// Levels of detail, from the finest to the coarsest.
+		/// </param>
+		/// <param name="settings">Options for choosing levels.</param>
+		/// <returns>NodeHandle of the created node.</returns>
+		/// <exception cref="std::invalid_argument">
+		/// If there are no levels, their errors are negative or decrease
+		/// from one level to the next, or the settings are out of range.
+		/// </exception>
+		NodeHandle add_lod(vector<DetailLevel> levels,
+						   const LODSettings & settings = LODSettings{});
+
 		/// <summary>
 		/// Add a transform to the scene under this node.
 		/// </summary>
 		/// <param name="placement">
 		/// Reference to the Placement used to control this transform. Not
-		/// copied.
+		/// copied. World matrices below the transform are cached, and only
+		/// recomputed once the Placement's version changes.
 		/// </param>
 		/// <returns>NodeHandle of the created node.</returns>
 		NodeHandle add_transform(const util::Placement & placement);
@@ -75,6 +180,20 @@ namespace glge::renderer::scene_graph
 		/// </param>
 		/// <returns>NodeHandle of the created node.</returns>
 		CameraHandle add_camera(const CameraIntrinsics & intrinsics);
+
+		/// <summary>
+		/// Make this geometry node hide the objects behind it from
+		/// occlusion culling.
+		/// </summary>
+		/// See SceneSettings::occlusion_culler.
+		/// <param name="mesh">
+		/// Low-poly mesh lying within the geometry, in the same model
+		/// space. Not copied.
+		/// </param>
+		/// <exception cref="std::logic_error">
+		/// If this node is not a geometry node.
+		/// </exception>
+		void set_occluder(const primitive::EBOModelData & mesh);
 	};
 
 	/// <summary>
@@ -84,21 +203,15 @@ namespace glge::renderer::scene_graph
 	{
 	public:
 		/// <summary>
-		/// Constructs a new CameraHandle with the given parent,
-		/// node, and scene.
+		/// Constructs a new CameraHandle with the given node and scene.
 		/// </summary>
-        /// <param name="parent">
-        /// Pointer to parent of the pointed-to node.
-        /// </param>
-        /// <param name="node">
-        /// The pointed-to node.
-        /// </param>
-        /// <param name="scene">
-        /// The scene containing the node.
-        /// </param>
-		CameraHandle(observer_ptr<Node> parent,
-					 SceneCamera & node,
-					 Scene & scene);
+		/// <param name="id">
+		/// Reference to the pointed-to camera node.
+		/// </param>
+		/// <param name="scene">
+		/// The scene containing the node.
+		/// </param>
+		CameraHandle(NodeId id, Scene & scene);
 
 		/// <summary>
 		/// Sets this camera node as the active camera in the scene.
@@ -112,7 +225,21 @@ namespace glge::renderer::scene_graph
 	class Scene
 	{
 	private:
-		unique_ptr<Node> root;
+		// Pools holding every node, with the root first
+		unique_ptr<NodeStore> nodes;
+		observer_ptr<Node> root;
+		// Flattened copy of the graph, built when first traversed after
+		// nodes are added or removed
+		mutable unique_ptr<FlatScene> flat;
+
+		friend class NodeHandle;
+		void structure_changed();
+
+		// The flattened graph, built if nodes changed since last used
+		FlatScene & flattened() const;
+
+		// Flattened graph with up to date world matrices and index
+		FlatScene & indexed() const;
 
 	public:
 		/// <summary>
@@ -130,6 +257,8 @@ namespace glge::renderer::scene_graph
 		/// whose state reflects the graph at the time of
 		/// traversal.
 		/// </summary>
+		/// Must not be called on the same Scene from several threads at
+		/// once, since the traversal may update cached state.
 		/// <returns>
 		/// Renderer to render the 3D scene described by this object.
 		/// </returns>
@@ -142,6 +271,35 @@ namespace glge::renderer::scene_graph
 		/// <returns>NodeHandle for the root node of the Scene.</summary>
 		NodeHandle get_root_handle();
 
+		/// <summary>
+		/// Get the number of nodes in this Scene, including the root.
+		/// </summary>
+		/// <returns>Number of nodes.</returns>
+		size_t node_count() const;
+
+		/// <summary>
+		/// Find the nearest geometry along a ray.
+		/// </summary>
+		/// Geometry is tested by its world space bounds, through a
+		/// bounding volume hierarchy kept up to date as placements
+		/// change. Geometry without bounds is never picked.
+		/// <param name="ray">
+		/// World space ray, e.g. from Camera::get_ray.
+		/// </param>
+		/// <returns>
+		/// NodeHandle of the nearest geometry whose bounds the ray hits,
+		/// if any.
+		/// </returns>
+		std::optional<NodeHandle> pick(const math::Ray & ray);
+
+		/// <summary>
+		/// Find every geometry overlapping a sphere.
+		/// </summary>
+		/// As with pick(), geometry is tested by its bounds.
+		/// <param name="sphere">World space sphere to search.</param>
+		/// <returns>NodeHandles of the geometry found.</returns>
+		vector<NodeHandle> overlapping(math::Sphere sphere);
+
 		~Scene();
 	};
 }   // namespace glge::renderer::scene_graph
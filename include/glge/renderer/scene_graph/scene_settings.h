@@ -9,6 +9,22 @@
 
 #include <glge/common.h>
 
+namespace glge::util
+{
+	class ThreadPool;
+}
+
+namespace glge::renderer
+{
+	class OcclusionCuller;
+}
+
+namespace glge::renderer::primitive
+{
+	class DebugDraw;
+	class TextureResidency;
+}
+
 namespace glge::renderer::scene_graph
 {
 	struct SceneCamera;
@@ -24,13 +40,89 @@ namespace glge::renderer::scene_graph
 		/// <summary>
 		/// Flag controlling whether bounding spheres should be drawn.
 		/// </summary>
+		/// Spheres are added to debug_draw when preparing a Renderer, so
+		/// are only drawn if it is set.
 		bool draw_bounding_spheres;
 
 		/// <summary>
 		/// Flag controlling whether view frustum culling should be used.
 		/// </summary>
+		/// Before traversal, each node is given a world space sphere
+		/// enclosing the bounds of all geometry beneath it. Traversal then
+		/// skips every subtree whose sphere lies outside the active
+		/// camera's view frustum, recording the geometry skipped with
+		/// Renderer::record_culled. Subtrees holding a Renderable with no
+		/// bounds are never culled.
 		bool enable_VF_culling;
 
+		/// <summary>
+		/// Culler to skip subtrees hidden behind occluders with when
+		/// preparing a Renderer; if null, none are skipped.
+		/// </summary>
+		/// Before traversal, the meshes of geometry made occluders with
+		/// NodeHandle::set_occluder are drawn into the culler's depth
+		/// buffer from the active camera, skipping those outside the view
+		/// frustum if enable_VF_culling is set. Traversal then skips every
+		/// subtree whose bounding sphere lies wholly behind them, recording
+		/// the geometry skipped with Renderer::record_culled, as for view
+		/// frustum culling.
+		observer_ptr<OcclusionCuller> occlusion_culler = nullptr;
+
+		/// <summary>
+		/// Flag controlling whether culling makes use of results found in
+		/// earlier traversals and in parent nodes.
+		/// </summary>
+		/// Each node's frustum test starts from the plane which last culled
+		/// it, and skips the planes its parent's sphere lies wholly inside.
+		/// Occlusion tests reuse results found in earlier traversals while
+		/// the camera keeps within the culler's
+		/// OcclusionCuller::reuse_limits, so objects coming out from
+		/// behind occluders may be drawn a few frames late.
+		bool coherent_culling = false;
+
+		/// <summary>
+		/// Height in pixels of the viewport the scene is drawn to, against
+		/// which LOD nodes measure the error of their levels on screen.
+		/// </summary>
+		float viewport_height = 1080.0f;
+
+		/// <summary>
+		/// Flag controlling whether independent subtrees of the scene are
+		/// traversed in parallel when preparing a Renderer.
+		/// </summary>
+		bool parallel_traversal = true;
+
+		/// <summary>
+		/// Flag controlling whether the scene is traversed through a
+		/// flattened copy of the graph when preparing a Renderer.
+		/// </summary>
+		/// The copy holds the nodes in contiguous arrays in depth-first
+		/// order, so that world matrices and bounds are computed by linear
+		/// passes over them with no virtual calls or pointer chasing. It is
+		/// rebuilt on the first traversal after nodes are added. Flattened
+		/// traversal is serial, so parallel_traversal has no effect.
+		bool flat_traversal = false;
+
+		/// <summary>
+		/// Pool of worker threads used for parallel traversal; if null,
+		/// util::ThreadPool::shared() is used.
+		/// </summary>
+		observer_ptr<util::ThreadPool> thread_pool = nullptr;
+
+		/// <summary>
+		/// Manager to report the size on screen of the textures drawn by
+		/// the scene to when preparing a Renderer; if null, none are
+		/// reported.
+		/// </summary>
+		observer_ptr<primitive::TextureResidency> texture_residency = nullptr;
+
+		/// <summary>
+		/// Batcher to add debug lines such as bounding spheres to when
+		/// preparing a Renderer; if null, none are drawn. It is not
+		/// cleared by the scene, nor enqueued in the Renderer.
+		/// </summary>
+		observer_ptr<primitive::DebugDraw> debug_draw = nullptr;
+
 		/// <summary>
 		/// Constructs a new SceneSettings with the given settings.
 		/// </summary>
@@ -39,12 +131,10 @@ namespace glge::renderer::scene_graph
 		/// </param>
 		/// <param name="draw_bounding_spheres">
 		/// Controls whether bounding spheres in the scene should be drawn.
-		/// CURRENTLY UNUSED.
 		/// </param>
 		/// <param name="enable_VF_culling">
 		/// Controls whether the scene traversal should use view frustum
 		/// culling when rendering.
-		/// CURRENTLY UNUSED.
 		/// </param>
 		SceneSettings(observer_ptr<const SceneCamera> active_camera,
 					  bool draw_bounding_spheres,
@@ -0,0 +1,341 @@
+/// <summary>Bounding volume hierarchy for spatial queries.</summary>
+///
+/// \file bvh.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/util/math.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace glge::math
+{
+	/// <summary>
+	/// Dynamic binary tree of AABBs over bounded items, answering frustum,
+	/// ray and sphere queries.
+	/// </summary>
+	/// Each leaf holds one item, bounded by a Sphere. Trees may be built
+	/// at once, splitting by the surface area heuristic (SAH), or grown by
+	/// insertion, each new leaf going where it adds least surface area.
+	/// Updating the bounds of an item refits the boxes above it, rotating
+	/// subtrees on the way up wherever that shrinks them, so that the tree
+	/// stays close to a fresh build while items move coherently; items
+	/// which jump clear of their old bounds are reinserted instead.
+	class BVH
+	{
+	public:
+		/// <summary>Value identifying an item to the user.</summary>
+		using Item = std::uint32_t;
+
+		/// <summary>
+		/// Handle to the leaf holding an item; valid until the item is
+		/// removed, after which it may be reused.
+		/// </summary>
+		using Leaf = std::uint32_t;
+
+		/// <summary>An item to build a tree over.</summary>
+		struct Entry
+		{
+			/// <summary>Bounds of the item.</summary>
+			Sphere bounds;
+			/// <summary>The item.</summary>
+			Item item;
+		};
+
+		/// <summary>Item hit by a ray.</summary>
+		struct RayHit
+		{
+			/// <summary>The item hit.</summary>
+			Item item;
+			/// <summary>Distance along the ray to the hit.</summary>
+			float distance;
+		};
+
+		/// <summary>Construct an empty tree.</summary>
+		BVH() = default;
+
+		/// <summary>
+		/// Replace the contents of the tree with a SAH build over items.
+		/// </summary>
+		/// <param name="entries">Items to hold, with their bounds.</param>
+		/// <returns>Leaves holding the items, in the same order.</returns>
+		vector<Leaf> build(const vector<Entry> & entries);
+
+		/// <summary>Add an item to the tree.</summary>
+		/// <param name="bounds">Bounds of the item.</param>
+		/// <param name="item">Item to add.</param>
+		/// <returns>Leaf holding the item.</returns>
+		Leaf insert(Sphere bounds, Item item);
+
+		/// <summary>Change the bounds of an item.</summary>
+		/// <param name="leaf">Leaf holding the item.</param>
+		/// <param name="bounds">New bounds of the item.</param>
+		void update(Leaf leaf, Sphere bounds);
+
+		/// <summary>Remove an item from the tree.</summary>
+		/// <param name="leaf">Leaf holding the item.</param>
+		void remove(Leaf leaf);
+
+		/// <summary>Remove every item from the tree.</summary>
+		void clear();
+
+		/// <summary>Get the number of items in the tree.</summary>
+		size_t size() const { return leaf_count; }
+
+		/// <summary>Get the item held by a leaf.</summary>
+		Item item(Leaf leaf) const { return nodes[leaf].item; }
+
+		/// <summary>Get the bounds of the item held by a leaf.</summary>
+		Sphere bounds(Leaf leaf) const { return nodes[leaf].sphere; }
+
+		/// <summary>Measure the quality of the tree.</summary>
+		/// <returns>
+		/// Total surface area of the boxes of the inner nodes, relative to
+		/// the area of the root's; lower is better. 0 for trees of fewer
+		/// than two items.
+		/// </returns>
+		float cost() const;
+
+		/// <summary>Find every item inside a Frustum.</summary>
+		/// Items only partly inside count as inside, as for culling.
+		/// <typeparam name="F">Callable taking an Item.</typeparam>
+		/// <param name="frustum">Frustum to search.</param>
+		/// <param name="visit">Function called with each item found.</param>
+		template<typename F>
+		void query(const Frustum & frustum, F && visit) const
+		{
+			search(
+				[&](const AABB & box) { return contains(frustum, box); },
+				[&](Sphere sphere) { return contains(frustum, sphere); },
+				visit);
+		}
+
+		/// <summary>Find every item overlapping a Sphere.</summary>
+		/// <typeparam name="F">Callable taking an Item.</typeparam>
+		/// <param name="sphere">Sphere to search.</param>
+		/// <param name="visit">Function called with each item found.</param>
+		template<typename F>
+		void query(Sphere sphere, F && visit) const
+		{
+			search([&](const AABB & box) { return intersects(box, sphere); },
+				   [&](Sphere bounds) { return intersects(bounds, sphere); },
+				   visit);
+		}
+
+		/// <summary>Find the nearest item whose bounds a Ray hits.</summary>
+		/// <param name="ray">Ray to cast.</param>
+		/// <param name="max_distance">Distance to search up to.</param>
+		/// <returns>Nearest hit, if any.</returns>
+		std::optional<RayHit>
+		raycast(const Ray & ray,
+				float max_distance =
+					std::numeric_limits<float>::infinity()) const
+		{
+			return raycast(
+				ray,
+				[this](Leaf leaf, const Ray & cast) {
+					return intersect(cast, nodes[leaf].sphere);
+				},
+				max_distance);
+		}
+
+		/// <summary>Find the nearest item a Ray hits.</summary>
+		/// Items are tested exactly by a function, once the ray is known
+		/// to hit their bounds, nearest bounds first.
+		/// <typeparam name="F">
+		/// Callable taking a Leaf and a Ray and returning the distance to
+		/// the item's hit as std::optional&lt;float&gt;.
+		/// </typeparam>
+		/// <param name="ray">Ray to cast.</param>
+		/// <param name="intersect_item">Exact test of an item.</param>
+		/// <param name="max_distance">Distance to search up to.</param>
+		/// <returns>Nearest hit, if any.</returns>
+		template<typename F>
+		std::optional<RayHit> raycast(const Ray & ray, F && intersect_item,
+									  float max_distance) const
+		{
+			std::optional<RayHit> nearest;
+			float limit = max_distance;
+
+			if (root == no_node)
+			{
+				return nearest;
+			}
+
+			// Nodes are paired with the distance at which the ray enters
+			// them, so that those beyond the nearest hit may be skipped
+			struct Pending
+			{
+				std::uint32_t node;
+				float distance;
+			};
+
+			LocalStack<Pending> pending;
+			if (const auto hit = intersect(ray, nodes[root].box))
+			{
+				pending.push(Pending{root, *hit});
+			}
+
+			while (!pending.empty())
+			{
+				const Pending next = pending.pop();
+
+				if (next.distance > limit)
+				{
+					continue;
+				}
+
+				const Node & node = nodes[next.node];
+				if (node.leaf())
+				{
+					const std::optional<float> hit =
+						intersect_item(next.node, ray);
+					if (hit && *hit <= limit)
+					{
+						limit = *hit;
+						nearest = RayHit{node.item, *hit};
+					}
+					continue;
+				}
+
+				const auto left = intersect(ray, nodes[node.left].box);
+				const auto right = intersect(ray, nodes[node.right].box);
+
+				// The nearer child goes on top, to be searched first
+				if (left && right && *left < *right)
+				{
+					pending.push(Pending{node.right, *right});
+					pending.push(Pending{node.left, *left});
+				}
+				else
+				{
+					if (left)
+					{
+						pending.push(Pending{node.left, *left});
+					}
+					if (right)
+					{
+						pending.push(Pending{node.right, *right});
+					}
+				}
+			}
+
+			return nearest;
+		}
+
+	private:
+		static constexpr std::uint32_t no_node = 0xffffffff;
+
+		struct Node
+		{
+			AABB box;
+			// Bounds of the item; only used by leaves
+			Sphere sphere;
+			std::uint32_t parent;
+			std::uint32_t left;
+			std::uint32_t right;
+			Item item;
+
+			bool leaf() const { return left == no_node; }
+		};
+
+		// Stack of nodes to search, held locally until deeper than most
+		// trees, so that queries need not allocate
+		template<typename T>
+		class LocalStack
+		{
+			std::array<T, 64> local;
+			vector<T> spilled;
+			size_t count = 0;
+
+		public:
+			bool empty() const { return count == 0; }
+
+			void push(const T & value)
+			{
+				if (count < local.size())
+				{
+					local[count] = value;
+				}
+				else
+				{
+					spilled.push_back(value);
+				}
+				count++;
+			}
+
+			T pop()
+			{
+				count--;
+				if (count < local.size())
+				{
+					return local[count];
+				}
+
+				const T value = spilled.back();
+				spilled.pop_back();
+				return value;
+			}
+		};
+
+		vector<Node> nodes;
+		vector<std::uint32_t> free_nodes;
+		std::uint32_t root = no_node;
+		size_t leaf_count = 0;
+
+		// Visits the items of every leaf whose box and sphere pass the
+		// tests, skipping subtrees whose boxes fail
+		template<typename BoxTest, typename SphereTest, typename F>
+		void search(BoxTest && box_test, SphereTest && sphere_test,
+					F && visit) const
+		{
+			if (root == no_node)
+			{
+				return;
+			}
+
+			LocalStack<std::uint32_t> pending;
+			pending.push(root);
+
+			while (!pending.empty())
+			{
+				const Node & node = nodes[pending.pop()];
+				if (!box_test(node.box))
+				{
+					continue;
+				}
+
+				if (node.leaf())
+				{
+					if (sphere_test(node.sphere))
+					{
+						visit(node.item);
+					}
+					continue;
+				}
+
+				pending.push(node.right);
+				pending.push(node.left);
+			}
+		}
+
+		std::uint32_t allocate();
+		void release(std::uint32_t node);
+
+		// Builds a subtree over leaves by binned SAH, returning its root
+		std::uint32_t build_range(std::uint32_t * first, std::uint32_t * last);
+
+		void insert_leaf(std::uint32_t leaf);
+		void remove_leaf(std::uint32_t leaf);
+		void replace_child(std::uint32_t parent, std::uint32_t old_child,
+						   std::uint32_t new_child);
+
+		// Refits the boxes from a node up to the root, rotating each
+		void refit(std::uint32_t node);
+		void rotate(std::uint32_t node);
+	};
+}   // namespace glge::math
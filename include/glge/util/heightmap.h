@@ -6,6 +6,8 @@
 
 #include <glge/common.h>
 
+#include <utility>
+
 namespace glge::util
 {
 	/// <summary>
@@ -34,6 +36,42 @@ namespace glge::util
 	vector<vec3> heightmap_normals(const vector<vec3> & heightmap,
 								   const vector<unsigned int> & indices);
 
+	/// <summary>
+	/// Recomputes, in place, the normals of a heightmap mesh around a
+	/// rectangle of moved points.
+	/// </summary>
+	/// Only the normals of points sharing a triangle with a moved point
+	/// change, so only those are recomputed. Their triangles are summed in
+	/// the same order as heightmap_normals, so the result matches a full
+	/// recomputation exactly. The mesh must be indexed as by
+	/// heightmap_indices, with point (x, z) at index z * width + x.
+	/// <param name="heightmap">
+	/// Heightmap after the edit.
+	/// </param>
+	/// <param name="width">
+	/// Width of the heightmap.
+	/// </param>
+	/// <param name="height">
+	/// Height of the heightmap.
+	/// </param>
+	/// <param name="x_begin">First column of moved points.</param>
+	/// <param name="z_begin">First row of moved points.</param>
+	/// <param name="x_end">One past the last column of moved points.</param>
+	/// <param name="z_end">One past the last row of moved points.</param>
+	/// <param name="normals">
+	/// Normals of the heightmap before the edit, as computed by
+	/// heightmap_normals. Updated in place.
+	/// </param>
+	/// <returns>
+	/// Indices of the first changed normal and one past the last, which
+	/// may be uploaded as one range.
+	/// </returns>
+	std::pair<size_t, size_t>
+	update_heightmap_normals(const vector<vec3> & heightmap, size_t width,
+							 size_t height, size_t x_begin, size_t z_begin,
+							 size_t x_end, size_t z_end,
+							 vector<vec3> & normals);
+
 	/// <summary>
 	/// Computes the texture coordinates (uvs) for each vertex in a heightmap
 	/// mesh.
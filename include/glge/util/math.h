@@ -8,6 +8,8 @@
 #include <glge/util/util.h>
 
 #include <array>
+#include <cstdint>
+#include <optional>
 
 namespace glge::math
 {
@@ -362,6 +364,173 @@ namespace glge::math
 	/// <returns>True if the sphere is inside the frustum.</returns>
 	bool contains(const Frustum & frustum, Sphere sphere);
 
+	/// <summary>
+	/// Bit mask of the planes of a Frustum, with bits 0 to 5 standing for
+	/// its near, far, left, right, bottom and top planes.
+	/// </summary>
+	using PlaneMask = std::uint8_t;
+
+	/// <summary>Mask of all 6 planes of a Frustum.</summary>
+	constexpr PlaneMask all_planes = 0x3f;
+
+	/// <summary>
+	/// Test whether a Sphere is inside a Frustum, making use of the results
+	/// of earlier tests.
+	/// </summary>
+	/// Planes missing from the mask are taken to contain the sphere, as
+	/// they do when they wholly contain a sphere enclosing it, so are not
+	/// tested. The plane which last failed is tested first, since from
+	/// one frame to the next a sphere tends to stay outside the same
+	/// plane.
+	/// <param name="frustum">
+	/// Frustum to test against.
+	/// </param>
+	/// <param name="sphere">
+	/// Sphere to test.
+	/// </param>
+	/// <param name="mask">
+	/// Planes to test; those wholly containing the sphere are cleared, so
+	/// that the mask may be passed on to spheres within it.
+	/// </param>
+	/// <param name="last_failed">
+	/// Index of the plane to test first; set to the plane failed, if any.
+	/// </param>
+	/// <returns>True if the sphere is inside the frustum.</returns>
+	bool contains(const Frustum & frustum, Sphere sphere, PlaneMask & mask,
+				  std::uint8_t & last_failed);
+
+	/// <summary>
+	/// Compute a Sphere enclosing a set of points.
+	/// </summary>
+	/// The sphere is centered on the points' bounding box, so it is not
+	/// the smallest enclosing sphere, but is never more than a factor of
+	/// sqrt(3) larger.
+	/// <param name="points">
+	/// Points to enclose; if empty, a sphere of radius 0 at the origin is
+	/// returned.
+	/// </param>
+	/// <returns>Sphere enclosing every point.</returns>
+	Sphere bounding_sphere(const vector<vec3> & points);
+
+	/// <summary>
+	/// Compute the smallest Sphere enclosing two Spheres.
+	/// </summary>
+	/// <param name="a">First sphere to enclose.</param>
+	/// <param name="b">Second sphere to enclose.</param>
+	/// <returns>Sphere enclosing both spheres.</returns>
+	Sphere enclose(Sphere a, Sphere b);
+
+	/// <summary>
+	/// Transform a Sphere by an affine transformation.
+	/// </summary>
+	/// The radius is scaled by the largest scale factor of the
+	/// transformation, so the result encloses the transformed sphere even
+	/// if the scaling is not uniform.
+	/// <param name="M">Affine transformation matrix.</param>
+	/// <param name="sphere">Sphere to transform.</param>
+	/// <returns>Sphere enclosing the transformed sphere.</returns>
+	Sphere transform(const mat4 & M, Sphere sphere);
+
+	/// <summary>Axis-aligned box; every point between two corners.</summary>
+	struct AABB
+	{
+		/// <summary>Corner with the least coordinates.</summary>
+		vec3 min;
+		/// <summary>Corner with the greatest coordinates.</summary>
+		vec3 max;
+	};
+
+	/// <summary>Half-line starting at a point.</summary>
+	struct Ray
+	{
+		/// <summary>Point the Ray starts at.</summary>
+		vec3 origin;
+		/// <summary>Unit vector along the Ray.</summary>
+		vec3 direction;
+	};
+
+	/// <summary>
+	/// Compute the smallest AABB enclosing a Sphere.
+	/// </summary>
+	/// <param name="sphere">Sphere to enclose.</param>
+	/// <returns>Box enclosing the sphere.</returns>
+	AABB bounding_box(Sphere sphere);
+
+	/// <summary>
+	/// Compute the smallest AABB enclosing two AABBs.
+	/// </summary>
+	/// <param name="a">First box to enclose.</param>
+	/// <param name="b">Second box to enclose.</param>
+	/// <returns>Box enclosing both boxes.</returns>
+	AABB enclose(const AABB & a, const AABB & b);
+
+	/// <summary>
+	/// Compute the surface area of an AABB.
+	/// </summary>
+	/// <param name="box">Box to measure.</param>
+	/// <returns>Total area of the faces of the box.</returns>
+	float surface_area(const AABB & box);
+
+	/// <summary>
+	/// Test whether an AABB lies entirely within another.
+	/// </summary>
+	/// <param name="outer">Box to test against.</param>
+	/// <param name="inner">Box to test.</param>
+	/// <returns>True if outer contains every point of inner.</returns>
+	bool contains(const AABB & outer, const AABB & inner);
+
+	/// <summary>
+	/// Test whether an AABB is inside a Frustum.
+	/// </summary>
+	/// As with spheres, boxes only partly inside count as inside, so
+	/// that the test may be used for culling.
+	/// <param name="frustum">
+	/// Frustum to test against.
+	/// </param>
+	/// <param name="box">
+	/// Box to test.
+	/// </param>
+	/// <returns>True unless the box lies wholly outside a plane.</returns>
+	bool contains(const Frustum & frustum, const AABB & box);
+
+	/// <summary>
+	/// Test whether two Spheres overlap.
+	/// </summary>
+	/// <param name="a">First sphere.</param>
+	/// <param name="b">Second sphere.</param>
+	/// <returns>True if the spheres share any point.</returns>
+	bool intersects(Sphere a, Sphere b);
+
+	/// <summary>
+	/// Test whether an AABB and a Sphere overlap.
+	/// </summary>
+	/// <param name="box">Box to test.</param>
+	/// <param name="sphere">Sphere to test.</param>
+	/// <returns>True if the box and sphere share any point.</returns>
+	bool intersects(const AABB & box, Sphere sphere);
+
+	/// <summary>
+	/// Find where a Ray first enters a Sphere.
+	/// </summary>
+	/// <param name="ray">Ray to cast.</param>
+	/// <param name="sphere">Sphere to cast against.</param>
+	/// <returns>
+	/// Distance along the ray to the sphere; 0 if the ray starts inside
+	/// it, or empty if the ray misses it.
+	/// </returns>
+	std::optional<float> intersect(const Ray & ray, Sphere sphere);
+
+	/// <summary>
+	/// Find where a Ray first enters an AABB.
+	/// </summary>
+	/// <param name="ray">Ray to cast.</param>
+	/// <param name="box">Box to cast against.</param>
+	/// <returns>
+	/// Distance along the ray to the box; 0 if the ray starts inside it,
+	/// or empty if the ray misses it.
+	/// </returns>
+	std::optional<float> intersect(const Ray & ray, const AABB & box);
+
 	/// <summary>
 	/// A term in a polynomial, e.g. 4x^2, where 4 is the coefficient and 2 is
 	/// the power.
@@ -9,6 +9,8 @@
 
 #include <glge/common.h>
 
+#include <cstdint>
+
 namespace glge::util
 {
 	/// <summary>
@@ -236,14 +238,6 @@ namespace glge::util
 	/// </summary>
 	struct Placement
 	{
-		/// <summary>
-		/// The matrix describing the 3D transform.
-		/// </summary>
-		/// The matrix describing the 3D transform, which
-		/// takes an object at the origin in default
-		/// orientation to the specified position and orientation.
-		mat4 transform;
-
 		/// <summary>
 		/// Constructs a Placement using the coordinate system's basis as its
 		/// initial orientation.
@@ -267,6 +261,51 @@ namespace glge::util
 		Placement(const Placement & other) noexcept : transform(other.transform)
 		{}
 
+		/// <summary>
+		/// Copies another Placement's transform, marking this Placement as
+		/// changed.
+		/// </summary>
+		/// <param name="other">
+		/// Placement to copy transform from.
+		/// </param>
+		/// <returns>Reference to this Placement.</returns>
+		Placement & operator=(const Placement & other) noexcept
+		{
+			set_transform(other.transform);
+			return *this;
+		}
+
+		/// <summary>
+		/// Get the matrix describing the 3D transform.
+		/// </summary>
+		/// The transform takes an object at the origin in default
+		/// orientation to the specified position and orientation.
+		/// <returns>The transform of the Placement.</returns>
+		const mat4 & get_transform() const noexcept { return transform; }
+
+		/// <summary>
+		/// Replace the transform, marking the Placement as changed.
+		/// </summary>
+		/// Scenes cache the world matrices computed from a Placement and
+		/// only recompute them once its version changes, so the transform
+		/// can only be changed through this.
+		/// <param name="new_transform">
+		/// New transform for the Placement.
+		/// </param>
+		void set_transform(const mat4 & new_transform) noexcept
+		{
+			transform = new_transform;
+			changes++;
+		}
+
+		/// <summary>
+		/// Get the version of the transform.
+		/// </summary>
+		/// <returns>
+		/// Number of changes made since the Placement was constructed.
+		/// </returns>
+		std::uint64_t version() const noexcept { return changes; }
+
 		/// <summary>
 		/// Get the orientation vector corresponding to the given model-space
 		/// axis, in world-space coordinates.
@@ -319,5 +358,9 @@ namespace glge::util
 		/// vec3 representation of the offset from the origin.
 		/// </returns>
 		vec3 get_position() const { return transform[3]; }
+
+	private:
+		mat4 transform;
+		std::uint64_t changes = 0;
 	};
 }   // namespace glge::util
@@ -0,0 +1,122 @@
+/// <summary>Work-stealing pool of worker threads.</summary>
+///
+/// Contains a thread pool used to run independent tasks in parallel,
+/// such as traversal of separate subtrees of a scene graph.
+///
+/// \file thread_pool.h
+
+#pragma once
+
+#include <glge/common.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+namespace glge::util
+{
+	/// <summary>
+	/// Fixed-size pool of worker threads with per-worker task queues.
+	/// </summary>
+	/// Each worker runs tasks from the back of its own queue, and steals
+	/// from the front of other workers' queues when its own is empty.
+	/// Tasks posted from a worker thread go to that worker's queue, so
+	/// recursively split work stays local until another worker is idle.
+	class ThreadPool
+	{
+	public:
+		/// <summary>Type of the tasks run by the pool.</summary>
+		using Task = std::function<void()>;
+
+		/// <summary>
+		/// Constructs a new ThreadPool and starts its workers.
+		/// </summary>
+		/// <param name="thread_count">
+		/// Number of worker threads; clamped to at least 1.
+		/// </param>
+		explicit ThreadPool(size_t thread_count);
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool(ThreadPool &&) = delete;
+		ThreadPool & operator=(const ThreadPool &) = delete;
+		ThreadPool & operator=(ThreadPool &&) = delete;
+
+		/// <summary>
+		/// Runs all queued tasks, then stops and joins the workers.
+		/// </summary>
+		~ThreadPool();
+
+		/// <summary>
+		/// Get a pool shared by the whole process, created on first use.
+		/// </summary>
+		/// The shared pool has one worker per hardware thread, less one for
+		/// the thread submitting work.
+		/// <returns>Reference to the shared pool.</returns>
+		static ThreadPool & shared();
+
+		/// <summary>Get the number of worker threads in this pool.</summary>
+		/// <returns>Number of workers.</returns>
+		size_t size() const;
+
+		/// <summary>
+		/// Get the index of the calling thread within this pool.
+		/// </summary>
+		/// <returns>
+		/// Index in [0, size()) if called from one of this pool's workers,
+		/// else an empty optional.
+		/// </returns>
+		std::optional<size_t> current_worker() const;
+
+		/// <summary>Queue a task to be run by the pool.</summary>
+		/// Tasks must not throw; use submit() for tasks that may.
+		/// <param name="task">Task to run.</param>
+		void post(Task task);
+
+		/// <summary>
+		/// Queue a callable to be run by the pool and get its result.
+		/// </summary>
+		/// <param name="f">Callable taking no arguments.</param>
+		/// <returns>
+		/// Future holding the result of, or exception thrown by, the
+		/// callable.
+		/// </returns>
+		template<typename F>
+		std::future<std::invoke_result_t<std::decay_t<F>>> submit(F && f)
+		{
+			using R = std::invoke_result_t<std::decay_t<F>>;
+
+			auto task =
+				std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+			std::future<R> result = task->get_future();
+
+			post([task] { (*task)(); });
+
+			return result;
+		}
+
+	private:
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		vector<unique_ptr<Worker>> workers;
+		vector<std::thread> threads;
+
+		std::mutex sleep_mutex;
+		std::condition_variable wake;
+		size_t queued = 0;
+		bool stopping = false;
+
+		std::atomic<size_t> next_queue = 0;
+
+		bool try_pop(size_t index, Task & task);
+		void run(size_t index);
+	};
+}   // namespace glge::util
@@ -0,0 +1,168 @@
+/// <summary>Bounding volume hierarchy over the triangles of a mesh.</summary>
+///
+/// \file triangle_bvh.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/util/math.h>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace glge::math
+{
+	/// <summary>
+	/// Static binary tree of AABBs over the triangles of a mesh, answering
+	/// ray queries against its surface.
+	/// </summary>
+	/// Trees are built once, splitting by the surface area heuristic (SAH)
+	/// over binned triangle centroids. Nodes are laid out depth first in 32
+	/// bytes each, every node recording where the search resumes once its
+	/// subtree is done with, so that rays are traversed without a stack.
+	class TriangleBVH
+	{
+	public:
+		/// <summary>Node of the tree, as laid out in memory.</summary>
+		/// The left child of an inner node follows it directly.
+		struct Node
+		{
+			/// <summary>
+			/// Corner of the node's box with least coordinates.
+			/// </summary>
+			vec3 min;
+			/// <summary>
+			/// Index of the node following this node's subtree.
+			/// </summary>
+			std::uint32_t skip;
+			/// <summary>
+			/// Corner of the node's box with most coordinates.
+			/// </summary>
+			vec3 max;
+			/// <summary>
+			/// 0 for inner nodes; for leaves, the index of their first
+			/// triangle shifted left by 4 bits, or'd with their count.
+			/// </summary>
+			std::uint32_t triangles;
+		};
+
+		/// <summary>Triangle of the mesh, as held by the tree.</summary>
+		struct Triangle
+		{
+			/// <summary>First vertex.</summary>
+			vec3 a;
+			/// <summary>Second vertex.</summary>
+			vec3 b;
+			/// <summary>Third vertex.</summary>
+			vec3 c;
+			/// <summary>Position of the triangle in the mesh.</summary>
+			std::uint32_t id;
+		};
+
+		/// <summary>Triangle hit by a ray.</summary>
+		struct Hit
+		{
+			/// <summary>Position of the triangle in the mesh.</summary>
+			std::uint32_t triangle;
+			/// <summary>Distance along the ray to the hit.</summary>
+			float distance;
+			/// <summary>
+			/// Weights of the second and third vertices at the hit.
+			/// </summary>
+			vec2 barycentric;
+		};
+
+		/// <summary>Construct an empty tree.</summary>
+		TriangleBVH() = default;
+
+		/// <summary>Build a tree over triangles.</summary>
+		/// <param name="triangles">
+		/// Triangles of the mesh, with their positions in it.
+		/// </param>
+		explicit TriangleBVH(vector<Triangle> triangles);
+
+		/// <summary>
+		/// Construct a tree from nodes and triangles laid out by another,
+		/// e.g. as read back from a file.
+		/// </summary>
+		/// <param name="nodes">Nodes of the tree.</param>
+		/// <param name="triangles">Triangles in the tree's order.</param>
+		/// <exception cref="std::invalid_argument">
+		/// If the nodes do not form a tree over the triangles.
+		/// </exception>
+		TriangleBVH(vector<Node> nodes, vector<Triangle> triangles);
+
+		/// <summary>Build a tree over an indexed triangle list.</summary>
+		/// <typeparam name="Points">Collection of points.</typeparam>
+		/// <typeparam name="Indices">Collection of indices.</typeparam>
+		/// <param name="points">Vertex positions of the mesh.</param>
+		/// <param name="indices">
+		/// Indices of the points, three per triangle.
+		/// </param>
+		/// <returns>Tree over the mesh.</returns>
+		template<typename Points, typename Indices>
+		static TriangleBVH from_mesh(const Points & points,
+									 const Indices & indices)
+		{
+			vector<Triangle> triangles;
+			triangles.reserve(indices.size() / 3);
+
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				triangles.push_back(
+					Triangle{vec3(points.at(indices[i])),
+							 vec3(points.at(indices[i + 1])),
+							 vec3(points.at(indices[i + 2])),
+							 static_cast<std::uint32_t>(i / 3)});
+			}
+
+			return TriangleBVH(std::move(triangles));
+		}
+
+		/// <summary>Find the nearest triangle a Ray hits.</summary>
+		/// Triangles are hit from either side.
+		/// <param name="ray">Ray to cast.</param>
+		/// <param name="max_distance">Distance to search up to.</param>
+		/// <returns>Nearest hit, if any.</returns>
+		std::optional<Hit>
+		intersect(const Ray & ray,
+				  float max_distance =
+					  std::numeric_limits<float>::infinity()) const;
+
+		/// <summary>
+		/// Find the nearest triangle each of many Rays hits.
+		/// </summary>
+		/// Rays are cast in parallel.
+		/// <param name="rays">Rays to cast.</param>
+		/// <param name="max_distance">Distance to search up to.</param>
+		/// <returns>Nearest hit of each ray, in the same order.</returns>
+		vector<std::optional<Hit>>
+		intersect(const vector<Ray> & rays,
+				  float max_distance =
+					  std::numeric_limits<float>::infinity()) const;
+
+		/// <summary>Get the box enclosing the mesh.</summary>
+		/// <returns>Box of the root; empty for empty trees.</returns>
+		std::optional<AABB> bounds() const;
+
+		/// <summary>Get the nodes of the tree, depth first.</summary>
+		const vector<Node> & get_nodes() const { return nodes; }
+
+		/// <summary>Get the triangles, in the tree's order.</summary>
+		const vector<Triangle> & get_triangles() const { return triangles; }
+
+	private:
+		vector<Node> nodes;
+		vector<Triangle> triangles;
+
+		// Builds the subtree over a range of the triangles in order, by
+		// binned SAH, appending its nodes depth first
+		void build_range(vector<std::uint32_t> & order,
+						 const vector<AABB> & boxes, size_t first,
+						 size_t last);
+	};
+
+	static_assert(sizeof(TriangleBVH::Node) == 32,
+				  "TriangleBVH nodes should fill half a cache line");
+}   // namespace glge::math
@@ -0,0 +1,66 @@
+/// <summary>Tracking of the modified parts of a buffer.</summary>
+///
+/// \file _dirty_ranges.h
+
+#pragma once
+
+#include <glge/common.h>
+
+namespace glge::renderer
+{
+	/// <summary>Half-open range [begin, end) of buffer elements.</summary>
+	struct DirtyRange
+	{
+		/// <summary>First element of the range.</summary>
+		size_t begin;
+		/// <summary>One past the last element of the range.</summary>
+		size_t end;
+
+		/// <summary>Get the number of elements in the range.</summary>
+		size_t size() const { return end - begin; }
+
+		bool operator==(DirtyRange other) const
+		{
+			return begin == other.begin && end == other.end;
+		}
+	};
+
+	/// <summary>
+	/// Sorted set of disjoint ranges of a buffer waiting to be uploaded.
+	/// </summary>
+	/// Overlapping and adjacent ranges are merged as they are added. Once
+	/// there are more ranges than allowed, the two closest are joined,
+	/// trading some redundant upload for fewer calls.
+	class DirtyRanges
+	{
+	public:
+		/// <summary>Construct an empty set of ranges.</summary>
+		/// <param name="max_ranges">
+		/// Most ranges kept apart before the closest are joined; at least
+		/// one.
+		/// </param>
+		explicit DirtyRanges(size_t max_ranges = 8);
+
+		/// <summary>Mark a range as modified.</summary>
+		/// Empty ranges are ignored.
+		/// <param name="begin">First modified element.</param>
+		/// <param name="end">One past the last modified element.</param>
+		void add(size_t begin, size_t end);
+
+		/// <summary>Forget every range.</summary>
+		void clear() { dirty.clear(); }
+
+		/// <summary>Check whether any range is modified.</summary>
+		bool empty() const { return dirty.empty(); }
+
+		/// <summary>Get the modified ranges, in order.</summary>
+		const vector<DirtyRange> & ranges() const { return dirty; }
+
+		/// <summary>Get the number of elements in every range.</summary>
+		size_t element_count() const;
+
+	private:
+		size_t max_ranges;
+		vector<DirtyRange> dirty;
+	};
+}   // namespace glge::renderer
@@ -0,0 +1,70 @@
+/// <summary>Layout of glge's virtual texture page files.</summary>
+///
+/// A file starts with a PageFileHeader, followed by the pages of each
+/// level, finest level first and row by row within a level. Every page is
+/// an RGBA image of PageLayout::padded_size() texels across, so the offset
+/// of any page follows from the header alone.
+///
+/// \file _page_file.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/virtual_texture.h>
+#include <internal/util/_compat.h>
+
+#include <cstdint>
+
+namespace glge::renderer
+{
+	/// <summary>Identifies a virtual texture page file ("GLVP").</summary>
+	constexpr std::uint32_t page_file_magic = 0x50564c47;
+	/// <summary>Bumped whenever the layout of the file changes.</summary>
+	constexpr std::uint32_t page_file_version = 1;
+
+	/// <summary>Header of a page file.</summary>
+	struct PageFileHeader
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t page_size;
+		std::uint32_t border;
+		std::uint32_t level_count;
+		std::uint32_t reserved;
+	};
+
+	static_assert(sizeof(PageFileHeader) == 32);
+
+	/// <summary>Offset of a page from the start of a page file.</summary>
+	/// <param name="layout">Layout of the file.</param>
+	/// <param name="page">Page to locate.</param>
+	/// <returns>Offset of the first byte of the page.</returns>
+	std::uint64_t page_offset(const primitive::PageLayout & layout,
+							  primitive::PageId page);
+
+	/// <summary>Validated, mapped page file.</summary>
+	/// Pages may be read from any number of threads at once.
+	class PageFile
+	{
+	public:
+		/// <summary>Map and check a page file.</summary>
+		/// Throws std::runtime_error if the file cannot be mapped or is not
+		/// a valid page file.
+		/// <param name="path">Path to the file.</param>
+		explicit PageFile(const string & path);
+
+		/// <summary>Get the layout of the pages.</summary>
+		const primitive::PageLayout & layout() const { return page_layout; }
+
+		/// <summary>Get the data of a page.</summary>
+		/// <param name="page">Page to read; must be within the layout.</param>
+		/// <returns>Pointer to the RGBA texels of the page.</returns>
+		const std::uint8_t * page(primitive::PageId page) const;
+
+	private:
+		util::MappedFile file;
+		primitive::PageLayout page_layout;
+	};
+}   // namespace glge::renderer
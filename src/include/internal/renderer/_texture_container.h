@@ -0,0 +1,92 @@
+/// <summary>Layout of glge's precompressed texture files.</summary>
+///
+/// A file starts with a TextureContainerHeader, followed by one
+/// TextureContainerLevel per face and level, face-major. Level data
+/// follows, each level at an offset aligned to
+/// texture_container_alignment.
+///
+/// \file _texture_container.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/compressed_texture.h>
+
+#include <cstdint>
+
+namespace glge::renderer
+{
+	/// <summary>Identifies a precompressed texture file ("GLTX").</summary>
+	constexpr std::uint32_t texture_container_magic = 0x58544c47;
+	/// <summary>Bumped whenever the layout of the file changes.</summary>
+	constexpr std::uint32_t texture_container_version = 1;
+	/// <summary>Alignment of the offset of each level's data.</summary>
+	constexpr size_t texture_container_alignment = 16;
+
+	/// <summary>Header of a precompressed texture file.</summary>
+	struct TextureContainerHeader
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t format;
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t face_count;
+		std::uint32_t level_count;
+		std::uint32_t reserved;
+	};
+
+	/// <summary>Entry of the level table of a texture file.</summary>
+	struct TextureContainerLevel
+	{
+		std::uint64_t offset;
+		std::uint64_t size;
+		std::uint32_t width;
+		std::uint32_t height;
+	};
+
+	static_assert(sizeof(TextureContainerHeader) == 32);
+	static_assert(sizeof(TextureContainerLevel) == 24);
+
+	/// <summary>
+	/// Validated view of a precompressed texture file held in memory.
+	/// </summary>
+	class TextureContainer
+	{
+	public:
+		/// <summary>One level of one face.</summary>
+		struct Level
+		{
+			const std::uint8_t * data;
+			size_t size;
+			size_t width;
+			size_t height;
+		};
+
+		/// <summary>Check and wrap the contents of a file.</summary>
+		/// Throws std::runtime_error if the contents are not a valid file.
+		/// <param name="data">Contents of the file; not copied.</param>
+		/// <param name="size">Size of the file in bytes.</param>
+		TextureContainer(const std::uint8_t * data, size_t size);
+
+		/// <summary>Get the compression format of the levels.</summary>
+		primitive::BlockFormat format() const;
+
+		/// <summary>Get the number of faces; 1 or 6.</summary>
+		size_t face_count() const;
+
+		/// <summary>Get the number of levels of each face.</summary>
+		size_t level_count() const;
+
+		/// <summary>Get a level of a face.</summary>
+		/// <param name="face">Index of the face.</param>
+		/// <param name="level">Index of the level, 0 being finest.</param>
+		/// <returns>View of the level's data.</returns>
+		Level level(size_t face, size_t level) const;
+
+	private:
+		const std::uint8_t * data;
+		const TextureContainerHeader * header;
+		const TextureContainerLevel * levels;
+	};
+}   // namespace glge::renderer
@@ -8,6 +8,8 @@
 
 #include <glge/common.h>
 
+#include <cstdint>
+
 namespace glge
 {
 	enum class OperatingSystem
@@ -72,6 +74,36 @@ namespace glge
 
 #endif
 
+/// \def GLGE_SSE2
+/// <summary>
+/// 1 if SSE2 intrinsics are available to the compiler, 0 otherwise.
+/// </summary>
+/// SSE2 is part of every x86-64 target, so this is only 0 on 32-bit x86
+/// builds without it and on other architectures.
+
+/// \def GLGE_SSSE3
+/// <summary>
+/// 1 if SSSE3 intrinsics are available to the compiler, 0 otherwise.
+/// </summary>
+/// Only set when the target architecture includes SSSE3, e.g. when building
+/// with -mssse3 or -march=native; code using it must keep an SSE2 or scalar
+/// path.
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLGE_SSE2 1
+#include <emmintrin.h>
+#else
+#define GLGE_SSE2 0
+#endif
+
+#if defined(__SSSE3__) || (defined(_MSC_VER) && defined(__AVX__))
+#define GLGE_SSSE3 1
+#include <tmmintrin.h>
+#else
+#define GLGE_SSSE3 0
+#endif
+
 namespace glge::util
 {
 	/// <summary>
@@ -93,7 +125,7 @@ namespace glge::util
 
 namespace glge::util
 {
-	string getcwd() { return std::filesystem::current_path().string(); }
+	inline string getcwd() { return std::filesystem::current_path().string(); }
 }   // namespace glge::util
 
 #else
@@ -107,7 +139,7 @@ namespace glge::util
 
 namespace glge::util
 {
-	string getcwd()
+	inline string getcwd()
 	{
 		char buf[256];
 		czstring cwd = getcwd(buf, sizeof(buf));
@@ -124,3 +156,40 @@ namespace glge::util
 	}
 }   // namespace glge::util
 #endif
+
+namespace glge::util
+{
+	/// <summary>Read-only memory mapping of a whole file.</summary>
+	///
+	/// Maps the file with mmap on POSIX systems and with a file mapping
+	/// object on Windows. The mapping is released on destruction.
+	class MappedFile
+	{
+	public:
+		/// <summary>Map a file into memory.</summary>
+		/// Throws std::runtime_error if the file cannot be opened or
+		/// mapped.
+		/// <param name="path">Path to the file to map.</param>
+		explicit MappedFile(const string & path);
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile(MappedFile && other) noexcept;
+
+		MappedFile & operator=(const MappedFile &) = delete;
+		MappedFile & operator=(MappedFile &&) = delete;
+
+		~MappedFile();
+
+		/// <summary>Get the start of the mapped file.</summary>
+		/// <returns>Pointer to the first byte of the file.</returns>
+		const std::uint8_t * data() const { return bytes; }
+
+		/// <summary>Get the size of the mapped file.</summary>
+		/// <returns>Size of the file in bytes.</returns>
+		size_t size() const { return length; }
+
+	private:
+		const std::uint8_t * bytes = nullptr;
+		size_t length = 0;
+	};
+}   // namespace glge::util
@@ -0,0 +1,186 @@
+/// <summary>Pooled storage of objects in fixed-size slabs.</summary>
+///
+/// \file _slab_pool.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/util/util.h>
+
+#include <array>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace glge::util
+{
+	/// <summary>
+	/// Pool of objects stored in slabs of fixed size, addressed by slot.
+	/// </summary>
+	/// Objects never move once created, and a slab is only allocated once
+	/// every slot before it is in use, so creating many objects makes few
+	/// allocations. Freed slots are reused, most recently freed first.
+	/// Each slot has a generation, bumped as it is freed, with which stale
+	/// references to a slot may be told from references to its new object.
+	/// <typeparam name="T">Type of object stored.</typeparam>
+	template<typename T>
+	class SlabPool
+	{
+	public:
+		/// <summary>Number of slots in each slab.</summary>
+		static constexpr std::uint32_t slab_size = 256;
+
+		/// <summary>Slot index meaning no slot.</summary>
+		static constexpr std::uint32_t no_slot = 0xffffffff;
+
+		/// <summary>Construct an empty pool.</summary>
+		SlabPool() = default;
+
+		SlabPool(const SlabPool &) = delete;
+		SlabPool & operator=(const SlabPool &) = delete;
+
+		/// <summary>Destroy every object left in the pool.</summary>
+		~SlabPool()
+		{
+			for (std::uint32_t slot = 0; slot < slot_count; slot++)
+			{
+				if (at(slot).live)
+				{
+					object(slot).~T();
+				}
+			}
+		}
+
+		/// <summary>Create an object in a free slot.</summary>
+		/// <param name="args">Arguments to construct the object with.</param>
+		/// <returns>Slot of the object, and the object.</returns>
+		template<typename... Args>
+		std::pair<std::uint32_t, T &> create(Args &&... args)
+		{
+			std::uint32_t slot = free_head;
+			if (slot != no_slot)
+			{
+				free_head = at(slot).next_free;
+			}
+			else
+			{
+				if (slot_count == no_slot)
+				{
+					throw std::length_error(EXC_MSG("Slab pool is full"));
+				}
+
+				if (slot_count % slab_size == 0)
+				{
+					slabs.push_back(std::make_unique<Slab>());
+				}
+				slot = slot_count++;
+			}
+
+			Slot & entry = at(slot);
+			try
+			{
+				new (entry.storage) T(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				entry.next_free = free_head;
+				free_head = slot;
+				throw;
+			}
+
+			entry.live = true;
+			live_count++;
+
+			return {slot, object(slot)};
+		}
+
+		/// <summary>Destroy the object in a slot, freeing the slot.</summary>
+		/// <param name="slot">Slot of a live object.</param>
+		void destroy(std::uint32_t slot)
+		{
+			if (!live(slot))
+			{
+				throw std::invalid_argument(
+					EXC_MSG("Slot holds no object to destroy"));
+			}
+
+			object(slot).~T();
+
+			Slot & entry = at(slot);
+			entry.live = false;
+			entry.generation++;
+			entry.next_free = free_head;
+			free_head = slot;
+			live_count--;
+		}
+
+		/// <summary>Check whether a slot holds an object.</summary>
+		/// <param name="slot">Slot to check.</param>
+		/// <returns>True if the slot holds a live object.</returns>
+		bool live(std::uint32_t slot) const
+		{
+			return slot < slot_count && at(slot).live;
+		}
+
+		/// <summary>Get the current generation of a slot.</summary>
+		/// <param name="slot">Slot in use or previously used.</param>
+		/// <returns>Number of times the slot was freed.</returns>
+		std::uint32_t generation(std::uint32_t slot) const
+		{
+			return at(slot).generation;
+		}
+
+		/// <summary>Find the object a reference to a slot refers to.</summary>
+		/// <param name="slot">Slot referred to.</param>
+		/// <param name="generation">
+		/// Generation of the slot when the reference was taken.
+		/// </param>
+		/// <returns>
+		/// The object, or null if it was destroyed since.
+		/// </returns>
+		observer_ptr<T> find(std::uint32_t slot, std::uint32_t generation)
+		{
+			return live(slot) && at(slot).generation == generation
+					   ? &object(slot)
+					   : nullptr;
+		}
+
+		/// <summary>Get the number of live objects.</summary>
+		size_t size() const { return live_count; }
+
+		/// <summary>Get the number of slots allocated.</summary>
+		size_t capacity() const { return slabs.size() * slab_size; }
+
+	private:
+		struct Slot
+		{
+			alignas(T) unsigned char storage[sizeof(T)];
+			std::uint32_t generation = 0;
+			std::uint32_t next_free = no_slot;
+			bool live = false;
+		};
+
+		using Slab = std::array<Slot, slab_size>;
+
+		vector<unique_ptr<Slab>> slabs;
+		std::uint32_t slot_count = 0;
+		std::uint32_t free_head = no_slot;
+		size_t live_count = 0;
+
+		Slot & at(std::uint32_t slot)
+		{
+			return (*slabs[slot / slab_size])[slot % slab_size];
+		}
+
+		const Slot & at(std::uint32_t slot) const
+		{
+			return (*slabs[slot / slab_size])[slot % slab_size];
+		}
+
+		T & object(std::uint32_t slot)
+		{
+			return *std::launder(reinterpret_cast<T *>(at(slot).storage));
+		}
+	};
+}   // namespace glge::util
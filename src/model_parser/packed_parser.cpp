@@ -3,10 +3,12 @@
 #include <internal/util/_util.h>
 
 #include <cstdint>
+#include <type_traits>
 
 namespace glge::model_parser
 {
-	constexpr uint8_t current_file_version = 0;
+	// Version 1 appends an optional triangle BVH after the model data
+	constexpr uint8_t current_file_version = 1;
 
 	struct PackedModelHeader
 	{
@@ -19,6 +21,16 @@ namespace glge::model_parser
 		std::uint64_t uv_index_count;
 	};
 
+	// Sizes of the triangle BVH; both 0 when none was stored
+	struct PackedBVHHeader
+	{
+		std::uint64_t node_count;
+		std::uint64_t triangle_count;
+	};
+
+	static_assert(std::is_trivially_copyable_v<math::TriangleBVH::Node>);
+	static_assert(std::is_trivially_copyable_v<math::TriangleBVH::Triangle>);
+
 	template<typename T>
 	size_t vector_size(const vector<T> & vec)
 	{
@@ -57,6 +69,23 @@ namespace glge::model_parser
 		write_raw(file, data.vertex_data.indices);
 		write_raw(file, data.normal_data.indices);
 		write_raw(file, data.uv_data.indices);
+
+		PackedBVHHeader bvh_header{0, 0};
+		if (data.triangle_bvh)
+		{
+			bvh_header = PackedBVHHeader{
+				data.triangle_bvh->get_nodes().size(),
+				data.triangle_bvh->get_triangles().size()};
+		}
+
+		file.write(reinterpret_cast<const char *>(&bvh_header),
+				   sizeof(bvh_header));
+
+		if (data.triangle_bvh)
+		{
+			write_raw(file, data.triangle_bvh->get_nodes());
+			write_raw(file, data.triangle_bvh->get_triangles());
+		}
 	}
 
 	template<typename T>
@@ -83,6 +112,12 @@ namespace glge::model_parser
 
 		file.read(reinterpret_cast<char *>(&header), sizeof(header));
 
+		if (header.file_version > current_file_version)
+		{
+			throw std::runtime_error(
+				EXC_MSG("Packed model file is of a newer version"));
+		}
+
 		ModelData data;
 		read_raw(file, data.vertex_data.points, header.vertex_count);
 		read_raw(file, data.normal_data.points, header.normal_count);
@@ -91,6 +126,24 @@ namespace glge::model_parser
 		read_raw(file, data.normal_data.indices, header.normal_index_count);
 		read_raw(file, data.uv_data.indices, header.uv_index_count);
 
+		if (header.file_version >= 1)
+		{
+			PackedBVHHeader bvh_header;
+			file.read(reinterpret_cast<char *>(&bvh_header),
+					  sizeof(bvh_header));
+
+			if (bvh_header.node_count > 0)
+			{
+				vector<math::TriangleBVH::Node> nodes;
+				vector<math::TriangleBVH::Triangle> triangles;
+				read_raw(file, nodes, bvh_header.node_count);
+				read_raw(file, triangles, bvh_header.triangle_count);
+
+				data.triangle_bvh =
+					math::TriangleBVH(std::move(nodes), std::move(triangles));
+			}
+		}
+
 		return data;
 	}
 }   // namespace glge::model_parser
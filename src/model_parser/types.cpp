@@ -6,6 +6,12 @@
 
 namespace glge::model_parser
 {
+	void ModelData::build_triangle_bvh()
+	{
+		triangle_bvh = math::TriangleBVH::from_mesh(vertex_data.points,
+													vertex_data.indices);
+	}
+
 	ModelData ModelData::from_file(ModelFileInfo file_info)
 	{
 		switch (file_info.filetype)
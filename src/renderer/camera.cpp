@@ -1,5 +1,7 @@
 #include "glge/renderer/camera.h"
 
+#include <limits>
+
 namespace glge::renderer
 {
 	static constexpr float plane_height(math::Radians v_fov, float distance)
@@ -35,7 +37,7 @@ namespace glge::renderer
 
 	mat4 Camera::get_V() const
 	{
-		mat4 cam2world = placement.transform;
+		mat4 cam2world = placement.get_transform();
 
 		mat4 world_to_cam_rot = {
 			{cam2world[0][0], cam2world[1][0], cam2world[2][0], 0},
@@ -54,53 +56,79 @@ namespace glge::renderer
 		return world2cam;
 	}
 
-	// TODO Switch this to a templated lambda with C++20
-    /*              ___far clip__
-     *              \     |     /
-     *               \    |    /
-     *                \   |   /
-     *     near clip-->\_____/<-- Computes the directional vector to this intersection
-     *                  \ | /     (example for right axis)
-     *                   \|/
-     *                    c
-     */
-	template<typename AxisT>
-	static vec3 compute_corner(const Camera & cam, vec3 near_center)
+	math::Frustum Camera::get_view_frustum() const
 	{
-		return glm::normalize(
-			near_center + 
-			(AxisT::signum * vec3(cam.placement.transform[AxisT::idx]) *
-			 cam.intrinsics.near_dimensions()[AxisT::idx] / 2.0f) -
-			cam.placement.get_position());
+		// The projection draws along the placement's back axis
+		const vec3 view_vec = placement.get_direction<util::CoordSys::Back>();
+		const vec3 right_vec = placement.get_right_direction();
+		const vec3 up_vec = placement.get_up_direction();
+		const vec3 cam_pos = placement.get_position();
+
+		const float tan_v = plane_height(intrinsics.v_fov, 1.0f) / 2.0f;
+		const float tan_h = tan_v * intrinsics.aspect_ratio;
+
+		// Directions along the middle of each side of the frustum
+		const vec3 right_edge = view_vec + right_vec * tan_h;
+		const vec3 left_edge = view_vec - right_vec * tan_h;
+		const vec3 top_edge = view_vec + up_vec * tan_v;
+		const vec3 bottom_edge = view_vec - up_vec * tan_v;
+
+		math::Plane near(cam_pos + view_vec * intrinsics.near_distance,
+						 view_vec);
+		math::Plane far(cam_pos + view_vec * intrinsics.far_distance,
+						-view_vec);
+
+		math::Plane right(cam_pos,
+						  glm::normalize(glm::cross(up_vec, right_edge)));
+		math::Plane left(cam_pos,
+						 glm::normalize(glm::cross(left_edge, up_vec)));
+		math::Plane top(cam_pos,
+						glm::normalize(glm::cross(top_edge, right_vec)));
+		math::Plane bottom(cam_pos,
+						   glm::normalize(glm::cross(right_vec, bottom_edge)));
+
+		return math::Frustum({near, far, left, right, bottom, top});
 	}
 
-	math::Frustum Camera::get_view_frustum() const
+	float Camera::screen_size(math::Sphere sphere) const
 	{
-		auto right_vec = placement.get_right_direction();
-		auto camera_vec = placement.get_forward_direction();
-		auto up_vec = placement.get_up_direction();
-		auto cam_pos = placement.get_position();
-
-		auto near_center = cam_pos + camera_vec * intrinsics.near_distance;
-		auto far_center = cam_pos + camera_vec * intrinsics.far_distance;
-
-		math::Plane near(near_center, camera_vec);
-		math::Plane far(far_center, -camera_vec);
-
-		auto right_corner =
-			compute_corner<util::CoordSys::Right>(*this, near_center);
-		auto left_corner =
-			compute_corner<util::CoordSys::Left>(*this, near_center);
-		auto top_corner =
-			compute_corner<util::CoordSys::Up>(*this, near_center);
-		auto bottom_corner =
-			compute_corner<util::CoordSys::Down>(*this, near_center);
-
-		math::Plane right(cam_pos, -glm::cross(up_vec, right_corner));
-		math::Plane left(cam_pos, glm::cross(up_vec, left_corner));
-		math::Plane top(cam_pos, glm::cross(right_vec, top_corner));
-		math::Plane bottom(cam_pos, -glm::cross(right_vec, bottom_corner));
+		const float distance =
+			glm::length(sphere.origin - placement.get_position());
 
-		return math::Frustum({near, far, left, right, bottom, top});
+		if (distance <= sphere.radius)
+		{
+			return std::numeric_limits<float>::infinity();
+		}
+
+		return 2 * sphere.radius / plane_height(intrinsics.v_fov, distance);
+	}
+
+	float Camera::pixel_size(float length, float distance,
+							 float viewport_height) const
+	{
+		if (distance <= 0.0f)
+		{
+			return std::numeric_limits<float>::infinity();
+		}
+
+		return length * viewport_height /
+			   plane_height(intrinsics.v_fov, distance);
+	}
+
+	math::Ray Camera::get_ray(float window_width, float window_height,
+							  float x, float y) const
+	{
+		// Point in [-1, 1] space on the image plane at distance 1
+		const float half_height = plane_height(intrinsics.v_fov, 1.0f) / 2.0f;
+		const float image_x = (2.0f * x - window_width) / window_width;
+		const float image_y = (window_height - 2.0f * y) / window_height;
+
+		const vec3 direction =
+			placement.get_direction<util::CoordSys::Back>() +
+			placement.get_right_direction() *
+				(image_x * half_height * intrinsics.aspect_ratio) +
+			placement.get_up_direction() * (image_y * half_height);
+
+		return math::Ray{placement.get_position(), glm::normalize(direction)};
 	}
 }   // namespace glge::renderer
@@ -0,0 +1,515 @@
+#include "glge/renderer/occlusion_culler.h"
+
+#include <glge/util/thread_pool.h>
+#include <glge/util/util.h>
+#include <internal/util/_compat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <limits>
+
+namespace glge::renderer
+{
+	namespace
+	{
+		// Last run of frames started by any culler; runs are numbered
+		// across all cullers, so that results cached for one culler are
+		// never reused by another
+		std::atomic<std::uint32_t> last_epoch = 0;
+
+		// Edge function of a triangle's edge, positive on the side of the
+		// edge the triangle lies on: E(x, y) = a * x + b * y + c
+		struct Edge
+		{
+			float a;
+			float b;
+			float c;
+
+			Edge(vec3 from, vec3 to) :
+				a(from.y - to.y), b(to.x - from.x),
+				c(-(a * from.x + b * from.y))
+			{}
+
+			float operator()(float x, float y) const
+			{
+				return a * x + b * y + c;
+			}
+		};
+
+		// Clips a polygon in clip space by the near plane, z >= -w
+		size_t clip_near(const vec4 (&in)[3], vec4 (&out)[4])
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < 3; i++)
+			{
+				const vec4 & a = in[i];
+				const vec4 & b = in[(i + 1) % 3];
+				const float da = a.z + a.w;
+				const float db = b.z + b.w;
+
+				if (da >= 0.0f)
+				{
+					out[count++] = a;
+				}
+				if ((da >= 0.0f) != (db >= 0.0f))
+				{
+					out[count++] = a + (b - a) * (da / (da - db));
+				}
+			}
+
+			return count;
+		}
+	}   // namespace
+
+	OcclusionCuller::OcclusionCuller(size_t width, size_t height,
+									 observer_ptr<util::ThreadPool> pool) :
+		buffer_width(width),
+		buffer_height(height), tiles_x(width / tile_size),
+		tiles_y(height / tile_size),
+		pool(pool ? pool : &util::ThreadPool::shared()), VP(1.0f), V(1.0f),
+		P(1.0f), near_distance(0.0f)
+	{
+		if (width == 0 || height == 0 || width % tile_size != 0 ||
+			height % tile_size != 0)
+		{
+			throw std::invalid_argument(EXC_MSG(
+				"Occlusion buffer sizes must be whole numbers of tiles"));
+		}
+
+		bins.resize(tiles_x * tiles_y);
+
+		// Each level halves the last, rounding up, down to a single texel
+		size_t level_width = width, level_height = height;
+		while (true)
+		{
+			level_sizes.emplace_back(level_width, level_height);
+			levels.emplace_back(level_width * level_height, 0.0f);
+
+			if (level_width == 1 && level_height == 1)
+			{
+				break;
+			}
+
+			level_width = (level_width + 1) / 2;
+			level_height = (level_height + 1) / 2;
+		}
+	}
+
+	void OcclusionCuller::begin(const Camera & camera)
+	{
+		V = camera.get_V();
+		P = camera.intrinsics.get_P();
+		VP = P * V;
+		near_distance = camera.intrinsics.near_distance;
+
+		// A new run of frames starts once the camera strays too far from
+		// where the last began, or the run grows too long
+		const vec3 position = camera.placement.get_position();
+		const vec3 direction =
+			camera.placement.get_direction<util::CoordSys::Back>();
+		const float min_cos = std::cos(static_cast<float>(reuse_limits.angle));
+
+		if (epoch == 0 || epoch_frames >= reuse_limits.frames ||
+			glm::length(position - epoch_position) > reuse_limits.distance ||
+			glm::dot(direction, epoch_direction) < min_cos || P != epoch_P)
+		{
+			// 0 marks a cache holding no result, so is skipped on wrapping
+			do
+			{
+				epoch = ++last_epoch;
+			} while (epoch == 0);
+			epoch_frames = 0;
+			epoch_position = position;
+			epoch_direction = direction;
+			epoch_P = P;
+		}
+		epoch_frames++;
+
+		triangles.clear();
+		for (auto & tile : bins)
+		{
+			tile.clear();
+		}
+
+		std::fill(levels[0].begin(), levels[0].end(), 0.0f);
+		rasterized = false;
+	}
+
+	void OcclusionCuller::add_occluder(const primitive::EBOModelData & mesh,
+									   const mat4 & M)
+	{
+		const mat4 MVP = VP * M;
+
+		const auto outside = [](const vec4 (&clip)[3], auto && beyond) {
+			return beyond(clip[0]) && beyond(clip[1]) && beyond(clip[2]);
+		};
+
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			const vec4 clip[3] = {
+				MVP * vec4(vec3(mesh.vertices.at(mesh.indices[i])), 1.0f),
+				MVP * vec4(vec3(mesh.vertices.at(mesh.indices[i + 1])), 1.0f),
+				MVP * vec4(vec3(mesh.vertices.at(mesh.indices[i + 2])), 1.0f)};
+
+			// Triangles wholly beyond one side of the image are skipped
+			if (outside(clip, [](vec4 v) { return v.x > v.w; }) ||
+				outside(clip, [](vec4 v) { return v.x < -v.w; }) ||
+				outside(clip, [](vec4 v) { return v.y > v.w; }) ||
+				outside(clip, [](vec4 v) { return v.y < -v.w; }) ||
+				outside(clip, [](vec4 v) { return v.z < -v.w; }))
+			{
+				continue;
+			}
+
+			vec4 polygon[4];
+			const size_t count = clip_near(clip, polygon);
+
+			vec3 screen[4];
+			for (size_t j = 0; j < count; j++)
+			{
+				const float inverse_w = 1.0f / polygon[j].w;
+				screen[j] = vec3(
+					(polygon[j].x * inverse_w * 0.5f + 0.5f) *
+						static_cast<float>(buffer_width),
+					(0.5f - polygon[j].y * inverse_w * 0.5f) *
+						static_cast<float>(buffer_height),
+					inverse_w);
+			}
+
+			for (size_t j = 2; j < count; j++)
+			{
+				bin(ScreenTriangle{{screen[0], screen[j - 1], screen[j]}});
+			}
+		}
+	}
+
+	void OcclusionCuller::bin(const ScreenTriangle & triangle)
+	{
+		const vec3 * v = triangle.vertices;
+		const float area = Edge(v[0], v[1])(v[2].x, v[2].y);
+		if (std::abs(area) < std::numeric_limits<float>::epsilon())
+		{
+			return;
+		}
+
+		const float min_x = std::min({v[0].x, v[1].x, v[2].x});
+		const float max_x = std::max({v[0].x, v[1].x, v[2].x});
+		const float min_y = std::min({v[0].y, v[1].y, v[2].y});
+		const float max_y = std::max({v[0].y, v[1].y, v[2].y});
+
+		if (max_x < 0.0f || max_y < 0.0f ||
+			min_x >= static_cast<float>(buffer_width) ||
+			min_y >= static_cast<float>(buffer_height))
+		{
+			return;
+		}
+
+		const auto tile = [](float coordinate, size_t tiles) {
+			const float index = std::floor(coordinate / tile_size);
+			return static_cast<size_t>(
+				std::clamp(index, 0.0f, static_cast<float>(tiles - 1)));
+		};
+
+		const auto index = static_cast<std::uint32_t>(triangles.size());
+		triangles.push_back(triangle);
+
+		for (size_t y = tile(min_y, tiles_y); y <= tile(max_y, tiles_y); y++)
+		{
+			for (size_t x = tile(min_x, tiles_x); x <= tile(max_x, tiles_x);
+				 x++)
+			{
+				bins[y * tiles_x + x].push_back(index);
+			}
+		}
+	}
+
+	void OcclusionCuller::rasterize()
+	{
+		// Waiting on the pool from one of its own workers could deadlock
+		if (tiles_y == 1 || pool->current_worker())
+		{
+			for (size_t y = 0; y < tiles_y; y++)
+			{
+				for (size_t x = 0; x < tiles_x; x++)
+				{
+					rasterize_tile(x, y);
+				}
+			}
+		}
+		else
+		{
+			vector<std::future<void>> rows;
+			for (size_t y = 0; y < tiles_y; y++)
+			{
+				rows.push_back(pool->submit([this, y] {
+					for (size_t x = 0; x < tiles_x; x++)
+					{
+						rasterize_tile(x, y);
+					}
+				}));
+			}
+
+			for (auto & row : rows)
+			{
+				row.wait();
+			}
+			for (auto & row : rows)
+			{
+				row.get();
+			}
+		}
+
+		build_pyramid();
+		rasterized = true;
+	}
+
+	void OcclusionCuller::rasterize_tile(size_t tile_x, size_t tile_y)
+	{
+		float * const buffer = levels[0].data();
+		const float tile_min_x = static_cast<float>(tile_x * tile_size);
+		const float tile_min_y = static_cast<float>(tile_y * tile_size);
+		const float tile_max = static_cast<float>(tile_size - 1);
+
+		for (const std::uint32_t index : bins[tile_y * tiles_x + tile_x])
+		{
+			vec3 v[3] = {triangles[index].vertices[0],
+						 triangles[index].vertices[1],
+						 triangles[index].vertices[2]};
+
+			// Wound so that each edge function is positive inside
+			float area = Edge(v[0], v[1])(v[2].x, v[2].y);
+			if (area < 0.0f)
+			{
+				std::swap(v[1], v[2]);
+				area = -area;
+			}
+
+			const Edge e0(v[1], v[2]), e1(v[2], v[0]), e2(v[0], v[1]);
+
+			// Reciprocal depth is a plane over the screen, through the
+			// barycentric weights given by the edge functions
+			const float z_a = (e0.a * v[0].z + e1.a * v[1].z + e2.a * v[2].z) /
+							  area;
+			const float z_b = (e0.b * v[0].z + e1.b * v[1].z + e2.b * v[2].z) /
+							  area;
+			const float z_c = (e0.c * v[0].z + e1.c * v[1].z + e2.c * v[2].z) /
+							  area;
+
+			// Pixels of the tile whose centers the triangle's box covers,
+			// the first column rounded down to a group of 4
+			const auto first = [&](float min, float tile_min) {
+				return static_cast<size_t>(std::clamp(
+					std::ceil(min - 0.5f) - tile_min, 0.0f, tile_max));
+			};
+			const auto last = [&](float max, float tile_min) {
+				return static_cast<size_t>(
+					std::clamp(std::floor(max - 0.5f) - tile_min, 0.0f,
+							   tile_max));
+			};
+
+			const size_t x0 =
+				first(std::min({v[0].x, v[1].x, v[2].x}), tile_min_x) & ~3;
+			const size_t x1 = last(std::max({v[0].x, v[1].x, v[2].x}),
+								   tile_min_x);
+			const size_t y0 =
+				first(std::min({v[0].y, v[1].y, v[2].y}), tile_min_y);
+			const size_t y1 = last(std::max({v[0].y, v[1].y, v[2].y}),
+								   tile_min_y);
+
+			for (size_t y = y0; y <= y1; y++)
+			{
+				const float center_y =
+					tile_min_y + static_cast<float>(y) + 0.5f;
+				float * const row =
+					buffer + (tile_y * tile_size + y) * buffer_width +
+					tile_x * tile_size;
+
+				size_t x = x0;
+
+#if GLGE_SSE2
+				const __m128 a0 = _mm_set1_ps(e0.a);
+				const __m128 a1 = _mm_set1_ps(e1.a);
+				const __m128 a2 = _mm_set1_ps(e2.a);
+				const __m128 row0 = _mm_set1_ps(e0.b * center_y + e0.c);
+				const __m128 row1 = _mm_set1_ps(e1.b * center_y + e1.c);
+				const __m128 row2 = _mm_set1_ps(e2.b * center_y + e2.c);
+				const __m128 za = _mm_set1_ps(z_a);
+				const __m128 row_z = _mm_set1_ps(z_b * center_y + z_c);
+				const __m128 zero = _mm_setzero_ps();
+
+				for (; x <= x1; x += 4)
+				{
+					const __m128 center_x = _mm_add_ps(
+						_mm_set1_ps(tile_min_x + static_cast<float>(x) + 0.5f),
+						_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+
+					const __m128 inside = _mm_and_ps(
+						_mm_cmpge_ps(
+							_mm_add_ps(_mm_mul_ps(a0, center_x), row0), zero),
+						_mm_and_ps(
+							_mm_cmpge_ps(
+								_mm_add_ps(_mm_mul_ps(a1, center_x), row1),
+								zero),
+							_mm_cmpge_ps(
+								_mm_add_ps(_mm_mul_ps(a2, center_x), row2),
+								zero)));
+
+					const __m128 old = _mm_loadu_ps(row + x);
+					const __m128 nearer =
+						_mm_max_ps(old, _mm_add_ps(_mm_mul_ps(za, center_x),
+												   row_z));
+					_mm_storeu_ps(row + x,
+								  _mm_or_ps(_mm_and_ps(inside, nearer),
+											_mm_andnot_ps(inside, old)));
+				}
+#endif
+
+				for (; x <= x1; x++)
+				{
+					const float center_x =
+						tile_min_x + static_cast<float>(x) + 0.5f;
+					if (e0(center_x, center_y) >= 0.0f &&
+						e1(center_x, center_y) >= 0.0f &&
+						e2(center_x, center_y) >= 0.0f)
+					{
+						const float z = z_a * center_x + z_b * center_y + z_c;
+						row[x] = std::max(row[x], z);
+					}
+				}
+			}
+		}
+	}
+
+	void OcclusionCuller::build_pyramid()
+	{
+		for (size_t level = 1; level < levels.size(); level++)
+		{
+			const auto [width, height] = level_sizes[level];
+			const auto [above_width, above_height] = level_sizes[level - 1];
+			const vector<float> & above = levels[level - 1];
+
+			for (size_t y = 0; y < height; y++)
+			{
+				const size_t y0 = 2 * y;
+				const size_t y1 = std::min(y0 + 1, above_height - 1);
+
+				for (size_t x = 0; x < width; x++)
+				{
+					const size_t x0 = 2 * x;
+					const size_t x1 = std::min(x0 + 1, above_width - 1);
+
+					levels[level][y * width + x] =
+						std::min({above[y0 * above_width + x0],
+								  above[y0 * above_width + x1],
+								  above[y1 * above_width + x0],
+								  above[y1 * above_width + x1]});
+				}
+			}
+		}
+	}
+
+	bool OcclusionCuller::visible(math::Sphere sphere) const
+	{
+		if (!rasterized)
+		{
+			return true;
+		}
+
+		const vec3 center = vec3(V * vec4(sphere.origin, 1.0f));
+		const float depth = -center.z;
+		const float nearest = depth - sphere.radius;
+		if (nearest <= near_distance)
+		{
+			return true;
+		}
+
+		// Bounds on screen of the sphere's view space box, each extreme
+		// found at a corner of the box
+		const auto extent = [&](float coordinate, float scale) {
+			float min = std::numeric_limits<float>::infinity();
+			float max = -min;
+			for (const float offset : {-sphere.radius, sphere.radius})
+			{
+				for (const float w : {nearest, depth + sphere.radius})
+				{
+					const float projected = scale * (coordinate + offset) / w;
+					min = std::min(min, projected);
+					max = std::max(max, projected);
+				}
+			}
+			return std::pair(min, max);
+		};
+
+		const auto [ndc_min_x, ndc_max_x] = extent(center.x, P[0][0]);
+		const auto [ndc_min_y, ndc_max_y] = extent(center.y, P[1][1]);
+
+		const float width = static_cast<float>(buffer_width);
+		const float height = static_cast<float>(buffer_height);
+		const float min_x = (ndc_min_x * 0.5f + 0.5f) * width;
+		const float max_x = (ndc_max_x * 0.5f + 0.5f) * width;
+		const float min_y = (0.5f - ndc_max_y * 0.5f) * height;
+		const float max_y = (0.5f - ndc_min_y * 0.5f) * height;
+
+		if (max_x < 0.0f || max_y < 0.0f || min_x >= width ||
+			min_y >= height)
+		{
+			return true;
+		}
+
+		const auto pixel = [](float coordinate, float size) {
+			return static_cast<size_t>(
+				std::clamp(std::floor(coordinate), 0.0f, size - 1.0f));
+		};
+
+		const size_t x0 = pixel(min_x, width), x1 = pixel(max_x, width);
+		const size_t y0 = pixel(min_y, height), y1 = pixel(max_y, height);
+
+		// The level at which the bounds span at most 3 texels a side
+		const size_t span = std::max(x1 - x0, y1 - y0) + 1;
+		size_t level = 0;
+		while ((span >> level) > 2 && level + 1 < levels.size())
+		{
+			level++;
+		}
+
+		const size_t level_width = level_sizes[level].first;
+		float farthest = std::numeric_limits<float>::infinity();
+		for (size_t y = y0 >> level; y <= y1 >> level; y++)
+		{
+			for (size_t x = x0 >> level; x <= x1 >> level; x++)
+			{
+				farthest =
+					std::min(farthest, levels[level][y * level_width + x]);
+			}
+		}
+
+		return 1.0f / nearest >= farthest;
+	}
+
+	bool OcclusionCuller::visible(math::Sphere sphere,
+								  CachedVisibility & cache) const
+	{
+		if (!rasterized)
+		{
+			return true;
+		}
+
+		if (cache.epoch == epoch && cache.sphere.radius == sphere.radius &&
+			cache.sphere.origin == sphere.origin)
+		{
+			return cache.visible;
+		}
+
+		cache = CachedVisibility{epoch, sphere, visible(sphere)};
+		return cache.visible;
+	}
+
+	float OcclusionCuller::depth(size_t x, size_t y) const
+	{
+		const float inverse = levels[0].at(y * buffer_width + x);
+		return inverse > 0.0f ? 1.0f / inverse
+							  : std::numeric_limits<float>::infinity();
+	}
+}   // namespace glge::renderer
@@ -3,6 +3,7 @@
 #include "gl_common.h"
 
 #include <glge/common.h>
+#include <glge/renderer/render_stats.h>
 #include <glge/util/util.h>
 
 namespace glge::renderer::primitive::opengl
@@ -16,7 +17,8 @@ namespace glge::renderer::primitive::opengl
 	void bind_attrib_data(const GLuint vbo,
 						  const GLuint index,
 						  const vector<T> & data,
-						  const bool normalize)
+						  const bool normalize,
+						  const GLenum usage = GL_STATIC_DRAW)
 	{
 		using data_type =
 			typename std::remove_reference_t<decltype(data)>::value_type;
@@ -27,7 +29,8 @@ namespace glge::renderer::primitive::opengl
 				[] { glBindBuffer(GL_ARRAY_BUFFER, 0); });
 
 			glBufferData(GL_ARRAY_BUFFER, sizeof(data_type) * data.size(),
-						 data.data(), GL_STATIC_DRAW);
+						 data.data(), usage);
+			renderer::stats::record_upload(sizeof(data_type) * data.size());
 
 			glEnableVertexAttribArray(index);
 			glVertexAttribPointer(
@@ -40,6 +43,12 @@ namespace glge::renderer::primitive::opengl
 			EXC_MSG("Failed to load model attribute"));
 	}
 
+	template<typename T>
+	std::uint64_t buffer_bytes(const vector<T> & data)
+	{
+		return sizeof(typename vector<T>::value_type) * data.size();
+	}
+
 	template<typename T>
 	void bind_element_array(const GLuint ebo, const vector<T> & elements)
 	{
@@ -50,6 +59,7 @@ namespace glge::renderer::primitive::opengl
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER,
 					 sizeof(data_type) * elements.size(), elements.data(),
 					 GL_STATIC_DRAW);
+		renderer::stats::record_upload(sizeof(data_type) * elements.size());
 
 		renderer::opengl::throw_if_gl_error(
 			EXC_MSG("Failed to load model indices"));
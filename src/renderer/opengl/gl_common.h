@@ -2,6 +2,8 @@
 
 #include <glge/common.h>
 
+#include <cstdint>
+
 #if GLGE_APPLE
 #include <OpenGL/gl3.h>
 #include <OpenGL/glext.h>
@@ -20,4 +22,80 @@ namespace glge::renderer::opengl
 	}
 
 	constexpr GLuint GL_NO_PROGRAM = 0;
+
+	// Bytes per texel of an uncompressed internal format; formats not
+	// listed are counted as 4 bytes
+	constexpr std::uint64_t texel_bytes(GLenum internal_format)
+	{
+		switch (internal_format)
+		{
+		case GL_R8:
+		case GL_STENCIL_INDEX8:
+			return 1;
+		case GL_RG8:
+		case GL_R16:
+		case GL_R16F:
+		case GL_DEPTH_COMPONENT16:
+			return 2;
+		case GL_RGB8:
+		case GL_SRGB8:
+		case GL_DEPTH_COMPONENT24:
+			return 3;
+		case GL_RGB16:
+		case GL_RGB16F:
+			return 6;
+		case GL_RGBA16:
+		case GL_RGBA16F:
+		case GL_RG32F:
+			return 8;
+		case GL_RGB32F:
+			return 12;
+		case GL_RGBA32F:
+			return 16;
+		default:
+			return 4;
+		}
+	}
+
+	// Computes the memory used by all mip levels of the texture bound to
+	// the given target; for cubemaps, pass a face target and multiply by 6
+	inline std::uint64_t bound_texture_bytes(GLenum target)
+	{
+		std::uint64_t total = 0;
+
+		for (GLint level = 0;; level++)
+		{
+			GLint width = 0, height = 0, compressed = GL_FALSE;
+			glGetTexLevelParameteriv(target, level, GL_TEXTURE_WIDTH, &width);
+			glGetTexLevelParameteriv(target, level, GL_TEXTURE_HEIGHT,
+									 &height);
+
+			if (width == 0 || height == 0)
+			{
+				break;
+			}
+
+			glGetTexLevelParameteriv(target, level, GL_TEXTURE_COMPRESSED,
+									 &compressed);
+
+			if (compressed)
+			{
+				GLint size = 0;
+				glGetTexLevelParameteriv(
+					target, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+				total += static_cast<std::uint64_t>(size);
+			}
+			else
+			{
+				GLint format = 0;
+				glGetTexLevelParameteriv(target, level,
+										 GL_TEXTURE_INTERNAL_FORMAT, &format);
+				total += static_cast<std::uint64_t>(width) *
+						 static_cast<std::uint64_t>(height) *
+						 texel_bytes(static_cast<GLenum>(format));
+			}
+		}
+
+		return total;
+	}
 }   // namespace glge::renderer::opengl
@@ -3,10 +3,83 @@
 #include "gl_common.h"
 
 #include <glge/common.h>
+#include <glge/renderer/render_stats.h>
 #include <glge/util/util.h>
 
 namespace glge::renderer::opengl
 {
+	// Submits compilation of shader source without waiting for it to finish
+	inline GLuint submit_shader(czstring code, GLenum shader_type)
+	{
+		GLuint id = glCreateShader(shader_type);
+
+		glShaderSource(id, 1, &code, NULL);
+		glCompileShader(id);
+
+		return id;
+	}
+
+	// Waits for compilation of a shader and throws if it failed
+	inline void check_shader(GLuint id)
+	{
+		using namespace std::literals::string_literals;
+
+		GLint success = GL_FALSE;
+		GLint info_log_length;
+
+		glGetShaderiv(id, GL_COMPILE_STATUS, &success);
+		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &info_log_length);
+		if (!success)
+		{
+			unique_ptr<char[]> error = std::make_unique<char[]>(
+				static_cast<size_t>(info_log_length) + 1);
+			glGetShaderInfoLog(id, info_log_length, NULL, error.get());
+			throw std::runtime_error(
+				EXC_MSG("Failed to compile shader source: "s + error.get()));
+		}
+	}
+
+	// Submits linking of a program without waiting for it to finish; if
+	// retrievable is set, the driver is asked to keep the program's binary
+	// available. The shaders stay attached until the caller detaches them.
+	inline GLuint
+	submit_link(GLuint vertex_id, GLuint fragment_id, bool retrievable)
+	{
+		GLuint id = glCreateProgram();
+
+		if (retrievable)
+		{
+			glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+								GL_TRUE);
+		}
+
+		glAttachShader(id, vertex_id);
+		glAttachShader(id, fragment_id);
+		glLinkProgram(id);
+
+		return id;
+	}
+
+	// Waits for linking of a program and throws if it failed
+	inline void check_link(GLuint id)
+	{
+		using namespace std::literals::string_literals;
+
+		GLint success = GL_FALSE;
+		GLint info_log_length;
+
+		glGetProgramiv(id, GL_LINK_STATUS, &success);
+		glGetProgramiv(id, GL_INFO_LOG_LENGTH, &info_log_length);
+		if (!success)
+		{
+			unique_ptr<char[]> error = std::make_unique<char[]>(
+				static_cast<size_t>(info_log_length) + 1);
+			glGetProgramInfoLog(id, info_log_length, NULL, error.get());
+			throw std::runtime_error(
+				EXC_MSG("Failed to link program: "s + error.get()));
+		}
+	}
+
 	class GLShader
 	{
 	public:
@@ -17,27 +90,16 @@ namespace glge::renderer::opengl
 
 		static id_type load_shader_source(czstring code, GLenum shader_type)
 		{
-			using namespace std::literals::string_literals;
-
-			id_type id = glCreateShader(shader_type);
+			id_type id = submit_shader(code, shader_type);
 
-			// Compile Vertex Shader
-			glShaderSource(id, 1, &code, NULL);
-			glCompileShader(id);
-
-			// Check Vertex Shader
-			GLint success = GL_FALSE;
-			GLint info_log_length;
-
-			glGetShaderiv(id, GL_COMPILE_STATUS, &success);
-			glGetShaderiv(id, GL_INFO_LOG_LENGTH, &info_log_length);
-			if (!success)
+			try
+			{
+				check_shader(id);
+			}
+			catch (...)
 			{
-				unique_ptr<char[]> error = std::make_unique<char[]>(
-					static_cast<size_t>(info_log_length) + 1);
-				glGetShaderInfoLog(id, info_log_length, NULL, error.get());
-				throw std::runtime_error(EXC_MSG(
-					"Failed to compile shader source: "s + error.get()));
+				glDeleteShader(id);
+				throw;
 			}
 
 			return id;
@@ -67,52 +129,57 @@ namespace glge::renderer::opengl
 		const id_type id;
 
 	public:
-		GLProgram(const GLShader & vertex_shader,
-				  const GLShader & fragment_shader) :
-			id(glCreateProgram())
+		// Links a new program from compiled shaders; if retrievable is set,
+		// the driver is asked to keep the program's binary available
+		static id_type link(const GLShader & vertex_shader,
+							const GLShader & fragment_shader,
+							bool retrievable = false)
 		{
-			using namespace std::literals::string_literals;
-
 			auto vertex_id = vertex_shader.get_id();
 			auto fragment_id = fragment_shader.get_id();
 
-			util::UniqueHandle attach_bind(
-				[=] {
-					glAttachShader(id, vertex_id);
-					glAttachShader(id, fragment_id);
-				},
-				[=] {
-					glDetachShader(id, vertex_id);
-					glDetachShader(id, fragment_id);
-				});
-
-			glLinkProgram(id);
-
-			// Check the program
-			GLint success = GL_FALSE;
-			GLint info_log_length;
-
-			glGetProgramiv(id, GL_LINK_STATUS, &success);
-			glGetProgramiv(id, GL_INFO_LOG_LENGTH, &info_log_length);
-			if (!success)
+			id_type id = submit_link(vertex_id, fragment_id, retrievable);
+
+			glDetachShader(id, vertex_id);
+			glDetachShader(id, fragment_id);
+
+			try
+			{
+				check_link(id);
+			}
+			catch (...)
 			{
-				unique_ptr<char[]> error = std::make_unique<char[]>(
-					static_cast<size_t>(info_log_length) + 1);
-				glGetShaderInfoLog(id, info_log_length, NULL, error.get());
-				throw std::runtime_error(
-					EXC_MSG("Failed to link program: "s + error.get()));
+				glDeleteProgram(id);
+				throw;
 			}
+
+			return id;
 		}
 
+		// Takes ownership of an already linked program
+		explicit GLProgram(id_type id) : id(id) {}
+
+		GLProgram(const GLShader & vertex_shader,
+				  const GLShader & fragment_shader) :
+			GLProgram(link(vertex_shader, fragment_shader))
+		{}
+
 		GLProgram(const GLProgram &) = delete;
 		GLProgram(GLProgram &&) = delete;
 
 		GLProgram & operator=(const GLProgram &) = delete;
 		GLProgram & operator=(GLProgram &&) = delete;
 
+		// Binds the program, leaving it bound
+		void use() const
+		{
+			glUseProgram(id);
+			stats::record_shader_bind();
+		}
+
 		util::UniqueHandle activate() const
 		{
-			return util::UniqueHandle([&] { glUseProgram(id); },
+			return util::UniqueHandle([&] { use(); },
 									  [&] { glUseProgram(GL_NO_PROGRAM); });
 		}
 
@@ -129,11 +196,44 @@ namespace glge::renderer::opengl
 		~GLProgram() { glDeleteProgram(id); }
 	};
 
-	GLProgram load_simple_shader(czstring vertex_code, czstring fragment_code)
+	inline void upload_uniform(GLint location, const mat4 & value)
+	{
+		glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+		stats::record_uniform_upload();
+	}
+
+	inline void upload_uniform(GLint location, const vec2 & value)
 	{
-		GLShader vertex_shader(vertex_code, GL_VERTEX_SHADER);
-		GLShader fragment_shader(fragment_code, GL_FRAGMENT_SHADER);
+		glUniform2fv(location, 1, &value[0]);
+		stats::record_uniform_upload();
+	}
 
-		return GLProgram(vertex_shader, fragment_shader);
+	inline void upload_uniform(GLint location, const vec3 & value)
+	{
+		glUniform3fv(location, 1, &value[0]);
+		stats::record_uniform_upload();
+	}
+
+	inline void upload_uniform(GLint location, float value)
+	{
+		glUniform1f(location, value);
+		stats::record_uniform_upload();
+	}
+
+	// Loads a linked program: takes it from the programs submitted by
+	// prepare_program if present, else from the program binary cache if
+	// possible, else compiles and links it from source. See
+	// gl_program_cache.cpp
+	GLuint load_program(czstring vertex_code, czstring fragment_code);
+
+	// Submits compilation and linking of a program without checking the
+	// result, so that several programs can build at once; a later call to
+	// load_program with the same sources finishes and checks the program
+	void prepare_program(czstring vertex_code, czstring fragment_code);
+
+	inline GLProgram load_simple_shader(czstring vertex_code,
+										czstring fragment_code)
+	{
+		return GLProgram(load_program(vertex_code, fragment_code));
 	}
 }   // namespace glge::renderer::opengl
\ No newline at end of file
@@ -0,0 +1,414 @@
+#include "gl_common.h"
+#include "gl_program.h"
+#include "glge/renderer/renderer.h"
+
+#include <glge/common.h>
+#include <glge/util/util.h>
+#include <internal/util/_util.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <utility>
+
+namespace glge::renderer
+{
+	namespace opengl
+	{
+		namespace fs = std::filesystem;
+
+		namespace
+		{
+			// Bumped whenever the layout of cache files changes
+			constexpr std::uint32_t current_cache_version = 1;
+			constexpr std::uint32_t cache_magic = 0x42504c47;   // "GLPB"
+
+			struct ProgramCacheHeader
+			{
+				std::uint32_t magic;
+				std::uint32_t version;
+				std::uint64_t key;
+				std::uint32_t binary_format;
+				std::uint64_t binary_size;
+			};
+
+			fs::path cache_directory;
+
+			constexpr std::uint64_t fnv_offset_basis =
+				0xcbf29ce484222325ull;
+			constexpr std::uint64_t fnv_prime = 0x100000001b3ull;
+
+			// 64-bit FNV-1a, including the terminating null so that
+			// adjacent strings cannot run together
+			std::uint64_t fnv1a(czstring str, std::uint64_t hash)
+			{
+				do
+				{
+					hash ^= static_cast<unsigned char>(*str);
+					hash *= fnv_prime;
+				} while (*str++);
+
+				return hash;
+			}
+
+			czstring gl_string(GLenum name)
+			{
+				auto str = reinterpret_cast<czstring>(glGetString(name));
+				return str ? str : "";
+			}
+
+			// Programs are only valid for the driver that produced them, so
+			// the key covers the driver identification as well as the
+			// sources
+			std::uint64_t program_cache_key(czstring vertex_code,
+											czstring fragment_code)
+			{
+				std::uint64_t hash = fnv_offset_basis;
+
+				hash = fnv1a(vertex_code, hash);
+				hash = fnv1a(fragment_code, hash);
+				hash = fnv1a(gl_string(GL_VENDOR), hash);
+				hash = fnv1a(gl_string(GL_RENDERER), hash);
+				hash = fnv1a(gl_string(GL_VERSION), hash);
+
+				return hash;
+			}
+
+			bool program_cache_supported()
+			{
+				if (cache_directory.empty())
+				{
+					return false;
+				}
+
+#if !GLGE_APPLE
+				if (!GLEW_ARB_get_program_binary)
+				{
+					return false;
+				}
+#endif
+
+				GLint format_count = 0;
+				glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+				return format_count > 0;
+			}
+
+			fs::path program_cache_path(std::uint64_t key)
+			{
+				char name[32];
+				std::snprintf(name, sizeof(name), "%016llx.glpb",
+							  static_cast<unsigned long long>(key));
+
+				return cache_directory / name;
+			}
+
+			// Returns a linked program, or nothing if the entry is missing,
+			// corrupt, or rejected by the driver
+			std::optional<GLuint> read_cached_program(std::uint64_t key)
+			{
+				const fs::path path = program_cache_path(key);
+
+				std::error_code error;
+				if (!fs::exists(path, error))
+				{
+					return std::nullopt;
+				}
+
+				vector<char> binary;
+				ProgramCacheHeader header;
+
+				try
+				{
+					std::ifstream file = util::open_file_read(path, true);
+
+					file.read(reinterpret_cast<char *>(&header),
+							  sizeof(header));
+
+					if (!file || header.magic != cache_magic ||
+						header.version != current_cache_version ||
+						header.key != key)
+					{
+						return std::nullopt;
+					}
+
+					binary.resize(util::safe_cast<std::uint64_t, size_t>(
+						header.binary_size));
+					file.read(binary.data(),
+							  static_cast<std::streamsize>(binary.size()));
+
+					if (!file)
+					{
+						return std::nullopt;
+					}
+				}
+				catch (const std::exception &)
+				{
+					return std::nullopt;
+				}
+
+				GLuint id = glCreateProgram();
+				glProgramBinary(
+					id, static_cast<GLenum>(header.binary_format),
+					binary.data(),
+					util::safe_cast<size_t, GLsizei>(binary.size()));
+
+				// Drivers reject binaries after driver updates or for formats
+				// they no longer support by failing the link
+				GLint success = GL_FALSE;
+				glGetProgramiv(id, GL_LINK_STATUS, &success);
+
+				if (!success)
+				{
+					glDeleteProgram(id);
+					// Clear errors raised by the rejected binary
+					while (glGetError() != GL_NO_ERROR)
+					{
+					}
+					return std::nullopt;
+				}
+
+				return id;
+			}
+
+			void write_cached_program(std::uint64_t key, GLuint id)
+			{
+				GLint binary_length = 0;
+				glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+
+				if (binary_length <= 0)
+				{
+					return;
+				}
+
+				vector<char> binary(static_cast<size_t>(binary_length));
+				GLenum binary_format = 0;
+				GLsizei written = 0;
+
+				glGetProgramBinary(id, binary_length, &written,
+								   &binary_format, binary.data());
+
+				if (written <= 0)
+				{
+					return;
+				}
+
+				ProgramCacheHeader header{
+					cache_magic, current_cache_version, key, binary_format,
+					static_cast<std::uint64_t>(written)};
+
+				// Write to a temporary file and rename, so that a crash or a
+				// concurrent process never leaves a partial entry behind
+				const fs::path path = program_cache_path(key);
+				fs::path temp_path = path;
+				temp_path += ".tmp";
+
+				try
+				{
+					{
+						std::ofstream file = util::open_file_write(
+							temp_path, true, false, true);
+
+						file.write(reinterpret_cast<const char *>(&header),
+								   sizeof(header));
+						file.write(binary.data(), written);
+					}
+
+					fs::rename(temp_path, path);
+				}
+				catch (const std::exception &)
+				{
+					// The cache is an optimization only; failing to populate
+					// it must not fail shader loading
+					std::error_code error;
+					fs::remove(temp_path, error);
+				}
+			}
+
+			// A program submitted by prepare_program; shader IDs are zero if
+			// the program was loaded from the binary cache
+			struct PendingProgram
+			{
+				GLuint program;
+				GLuint vertex_shader;
+				GLuint fragment_shader;
+				bool use_cache;
+				std::uint64_t key;
+			};
+
+			using PendingPrograms =
+				std::map<std::pair<czstring, czstring>, PendingProgram>;
+
+			PendingPrograms pending_programs;
+
+			void enable_parallel_compile()
+			{
+				static bool enabled = false;
+
+				if (enabled)
+				{
+					return;
+				}
+				enabled = true;
+
+#if !GLGE_APPLE
+				// Let the driver use as many compiler threads as it likes
+				if (GLEW_KHR_parallel_shader_compile)
+				{
+					glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+				}
+				else if (GLEW_ARB_parallel_shader_compile)
+				{
+					glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+				}
+#endif
+			}
+
+			// Waits for a pending program, removing it from pending_programs
+			// whether or not it links
+			GLuint finish_program(PendingPrograms::iterator pending_iter)
+			{
+				const PendingProgram pending = pending_iter->second;
+
+				if (!pending.vertex_shader)
+				{
+					pending_programs.erase(pending_iter);
+					return pending.program;
+				}
+
+				try
+				{
+					// The shaders are detached before the program is deleted
+					util::UniqueHandle delete_shaders([] {}, [&] {
+						glDetachShader(pending.program, pending.vertex_shader);
+						glDetachShader(pending.program,
+									   pending.fragment_shader);
+						glDeleteShader(pending.vertex_shader);
+						glDeleteShader(pending.fragment_shader);
+					});
+
+					// Only checked when linking fails, to report the
+					// compile error in preference to the link error
+					GLint success = GL_FALSE;
+					glGetProgramiv(pending.program, GL_LINK_STATUS, &success);
+
+					if (!success)
+					{
+						check_shader(pending.vertex_shader);
+						check_shader(pending.fragment_shader);
+						check_link(pending.program);
+					}
+				}
+				catch (...)
+				{
+					pending_programs.erase(pending_iter);
+					glDeleteProgram(pending.program);
+					throw;
+				}
+
+				pending_programs.erase(pending_iter);
+
+				if (pending.use_cache)
+				{
+					write_cached_program(pending.key, pending.program);
+				}
+
+				return pending.program;
+			}
+		}   // namespace
+
+		void prepare_program(czstring vertex_code, czstring fragment_code)
+		{
+			const auto sources = std::make_pair(vertex_code, fragment_code);
+
+			if (pending_programs.count(sources))
+			{
+				return;
+			}
+
+			const bool use_cache = program_cache_supported();
+			std::uint64_t key = 0;
+
+			if (use_cache)
+			{
+				key = program_cache_key(vertex_code, fragment_code);
+
+				if (auto cached = read_cached_program(key))
+				{
+					pending_programs.emplace(
+						sources, PendingProgram{*cached, 0, 0, false, key});
+					return;
+				}
+			}
+
+			enable_parallel_compile();
+
+			GLuint vertex_shader = submit_shader(vertex_code, GL_VERTEX_SHADER);
+			GLuint fragment_shader =
+				submit_shader(fragment_code, GL_FRAGMENT_SHADER);
+			GLuint program =
+				submit_link(vertex_shader, fragment_shader, use_cache);
+
+			pending_programs.emplace(
+				sources, PendingProgram{program, vertex_shader,
+										fragment_shader, use_cache, key});
+		}
+
+		GLuint load_program(czstring vertex_code, czstring fragment_code)
+		{
+			auto pending_iter = pending_programs.find(
+				std::make_pair(vertex_code, fragment_code));
+
+			if (pending_iter != pending_programs.end())
+			{
+				return finish_program(pending_iter);
+			}
+
+			const bool use_cache = program_cache_supported();
+			std::uint64_t key = 0;
+
+			if (use_cache)
+			{
+				key = program_cache_key(vertex_code, fragment_code);
+
+				if (auto cached = read_cached_program(key))
+				{
+					return *cached;
+				}
+			}
+
+			GLShader vertex_shader(vertex_code, GL_VERTEX_SHADER);
+			GLShader fragment_shader(fragment_code, GL_FRAGMENT_SHADER);
+
+			GLuint id =
+				GLProgram::link(vertex_shader, fragment_shader, use_cache);
+
+			if (use_cache)
+			{
+				write_cached_program(key, id);
+			}
+
+			return id;
+		}
+	}   // namespace opengl
+
+	void configure_shader_cache(const string & directory)
+	{
+		if (!directory.empty())
+		{
+			std::error_code error;
+			opengl::fs::create_directories(directory, error);
+
+			if (error)
+			{
+				throw std::runtime_error(
+					EXC_MSG("Failed to create shader cache directory " +
+							directory + ": " + error.message()));
+			}
+		}
+
+		opengl::cache_directory = directory;
+	}
+}   // namespace glge::renderer
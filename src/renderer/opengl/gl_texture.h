@@ -0,0 +1,84 @@
+#pragma once
+
+#include "gl_common.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/cubemap.h>
+#include <glge/renderer/primitives/image.h>
+#include <glge/renderer/primitives/texture.h>
+#include <glge/util/thread_pool.h>
+#include <internal/renderer/_texture_container.h>
+
+#include <array>
+#include <cstdint>
+
+namespace glge::renderer::opengl
+{
+	// A decoded image and its mip chain, finest level first
+	using MipChain = vector<primitive::Image>;
+
+	// Cubemap faces in the order of the GL_TEXTURE_CUBE_MAP_* face targets:
+	// +X (right), -X (left), +Y (top), -Y (bottom), +Z (back), -Z (front)
+	using CubemapFaces = std::array<MipChain, 6>;
+
+	// Paths of the cubemap faces, in the same order as CubemapFaces
+	std::array<const primitive::TextureFileInfo *, 6>
+	cubemap_face_files(const primitive::CubemapFileInfo & info);
+
+	// Decodes a texture file and builds its mip chain; safe to call from
+	// any thread, as no GL calls are made. The chain is built in parallel
+	// on the shared pool unless called from one of its workers
+	MipChain decode_texture(const primitive::TextureFileInfo & info);
+
+	// Decodes a single cubemap face and builds its mip chain; safe to call
+	// from any thread
+	MipChain decode_cubemap_face(const primitive::TextureFileInfo & info);
+
+	// Decodes files in parallel on the given pool with the given decoder,
+	// returning the results in the same order as the files
+	vector<MipChain>
+	decode_parallel(const vector<const primitive::TextureFileInfo *> & files,
+					MipChain (*decode)(const primitive::TextureFileInfo &),
+					util::ThreadPool & pool);
+
+	// Decodes all six faces of a cubemap in parallel on the given pool
+	CubemapFaces decode_cubemap(const primitive::CubemapFileInfo & info,
+								util::ThreadPool & pool);
+
+	// Sets the sampling parameters of the texture bound to the target, to
+	// match those of each kind of texture
+	void set_texture_parameters(GLenum target);
+
+	// Client-side format and internal format of the GL texture holding a
+	// decoded image
+	GLenum image_format(const primitive::Image & image);
+	GLenum image_internal_format(const primitive::Image & image);
+
+	// Uploads one level of a texture from client memory, or from the bound
+	// pixel unpack buffer if data is null
+	void upload_level(GLenum target, GLint level,
+					  const primitive::Image & image, const void * data);
+
+	// Uploads one level of a texture through a pixel unpack buffer, so
+	// that the driver can copy it to the GPU without stalling the caller;
+	// falls back to client memory if the buffer cannot be mapped
+	void upload_level_buffered(GLuint PBO, GLenum target, GLint level,
+							   const primitive::Image & image);
+
+	// Memory used on the GPU by a mip chain, counted in the same way as
+	// bound_texture_bytes
+	std::uint64_t mip_chain_bytes(const MipChain & levels);
+
+	// Creates a texture object from a precompressed texture file, uploading
+	// every level without decoding; target is GL_TEXTURE_2D or
+	// GL_TEXTURE_CUBE_MAP, and must match the file's face count
+	GLuint create_compressed_texture(GLenum target, const string & path,
+									 std::uint64_t & bytes);
+
+	// Wrap existing texture objects, taking ownership of them; bytes is the
+	// memory they hold, for the memory statistics
+	unique_ptr<primitive::Texture> adopt_texture(GLuint id,
+												 std::uint64_t bytes);
+	unique_ptr<primitive::Cubemap> adopt_cubemap(GLuint id,
+												 std::uint64_t bytes);
+}   // namespace glge::renderer::opengl
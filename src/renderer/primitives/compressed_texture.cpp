@@ -0,0 +1,575 @@
+#include "glge/renderer/primitives/compressed_texture.h"
+
+#include <internal/renderer/_texture_container.h>
+#include <internal/util/_compat.h>
+#include <internal/util/_util.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <limits>
+
+namespace glge::renderer
+{
+	namespace primitive
+	{
+		namespace
+		{
+			constexpr size_t block_dim = 4;
+			constexpr size_t block_pixels = block_dim * block_dim;
+
+			// The pixels of one block, as RGBA
+			using Block =
+				std::array<std::array<std::uint8_t, 4>, block_pixels>;
+
+			size_t blocks_across(size_t pixels)
+			{
+				return std::max<size_t>((pixels + block_dim - 1) / block_dim,
+										1);
+			}
+
+			// Pixels past the edge of the image repeat the edge pixels
+			Block fetch_block(const Image & image, size_t block_x,
+							  size_t block_y)
+			{
+				Block block;
+
+				for (size_t i = 0; i < block_pixels; i++)
+				{
+					const size_t x = std::min(
+						block_x * block_dim + i % block_dim, image.width - 1);
+					const size_t y = std::min(
+						block_y * block_dim + i / block_dim, image.height - 1);
+					const std::uint8_t * pixel = image.pixel(x, y);
+
+					for (size_t c = 0; c < 3; c++)
+					{
+						block[i][c] = pixel[c];
+					}
+					block[i][3] = image.channels == 4 ? pixel[3] : 255;
+				}
+
+				return block;
+			}
+
+			std::uint16_t pack_565(const std::array<int, 3> & color)
+			{
+				return static_cast<std::uint16_t>(
+					((color[0] * 31 + 127) / 255) << 11 |
+					((color[1] * 63 + 127) / 255) << 5 |
+					((color[2] * 31 + 127) / 255));
+			}
+
+			std::array<int, 3> unpack_565(std::uint16_t packed)
+			{
+				const int r = (packed >> 11) & 0x1f;
+				const int g = (packed >> 5) & 0x3f;
+				const int b = packed & 0x1f;
+
+				// Replicate the high bits into the low bits, so that the
+				// full range maps to [0, 255]
+				return {(r << 3) | (r >> 2), (g << 2) | (g >> 4),
+						(b << 3) | (b >> 2)};
+			}
+
+			std::array<std::array<int, 3>, 4>
+			color_palette(std::uint16_t c0, std::uint16_t c1)
+			{
+				std::array<std::array<int, 3>, 4> palette;
+				palette[0] = unpack_565(c0);
+				palette[1] = unpack_565(c1);
+
+				for (size_t c = 0; c < 3; c++)
+				{
+					if (c0 > c1)
+					{
+						palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+						palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+					}
+					else
+					{
+						palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+						palette[3][c] = 0;
+					}
+				}
+
+				return palette;
+			}
+
+			void write_u16(std::uint8_t * out, std::uint16_t value)
+			{
+				out[0] = static_cast<std::uint8_t>(value);
+				out[1] = static_cast<std::uint8_t>(value >> 8);
+			}
+
+			std::uint16_t read_u16(const std::uint8_t * in)
+			{
+				return static_cast<std::uint16_t>(in[0] | in[1] << 8);
+			}
+
+			void encode_color(const Block & block, std::uint8_t * out)
+			{
+				std::array<int, 3> low{255, 255, 255}, high{0, 0, 0};
+
+				for (const auto & pixel : block)
+				{
+					for (size_t c = 0; c < 3; c++)
+					{
+						low[c] = std::min<int>(low[c], pixel[c]);
+						high[c] = std::max<int>(high[c], pixel[c]);
+					}
+				}
+
+				// Pull the endpoints in slightly, as the extremes of the box
+				// are rarely the best endpoints
+				for (size_t c = 0; c < 3; c++)
+				{
+					const int inset = (high[c] - low[c]) / 16;
+					low[c] += inset;
+					high[c] -= inset;
+				}
+
+				std::uint16_t c0 = pack_565(high);
+				std::uint16_t c1 = pack_565(low);
+
+				// c0 > c1 selects the four color mode; equal endpoints make
+				// every index select c0
+				if (c0 < c1)
+				{
+					std::swap(c0, c1);
+				}
+
+				write_u16(out, c0);
+				write_u16(out + 2, c1);
+
+				std::uint32_t indices = 0;
+
+				if (c0 != c1)
+				{
+					const auto palette = color_palette(c0, c1);
+
+					for (size_t i = 0; i < block_pixels; i++)
+					{
+						std::uint32_t best = 0;
+						int best_error = std::numeric_limits<int>::max();
+
+						for (std::uint32_t p = 0; p < palette.size(); p++)
+						{
+							int error = 0;
+							for (size_t c = 0; c < 3; c++)
+							{
+								const int d = palette[p][c] - block[i][c];
+								error += d * d;
+							}
+
+							if (error < best_error)
+							{
+								best = p;
+								best_error = error;
+							}
+						}
+
+						indices |= best << (2 * i);
+					}
+				}
+
+				for (size_t i = 0; i < 4; i++)
+				{
+					out[4 + i] = static_cast<std::uint8_t>(indices >> (8 * i));
+				}
+			}
+
+			std::array<int, 8> alpha_palette(int a0, int a1)
+			{
+				std::array<int, 8> palette{a0, a1};
+
+				if (a0 > a1)
+				{
+					for (int i = 1; i < 7; i++)
+					{
+						palette[static_cast<size_t>(i) + 1] =
+							((7 - i) * a0 + i * a1) / 7;
+					}
+				}
+				else
+				{
+					for (int i = 1; i < 5; i++)
+					{
+						palette[static_cast<size_t>(i) + 1] =
+							((5 - i) * a0 + i * a1) / 5;
+					}
+					palette[6] = 0;
+					palette[7] = 255;
+				}
+
+				return palette;
+			}
+
+			void encode_alpha(const Block & block, std::uint8_t * out)
+			{
+				int a0 = 0, a1 = 255;
+
+				for (const auto & pixel : block)
+				{
+					a0 = std::max<int>(a0, pixel[3]);
+					a1 = std::min<int>(a1, pixel[3]);
+				}
+
+				out[0] = static_cast<std::uint8_t>(a0);
+				out[1] = static_cast<std::uint8_t>(a1);
+
+				const auto palette = alpha_palette(a0, a1);
+				std::uint64_t indices = 0;
+
+				for (size_t i = 0; i < block_pixels; i++)
+				{
+					std::uint64_t best = 0;
+					int best_error = std::numeric_limits<int>::max();
+
+					for (std::uint64_t p = 0; p < palette.size(); p++)
+					{
+						const int error = std::abs(palette[p] - block[i][3]);
+
+						if (error < best_error)
+						{
+							best = p;
+							best_error = error;
+						}
+					}
+
+					indices |= best << (3 * i);
+				}
+
+				for (size_t i = 0; i < 6; i++)
+				{
+					out[2 + i] = static_cast<std::uint8_t>(indices >> (8 * i));
+				}
+			}
+
+			void decode_color(const std::uint8_t * in, Block & block)
+			{
+				const std::uint16_t c0 = read_u16(in);
+				const std::uint16_t c1 = read_u16(in + 2);
+				const auto palette = color_palette(c0, c1);
+
+				for (size_t i = 0; i < block_pixels; i++)
+				{
+					const size_t index = (in[4 + i / 4] >> (2 * (i % 4))) & 3;
+
+					for (size_t c = 0; c < 3; c++)
+					{
+						block[i][c] =
+							static_cast<std::uint8_t>(palette[index][c]);
+					}
+
+					// Index 3 is transparent black in three color mode
+					block[i][3] = c0 <= c1 && index == 3 ? 0 : 255;
+				}
+			}
+
+			void decode_alpha(const std::uint8_t * in, Block & block)
+			{
+				const auto palette = alpha_palette(in[0], in[1]);
+
+				std::uint64_t indices = 0;
+				for (size_t i = 0; i < 6; i++)
+				{
+					indices |= static_cast<std::uint64_t>(in[2 + i]) << (8 * i);
+				}
+
+				for (size_t i = 0; i < block_pixels; i++)
+				{
+					block[i][3] = static_cast<std::uint8_t>(
+						palette[(indices >> (3 * i)) & 7]);
+				}
+			}
+
+			size_t align_offset(size_t offset)
+			{
+				return (offset + texture_container_alignment - 1) /
+					   texture_container_alignment *
+					   texture_container_alignment;
+			}
+		}   // namespace
+
+		size_t block_bytes(BlockFormat format)
+		{
+			return format == BlockFormat::BC1 ? 8 : 16;
+		}
+
+		size_t compressed_size(BlockFormat format, size_t width, size_t height)
+		{
+			return blocks_across(width) * blocks_across(height) *
+				   block_bytes(format);
+		}
+
+		vector<std::uint8_t> compress_image(const Image & image,
+											BlockFormat format)
+		{
+			if (image.channels != 3 && image.channels != 4)
+			{
+				throw std::invalid_argument(
+					EXC_MSG("Only RGB and RGBA images can be compressed"));
+			}
+
+			const size_t block_size = block_bytes(format);
+			const size_t columns = blocks_across(image.width);
+
+			vector<std::uint8_t> blocks(
+				compressed_size(format, image.width, image.height));
+
+			for (size_t y = 0; y < blocks_across(image.height); y++)
+			{
+				for (size_t x = 0; x < columns; x++)
+				{
+					const Block block = fetch_block(image, x, y);
+					std::uint8_t * out =
+						blocks.data() + (y * columns + x) * block_size;
+
+					if (format == BlockFormat::BC3)
+					{
+						encode_alpha(block, out);
+						out += 8;
+					}
+
+					encode_color(block, out);
+				}
+			}
+
+			return blocks;
+		}
+
+		Image decompress_image(const std::uint8_t * blocks, size_t width,
+							   size_t height, BlockFormat format)
+		{
+			const size_t block_size = block_bytes(format);
+			const size_t columns = blocks_across(width);
+
+			Image image;
+			image.width = width;
+			image.height = height;
+			image.channels = 4;
+			image.pixels.resize(image.row_size() * height);
+
+			for (size_t y = 0; y < blocks_across(height); y++)
+			{
+				for (size_t x = 0; x < columns; x++)
+				{
+					const std::uint8_t * in =
+						blocks + (y * columns + x) * block_size;
+
+					Block block;
+					if (format == BlockFormat::BC3)
+					{
+						decode_color(in + 8, block);
+						decode_alpha(in, block);
+					}
+					else
+					{
+						decode_color(in, block);
+					}
+
+					for (size_t i = 0; i < block_pixels; i++)
+					{
+						const size_t px = x * block_dim + i % block_dim;
+						const size_t py = y * block_dim + i / block_dim;
+
+						if (px < width && py < height)
+						{
+							std::copy(block[i].cbegin(), block[i].cend(),
+									  image.pixels.begin() +
+										  static_cast<std::ptrdiff_t>(
+											  py * image.row_size() +
+											  px * 4));
+						}
+					}
+				}
+			}
+
+			return image;
+		}
+
+		void write_compressed_texture(const string & path,
+									  const vector<vector<Image>> & faces,
+									  BlockFormat format)
+		{
+			if (faces.size() != 1 && faces.size() != 6)
+			{
+				throw std::invalid_argument(
+					EXC_MSG("A texture file must have 1 or 6 faces"));
+			}
+
+			const vector<Image> & first = faces.front();
+
+			if (first.empty())
+			{
+				throw std::invalid_argument(
+					EXC_MSG("A texture file must have at least one level"));
+			}
+
+			for (const auto & face : faces)
+			{
+				bool same_size = face.size() == first.size();
+
+				for (size_t i = 0; same_size && i < face.size(); i++)
+				{
+					same_size = face[i].width == first[i].width &&
+								face[i].height == first[i].height;
+				}
+
+				if (!same_size)
+				{
+					throw std::invalid_argument(EXC_MSG(
+						"All faces of a texture file must have the same "
+						"levels"));
+				}
+			}
+
+			vector<const Image *> images;
+			for (const auto & face : faces)
+			{
+				for (const Image & level : face)
+				{
+					images.push_back(&level);
+				}
+			}
+
+			vector<vector<std::uint8_t>> compressed(images.size());
+			std::transform(EXECUTION_POLICY_PAR images.cbegin(),
+						   images.cend(), compressed.begin(),
+						   [format](const Image * image) {
+							   return compress_image(*image, format);
+						   });
+
+			TextureContainerHeader header{
+				texture_container_magic,
+				texture_container_version,
+				static_cast<std::uint32_t>(format),
+				util::safe_cast<size_t, std::uint32_t>(first[0].width),
+				util::safe_cast<size_t, std::uint32_t>(first[0].height),
+				static_cast<std::uint32_t>(faces.size()),
+				static_cast<std::uint32_t>(first.size()),
+				0};
+
+			vector<TextureContainerLevel> table(images.size());
+			size_t offset = align_offset(
+				sizeof(header) + table.size() * sizeof(TextureContainerLevel));
+
+			for (size_t i = 0; i < images.size(); i++)
+			{
+				table[i] = TextureContainerLevel{
+					offset, compressed[i].size(),
+					static_cast<std::uint32_t>(images[i]->width),
+					static_cast<std::uint32_t>(images[i]->height)};
+				offset = align_offset(offset + compressed[i].size());
+			}
+
+			std::ofstream file = util::open_file_write(path, true, false, true);
+
+			file.write(reinterpret_cast<const char *>(&header),
+					   sizeof(header));
+			file.write(reinterpret_cast<const char *>(table.data()),
+					   static_cast<std::streamsize>(
+						   table.size() * sizeof(TextureContainerLevel)));
+
+			const std::array<char, texture_container_alignment> padding{};
+			size_t position =
+				sizeof(header) + table.size() * sizeof(TextureContainerLevel);
+
+			for (size_t i = 0; i < images.size(); i++)
+			{
+				file.write(padding.data(), static_cast<std::streamsize>(
+											   table[i].offset - position));
+				file.write(
+					reinterpret_cast<const char *>(compressed[i].data()),
+					static_cast<std::streamsize>(compressed[i].size()));
+				position = table[i].offset + compressed[i].size();
+			}
+
+			if (!file)
+			{
+				throw std::runtime_error(
+					EXC_MSG("Failed to write texture file " + path));
+			}
+		}
+	}   // namespace primitive
+
+	TextureContainer::TextureContainer(const std::uint8_t * data,
+									   size_t size) :
+		data(data),
+		header(reinterpret_cast<const TextureContainerHeader *>(data)),
+		levels(reinterpret_cast<const TextureContainerLevel *>(
+			data + sizeof(TextureContainerHeader)))
+	{
+		auto invalid = [](const string & reason) {
+			return std::runtime_error(
+				EXC_MSG("Invalid texture file: " + reason));
+		};
+
+		if (size < sizeof(TextureContainerHeader) ||
+			header->magic != texture_container_magic)
+		{
+			throw invalid("not a texture file");
+		}
+
+		if (header->version != texture_container_version)
+		{
+			throw invalid("unsupported version " +
+						  std::to_string(header->version));
+		}
+
+		if (header->format > static_cast<std::uint32_t>(
+								 primitive::BlockFormat::BC3))
+		{
+			throw invalid("unknown format");
+		}
+
+		if ((header->face_count != 1 && header->face_count != 6) ||
+			header->level_count == 0 || header->level_count > 32)
+		{
+			throw invalid("bad face or level count");
+		}
+
+		const size_t entries = face_count() * level_count();
+		if (size < sizeof(TextureContainerHeader) +
+					   entries * sizeof(TextureContainerLevel))
+		{
+			throw invalid("truncated level table");
+		}
+
+		for (size_t i = 0; i < entries; i++)
+		{
+			const TextureContainerLevel & entry = levels[i];
+
+			if (entry.offset % texture_container_alignment != 0 ||
+				entry.offset > size || entry.size > size - entry.offset ||
+				entry.size != primitive::compressed_size(
+								  format(), entry.width, entry.height))
+			{
+				throw invalid("bad level " + std::to_string(i));
+			}
+		}
+	}
+
+	primitive::BlockFormat TextureContainer::format() const
+	{
+		return static_cast<primitive::BlockFormat>(header->format);
+	}
+
+	size_t TextureContainer::face_count() const { return header->face_count; }
+
+	size_t TextureContainer::level_count() const
+	{
+		return header->level_count;
+	}
+
+	TextureContainer::Level TextureContainer::level(size_t face,
+													size_t level) const
+	{
+		const TextureContainerLevel & entry =
+			levels[face * level_count() + level];
+
+		return Level{data + entry.offset, static_cast<size_t>(entry.size),
+					 entry.width, entry.height};
+	}
+}   // namespace glge::renderer
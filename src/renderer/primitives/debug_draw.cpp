@@ -0,0 +1,164 @@
+#include "glge/renderer/primitives/debug_draw.h"
+
+#include <glge/util/util.h>
+#include <internal/util/_util.h>
+
+#include <cmath>
+
+namespace glge::renderer::primitive
+{
+	namespace
+	{
+		constexpr float pi = 3.14159265358979f;
+
+		// Corners of a box, indexed by bits selecting the maximum on x, y
+		// and z
+		std::array<vec3, 8> box_corners(vec3 min, vec3 max)
+		{
+			std::array<vec3, 8> corners;
+			for (size_t i = 0; i < corners.size(); i++)
+			{
+				corners[i] = vec3(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y,
+								  i & 4 ? max.z : min.z);
+			}
+
+			return corners;
+		}
+
+		// Draws the faces at the minimum and maximum z as loops, and the
+		// edges joining them as segments
+		void box_edges(DebugDraw & draw, const std::array<vec3, 8> & corners,
+					   vec3 color)
+		{
+			draw.loop({corners[0], corners[1], corners[3], corners[2]}, color);
+			draw.loop({corners[4], corners[5], corners[7], corners[6]}, color);
+
+			for (size_t i = 0; i < 4; i++)
+			{
+				draw.line(corners[i], corners[i + 4], color);
+			}
+		}
+	}   // namespace
+
+	DebugBatch & DebugDraw::modify(DebugPrimitive primitive)
+	{
+		changes++;
+		return batches[static_cast<size_t>(primitive)];
+	}
+
+	void DebugDraw::polyline(DebugPrimitive primitive,
+							 const vector<vec3> & points, vec3 color)
+	{
+		if (points.size() < 2)
+		{
+			return;
+		}
+
+		DebugBatch & target = modify(primitive);
+
+		for (const vec3 & point : points)
+		{
+			target.indices.push_back(
+				util::safe_cast<size_t, std::uint32_t>(target.vertices.size()));
+			target.vertices.push_back(DebugVertex{point, color});
+		}
+
+		target.indices.push_back(restart_index);
+	}
+
+	void DebugDraw::line(vec3 from, vec3 to, vec3 color)
+	{
+		DebugBatch & target = modify(DebugPrimitive::Lines);
+
+		target.vertices.push_back(DebugVertex{from, color});
+		target.vertices.push_back(DebugVertex{to, color});
+	}
+
+	void DebugDraw::strip(const vector<vec3> & points, vec3 color)
+	{
+		polyline(DebugPrimitive::LineStrip, points, color);
+	}
+
+	void DebugDraw::loop(const vector<vec3> & points, vec3 color)
+	{
+		polyline(DebugPrimitive::LineLoop, points, color);
+	}
+
+	void DebugDraw::sphere(const math::Sphere & sphere, vec3 color,
+						   size_t segments)
+	{
+		if (segments < 3)
+		{
+			throw std::invalid_argument(
+				EXC_MSG("Spheres need at least three segments per circle"));
+		}
+
+		vector<vec3> xy(segments), yz(segments), zx(segments);
+
+		for (size_t i = 0; i < segments; i++)
+		{
+			const float angle = 2.0f * pi * static_cast<float>(i) /
+								static_cast<float>(segments);
+			const float c = sphere.radius * std::cos(angle);
+			const float s = sphere.radius * std::sin(angle);
+
+			xy[i] = sphere.origin + vec3(c, s, 0.0f);
+			yz[i] = sphere.origin + vec3(0.0f, c, s);
+			zx[i] = sphere.origin + vec3(s, 0.0f, c);
+		}
+
+		loop(xy, color);
+		loop(yz, color);
+		loop(zx, color);
+	}
+
+	void DebugDraw::box(vec3 min, vec3 max, vec3 color)
+	{
+		box_edges(*this, box_corners(min, max), color);
+	}
+
+	void DebugDraw::box(const mat4 & transform, vec3 color)
+	{
+		auto corners = box_corners(vec3(-1.0f), vec3(1.0f));
+		for (vec3 & corner : corners)
+		{
+			const vec4 transformed = transform * vec4(corner, 1.0f);
+			corner = vec3(transformed) / transformed.w;
+		}
+
+		box_edges(*this, corners, color);
+	}
+
+	void DebugDraw::frustum(const mat4 & view_projection, vec3 color)
+	{
+		// The frustum is the clip space cube, taken back to world space
+		box(glm::inverse(view_projection), color);
+	}
+
+	void DebugDraw::clear()
+	{
+		for (DebugBatch & target : batches)
+		{
+			target.vertices.clear();
+			target.indices.clear();
+		}
+
+		changes++;
+	}
+
+	const DebugBatch & DebugDraw::batch(DebugPrimitive primitive) const
+	{
+		return batches[static_cast<size_t>(primitive)];
+	}
+
+	size_t DebugDraw::vertex_count() const
+	{
+		size_t count = 0;
+		for (const DebugBatch & target : batches)
+		{
+			count += target.vertices.size();
+		}
+
+		return count;
+	}
+}   // namespace glge::renderer::primitive
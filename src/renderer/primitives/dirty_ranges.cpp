@@ -0,0 +1,72 @@
+#include "internal/renderer/_dirty_ranges.h"
+
+#include <glge/util/util.h>
+
+#include <algorithm>
+
+namespace glge::renderer
+{
+	DirtyRanges::DirtyRanges(size_t max_ranges) : max_ranges(max_ranges)
+	{
+		if (max_ranges == 0)
+		{
+			throw std::invalid_argument(
+				EXC_MSG("At least one dirty range must be allowed"));
+		}
+	}
+
+	void DirtyRanges::add(size_t begin, size_t end)
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+
+		// First range not entirely before the new one, counting adjacent
+		// ranges as touching
+		auto first = std::lower_bound(
+			dirty.begin(), dirty.end(), begin,
+			[](DirtyRange range, size_t value) { return range.end < value; });
+
+		// One past the last range touching the new one
+		auto last = first;
+		while (last != dirty.end() && last->begin <= end)
+		{
+			begin = std::min(begin, last->begin);
+			end = std::max(end, last->end);
+			++last;
+		}
+
+		first = dirty.erase(first, last);
+		dirty.insert(first, DirtyRange{begin, end});
+
+		while (dirty.size() > max_ranges)
+		{
+			// Join the two ranges with the smallest gap between them
+			size_t closest = 0;
+			for (size_t i = 1; i + 1 < dirty.size(); i++)
+			{
+				if (dirty[i + 1].begin - dirty[i].end <
+					dirty[closest + 1].begin - dirty[closest].end)
+				{
+					closest = i;
+				}
+			}
+
+			dirty[closest].end = dirty[closest + 1].end;
+			dirty.erase(dirty.begin() + static_cast<std::ptrdiff_t>(closest) +
+						1);
+		}
+	}
+
+	size_t DirtyRanges::element_count() const
+	{
+		size_t count = 0;
+		for (const DirtyRange & range : dirty)
+		{
+			count += range.size();
+		}
+
+		return count;
+	}
+}   // namespace glge::renderer
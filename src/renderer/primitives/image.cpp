@@ -0,0 +1,536 @@
+#include "glge/renderer/primitives/image.h"
+
+#include <glge/util/util.h>
+#include <internal/util/_compat.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <future>
+
+namespace glge::renderer::primitive
+{
+	namespace
+	{
+		constexpr float pi = 3.14159265358979f;
+
+		// Radius of the windowed sinc filters, in texels of the smaller
+		// level, and the shape parameter of the Kaiser window
+		constexpr float window_radius = 3.0f;
+		constexpr float kaiser_alpha = 4.0f;
+
+		// Number of values each parallel job aims to write
+		constexpr size_t band_values = 32 * 1024;
+
+		// Channel values while filtering, scaled to [0, 255] so that box
+		// filtering of plain 8-bit values is exact
+		struct FloatImage
+		{
+			size_t width = 0;
+			size_t height = 0;
+			size_t channels = 0;
+			vector<float> values;
+
+			size_t row_size() const { return width * channels; }
+		};
+
+		// Number of channels holding color, rather than alpha
+		size_t color_channels(size_t channels)
+		{
+			return channels - (channels % 2 == 0 ? 1 : 0);
+		}
+
+		const std::array<float, 256> & srgb_to_linear_table()
+		{
+			static const auto table = [] {
+				std::array<float, 256> values{};
+
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					const float c = static_cast<float>(i) / 255.0f;
+					const float linear =
+						c <= 0.04045f ? c / 12.92f
+									  : std::pow((c + 0.055f) / 1.055f, 2.4f);
+					values[i] = linear * 255.0f;
+				}
+
+				return values;
+			}();
+
+			return table;
+		}
+
+		// Encodes linear values quantized to 16 bits, which keeps the
+		// error well under one 8-bit step even near black
+		const vector<std::uint8_t> & linear_to_srgb_table()
+		{
+			static const auto table = [] {
+				vector<std::uint8_t> values(65536);
+
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					const float l = static_cast<float>(i) / 65535.0f;
+					const float c =
+						l <= 0.0031308f
+							? l * 12.92f
+							: 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+					values[i] = static_cast<std::uint8_t>(c * 255.0f + 0.5f);
+				}
+
+				return values;
+			}();
+
+			return table;
+		}
+
+		float sinc(float x)
+		{
+			if (std::abs(x) < 1e-6f)
+			{
+				return 1.0f;
+			}
+
+			x *= pi;
+			return std::sin(x) / x;
+		}
+
+		// Zeroth order modified Bessel function of the first kind
+		float bessel_i0(float x)
+		{
+			float sum = 1.0f, term = 1.0f;
+
+			for (int k = 1; k < 32 && term > sum * 1e-8f; k++)
+			{
+				const float factor = x / static_cast<float>(2 * k);
+				term *= factor * factor;
+				sum += term;
+			}
+
+			return sum;
+		}
+
+		float filter_radius(MipFilter filter)
+		{
+			return filter == MipFilter::Box ? 0.5f : window_radius;
+		}
+
+		// Weight of a texel at distance x, in texels of the smaller level
+		float filter_weight(MipFilter filter, float x)
+		{
+			x = std::abs(x);
+
+			switch (filter)
+			{
+			case MipFilter::Box:
+				return x < 0.5f ? 1.0f : x == 0.5f ? 0.5f : 0.0f;
+			case MipFilter::Kaiser:
+			{
+				if (x >= window_radius)
+				{
+					return 0.0f;
+				}
+
+				const float t = x / window_radius;
+				return sinc(x) *
+					   bessel_i0(kaiser_alpha * std::sqrt(1.0f - t * t)) /
+					   bessel_i0(kaiser_alpha);
+			}
+			case MipFilter::Lanczos:
+				return x < window_radius ? sinc(x) * sinc(x / window_radius)
+										 : 0.0f;
+			}
+
+			return 0.0f;
+		}
+
+		// Source texels contributing to each texel along one axis of a
+		// level, and their weights, which sum to 1
+		struct Taps
+		{
+			size_t count = 0;
+			vector<size_t> indices;
+			vector<float> weights;
+		};
+
+		Taps compute_taps(size_t source, size_t dest, MipFilter filter)
+		{
+			const float scale =
+				static_cast<float>(source) / static_cast<float>(dest);
+			const float support = filter_radius(filter) * scale;
+
+			Taps taps;
+			taps.count = static_cast<size_t>(std::ceil(support * 2.0f)) + 1;
+			taps.indices.resize(taps.count * dest);
+			taps.weights.resize(taps.count * dest);
+
+			for (size_t x = 0; x < dest; x++)
+			{
+				const float center = (static_cast<float>(x) + 0.5f) * scale;
+				const long first =
+					static_cast<long>(std::floor(center - support));
+
+				size_t * indices = taps.indices.data() + x * taps.count;
+				float * weights = taps.weights.data() + x * taps.count;
+				float sum = 0.0f;
+
+				for (size_t k = 0; k < taps.count; k++)
+				{
+					const long i = first + static_cast<long>(k);
+
+					// Texels past the edges repeat the edge texels
+					indices[k] = static_cast<size_t>(
+						std::clamp(i, 0l, static_cast<long>(source) - 1));
+					weights[k] = filter_weight(
+						filter,
+						(static_cast<float>(i) + 0.5f - center) / scale);
+					sum += weights[k];
+				}
+
+				for (size_t k = 0; k < taps.count; k++)
+				{
+					weights[k] /= sum;
+				}
+			}
+
+			return taps;
+		}
+
+		// out[i] += weight * in[i]
+		void accumulate(float * out, const float * in, float weight,
+						size_t count)
+		{
+			size_t i = 0;
+
+#if GLGE_SSE2
+			const __m128 factor = _mm_set1_ps(weight);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm_storeu_ps(out + i,
+							  _mm_add_ps(_mm_loadu_ps(out + i),
+										 _mm_mul_ps(_mm_loadu_ps(in + i),
+													factor)));
+			}
+#endif
+
+			for (; i < count; i++)
+			{
+				out[i] += weight * in[i];
+			}
+		}
+
+		// Filters a row along its length; the channel count is a template
+		// parameter so that the loop over channels unrolls
+		template<size_t Channels>
+		void filter_across(const float * column, const Taps & taps,
+						   float * out, size_t width)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				const size_t * indices = taps.indices.data() + x * taps.count;
+				const float * weights = taps.weights.data() + x * taps.count;
+				std::array<float, Channels> sum{};
+
+				for (size_t k = 0; k < taps.count; k++)
+				{
+					const float * texel = column + indices[k] * Channels;
+
+					for (size_t c = 0; c < Channels; c++)
+					{
+						sum[c] += weights[k] * texel[c];
+					}
+				}
+
+				// Negative lobes of the windowed filters can overshoot
+				for (size_t c = 0; c < Channels; c++)
+				{
+					out[x * Channels + c] = std::clamp(sum[c], 0.0f, 255.0f);
+				}
+			}
+		}
+
+		// Filters one row of a level: first down the columns of the
+		// source, which vectorizes across the whole row, then along the
+		// row. column is scratch space for one row of the source
+		void filter_row(const FloatImage & source, const Taps & x_taps,
+						const Taps & y_taps, size_t y, float * column,
+						float * out, size_t width)
+		{
+			const size_t row_size = source.row_size();
+			std::fill(column, column + row_size, 0.0f);
+
+			for (size_t k = 0; k < y_taps.count; k++)
+			{
+				const float weight = y_taps.weights[y * y_taps.count + k];
+
+				if (weight != 0.0f)
+				{
+					const size_t row = y_taps.indices[y * y_taps.count + k];
+					accumulate(column, source.values.data() + row * row_size,
+							   weight, row_size);
+				}
+			}
+
+			switch (source.channels)
+			{
+			case 1: filter_across<1>(column, x_taps, out, width); break;
+			case 2: filter_across<2>(column, x_taps, out, width); break;
+			case 3: filter_across<3>(column, x_taps, out, width); break;
+			default: filter_across<4>(column, x_taps, out, width); break;
+			}
+		}
+
+		void decode_row(const std::uint8_t * in, float * out, size_t width,
+						size_t channels, bool srgb)
+		{
+			const size_t color = srgb ? color_channels(channels) : 0;
+			const auto & table = srgb_to_linear_table();
+
+			for (size_t x = 0; x < width; x++)
+			{
+				for (size_t c = 0; c < channels; c++)
+				{
+					const std::uint8_t value = in[x * channels + c];
+					out[x * channels + c] =
+						c < color ? table[value] : static_cast<float>(value);
+				}
+			}
+		}
+
+		void encode_row(const float * in, std::uint8_t * out, size_t width,
+						size_t channels, bool srgb)
+		{
+			const size_t color = srgb ? color_channels(channels) : 0;
+			const auto & table = linear_to_srgb_table();
+
+			for (size_t x = 0; x < width; x++)
+			{
+				for (size_t c = 0; c < channels; c++)
+				{
+					const float value = in[x * channels + c];
+					out[x * channels + c] =
+						c < color ? table[static_cast<size_t>(
+										value * (65535.0f / 255.0f) + 0.5f)]
+								  : static_cast<std::uint8_t>(value + 0.5f);
+				}
+			}
+		}
+
+		using Job = std::function<void()>;
+
+		// Splits rows into bands of roughly band_values values, adding a
+		// job running band(begin, end) for each
+		template<typename Band>
+		void add_bands(vector<Job> & jobs, size_t rows, size_t row_size,
+					   Band band)
+		{
+			const size_t band_rows = std::max<size_t>(
+				1, band_values / std::max<size_t>(row_size, 1));
+
+			for (size_t begin = 0; begin < rows; begin += band_rows)
+			{
+				const size_t end = std::min(begin + band_rows, rows);
+				jobs.emplace_back([band, begin, end] { band(begin, end); });
+			}
+		}
+
+		void run_jobs(vector<Job> & jobs, observer_ptr<util::ThreadPool> pool)
+		{
+			if (!pool || jobs.size() == 1)
+			{
+				for (auto & job : jobs)
+				{
+					job();
+				}
+
+				return;
+			}
+
+			vector<std::future<void>> done;
+			done.reserve(jobs.size());
+
+			for (auto & job : jobs)
+			{
+				done.emplace_back(pool->submit(std::move(job)));
+			}
+
+			// Wait for every job before rethrowing, as they all refer to
+			// the caller's data
+			for (auto & future : done)
+			{
+				future.wait();
+			}
+
+			for (auto & future : done)
+			{
+				future.get();
+			}
+		}
+	}   // namespace
+
+	vector<Image> build_mip_chain(Image base, const MipSettings & settings,
+								  observer_ptr<util::ThreadPool> pool)
+	{
+		vector<Image> bases;
+		bases.emplace_back(std::move(base));
+
+		return std::move(
+			build_mip_chains(std::move(bases), settings, pool).front());
+	}
+
+	vector<vector<Image>> build_mip_chains(vector<Image> bases,
+										   const MipSettings & settings,
+										   observer_ptr<util::ThreadPool> pool)
+	{
+		for (const Image & base : bases)
+		{
+			if (base.width == 0 || base.height == 0 || base.channels == 0 ||
+				base.channels > 4)
+			{
+				throw std::invalid_argument(
+					EXC_MSG("Mip chains need images with a size and 1 to 4 "
+							"channels"));
+			}
+		}
+
+		// Waiting on the pool from one of its workers could deadlock it
+		if (pool && pool->current_worker())
+		{
+			pool = nullptr;
+		}
+
+		const size_t count = bases.size();
+		vector<vector<Image>> chains(count);
+		vector<FloatImage> current(count);
+		vector<Job> jobs;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const Image & base = bases[i];
+			current[i] = FloatImage{base.width, base.height, base.channels,
+									vector<float>(base.pixels.size())};
+
+			add_bands(jobs, base.height, base.row_size(),
+					  [&, i](size_t begin, size_t end) {
+						  const Image & image = bases[i];
+
+						  for (size_t y = begin; y < end; y++)
+						  {
+							  decode_row(
+								  image.pixel(0, y),
+								  current[i].values.data() +
+									  y * current[i].row_size(),
+								  image.width, image.channels, settings.srgb);
+						  }
+					  });
+		}
+
+		run_jobs(jobs, pool);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			chains[i].emplace_back(std::move(bases[i]));
+		}
+
+		vector<Taps> x_taps(count), y_taps(count);
+
+		// Each round adds the next level of every chain not yet at 1x1,
+		// with the rows of all of them filtered in parallel
+		while (true)
+		{
+			jobs.clear();
+			vector<FloatImage> next(count);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const Image & last = chains[i].back();
+
+				if (last.width == 1 && last.height == 1)
+				{
+					continue;
+				}
+
+				Image level;
+				level.width = std::max<size_t>(last.width / 2, 1);
+				level.height = std::max<size_t>(last.height / 2, 1);
+				level.channels = last.channels;
+				level.pixels.resize(level.row_size() * level.height);
+
+				x_taps[i] =
+					compute_taps(last.width, level.width, settings.filter);
+				y_taps[i] =
+					compute_taps(last.height, level.height, settings.filter);
+
+				next[i] = FloatImage{level.width, level.height,
+									 level.channels,
+									 vector<float>(level.pixels.size())};
+
+				chains[i].emplace_back(std::move(level));
+
+				add_bands(
+					jobs, next[i].height, next[i].row_size(),
+					[&, i](size_t begin, size_t end) {
+						const FloatImage & source = current[i];
+						FloatImage & dest = next[i];
+						Image & image = chains[i].back();
+
+						vector<float> column(source.row_size());
+
+						for (size_t y = begin; y < end; y++)
+						{
+							float * row =
+								dest.values.data() + y * dest.row_size();
+
+							filter_row(source, x_taps[i], y_taps[i], y,
+									   column.data(), row, dest.width);
+							encode_row(row,
+									   image.pixels.data() +
+										   y * image.row_size(),
+									   dest.width, dest.channels,
+									   settings.srgb);
+						}
+					});
+			}
+
+			if (jobs.empty())
+			{
+				break;
+			}
+
+			run_jobs(jobs, pool);
+			current = std::move(next);
+		}
+
+		return chains;
+	}
+
+	void make_ntsc_safe(Image & image)
+	{
+		static const std::array<std::uint8_t, 256> lut = [] {
+			std::array<std::uint8_t, 256> table{};
+			constexpr float low = 16.0f - 0.499f;
+			constexpr float high = 235.0f + 0.499f;
+
+			for (size_t i = 0; i < table.size(); i++)
+			{
+				table[i] = static_cast<std::uint8_t>(
+					low + (high - low) * static_cast<float>(i) / 255.0f);
+			}
+
+			return table;
+		}();
+
+		// Alpha, if present, is left untouched
+		const size_t color_channels =
+			image.channels - (image.channels % 2 == 0 ? 1 : 0);
+
+		for (size_t i = 0; i < image.pixels.size(); i += image.channels)
+		{
+			for (size_t c = 0; c < color_channels; c++)
+			{
+				image.pixels[i + c] = lut[image.pixels[i + c]];
+			}
+		}
+	}
+}   // namespace glge::renderer::primitive
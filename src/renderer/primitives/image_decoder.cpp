@@ -0,0 +1,1099 @@
+#include "glge/renderer/primitives/image_decoder.h"
+
+#include <glge/util/util.h>
+#include <internal/util/_compat.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace glge::renderer::primitive
+{
+	namespace
+	{
+		[[noreturn]] void malformed(czstring format, czstring reason)
+		{
+			throw std::runtime_error(EXC_MSG(string("Malformed ") + format +
+											 " file: " + reason));
+		}
+
+		void check_channels(size_t channels)
+		{
+			if (channels > 4)
+			{
+				throw std::invalid_argument(
+					EXC_MSG("Images have from 1 to 4 channels"));
+			}
+		}
+
+		// Swaps the first and third channels of 3-channel pixels, turning
+		// BGR into RGB; source and destination may be the same
+		void swap_red_blue_3(const std::uint8_t * src, std::uint8_t * dst,
+							 size_t count)
+		{
+			size_t i = 0;
+
+#if GLGE_SSSE3
+			// Each step loads 16 bytes but only swizzles the 5 whole pixels
+			// among them; the last byte is rewritten by the next step
+			const __m128i order = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11,
+												10, 9, 14, 13, 12, 15);
+
+			for (; i + 6 <= count; i += 5)
+			{
+				const __m128i pixels = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(src + i * 3));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 3),
+								 _mm_shuffle_epi8(pixels, order));
+			}
+#endif
+
+			for (; i < count; i++)
+			{
+				const std::uint8_t blue = src[i * 3];
+				dst[i * 3] = src[i * 3 + 2];
+				dst[i * 3 + 1] = src[i * 3 + 1];
+				dst[i * 3 + 2] = blue;
+			}
+		}
+
+		// Swaps the first and third channels of 4-channel pixels, turning
+		// BGRA into RGBA; source and destination may be the same
+		void swap_red_blue_4(const std::uint8_t * src, std::uint8_t * dst,
+							 size_t count)
+		{
+			size_t i = 0;
+
+#if GLGE_SSE2
+			// Green and alpha stay in place; red and blue trade places by
+			// shifting each 32-bit pixel both ways
+			const __m128i green_alpha = _mm_set1_epi32(
+				static_cast<int>(0xff00ff00u));
+			const __m128i red_blue = _mm_set1_epi32(0x00ff00ff);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128i pixels = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(src + i * 4));
+				const __m128i swapped =
+					_mm_and_si128(pixels, red_blue);
+
+				_mm_storeu_si128(
+					reinterpret_cast<__m128i *>(dst + i * 4),
+					_mm_or_si128(_mm_and_si128(pixels, green_alpha),
+								 _mm_or_si128(_mm_slli_epi32(swapped, 16),
+											  _mm_srli_epi32(swapped, 16))));
+			}
+#endif
+
+			for (; i < count; i++)
+			{
+				const std::uint8_t blue = src[i * 4];
+				dst[i * 4] = src[i * 4 + 2];
+				dst[i * 4 + 1] = src[i * 4 + 1];
+				dst[i * 4 + 2] = blue;
+				dst[i * 4 + 3] = src[i * 4 + 3];
+			}
+		}
+
+		// Converts an image to another number of channels as SOIL does:
+		// gray is replicated into color, color is reduced to luminance and
+		// missing alpha is opaque
+		Image convert_channels(const Image & image, size_t channels)
+		{
+			Image result;
+			result.width = image.width;
+			result.height = image.height;
+			result.channels = channels;
+			result.pixels.resize(result.row_size() * result.height);
+
+			const bool has_alpha = image.channels % 2 == 0;
+			const std::uint8_t * in = image.pixels.data();
+			std::uint8_t * out = result.pixels.data();
+
+			for (size_t i = 0; i < image.width * image.height; i++)
+			{
+				const std::uint8_t alpha =
+					has_alpha ? in[image.channels - 1] : 255;
+
+				if (channels <= 2)
+				{
+					out[0] = image.channels <= 2
+								 ? in[0]
+								 : static_cast<std::uint8_t>(
+									   (in[0] * 77 + in[1] * 150 +
+										in[2] * 29) >>
+									   8);
+				}
+				else if (image.channels <= 2)
+				{
+					out[0] = out[1] = out[2] = in[0];
+				}
+				else
+				{
+					out[0] = in[0];
+					out[1] = in[1];
+					out[2] = in[2];
+				}
+
+				if (channels % 2 == 0)
+				{
+					out[channels - 1] = alpha;
+				}
+
+				in += image.channels;
+				out += channels;
+			}
+
+			return result;
+		}
+
+		std::optional<Image> with_channels(Image && image, size_t channels)
+		{
+			if (channels && channels != image.channels)
+			{
+				return convert_channels(image, channels);
+			}
+
+			return std::move(image);
+		}
+
+		// Expands run-length encoded TGA pixel data into length bytes
+		vector<std::uint8_t> decode_tga_rle(const std::uint8_t * data,
+											size_t size, size_t length,
+											size_t pixel_size)
+		{
+			vector<std::uint8_t> out(length);
+			size_t in = 0, written = 0;
+
+			while (written < length)
+			{
+				if (in == size)
+				{
+					malformed("TGA", "truncated pixel data");
+				}
+
+				const std::uint8_t header = data[in++];
+				const size_t bytes = std::min<size_t>(
+					((header & 0x7f) + 1) * pixel_size, length - written);
+				std::uint8_t * to = out.data() + written;
+
+				if (header & 0x80)
+				{
+					if (size - in < pixel_size)
+					{
+						malformed("TGA", "truncated pixel data");
+					}
+
+					// Fill the run by doubling the filled part each time
+					std::memcpy(to, data + in, pixel_size);
+					for (size_t filled = pixel_size; filled < bytes;)
+					{
+						const size_t count = std::min(filled, bytes - filled);
+						std::memcpy(to + filled, to, count);
+						filled += count;
+					}
+
+					in += pixel_size;
+				}
+				else
+				{
+					if (size - in < bytes)
+					{
+						malformed("TGA", "truncated pixel data");
+					}
+
+					std::memcpy(to, data + in, bytes);
+					in += bytes;
+				}
+
+				written += bytes;
+			}
+
+			return out;
+		}
+
+		constexpr std::array<std::uint8_t, 8> png_signature{
+			137, 80, 78, 71, 13, 10, 26, 10};
+
+		bool is_png(const std::uint8_t * data, size_t size)
+		{
+			return size >= png_signature.size() &&
+				   std::equal(png_signature.cbegin(), png_signature.cend(),
+							  data);
+		}
+
+		std::uint32_t read_be32(const std::uint8_t * data)
+		{
+			return static_cast<std::uint32_t>(data[0]) << 24 |
+				   static_cast<std::uint32_t>(data[1]) << 16 |
+				   static_cast<std::uint32_t>(data[2]) << 8 |
+				   static_cast<std::uint32_t>(data[3]);
+		}
+
+		// Reader of a deflate stream, which packs bits from the least
+		// significant end of each byte
+		class BitReader
+		{
+		private:
+			const std::uint8_t * data;
+			size_t size;
+			size_t pos = 0;
+			std::uint64_t bits = 0;
+			unsigned count = 0;
+
+			void refill()
+			{
+				while (count <= 56 && pos < size)
+				{
+					bits |= static_cast<std::uint64_t>(data[pos++]) << count;
+					count += 8;
+				}
+			}
+
+		public:
+			BitReader(const std::uint8_t * data, size_t size) :
+				data(data), size(size)
+			{}
+
+			// Gets the next n bits without consuming them; bits past the
+			// end of the stream read as 0
+			std::uint32_t peek(unsigned n)
+			{
+				if (count < n)
+				{
+					refill();
+				}
+
+				return static_cast<std::uint32_t>(bits &
+												  ((1ull << n) - 1));
+			}
+
+			void consume(unsigned n)
+			{
+				if (count < n)
+				{
+					malformed("PNG", "truncated image data");
+				}
+
+				bits >>= n;
+				count -= n;
+			}
+
+			std::uint32_t read(unsigned n)
+			{
+				const std::uint32_t value = peek(n);
+				consume(n);
+				return value;
+			}
+
+			// Skips to the next byte boundary
+			void align() { consume(count % 8); }
+
+			// Copies bytes from a byte-aligned position
+			void copy(std::uint8_t * out, size_t n)
+			{
+				for (; n > 0 && count >= 8; n--)
+				{
+					*out++ = static_cast<std::uint8_t>(bits);
+					bits >>= 8;
+					count -= 8;
+				}
+
+				if (size - pos < n)
+				{
+					malformed("PNG", "truncated image data");
+				}
+
+				std::memcpy(out, data + pos, n);
+				pos += n;
+			}
+		};
+
+		// Canonical Huffman code of a deflate block. Codes of up to
+		// fast_bits bits are decoded with a single table lookup; longer
+		// ones are decoded a bit at a time, as in zlib's puff
+		class Huffman
+		{
+		private:
+			static constexpr unsigned fast_bits = 10;
+			static constexpr unsigned max_bits = 15;
+
+			std::array<std::uint16_t, max_bits + 1> counts{};
+			std::array<std::uint16_t, 288> symbols{};
+			// Symbol and code length packed as symbol << 4 | length, indexed
+			// by the next fast_bits bits of input; 0 if no code that short
+			// matches
+			std::array<std::uint16_t, 1 << fast_bits> fast{};
+
+			static unsigned reverse(unsigned code, unsigned length)
+			{
+				unsigned reversed = 0;
+				for (unsigned i = 0; i < length; i++)
+				{
+					reversed = reversed << 1 | (code >> i & 1);
+				}
+
+				return reversed;
+			}
+
+		public:
+			void build(const std::uint8_t * lengths, size_t symbol_count)
+			{
+				counts.fill(0);
+				for (size_t i = 0; i < symbol_count; i++)
+				{
+					counts[lengths[i]]++;
+				}
+				counts[0] = 0;
+
+				// Incomplete codes are allowed, as deflate uses them for
+				// blocks with a single distance code
+				int left = 1;
+				for (unsigned length = 1; length <= max_bits; length++)
+				{
+					left = (left << 1) - counts[length];
+					if (left < 0)
+					{
+						malformed("PNG", "over-subscribed Huffman code");
+					}
+				}
+
+				std::array<std::uint16_t, max_bits + 1> offsets{};
+				for (unsigned length = 1; length < max_bits; length++)
+				{
+					offsets[length + 1] = static_cast<std::uint16_t>(
+						offsets[length] + counts[length]);
+				}
+
+				for (size_t i = 0; i < symbol_count; i++)
+				{
+					if (lengths[i])
+					{
+						symbols[offsets[lengths[i]]++] =
+							static_cast<std::uint16_t>(i);
+					}
+				}
+
+				fast.fill(0);
+
+				unsigned code = 0;
+				size_t index = 0;
+				for (unsigned length = 1; length <= fast_bits; length++)
+				{
+					for (unsigned i = 0; i < counts[length]; i++)
+					{
+						const std::uint16_t entry = static_cast<std::uint16_t>(
+							symbols[index++] << 4 | length);
+
+						for (unsigned fill = reverse(code++, length);
+							 fill < fast.size(); fill += 1u << length)
+						{
+							fast[fill] = entry;
+						}
+					}
+
+					code <<= 1;
+				}
+			}
+
+			unsigned decode(BitReader & in) const
+			{
+				const std::uint16_t entry = fast[in.peek(fast_bits)];
+
+				if (entry)
+				{
+					in.consume(entry & 0xf);
+					return entry >> 4;
+				}
+
+				int code = 0, first = 0, index = 0;
+				for (unsigned length = 1; length <= max_bits; length++)
+				{
+					code |= static_cast<int>(in.read(1));
+
+					const int count = counts[length];
+					if (code - first < count)
+					{
+						return symbols[static_cast<size_t>(index + code -
+														   first)];
+					}
+
+					index += count;
+					first = (first + count) << 1;
+					code <<= 1;
+				}
+
+				malformed("PNG", "invalid Huffman code");
+			}
+		};
+
+		constexpr std::array<std::uint16_t, 29> length_base{
+			3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+			31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+		constexpr std::array<std::uint8_t, 29> length_extra{
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+			2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+		constexpr std::array<std::uint16_t, 30> distance_base{
+			1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+			33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+			1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+		constexpr std::array<std::uint8_t, 30> distance_extra{
+			0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+			6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+		void read_dynamic_codes(BitReader & in, Huffman & literals,
+								Huffman & distances)
+		{
+			static constexpr std::array<std::uint8_t, 19> order{
+				16, 17, 18, 0, 8, 7, 9, 6, 10, 5,
+				11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+			const size_t literal_count = in.read(5) + 257;
+			const size_t distance_count = in.read(5) + 1;
+			const size_t length_count = in.read(4) + 4;
+
+			if (literal_count > 286 || distance_count > 30)
+			{
+				malformed("PNG", "too many Huffman codes");
+			}
+
+			std::array<std::uint8_t, 19> code_lengths{};
+			for (size_t i = 0; i < length_count; i++)
+			{
+				code_lengths[order[i]] =
+					static_cast<std::uint8_t>(in.read(3));
+			}
+
+			Huffman length_code;
+			length_code.build(code_lengths.data(), code_lengths.size());
+
+			const size_t total = literal_count + distance_count;
+			std::array<std::uint8_t, 286 + 30> lengths{};
+
+			for (size_t i = 0; i < total;)
+			{
+				const unsigned symbol = length_code.decode(in);
+
+				if (symbol < 16)
+				{
+					lengths[i++] = static_cast<std::uint8_t>(symbol);
+					continue;
+				}
+
+				std::uint8_t value = 0;
+				size_t repeat = 0;
+
+				if (symbol == 16)
+				{
+					if (i == 0)
+					{
+						malformed("PNG", "repeated length with no previous");
+					}
+
+					value = lengths[i - 1];
+					repeat = 3 + in.read(2);
+				}
+				else if (symbol == 17)
+				{
+					repeat = 3 + in.read(3);
+				}
+				else
+				{
+					repeat = 11 + in.read(7);
+				}
+
+				if (repeat > total - i)
+				{
+					malformed("PNG", "too many code lengths");
+				}
+
+				std::fill_n(lengths.begin() + static_cast<long>(i), repeat,
+							value);
+				i += repeat;
+			}
+
+			if (lengths[256] == 0)
+			{
+				malformed("PNG", "missing end of block code");
+			}
+
+			literals.build(lengths.data(), literal_count);
+			distances.build(lengths.data() + literal_count, distance_count);
+		}
+
+		void build_fixed_codes(Huffman & literals, Huffman & distances)
+		{
+			std::array<std::uint8_t, 288> lengths{};
+			std::fill(lengths.begin(), lengths.begin() + 144, 8);
+			std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+			std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+			std::fill(lengths.begin() + 280, lengths.end(), 8);
+			literals.build(lengths.data(), lengths.size());
+
+			lengths.fill(5);
+			distances.build(lengths.data(), 30);
+		}
+
+		// Inflates a zlib stream into a buffer which it must fill exactly
+		void inflate(const std::uint8_t * data, size_t size,
+					 std::uint8_t * out, size_t out_size)
+		{
+			if (size < 2 || (data[0] & 0x0f) != 8 ||
+				(data[0] * 256 + data[1]) % 31 != 0 || (data[1] & 0x20))
+			{
+				malformed("PNG", "invalid zlib header");
+			}
+
+			BitReader in(data + 2, size - 2);
+			Huffman literals, distances;
+			size_t written = 0;
+			bool last = false;
+
+			while (!last)
+			{
+				last = in.read(1);
+				const unsigned type = in.read(2);
+
+				if (type == 0)
+				{
+					in.align();
+					const size_t length = in.read(16);
+					if (length != (~in.read(16) & 0xffff))
+					{
+						malformed("PNG", "corrupt stored block");
+					}
+
+					if (length > out_size - written)
+					{
+						malformed("PNG", "too much image data");
+					}
+
+					in.copy(out + written, length);
+					written += length;
+					continue;
+				}
+				else if (type == 1)
+				{
+					build_fixed_codes(literals, distances);
+				}
+				else if (type == 2)
+				{
+					read_dynamic_codes(in, literals, distances);
+				}
+				else
+				{
+					malformed("PNG", "invalid block type");
+				}
+
+				while (true)
+				{
+					unsigned symbol = literals.decode(in);
+
+					if (symbol < 256)
+					{
+						if (written == out_size)
+						{
+							malformed("PNG", "too much image data");
+						}
+
+						out[written++] = static_cast<std::uint8_t>(symbol);
+						continue;
+					}
+
+					if (symbol == 256)
+					{
+						break;
+					}
+
+					symbol -= 257;
+					if (symbol >= length_base.size())
+					{
+						malformed("PNG", "invalid length code");
+					}
+
+					const size_t length =
+						length_base[symbol] + in.read(length_extra[symbol]);
+
+					const unsigned code = distances.decode(in);
+					if (code >= distance_base.size())
+					{
+						malformed("PNG", "invalid distance code");
+					}
+
+					const size_t distance =
+						distance_base[code] + in.read(distance_extra[code]);
+
+					if (distance > written)
+					{
+						malformed("PNG", "distance before start of data");
+					}
+
+					if (length > out_size - written)
+					{
+						malformed("PNG", "too much image data");
+					}
+
+					std::uint8_t * to = out + written;
+					const std::uint8_t * from = to - distance;
+
+					if (distance >= length)
+					{
+						std::memcpy(to, from, length);
+					}
+					else
+					{
+						// Overlapping copies repeat the last distance bytes
+						for (size_t i = 0; i < length; i++)
+						{
+							to[i] = from[i];
+						}
+					}
+
+					written += length;
+				}
+			}
+
+			if (written != out_size)
+			{
+				malformed("PNG", "truncated image data");
+			}
+		}
+
+		std::uint8_t paeth(int left, int up, int up_left)
+		{
+			const int estimate = left + up - up_left;
+			const int to_left = std::abs(estimate - left);
+			const int to_up = std::abs(estimate - up);
+			const int to_up_left = std::abs(estimate - up_left);
+
+			if (to_left <= to_up && to_left <= to_up_left)
+			{
+				return static_cast<std::uint8_t>(left);
+			}
+
+			return static_cast<std::uint8_t>(to_up <= to_up_left ? up
+																 : up_left);
+		}
+
+		// Reverses the filter of one row of a PNG image, given the
+		// previous unfiltered row, which is all zero for the first row
+		void unfilter_row(std::uint8_t filter, const std::uint8_t * in,
+						  const std::uint8_t * prior, std::uint8_t * out,
+						  size_t length, size_t pixel_size)
+		{
+			switch (filter)
+			{
+			case 0:
+				std::memcpy(out, in, length);
+				break;
+			case 1:
+				std::memcpy(out, in, pixel_size);
+				for (size_t i = pixel_size; i < length; i++)
+				{
+					out[i] = static_cast<std::uint8_t>(in[i] +
+													   out[i - pixel_size]);
+				}
+				break;
+			case 2:
+			{
+				size_t i = 0;
+#if GLGE_SSE2
+				for (; i + 16 <= length; i += 16)
+				{
+					_mm_storeu_si128(
+						reinterpret_cast<__m128i *>(out + i),
+						_mm_add_epi8(
+							_mm_loadu_si128(
+								reinterpret_cast<const __m128i *>(in + i)),
+							_mm_loadu_si128(
+								reinterpret_cast<const __m128i *>(prior + i))));
+				}
+#endif
+				for (; i < length; i++)
+				{
+					out[i] = static_cast<std::uint8_t>(in[i] + prior[i]);
+				}
+				break;
+			}
+			case 3:
+				for (size_t i = 0; i < length; i++)
+				{
+					const unsigned left = i >= pixel_size ? out[i - pixel_size]
+														  : 0;
+					out[i] = static_cast<std::uint8_t>(
+						in[i] + ((left + prior[i]) >> 1));
+				}
+				break;
+			case 4:
+				for (size_t i = 0; i < length; i++)
+				{
+					const bool first = i < pixel_size;
+					out[i] = static_cast<std::uint8_t>(
+						in[i] +
+						paeth(first ? 0 : out[i - pixel_size], prior[i],
+							  first ? 0 : prior[i - pixel_size]));
+				}
+				break;
+			default:
+				malformed("PNG", "invalid filter type");
+			}
+		}
+
+		bool has_extension(const string & path, const string & extension)
+		{
+			if (path.size() < extension.size())
+			{
+				return false;
+			}
+
+			return std::equal(extension.cbegin(), extension.cend(),
+							  path.cend() - static_cast<long>(extension.size()),
+							  [](char a, char b) {
+								  return std::tolower(a) == std::tolower(b);
+							  });
+		}
+	}   // namespace
+
+	std::optional<Image> decode_tga(const std::uint8_t * data, size_t size,
+									size_t channels)
+	{
+		check_channels(channels);
+
+		constexpr size_t header_size = 18;
+		if (size < header_size)
+		{
+			malformed("TGA", "truncated header");
+		}
+
+		const size_t id_length = data[0];
+		const std::uint8_t colormap_type = data[1];
+		const std::uint8_t image_type = data[2];
+		const size_t width = data[12] | data[13] << 8;
+		const size_t height = data[14] | data[15] << 8;
+		const size_t bits = data[16];
+		const std::uint8_t descriptor = data[17];
+
+		const bool rle = image_type == 10 || image_type == 11;
+		const bool gray = image_type == 3 || image_type == 11;
+
+		// Color-mapped, 16-bit and right-to-left images are left to the
+		// fallback decoder
+		if (colormap_type != 0 ||
+			(image_type != 2 && image_type != 3 && !rle) ||
+			(gray ? bits != 8 : bits != 24 && bits != 32) ||
+			(descriptor & 0x10))
+		{
+			return std::nullopt;
+		}
+
+		if (width == 0 || height == 0)
+		{
+			malformed("TGA", "empty image");
+		}
+
+		if (size - header_size < id_length)
+		{
+			malformed("TGA", "truncated header");
+		}
+
+		const size_t pixel_size = bits / 8;
+		const size_t row_size = width * pixel_size;
+		const size_t offset = header_size + id_length;
+
+		// Uncompressed pixels are swizzled straight out of the file
+		const std::uint8_t * pixels = data + offset;
+		vector<std::uint8_t> expanded;
+
+		if (rle)
+		{
+			// Each packet expands to at most 128 pixels; checking this
+			// first keeps corrupt sizes from allocating huge buffers
+			if ((size - offset) * 128 * pixel_size < row_size * height)
+			{
+				malformed("TGA", "truncated pixel data");
+			}
+
+			expanded = decode_tga_rle(pixels, size - offset,
+									  row_size * height, pixel_size);
+			pixels = expanded.data();
+		}
+		else if (size - offset < row_size * height)
+		{
+			malformed("TGA", "truncated pixel data");
+		}
+
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.channels = pixel_size;
+		image.pixels.resize(row_size * height);
+
+		// Rows are stored bottom first unless the descriptor says otherwise
+		const bool top_first = descriptor & 0x20;
+
+		for (size_t y = 0; y < height; y++)
+		{
+			const std::uint8_t * in =
+				pixels + (top_first ? y : height - 1 - y) * row_size;
+			std::uint8_t * out = image.pixels.data() + y * row_size;
+
+			if (pixel_size == 3)
+			{
+				swap_red_blue_3(in, out, width);
+			}
+			else if (pixel_size == 4)
+			{
+				swap_red_blue_4(in, out, width);
+			}
+			else
+			{
+				std::memcpy(out, in, row_size);
+			}
+		}
+
+		return with_channels(std::move(image), channels);
+	}
+
+	std::optional<Image> decode_png(const std::uint8_t * data, size_t size,
+									size_t channels)
+	{
+		check_channels(channels);
+
+		if (!is_png(data, size))
+		{
+			malformed("PNG", "missing signature");
+		}
+
+		bool header = false;
+		size_t width = 0, height = 0;
+		std::uint8_t bit_depth = 0, color_type = 0, interlace = 0;
+
+		// Palette entries missing from the file are opaque black
+		std::array<std::uint8_t, 256 * 4> palette{};
+		for (size_t i = 3; i < palette.size(); i += 4)
+		{
+			palette[i] = 255;
+		}
+		size_t palette_size = 0;
+		bool transparency = false;
+
+		vector<std::pair<const std::uint8_t *, size_t>> chunks;
+		size_t compressed_size = 0;
+
+		for (size_t pos = png_signature.size();;)
+		{
+			if (size - pos < 12)
+			{
+				malformed("PNG", "truncated chunk");
+			}
+
+			const size_t length = read_be32(data + pos);
+			const std::uint8_t * type = data + pos + 4;
+			const std::uint8_t * body = data + pos + 8;
+
+			if (length > size - pos - 12)
+			{
+				malformed("PNG", "truncated chunk");
+			}
+
+			pos += 12 + length;
+
+			auto is = [type](czstring name) {
+				return std::memcmp(type, name, 4) == 0;
+			};
+
+			if (!header && !is("IHDR"))
+			{
+				malformed("PNG", "missing header");
+			}
+
+			if (is("IHDR"))
+			{
+				if (length != 13 || body[10] != 0 || body[11] != 0)
+				{
+					malformed("PNG", "invalid header");
+				}
+
+				width = read_be32(body);
+				height = read_be32(body + 4);
+				bit_depth = body[8];
+				color_type = body[9];
+				interlace = body[12];
+				header = true;
+			}
+			else if (is("PLTE"))
+			{
+				if (length % 3 != 0 || length > 256 * 3)
+				{
+					malformed("PNG", "invalid palette");
+				}
+
+				palette_size = length / 3;
+				for (size_t i = 0; i < palette_size; i++)
+				{
+					std::memcpy(&palette[i * 4], body + i * 3, 3);
+				}
+			}
+			else if (is("tRNS"))
+			{
+				// A single transparent color of a gray or true-color
+				// image is left to the fallback decoder
+				if (color_type != 3)
+				{
+					return std::nullopt;
+				}
+
+				if (length > 256)
+				{
+					malformed("PNG", "invalid transparency");
+				}
+
+				for (size_t i = 0; i < length; i++)
+				{
+					palette[i * 4 + 3] = body[i];
+				}
+				transparency = true;
+			}
+			else if (is("IDAT"))
+			{
+				chunks.emplace_back(body, length);
+				compressed_size += length;
+			}
+			else if (is("IEND"))
+			{
+				break;
+			}
+			else if (!(type[0] & 0x20))
+			{
+				// Unknown chunks which are critical to the image
+				return std::nullopt;
+			}
+		}
+
+		if (bit_depth != 8 || interlace != 0)
+		{
+			return std::nullopt;
+		}
+
+		size_t pixel_size = 0;
+		switch (color_type)
+		{
+		case 0: pixel_size = 1; break;
+		case 2: pixel_size = 3; break;
+		case 3: pixel_size = 1; break;
+		case 4: pixel_size = 2; break;
+		case 6: pixel_size = 4; break;
+		default: malformed("PNG", "invalid color type");
+		}
+
+		if (color_type == 3 && palette_size == 0)
+		{
+			malformed("PNG", "missing palette");
+		}
+
+		if (chunks.empty())
+		{
+			malformed("PNG", "missing image data");
+		}
+
+		const size_t row_size = width * pixel_size;
+		if (width == 0 || height == 0 ||
+			width > std::numeric_limits<std::uint32_t>::max() / pixel_size ||
+			height > std::numeric_limits<size_t>::max() / (row_size + 1))
+		{
+			malformed("PNG", "invalid image size");
+		}
+
+		// Deflate expands data at most 1032 times; checking this first keeps
+		// corrupt sizes from allocating huge buffers
+		if (height * (row_size + 1) / 1032 > compressed_size)
+		{
+			malformed("PNG", "truncated image data");
+		}
+
+		// Image data split across chunks is joined before inflating it
+		vector<std::uint8_t> joined;
+		const std::uint8_t * compressed = chunks.front().first;
+
+		if (chunks.size() > 1)
+		{
+			joined.reserve(compressed_size);
+			for (const auto & [chunk, length] : chunks)
+			{
+				joined.insert(joined.end(), chunk, chunk + length);
+			}
+			compressed = joined.data();
+		}
+
+		vector<std::uint8_t> filtered(height * (row_size + 1));
+		inflate(compressed, compressed_size, filtered.data(),
+				filtered.size());
+
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.channels =
+			color_type == 3 ? (transparency ? 4 : 3) : pixel_size;
+		image.pixels.resize(image.row_size() * height);
+
+		const vector<std::uint8_t> zero_row(row_size);
+		const std::uint8_t * prior = zero_row.data();
+
+		// Palette indices are unfiltered into two alternating rows
+		vector<std::uint8_t> index_rows(color_type == 3 ? row_size * 2 : 0);
+
+		for (size_t y = 0; y < height; y++)
+		{
+			const std::uint8_t * in = filtered.data() + y * (row_size + 1);
+			std::uint8_t * out =
+				color_type == 3 ? index_rows.data() + (y % 2) * row_size
+								: image.pixels.data() + y * row_size;
+
+			unfilter_row(in[0], in + 1, prior, out, row_size, pixel_size);
+			prior = out;
+
+			if (color_type == 3)
+			{
+				std::uint8_t * pixel =
+					image.pixels.data() + y * image.row_size();
+
+				for (size_t x = 0; x < width; x++)
+				{
+					std::memcpy(pixel, &palette[out[x] * 4], image.channels);
+					pixel += image.channels;
+				}
+			}
+		}
+
+		return with_channels(std::move(image), channels);
+	}
+
+	std::optional<Image> load_image(const string & path, size_t channels)
+	{
+		const util::MappedFile file(path);
+
+		try
+		{
+			if (is_png(file.data(), file.size()))
+			{
+				return decode_png(file.data(), file.size(), channels);
+			}
+
+			if (has_extension(path, ".tga"))
+			{
+				return decode_tga(file.data(), file.size(), channels);
+			}
+		}
+		catch (const std::runtime_error & e)
+		{
+			throw std::runtime_error(EXC_MSG("Failed to decode image file " +
+											 path + ": " + e.what()));
+		}
+
+		return std::nullopt;
+	}
+}   // namespace glge::renderer::primitive
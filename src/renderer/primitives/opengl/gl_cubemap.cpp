@@ -1,10 +1,38 @@
-#include <SOIL.h>
-
 #include <glge/common.h>
 #include <glge/renderer/primitives/cubemap.h>
+#include <glge/renderer/render_stats.h>
+#include <glge/util/thread_pool.h>
 #include <glge/util/util.h>
 
 #include "gl_common.h"
+#include "gl_texture.h"
+
+#include <algorithm>
+
+namespace glge::renderer::opengl
+{
+	std::array<const primitive::TextureFileInfo *, 6>
+	cubemap_face_files(const primitive::CubemapFileInfo & info)
+	{
+		return {&info.right, &info.left,  &info.top,
+				&info.bottom, &info.back, &info.front};
+	}
+
+	CubemapFaces decode_cubemap(const primitive::CubemapFileInfo & info,
+								util::ThreadPool & pool)
+	{
+		const auto files = cubemap_face_files(info);
+		vector<MipChain> decoded = decode_parallel(
+			vector<const primitive::TextureFileInfo *>(files.cbegin(),
+													   files.cend()),
+			decode_cubemap_face, pool);
+
+		CubemapFaces faces;
+		std::move(decoded.begin(), decoded.end(), faces.begin());
+
+		return faces;
+	}
+}   // namespace glge::renderer::opengl
 
 namespace glge::renderer::primitive
 {
@@ -14,25 +42,71 @@ namespace glge::renderer::primitive
 		{
 		private:
 			const GLuint id;
+			std::uint64_t gpu_bytes;
 			bool destroy;
 
+			static GLuint
+			create_cubemap(const renderer::opengl::CubemapFaces & faces)
+			{
+				GLuint cubemap = 0;
+				glGenTextures(1, &cubemap);
+				glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+
+				for (size_t face = 0; face < faces.size(); face++)
+				{
+					const GLenum target = static_cast<GLenum>(
+						GL_TEXTURE_CUBE_MAP_POSITIVE_X + face);
+
+					for (size_t i = 0; i < faces[face].size(); i++)
+					{
+						renderer::opengl::upload_level(
+							target, static_cast<GLint>(i), faces[face][i],
+							faces[face][i].pixels.data());
+					}
+				}
+
+				renderer::opengl::set_texture_parameters(GL_TEXTURE_CUBE_MAP);
+				glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+				return cubemap;
+			}
+
+			static std::uint64_t
+			faces_bytes(const renderer::opengl::CubemapFaces & faces)
+			{
+				std::uint64_t total = 0;
+
+				for (const auto & face : faces)
+				{
+					total += renderer::opengl::mip_chain_bytes(face);
+				}
+
+				return total;
+			}
+
 		public:
+			GLCubemap(GLuint id, std::uint64_t gpu_bytes) :
+				id(id), gpu_bytes(gpu_bytes), destroy(true)
+			{
+				renderer::stats::record_allocation(
+					renderer::GPUResource::Cubemap, gpu_bytes);
+			}
+
+			GLCubemap(const renderer::opengl::CubemapFaces & faces) :
+				GLCubemap(create_cubemap(faces), faces_bytes(faces))
+			{
+			}
+
 			GLCubemap(const CubemapFileInfo & info) :
-				id(SOIL_load_OGL_cubemap(info.right.path.c_str(),
-										 info.left.path.c_str(),
-										 info.top.path.c_str(),
-										 info.bottom.path.c_str(),
-										 info.back.path.c_str(),
-										 info.front.path.c_str(),
-										 SOIL_LOAD_RGB,
-										 SOIL_CREATE_NEW_ID,
-										 SOIL_FLAG_MIPMAPS)),
-				destroy(true)
-			{}
+				GLCubemap(renderer::opengl::decode_cubemap(
+					info, util::ThreadPool::shared()))
+			{
+			}
 
 			GLCubemap(const GLCubemap &) = delete;
 
-			GLCubemap(GLCubemap && other) : id(other.id), destroy(other.destroy)
+			GLCubemap(GLCubemap && other) :
+				id(other.id), gpu_bytes(other.gpu_bytes), destroy(other.destroy)
 			{
 				other.destroy = false;
 			}
@@ -44,12 +118,15 @@ namespace glge::renderer::primitive
 			void activate() const override
 			{
 				glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+				renderer::stats::record_texture_bind();
 			}
 
 			~GLCubemap()
 			{
 				if (destroy)
 				{
+					renderer::stats::record_release(
+						renderer::GPUResource::Cubemap, gpu_bytes);
 					glDeleteTextures(1, &id);
 				}
 			}
@@ -60,4 +137,23 @@ namespace glge::renderer::primitive
 	{
 		return std::make_unique<opengl::GLCubemap>(file_info);
 	}
+
+	unique_ptr<Cubemap>
+	Cubemap::from_compressed_file(const TextureFileInfo & file_info)
+	{
+		std::uint64_t bytes = 0;
+		GLuint id = renderer::opengl::create_compressed_texture(
+			GL_TEXTURE_CUBE_MAP, file_info.path, bytes);
+
+		return std::make_unique<opengl::GLCubemap>(id, bytes);
+	}
 }   // namespace glge::renderer::primitive
+
+namespace glge::renderer::opengl
+{
+	unique_ptr<primitive::Cubemap> adopt_cubemap(GLuint id,
+												 std::uint64_t bytes)
+	{
+		return std::make_unique<primitive::opengl::GLCubemap>(id, bytes);
+	}
+}   // namespace glge::renderer::opengl
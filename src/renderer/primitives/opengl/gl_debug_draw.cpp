@@ -0,0 +1,250 @@
+#include "gl_buffer.h"
+#include "gl_common.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/debug_draw.h>
+#include <glge/renderer/render_stats.h>
+#include <glge/util/util.h>
+#include <internal/util/_util.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace glge::renderer::primitive
+{
+	namespace opengl
+	{
+		constexpr GLuint color_index = 1;
+
+		class GLDebugDraw : public DebugDraw
+		{
+		private:
+			// Where a batch was last uploaded
+			struct Range
+			{
+				GLint first_vertex = 0;
+				GLsizei vertex_count = 0;
+				size_t first_index = 0;
+				GLsizei index_count = 0;
+			};
+
+			GLuint VAO, VBO, EBO;
+
+			// Capacities of the buffers, grown as needed
+			mutable size_t vertex_capacity, index_capacity;
+			mutable std::array<Range, debug_primitive_count> ranges;
+			mutable std::uint64_t uploaded_generation;
+
+			// Streams every batch into the buffers, orphaning their old
+			// storage so that draws still using it do not stall the upload
+			void upload() const
+			{
+				size_t vertex_count = 0, index_count = 0;
+				for (size_t i = 0; i < debug_primitive_count; i++)
+				{
+					const DebugBatch & lines =
+						batch(static_cast<DebugPrimitive>(i));
+
+					ranges[i] = Range{
+						util::safe_cast<size_t, GLint>(vertex_count),
+						util::safe_cast<size_t, GLsizei>(lines.vertices.size()),
+						index_count,
+						util::safe_cast<size_t, GLsizei>(lines.indices.size())};
+
+					vertex_count += lines.vertices.size();
+					index_count += lines.indices.size();
+				}
+
+				glBindBuffer(GL_ARRAY_BUFFER, VBO);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+				if (vertex_count > vertex_capacity)
+				{
+					renderer::stats::record_release(
+						renderer::GPUResource::Lines,
+						vertex_capacity * sizeof(DebugVertex));
+					vertex_capacity =
+						std::max(vertex_count, 2 * vertex_capacity);
+					renderer::stats::record_allocation(
+						renderer::GPUResource::Lines,
+						vertex_capacity * sizeof(DebugVertex));
+				}
+
+				if (index_count > index_capacity)
+				{
+					renderer::stats::record_release(
+						renderer::GPUResource::Lines,
+						index_capacity * sizeof(std::uint32_t));
+					index_capacity = std::max(index_count, 2 * index_capacity);
+					renderer::stats::record_allocation(
+						renderer::GPUResource::Lines,
+						index_capacity * sizeof(std::uint32_t));
+				}
+
+				glBufferData(GL_ARRAY_BUFFER,
+							 static_cast<GLsizeiptr>(vertex_capacity *
+													 sizeof(DebugVertex)),
+							 nullptr, GL_STREAM_DRAW);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+							 static_cast<GLsizeiptr>(index_capacity *
+													 sizeof(std::uint32_t)),
+							 nullptr, GL_STREAM_DRAW);
+
+				for (size_t i = 0; i < debug_primitive_count; i++)
+				{
+					const DebugBatch & lines =
+						batch(static_cast<DebugPrimitive>(i));
+					const Range & range = ranges[i];
+
+					glBufferSubData(
+						GL_ARRAY_BUFFER,
+						static_cast<GLintptr>(
+							static_cast<size_t>(range.first_vertex) *
+							sizeof(DebugVertex)),
+						static_cast<GLsizeiptr>(buffer_bytes(lines.vertices)),
+						lines.vertices.data());
+					glBufferSubData(
+						GL_ELEMENT_ARRAY_BUFFER,
+						static_cast<GLintptr>(range.first_index *
+											  sizeof(std::uint32_t)),
+						static_cast<GLsizeiptr>(buffer_bytes(lines.indices)),
+						lines.indices.data());
+				}
+
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+				renderer::stats::record_upload(
+					vertex_count * sizeof(DebugVertex) +
+					index_count * sizeof(std::uint32_t));
+
+				uploaded_generation = generation();
+			}
+
+		public:
+			GLDebugDraw() :
+				VAO(0), VBO(0), EBO(0), vertex_capacity(0), index_capacity(0),
+				uploaded_generation(0)
+			{
+				glGenVertexArrays(1, &VAO);
+				glGenBuffers(1, &VBO);
+				glGenBuffers(1, &EBO);
+
+				renderer::opengl::throw_if_gl_error(EXC_MSG(
+					"Failed to generate requisite storage for debug lines"));
+
+				util::UniqueHandle vaoBind([&] { glBindVertexArray(VAO); },
+										   [] { glBindVertexArray(0); });
+
+				glBindBuffer(GL_ARRAY_BUFFER, VBO);
+				glEnableVertexAttribArray(vertex_index);
+				glVertexAttribPointer(
+					vertex_index, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex),
+					reinterpret_cast<const GLvoid *>(
+						offsetof(DebugVertex, position)));
+				glEnableVertexAttribArray(color_index);
+				glVertexAttribPointer(
+					color_index, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex),
+					reinterpret_cast<const GLvoid *>(
+						offsetof(DebugVertex, color)));
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+				// The element buffer binding is part of the VAO's state
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+			}
+
+			GLDebugDraw(const GLDebugDraw &) = delete;
+			GLDebugDraw(GLDebugDraw &&) = delete;
+
+			GLDebugDraw & operator=(const GLDebugDraw &) = delete;
+			GLDebugDraw & operator=(GLDebugDraw &&) = delete;
+
+			~GLDebugDraw()
+			{
+				renderer::stats::record_release(
+					renderer::GPUResource::Lines,
+					vertex_capacity * sizeof(DebugVertex) +
+						index_capacity * sizeof(std::uint32_t));
+
+				glDeleteBuffers(1, &EBO);
+				glDeleteBuffers(1, &VBO);
+				glDeleteVertexArrays(1, &VAO);
+			}
+
+			void render() const override
+			{
+				if (vertex_count() == 0)
+				{
+					return;
+				}
+
+				util::UniqueHandle vaoBind(
+					[&] {
+						glBindVertexArray(VAO);
+						renderer::stats::record_vao_bind();
+					},
+					[] { glBindVertexArray(0); });
+
+				if (uploaded_generation != generation())
+				{
+					upload();
+				}
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("Error prior to render"));
+				}
+
+				const Range & lines =
+					ranges[static_cast<size_t>(DebugPrimitive::Lines)];
+				if (lines.vertex_count > 0)
+				{
+					glDrawArrays(GL_LINES, lines.first_vertex,
+								 lines.vertex_count);
+					renderer::stats::record_draw(
+						static_cast<std::uint64_t>(lines.vertex_count), 0);
+				}
+
+				util::UniqueHandle restart(
+					[] {
+						glEnable(GL_PRIMITIVE_RESTART);
+						glPrimitiveRestartIndex(restart_index);
+					},
+					[] { glDisable(GL_PRIMITIVE_RESTART); });
+
+				using Mode = std::pair<DebugPrimitive, GLenum>;
+				for (const auto & [primitive, mode] :
+					 {Mode(DebugPrimitive::LineStrip, GL_LINE_STRIP),
+					  Mode(DebugPrimitive::LineLoop, GL_LINE_LOOP)})
+				{
+					const Range & range =
+						ranges[static_cast<size_t>(primitive)];
+					if (range.index_count == 0)
+					{
+						continue;
+					}
+
+					glDrawElementsBaseVertex(
+						mode, range.index_count, GL_UNSIGNED_INT,
+						reinterpret_cast<const GLvoid *>(
+							range.first_index * sizeof(std::uint32_t)),
+						range.first_vertex);
+					renderer::stats::record_draw(
+						static_cast<std::uint64_t>(range.vertex_count), 0);
+				}
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("Error during render"));
+				}
+			}
+		};
+	}   // namespace opengl
+
+	unique_ptr<DebugDraw> DebugDraw::create()
+	{
+		return std::make_unique<opengl::GLDebugDraw>();
+	}
+}   // namespace glge::renderer::primitive
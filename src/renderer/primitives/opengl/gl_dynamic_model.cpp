@@ -0,0 +1,321 @@
+#include "gl_buffer.h"
+#include "gl_common.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/dynamic_model.h>
+#include <glge/renderer/render_stats.h>
+#include <glge/util/util.h>
+#include <internal/renderer/_dirty_ranges.h>
+#include <internal/util/_util.h>
+
+#include <array>
+#include <cmath>
+
+namespace glge::renderer::primitive
+{
+	namespace opengl
+	{
+		using renderer::DirtyRange;
+		using renderer::DirtyRanges;
+		using renderer::GPUResource;
+
+		class GLDynamicModel : public DynamicModel
+		{
+		private:
+			// One copy of the vertex storage, with the ranges of each
+			// attribute updated since it was last drawn from
+			struct VertexStorage
+			{
+				GLuint VAO = 0;
+				std::array<GLuint, 3> VBO{};
+				std::array<DirtyRanges, 3> pending;
+			};
+
+			// CPU copies of the attributes, from which every copy of the
+			// vertex storage is brought up to date
+			Vertices vertices;
+			Normals normals;
+			TexCoords uvs;
+
+			const GLsizei index_count;
+			GLuint EBO;
+			mutable vector<VertexStorage> storage;
+			mutable size_t current;
+			mutable bool changed;
+			std::uint64_t gpu_bytes;
+			math::Sphere bounding_sphere;
+
+			template<typename T>
+			static void upload_ranges(GLuint vbo, const vector<T> & shadow,
+									  const DirtyRanges & ranges)
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+				for (const DirtyRange & range : ranges.ranges())
+				{
+					glBufferSubData(
+						GL_ARRAY_BUFFER,
+						static_cast<GLintptr>(range.begin * sizeof(T)),
+						static_cast<GLsizeiptr>(range.size() * sizeof(T)),
+						shadow.data() + range.begin);
+				}
+
+				renderer::stats::record_upload(ranges.element_count() *
+											   sizeof(T));
+			}
+
+			// Brings the copy about to be drawn from up to date
+			void flush(VertexStorage & copy) const
+			{
+				if (!copy.pending[vertex_index].empty())
+				{
+					upload_ranges(copy.VBO[vertex_index], vertices,
+								  copy.pending[vertex_index]);
+				}
+				if (!copy.pending[normal_index].empty())
+				{
+					upload_ranges(copy.VBO[normal_index], normals,
+								  copy.pending[normal_index]);
+				}
+				if (!copy.pending[texcor_index].empty())
+				{
+					upload_ranges(copy.VBO[texcor_index], uvs,
+								  copy.pending[texcor_index]);
+				}
+
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+				for (DirtyRanges & ranges : copy.pending)
+				{
+					ranges.clear();
+				}
+
+				renderer::opengl::throw_if_gl_error(
+					EXC_MSG("Failed to update model attributes"));
+			}
+
+			template<typename T, typename ValueT>
+			void update(vector<T> & shadow, GLuint attribute, size_t first,
+						const ValueT * values, size_t count)
+			{
+				if (first > shadow.size() || count > shadow.size() - first)
+				{
+					throw std::out_of_range(EXC_MSG(
+						"Update lies outside the model's attribute"));
+				}
+
+				for (size_t i = 0; i < count; i++)
+				{
+					shadow[first + i] = T(values[i]);
+				}
+
+				for (VertexStorage & copy : storage)
+				{
+					copy.pending[attribute].add(first, first + count);
+				}
+
+				changed = changed || count > 0;
+			}
+
+			// Grows the bounds just enough to take in a point
+			void enclose(vec3 point)
+			{
+				const float distance =
+					glm::length(point - bounding_sphere.origin);
+				if (distance <= bounding_sphere.radius)
+				{
+					return;
+				}
+
+				const float radius =
+					(bounding_sphere.radius + distance) / 2.0f;
+				bounding_sphere.origin +=
+					(point - bounding_sphere.origin) *
+					((radius - bounding_sphere.radius) / distance);
+				bounding_sphere.radius = radius;
+			}
+
+		public:
+			GLDynamicModel(const EBOModelData & model_data,
+						   size_t buffer_count) :
+				vertices(model_data.vertices),
+				normals(model_data.normals), uvs(model_data.uvs),
+				index_count(util::safe_cast<size_t, GLsizei>(
+					model_data.indices.size())),
+				EBO(0), storage(buffer_count), current(0), changed(false),
+				gpu_bytes(0)
+			{
+				if (buffer_count == 0)
+				{
+					throw std::invalid_argument(EXC_MSG(
+						"Dynamic models need at least one vertex buffer"));
+				}
+
+				vector<vec3> points(vertices.cbegin(), vertices.cend());
+				bounding_sphere = math::bounding_sphere(points);
+
+				// Indices are widened to match the draw call
+				vector<std::uint32_t> indices;
+				indices.reserve(model_data.indices.size());
+				for (const model_parser::Index & index : model_data.indices)
+				{
+					indices.push_back(
+						util::safe_cast<size_t, std::uint32_t>(index));
+				}
+
+				glGenBuffers(1, &EBO);
+				for (VertexStorage & copy : storage)
+				{
+					glGenVertexArrays(1, &copy.VAO);
+					glGenBuffers(static_cast<GLsizei>(copy.VBO.size()),
+								 copy.VBO.data());
+				}
+
+				renderer::opengl::throw_if_gl_error(
+					EXC_MSG("Failed to generate storage for dynamic model"));
+
+				for (VertexStorage & copy : storage)
+				{
+					util::UniqueHandle vaoBind(
+						[&] { glBindVertexArray(copy.VAO); },
+						[] { glBindVertexArray(0); });
+
+					bind_attrib_data(copy.VBO[vertex_index], vertex_index,
+									 vertices, false, GL_DYNAMIC_DRAW);
+
+					if (!normals.empty())
+					{
+						bind_attrib_data(copy.VBO[normal_index],
+										 normal_index, normals, true,
+										 GL_DYNAMIC_DRAW);
+					}
+					if (!uvs.empty())
+					{
+						bind_attrib_data(copy.VBO[texcor_index],
+										 texcor_index, uvs, false,
+										 GL_DYNAMIC_DRAW);
+					}
+
+					// Every copy shares the indices, uploaded with the
+					// first
+					if (&copy == &storage.front())
+					{
+						bind_element_array(EBO, indices);
+					}
+					else
+					{
+						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+					}
+				}
+
+				gpu_bytes = buffer_count * (buffer_bytes(vertices) +
+											buffer_bytes(normals) +
+											buffer_bytes(uvs)) +
+							buffer_bytes(indices);
+
+				renderer::stats::record_allocation(GPUResource::Model,
+												   gpu_bytes);
+			}
+
+			GLDynamicModel(const GLDynamicModel &) = delete;
+			GLDynamicModel(GLDynamicModel &&) = delete;
+
+			GLDynamicModel & operator=(const GLDynamicModel &) = delete;
+			GLDynamicModel & operator=(GLDynamicModel &&) = delete;
+
+			~GLDynamicModel()
+			{
+				renderer::stats::record_release(GPUResource::Model,
+												gpu_bytes);
+
+				for (VertexStorage & copy : storage)
+				{
+					glDeleteVertexArrays(1, &copy.VAO);
+					glDeleteBuffers(static_cast<GLsizei>(copy.VBO.size()),
+									copy.VBO.data());
+				}
+				glDeleteBuffers(1, &EBO);
+			}
+
+			void update_vertices(size_t first, const vec3 * values,
+								 size_t count) override
+			{
+				update(vertices, vertex_index, first, values, count);
+
+				for (size_t i = 0; i < count; i++)
+				{
+					enclose(values[i]);
+				}
+			}
+
+			void update_normals(size_t first, const vec3 * values,
+								size_t count) override
+			{
+				update(normals, normal_index, first, values, count);
+			}
+
+			void update_uvs(size_t first, const vec2 * values,
+							size_t count) override
+			{
+				update(uvs, texcor_index, first, values, count);
+			}
+
+			size_t vertex_count() const override { return vertices.size(); }
+
+			void render() const override
+			{
+				// Move on from the copy the GPU may still be drawing from
+				// before writing to the storage
+				if (changed)
+				{
+					current = (current + 1) % storage.size();
+				}
+
+				VertexStorage & copy = storage[current];
+
+				util::UniqueHandle vaoBind(
+					[&] {
+						glBindVertexArray(copy.VAO);
+						renderer::stats::record_vao_bind();
+					},
+					[] { glBindVertexArray(0); });
+
+				if (changed)
+				{
+					flush(copy);
+					changed = false;
+				}
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("Error prior to render"));
+				}
+
+				glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, 0);
+				renderer::stats::record_draw(
+					static_cast<std::uint64_t>(index_count),
+					static_cast<std::uint64_t>(index_count / 3));
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("Error during render"));
+				}
+			}
+
+			std::optional<math::Sphere> bounds() const override
+			{
+				return bounding_sphere;
+			}
+		};
+	}   // namespace opengl
+
+	unique_ptr<DynamicModel>
+	DynamicModel::from_data(const EBOModelData & model_data,
+							size_t buffer_count)
+	{
+		return std::make_unique<opengl::GLDynamicModel>(model_data,
+														buffer_count);
+	}
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,414 @@
+#include "gl_common.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/framebuffer.h>
+#include <glge/renderer/render_stats.h>
+#include <glge/util/util.h>
+#include <internal/util/_util.h>
+
+#include <array>
+#include <cstring>
+#include <deque>
+
+namespace glge::renderer::primitive
+{
+	namespace opengl
+	{
+		using renderer::GPUResource;
+
+		constexpr std::uint64_t rgba_pixel_size = 4;
+		constexpr std::uint64_t depth_pixel_size = 4;
+
+		class GLFramebuffer : public Framebuffer
+		{
+		private:
+			const GLsizei fb_width, fb_height;
+			std::array<GLuint, 1> FBO;
+			std::array<GLuint, 2> RBO;
+			bool destroy;
+
+			std::uint64_t gpu_bytes() const
+			{
+				return static_cast<std::uint64_t>(fb_width) *
+					   static_cast<std::uint64_t>(fb_height) *
+					   (rgba_pixel_size + depth_pixel_size);
+			}
+
+			void release()
+			{
+				glDeleteFramebuffers(static_cast<GLsizei>(FBO.size()),
+									 FBO.data());
+				glDeleteRenderbuffers(static_cast<GLsizei>(RBO.size()),
+									  RBO.data());
+				destroy = false;
+			}
+
+		public:
+			GLFramebuffer(size_t width, size_t height) :
+				fb_width(util::safe_cast<size_t, GLsizei>(width)),
+				fb_height(util::safe_cast<size_t, GLsizei>(height)),
+				destroy(false)
+			{
+				if (width == 0 || height == 0)
+				{
+					throw std::invalid_argument(
+						EXC_MSG("Framebuffer dimensions must be nonzero"));
+				}
+
+				glGenFramebuffers(static_cast<GLsizei>(FBO.size()), FBO.data());
+				glGenRenderbuffers(static_cast<GLsizei>(RBO.size()),
+								   RBO.data());
+				destroy = true;
+
+				glBindRenderbuffer(GL_RENDERBUFFER, RBO[0]);
+				glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, fb_width,
+									  fb_height);
+				glBindRenderbuffer(GL_RENDERBUFFER, RBO[1]);
+				glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8,
+									  fb_width, fb_height);
+				glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+				GLint previous_fbo = 0;
+				glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_fbo);
+
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO[0]);
+				glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER,
+										  GL_COLOR_ATTACHMENT0,
+										  GL_RENDERBUFFER, RBO[0]);
+				glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER,
+										  GL_DEPTH_STENCIL_ATTACHMENT,
+										  GL_RENDERBUFFER, RBO[1]);
+
+				GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
+								  static_cast<GLuint>(previous_fbo));
+
+				if (status != GL_FRAMEBUFFER_COMPLETE)
+				{
+					release();
+					throw std::runtime_error(EXC_MSG(
+						"Framebuffer is incomplete; status " +
+						std::to_string(status)));
+				}
+
+				renderer::stats::record_allocation(GPUResource::Framebuffer,
+												   gpu_bytes());
+			}
+
+			GLFramebuffer(const GLFramebuffer &) = delete;
+			GLFramebuffer(GLFramebuffer && other) = delete;
+
+			GLFramebuffer & operator=(const GLFramebuffer &) = delete;
+			GLFramebuffer & operator=(GLFramebuffer &&) = delete;
+
+			~GLFramebuffer()
+			{
+				if (destroy)
+				{
+					renderer::stats::record_release(GPUResource::Framebuffer,
+													gpu_bytes());
+					release();
+				}
+			}
+
+			GLuint get_id() const { return FBO[0]; }
+
+			size_t width() const override
+			{
+				return static_cast<size_t>(fb_width);
+			}
+
+			size_t height() const override
+			{
+				return static_cast<size_t>(fb_height);
+			}
+
+			util::UniqueHandle bind() override
+			{
+				GLint previous_fbo = 0;
+				std::array<GLint, 4> previous_viewport;
+
+				glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_fbo);
+				glGetIntegerv(GL_VIEWPORT, previous_viewport.data());
+
+				return util::UniqueHandle(
+					[&] {
+						glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO[0]);
+						glViewport(0, 0, fb_width, fb_height);
+					},
+					[previous_fbo, previous_viewport] {
+						glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
+										  static_cast<GLuint>(previous_fbo));
+						glViewport(previous_viewport[0], previous_viewport[1],
+								   previous_viewport[2], previous_viewport[3]);
+					});
+			}
+
+			void clear(vec4 color) override
+			{
+				std::array<GLfloat, 4> previous_color;
+				glGetFloatv(GL_COLOR_CLEAR_VALUE, previous_color.data());
+
+				auto fb_bind = bind();
+
+				glClearColor(color.x, color.y, color.z, color.w);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				glClearColor(previous_color[0], previous_color[1],
+							 previous_color[2], previous_color[3]);
+			}
+
+			// Binds this framebuffer for reading with tightly packed rows
+			util::UniqueHandle bind_read() const
+			{
+				GLint previous_fbo = 0, previous_alignment = 4;
+
+				glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_fbo);
+				glGetIntegerv(GL_PACK_ALIGNMENT, &previous_alignment);
+
+				return util::UniqueHandle(
+					[&] {
+						glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO[0]);
+						glReadBuffer(GL_COLOR_ATTACHMENT0);
+						glPixelStorei(GL_PACK_ALIGNMENT, 1);
+					},
+					[previous_fbo, previous_alignment] {
+						glBindFramebuffer(GL_READ_FRAMEBUFFER,
+										  static_cast<GLuint>(previous_fbo));
+						glPixelStorei(GL_PACK_ALIGNMENT, previous_alignment);
+					});
+			}
+
+			Image read() const override
+			{
+				Image image;
+				image.width = width();
+				image.height = height();
+				image.pixels.resize(image.row_size() * image.height);
+
+				auto read_bind = bind_read();
+
+				glReadPixels(0, 0, fb_width, fb_height, GL_RGBA,
+							 GL_UNSIGNED_BYTE, image.pixels.data());
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error reading framebuffer"));
+				}
+
+				return image;
+			}
+		};
+
+		class GLAsyncReadback : public AsyncReadback
+		{
+		private:
+			struct Slot
+			{
+				GLuint PBO = 0;
+				GLsync fence = nullptr;
+			};
+
+			const GLsizei image_width, image_height;
+			const size_t image_bytes;
+
+			vector<Slot> slots;
+			// Requests in flight, oldest first, as indices into slots
+			std::deque<size_t> in_flight;
+			// Completed requests not yet returned, oldest first
+			std::deque<Image> completed;
+			size_t next_slot = 0;
+
+			// Polling interval used while blocking on a copy
+			static constexpr GLuint64 wait_timeout_ns = 100'000'000;
+
+			bool try_complete_oldest(GLuint64 timeout)
+			{
+				Slot & slot = slots[in_flight.front()];
+
+				GLenum result = glClientWaitSync(
+					slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+
+				if (result == GL_WAIT_FAILED)
+				{
+					throw std::runtime_error(
+						EXC_MSG("Failed waiting on framebuffer readback"));
+				}
+				if (result == GL_TIMEOUT_EXPIRED)
+				{
+					return false;
+				}
+
+				glDeleteSync(slot.fence);
+				slot.fence = nullptr;
+
+				Image image;
+				image.width = static_cast<size_t>(image_width);
+				image.height = static_cast<size_t>(image_height);
+				image.pixels.resize(image_bytes);
+
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+				const void * data = glMapBufferRange(
+					GL_PIXEL_PACK_BUFFER, 0,
+					static_cast<GLsizeiptr>(image_bytes), GL_MAP_READ_BIT);
+
+				if (!data)
+				{
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+					throw std::runtime_error(
+						EXC_MSG("Failed to map framebuffer readback buffer"));
+				}
+
+				std::memcpy(image.pixels.data(), data, image_bytes);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+				in_flight.pop_front();
+				completed.emplace_back(std::move(image));
+
+				return true;
+			}
+
+			void complete_oldest()
+			{
+				while (!try_complete_oldest(wait_timeout_ns))
+				{
+				}
+			}
+
+		public:
+			GLAsyncReadback(size_t width, size_t height, size_t ring_size) :
+				image_width(util::safe_cast<size_t, GLsizei>(width)),
+				image_height(util::safe_cast<size_t, GLsizei>(height)),
+				image_bytes(width * height * rgba_pixel_size),
+				slots(std::max<size_t>(ring_size, 1))
+			{
+				for (Slot & slot : slots)
+				{
+					glGenBuffers(1, &slot.PBO);
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+					glBufferData(GL_PIXEL_PACK_BUFFER,
+								 static_cast<GLsizeiptr>(image_bytes), nullptr,
+								 GL_STREAM_READ);
+				}
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+				renderer::stats::record_allocation(
+					GPUResource::Framebuffer, image_bytes * slots.size());
+			}
+
+			GLAsyncReadback(const GLAsyncReadback &) = delete;
+			GLAsyncReadback(GLAsyncReadback &&) = delete;
+
+			GLAsyncReadback & operator=(const GLAsyncReadback &) = delete;
+			GLAsyncReadback & operator=(GLAsyncReadback &&) = delete;
+
+			~GLAsyncReadback()
+			{
+				renderer::stats::record_release(GPUResource::Framebuffer,
+												image_bytes * slots.size());
+
+				for (Slot & slot : slots)
+				{
+					if (slot.fence)
+					{
+						glDeleteSync(slot.fence);
+					}
+					glDeleteBuffers(1, &slot.PBO);
+				}
+			}
+
+			void request(const Framebuffer & source) override
+			{
+				if (source.width() != static_cast<size_t>(image_width) ||
+					source.height() != static_cast<size_t>(image_height))
+				{
+					throw std::invalid_argument(EXC_MSG(
+						"Framebuffer size does not match readback size"));
+				}
+
+				if (in_flight.size() == slots.size())
+				{
+					complete_oldest();
+				}
+
+				Slot & slot = slots[next_slot];
+
+				{
+					auto read_bind =
+						static_cast<const GLFramebuffer &>(source).bind_read();
+
+					// With a pack buffer bound, glReadPixels queues a copy
+					// into the buffer and returns without waiting
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+					glReadPixels(0, 0, image_width, image_height, GL_RGBA,
+								 GL_UNSIGNED_BYTE, nullptr);
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+				}
+
+				slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error requesting readback"));
+				}
+
+				in_flight.push_back(next_slot);
+				next_slot = (next_slot + 1) % slots.size();
+			}
+
+			std::optional<Image> poll() override
+			{
+				if (completed.empty() && !in_flight.empty())
+				{
+					try_complete_oldest(0);
+				}
+
+				if (completed.empty())
+				{
+					return std::nullopt;
+				}
+
+				Image image = std::move(completed.front());
+				completed.pop_front();
+				return image;
+			}
+
+			Image wait() override
+			{
+				if (completed.empty())
+				{
+					if (in_flight.empty())
+					{
+						throw std::logic_error(
+							EXC_MSG("Waited on readback with no requests"));
+					}
+
+					complete_oldest();
+				}
+
+				Image image = std::move(completed.front());
+				completed.pop_front();
+				return image;
+			}
+
+			size_t pending() const override
+			{
+				return in_flight.size() + completed.size();
+			}
+		};
+	}   // namespace opengl
+
+	unique_ptr<Framebuffer> Framebuffer::from_size(size_t width, size_t height)
+	{
+		return std::make_unique<opengl::GLFramebuffer>(width, height);
+	}
+
+	unique_ptr<AsyncReadback>
+	AsyncReadback::create(size_t width, size_t height, size_t ring_size)
+	{
+		return std::make_unique<opengl::GLAsyncReadback>(width, height,
+														 ring_size);
+	}
+}   // namespace glge::renderer::primitive
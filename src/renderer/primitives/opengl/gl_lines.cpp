@@ -3,6 +3,7 @@
 
 #include <glge/common.h>
 #include <glge/renderer/primitives/lines.h>
+#include <glge/renderer/render_stats.h>
 #include <internal/util/_util.h>
 
 #include <array>
@@ -40,6 +41,9 @@ namespace glge::renderer::primitive
 					bind_attrib_data(VBO[vertex_index], vertex_index, points,
 									 false);
 				}
+
+				renderer::stats::record_allocation(
+					renderer::GPUResource::Lines, buffer_bytes(points));
 			}
 
 			GLLines(const GLLines &) = delete;
@@ -55,6 +59,10 @@ namespace glge::renderer::primitive
 			{
 				if (destroy)
 				{
+					renderer::stats::record_release(
+						renderer::GPUResource::Lines,
+						sizeof(vec3) * static_cast<std::uint64_t>(vertex_count));
+
 					glDeleteVertexArrays(
 						util::safe_cast<typename decltype(VAO)::size_type,
 										GLsizei>(VAO.size()),
@@ -71,8 +79,12 @@ namespace glge::renderer::primitive
 
 			void render() const override
 			{
-				util::UniqueHandle vaoBind([&] { glBindVertexArray(VAO[0]); },
-										   [] { glBindVertexArray(0); });
+				util::UniqueHandle vaoBind(
+					[&] {
+						glBindVertexArray(VAO[0]);
+						renderer::stats::record_vao_bind();
+					},
+					[] { glBindVertexArray(0); });
 
 				if constexpr (debug)
 				{
@@ -81,6 +93,8 @@ namespace glge::renderer::primitive
 				}
 
 				glDrawArrays(GL_LINE_LOOP, 0, vertex_count);
+				renderer::stats::record_draw(
+					static_cast<std::uint64_t>(vertex_count), 0);
 
 				if constexpr (debug)
 				{
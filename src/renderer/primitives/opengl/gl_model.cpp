@@ -3,6 +3,7 @@
 
 #include <glge/common.h>
 #include <glge/renderer/primitives/model.h>
+#include <glge/renderer/render_stats.h>
 
 #include <array>
 
@@ -10,6 +11,17 @@ namespace glge::renderer::primitive
 {
 	namespace opengl
 	{
+		using renderer::GPUResource;
+
+		namespace
+		{
+			math::Sphere vertex_bounds(const Vertices & vertices)
+			{
+				vector<vec3> points(vertices.cbegin(), vertices.cend());
+				return math::bounding_sphere(points);
+			}
+		}   // namespace
+
 		class GLModel : public Model
 		{
 		private:
@@ -17,6 +29,8 @@ namespace glge::renderer::primitive
 			std::array<GLuint, 1> VAO;
 			std::array<GLuint, 3> VBO;
 			std::array<GLuint, 1> EBO;
+			std::uint64_t gpu_bytes;
+			math::Sphere bounding_sphere;
 			bool destroy;
 
 		public:
@@ -24,13 +38,19 @@ namespace glge::renderer::primitive
 
 			GLModel(GLModel && other) :
 				index_count(other.index_count), VAO(other.VAO), VBO(other.VBO),
-				EBO(other.EBO), destroy(other.destroy)
+				EBO(other.EBO), gpu_bytes(other.gpu_bytes),
+				bounding_sphere(other.bounding_sphere), destroy(other.destroy)
 			{
 				other.destroy = false;
 			}
 
 			GLModel(const EBOModelData & model_data) :
 				index_count(static_cast<GLsizei>(model_data.indices.size())),
+				gpu_bytes(buffer_bytes(model_data.vertices) +
+						  buffer_bytes(model_data.normals) +
+						  buffer_bytes(model_data.uvs) +
+						  buffer_bytes(model_data.indices)),
+				bounding_sphere(vertex_bounds(model_data.vertices)),
 				destroy(false)
 			{
 				glGenVertexArrays(static_cast<GLsizei>(VAO.size()), VAO.data());
@@ -63,12 +83,18 @@ namespace glge::renderer::primitive
 				}
 
 				destroy = true;
+
+				renderer::stats::record_allocation(GPUResource::Model,
+												   gpu_bytes);
 			}
 
 			~GLModel()
 			{
 				if (destroy)
 				{
+					renderer::stats::record_release(GPUResource::Model,
+													gpu_bytes);
+
 					glDeleteVertexArrays(static_cast<GLsizei>(VAO.size()),
 										 VAO.data());
 					glDeleteBuffers(static_cast<GLsizei>(VBO.size()),
@@ -84,8 +110,12 @@ namespace glge::renderer::primitive
 
 			void render() const override
 			{
-				util::UniqueHandle vaoBind([&] { glBindVertexArray(VAO[0]); },
-										   [] { glBindVertexArray(0); });
+				util::UniqueHandle vaoBind(
+					[&] {
+						glBindVertexArray(VAO[0]);
+						renderer::stats::record_vao_bind();
+					},
+					[] { glBindVertexArray(0); });
 
 				if constexpr (debug)
 				{
@@ -94,6 +124,9 @@ namespace glge::renderer::primitive
 				}
 
 				glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, 0);
+				renderer::stats::record_draw(
+					static_cast<std::uint64_t>(index_count),
+					static_cast<std::uint64_t>(index_count / 3));
 
 				if constexpr (debug)
 				{
@@ -102,6 +135,11 @@ namespace glge::renderer::primitive
 				}
 			}
 
+			std::optional<math::Sphere> bounds() const override
+			{
+				return bounding_sphere;
+			}
+
 			GLuint getVAO() const { return VAO[0]; }
 		};
 	}   // namespace opengl
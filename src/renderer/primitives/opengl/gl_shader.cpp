@@ -3,9 +3,14 @@
 #include <glge/renderer/primitives/cubemap.h>
 #include <glge/renderer/primitives/shader_program.h>
 #include <glge/renderer/primitives/texture.h>
+#include <glge/renderer/primitives/texture_array.h>
+#include <glge/renderer/primitives/virtual_texture.h>
 #include <glge/renderer/render_settings.h>
 #include <glge/util/util.h>
 
+#include <cmath>
+#include <string>
+
 namespace glge::renderer::primitive
 {
 	namespace opengl
@@ -30,11 +35,113 @@ namespace glge::renderer::primitive
 			virtual ~GLShader() = default;
 		};
 
-		class GLNormalShader : public GLShader<NormalShaderData, GLNormalShader>
+		template<typename ShaderT>
+		void prepare_shader()
+		{
+			renderer::opengl::prepare_program(ShaderT::vertex_code,
+											  ShaderT::fragment_code);
+		}
+
+		// The fade uniform and faded_out(), shared by every fade variant
+		constexpr czstring fade_code =
+#include "generated/glsl/fade.glsl"
+			;
+
+		// Fragment source of the fade variant of a shader's program, with
+		// GLGE_FADE defined and fade_code inserted after the #version line.
+		// Programs are matched by the addresses of their sources, so it is
+		// built only once
+		template<typename ShaderT>
+		czstring fade_fragment_code()
+		{
+			static const std::string code = [] {
+				std::string source = ShaderT::fragment_code;
+				source.insert(source.find('\n') + 1,
+							  std::string("#define GLGE_FADE\n") + fade_code);
+				return source;
+			}();
+
+			return code.c_str();
+		}
+
+		// Shader able to draw objects part way through a dithered cross-fade
+		// between levels of detail. Dithering discards fragments, which turns
+		// off early depth testing for the whole program, so it is compiled
+		// only into a variant of the program which is bound just for objects
+		// whose fade is not 1. UniformsT holds the locations of the other
+		// uniforms, which may differ between the variants
+		template<typename DataT, typename ShaderT, typename UniformsT>
+		class GLFadingShader : public GLShader<DataT, ShaderT>
 		{
+		protected:
+			const GLProgram fade_prog;
+
 		private:
+			const GLuint uFade;
+			const UniformsT whole_uniforms, fade_uniforms;
+			// Whether fade_prog rather than prog is bound
+			bool fading;
+
+		public:
+			GLFadingShader() :
+				fade_prog(renderer::opengl::load_simple_shader(
+					ShaderT::vertex_code, fade_fragment_code<ShaderT>())),
+				uFade(fade_prog.get_uniform("fade")),
+				whole_uniforms(this->prog), fade_uniforms(fade_prog),
+				fading(false)
+			{}
+
+			util::UniqueHandle bind() override
+			{
+				fading = false;
+
+				return GLShader<DataT, ShaderT>::bind();
+			}
+
+		protected:
+			// Binds the variant of the program for an object with the given
+			// fade, returning the locations of its uniforms
+			const UniformsT & select(float fade)
+			{
+				const bool faded = fade != 1.0f;
+
+				if (faded != fading)
+				{
+					(faded ? fade_prog : this->prog).use();
+					fading = faded;
+				}
+
+				if (!faded)
+				{
+					return whole_uniforms;
+				}
+
+				upload_uniform(uFade, fade);
+
+				return fade_uniforms;
+			}
+		};
+
+		template<typename ShaderT>
+		void prepare_fading_shader()
+		{
+			prepare_shader<ShaderT>();
+			renderer::opengl::prepare_program(ShaderT::vertex_code,
+											  fade_fragment_code<ShaderT>());
+		}
+
+		struct MVPUniforms
+		{
 			const GLuint uMVP;
 
+			explicit MVPUniforms(const GLProgram & prog) :
+				uMVP(prog.get_uniform("MVP"))
+			{}
+		};
+
+		class GLNormalShader :
+			public GLFadingShader<NormalShaderData, GLNormalShader, MVPUniforms>
+		{
 		public:
 			static constexpr czstring vertex_code =
 #include "generated/glsl/normal.vert.glsl"
@@ -44,12 +151,10 @@ namespace glge::renderer::primitive
 #include "generated/glsl/normal.frag.glsl"
 				;
 
-			GLNormalShader() : uMVP(prog.get_uniform("MVP")) {}
-
 			void parameterize(const RenderParameters & render,
 							  const NormalShaderData &) override
 			{
-				glUniformMatrix4fv(uMVP, 1, GL_FALSE, &render.MVP[0][0]);
+				upload_uniform(select(render.fade).uMVP, render.MVP);
 
 				if constexpr (debug)
 				{
@@ -59,30 +164,73 @@ namespace glge::renderer::primitive
 			}
 		};
 
-		class GLColorShader : public GLShader<ColorShaderData, GLColorShader>
+		class GLDepthShader :
+			public GLFadingShader<DepthShaderData, GLDepthShader, MVPUniforms>
 		{
-		private:
-			const GLuint uMVP, uColor;
-
 		public:
 			static constexpr czstring vertex_code =
-#include "generated/glsl/color.vert.glsl"
+#include "generated/glsl/depth.vert.glsl"
 				;
 
 			static constexpr czstring fragment_code =
-#include "generated/glsl/color.frag.glsl"
+#include "generated/glsl/depth.frag.glsl"
 				;
 
-			GLColorShader() :
+			util::UniqueHandle bind() override
+			{
+				return std::move(
+					GLFadingShader::bind().chain(
+						[&] {
+							glColorMask(GL_FALSE, GL_FALSE, GL_FALSE,
+										GL_FALSE);
+						},
+						[&] {
+							glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+						}));
+			}
+
+			void parameterize(const RenderParameters & render,
+							  const DepthShaderData &) override
+			{
+				upload_uniform(select(render.fade).uMVP, render.MVP);
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error setting up shader"));
+				}
+			}
+		};
+
+		struct ColorUniforms
+		{
+			const GLuint uMVP, uColor;
+
+			explicit ColorUniforms(const GLProgram & prog) :
 				uMVP(prog.get_uniform("MVP")),
 				uColor(prog.get_uniform("in_color"))
 			{}
+		};
+
+		class GLColorShader :
+			public GLFadingShader<ColorShaderData, GLColorShader, ColorUniforms>
+		{
+		public:
+			static constexpr czstring vertex_code =
+#include "generated/glsl/color.vert.glsl"
+				;
+
+			static constexpr czstring fragment_code =
+#include "generated/glsl/color.frag.glsl"
+				;
 
 			void parameterize(const RenderParameters & render,
 							  const ColorShaderData & data) override
 			{
-				glUniformMatrix4fv(uMVP, 1, GL_FALSE, &render.MVP[0][0]);
-				glUniform3fv(uColor, 1, &data.color[0]);
+				const ColorUniforms & uniforms = select(render.fade);
+
+				upload_uniform(uniforms.uMVP, render.MVP);
+				upload_uniform(uniforms.uColor, data.color);
 
 				if constexpr (debug)
 				{
@@ -92,12 +240,45 @@ namespace glge::renderer::primitive
 			}
 		};
 
-		class GLTextureShader :
-			public GLShader<TextureShaderData, GLTextureShader>
+		class GLVertexColorShader :
+			public GLFadingShader<VertexColorShaderData, GLVertexColorShader,
+								  MVPUniforms>
+		{
+		public:
+			static constexpr czstring vertex_code =
+#include "generated/glsl/vcolor.vert.glsl"
+				;
+
+			static constexpr czstring fragment_code =
+#include "generated/glsl/vcolor.frag.glsl"
+				;
+
+			void parameterize(const RenderParameters & render,
+							  const VertexColorShaderData &) override
+			{
+				upload_uniform(select(render.fade).uMVP, render.MVP);
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error setting up shader"));
+				}
+			}
+		};
+
+		struct TextureUniforms
 		{
-		private:
 			const GLuint uMVP, uModel;
 
+			explicit TextureUniforms(const GLProgram & prog) :
+				uMVP(prog.get_uniform("MVP")), uModel(prog.get_uniform("model"))
+			{}
+		};
+
+		class GLTextureShader :
+			public GLFadingShader<TextureShaderData, GLTextureShader,
+								  TextureUniforms>
+		{
 		public:
 			static constexpr czstring vertex_code =
 #include "generated/glsl/tex.vert.glsl"
@@ -107,17 +288,73 @@ namespace glge::renderer::primitive
 #include "generated/glsl/tex.frag.glsl"
 				;
 
-			GLTextureShader() :
-				uMVP(prog.get_uniform("MVP")), uModel(prog.get_uniform("model"))
-			{}
-
 			void parameterize(const RenderParameters & render,
 							  const TextureShaderData & data) override
 			{
 				data.texture.activate();
 
-				glUniformMatrix4fv(uMVP, 1, GL_FALSE, &render.MVP[0][0]);
-				glUniformMatrix4fv(uModel, 1, GL_FALSE, &render.M[0][0]);
+				const TextureUniforms & uniforms = select(render.fade);
+
+				upload_uniform(uniforms.uMVP, render.MVP);
+				upload_uniform(uniforms.uModel, render.M);
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error setting up shader"));
+				}
+			}
+		};
+
+		struct TextureArrayUniforms
+		{
+			const GLuint uMVP, uLayer;
+
+			explicit TextureArrayUniforms(const GLProgram & prog) :
+				uMVP(prog.get_uniform("MVP")), uLayer(prog.get_uniform("layer"))
+			{}
+		};
+
+		class GLTextureArrayShader :
+			public GLFadingShader<TextureArrayShaderData, GLTextureArrayShader,
+								  TextureArrayUniforms>
+		{
+		private:
+			// Array bound since this shader was bound; reset on every bind
+			// as other shaders may have changed the binding
+			observer_ptr<const TextureArray> bound_array;
+
+		public:
+			static constexpr czstring vertex_code =
+#include "generated/glsl/texarray.vert.glsl"
+				;
+
+			static constexpr czstring fragment_code =
+#include "generated/glsl/texarray.frag.glsl"
+				;
+
+			GLTextureArrayShader() : bound_array(nullptr) {}
+
+			util::UniqueHandle bind() override
+			{
+				bound_array = nullptr;
+
+				return GLFadingShader::bind();
+			}
+
+			void parameterize(const RenderParameters & render,
+							  const TextureArrayShaderData & data) override
+			{
+				if (bound_array != &data.textures)
+				{
+					data.textures.activate();
+					bound_array = &data.textures;
+				}
+
+				const TextureArrayUniforms & uniforms = select(render.fade);
+
+				upload_uniform(uniforms.uMVP, render.MVP);
+				upload_uniform(uniforms.uLayer, static_cast<float>(data.layer));
 
 				if constexpr (debug)
 				{
@@ -156,7 +393,7 @@ namespace glge::renderer::primitive
 			{
 				data.skybox.activate();
 
-				glUniformMatrix4fv(uMVP, 1, GL_FALSE, &render.MVP[0][0]);
+				upload_uniform(uMVP, render.MVP);
 
 				if constexpr (debug)
 				{
@@ -166,11 +403,21 @@ namespace glge::renderer::primitive
 			}
 		};
 
-		class GLEnvMapShader : public GLShader<EnvMapShaderData, GLEnvMapShader>
+		struct EnvMapUniforms
 		{
-		private:
 			const GLuint uMVP, uModel, uCam;
 
+			explicit EnvMapUniforms(const GLProgram & prog) :
+				uMVP(prog.get_uniform("MVP")),
+				uModel(prog.get_uniform("model")),
+				uCam(prog.get_uniform("camPos"))
+			{}
+		};
+
+		class GLEnvMapShader :
+			public GLFadingShader<EnvMapShaderData, GLEnvMapShader,
+								  EnvMapUniforms>
+		{
 		public:
 			static constexpr czstring vertex_code =
 #include "generated/glsl/envmap.vert.glsl"
@@ -180,22 +427,142 @@ namespace glge::renderer::primitive
 #include "generated/glsl/envmap.frag.glsl"
 				;
 
-			GLEnvMapShader() :
-				uMVP(prog.get_uniform("MVP")),
-				uModel(prog.get_uniform("model")),
-				uCam(prog.get_uniform("camPos"))
-			{}
-
 			void parameterize(const RenderParameters & render,
 							  const EnvMapShaderData & data) override
 			{
 				data.skybox.activate();
 
-				glUniformMatrix4fv(uMVP, 1, GL_FALSE, &render.MVP[0][0]);
-				glUniformMatrix4fv(uModel, 1, GL_FALSE, &render.M[0][0]);
+				const EnvMapUniforms & uniforms = select(render.fade);
+
+				upload_uniform(uniforms.uMVP, render.MVP);
+				upload_uniform(uniforms.uModel, render.M);
 
 				vec3 cam_pos = render.settings.camera->placement.get_position();
-				glUniform3fv(uCam, cam_pos.length(), &cam_pos[0]);
+				upload_uniform(uniforms.uCam, cam_pos);
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error setting up shader"));
+				}
+			}
+		};
+
+		// Uniforms describing the layout of a virtual texture, shared by
+		// the virtual texture shaders
+		class VirtualTextureUniforms
+		{
+		private:
+			const GLuint uVirtualSize, uPageSize, uBorder, uCachePages,
+				uMaxLevel;
+
+		public:
+			explicit VirtualTextureUniforms(const GLProgram & prog) :
+				uVirtualSize(prog.get_uniform("virtual_size")),
+				uPageSize(prog.get_uniform("page_size")),
+				uBorder(prog.get_uniform("border")),
+				uCachePages(prog.get_uniform("cache_pages")),
+				uMaxLevel(prog.get_uniform("max_level"))
+			{}
+
+			void upload(const VirtualTexture & texture) const
+			{
+				const PageLayout & layout = texture.layout();
+
+				upload_uniform(uVirtualSize,
+							   vec2(static_cast<float>(layout.width),
+									static_cast<float>(layout.height)));
+				upload_uniform(uPageSize, static_cast<float>(layout.page_size));
+				upload_uniform(uBorder, static_cast<float>(layout.border));
+				upload_uniform(uCachePages,
+							   static_cast<float>(texture.cache_pages()));
+				upload_uniform(uMaxLevel,
+							   static_cast<float>(layout.level_count - 1));
+			}
+		};
+
+		struct VirtualTextureShaderUniforms
+		{
+			const GLuint uMVP;
+			const VirtualTextureUniforms uLayout;
+
+			explicit VirtualTextureShaderUniforms(const GLProgram & prog) :
+				uMVP(prog.get_uniform("MVP")), uLayout(prog)
+			{}
+		};
+
+		class GLVirtualTextureShader :
+			public GLFadingShader<VirtualTextureShaderData,
+								  GLVirtualTextureShader,
+								  VirtualTextureShaderUniforms>
+		{
+		public:
+			static constexpr czstring vertex_code =
+#include "generated/glsl/tex.vert.glsl"
+				;
+
+			static constexpr czstring fragment_code =
+#include "generated/glsl/vtex.frag.glsl"
+				;
+
+			GLVirtualTextureShader()
+			{
+				for (const GLProgram * variant : {&prog, &fade_prog})
+				{
+					auto active = variant->activate();
+					glUniform1i(variant->get_uniform("cache"), 0);
+					glUniform1i(variant->get_uniform("indirection"), 1);
+				}
+			}
+
+			void parameterize(const RenderParameters & render,
+							  const VirtualTextureShaderData & data) override
+			{
+				data.texture.activate();
+
+				const VirtualTextureShaderUniforms & uniforms =
+					select(render.fade);
+
+				upload_uniform(uniforms.uMVP, render.MVP);
+				uniforms.uLayout.upload(data.texture);
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error setting up shader"));
+				}
+			}
+		};
+
+		class GLVirtualTextureFeedbackShader :
+			public GLShader<VirtualTextureFeedbackShaderData,
+							GLVirtualTextureFeedbackShader>
+		{
+		private:
+			const GLuint uMVP, uLodBias;
+			const VirtualTextureUniforms uLayout;
+
+		public:
+			static constexpr czstring vertex_code =
+#include "generated/glsl/tex.vert.glsl"
+				;
+
+			static constexpr czstring fragment_code =
+#include "generated/glsl/vtex_feedback.frag.glsl"
+				;
+
+			GLVirtualTextureFeedbackShader() :
+				uMVP(prog.get_uniform("MVP")),
+				uLodBias(prog.get_uniform("lod_bias")), uLayout(prog)
+			{}
+
+			void parameterize(
+				const RenderParameters & render,
+				const VirtualTextureFeedbackShaderData & data) override
+			{
+				upload_uniform(uMVP, render.MVP);
+				upload_uniform(uLodBias, std::log2(data.resolution_scale));
+				uLayout.upload(data.texture);
 
 				if constexpr (debug)
 				{
@@ -212,27 +579,118 @@ namespace glge::renderer::primitive
 		return std::make_unique<opengl::GLNormalShader>();
 	}
 
+	template<>
+	void NormalShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLNormalShader>();
+	}
+
+	template<>
+	unique_ptr<DepthShader> DepthShader::load()
+	{
+		return std::make_unique<opengl::GLDepthShader>();
+	}
+
+	template<>
+	void DepthShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLDepthShader>();
+	}
+
 	template<>
 	unique_ptr<ColorShader> ColorShader::load()
 	{
 		return std::make_unique<opengl::GLColorShader>();
 	}
 
+	template<>
+	void ColorShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLColorShader>();
+	}
+
+	template<>
+	unique_ptr<VertexColorShader> VertexColorShader::load()
+	{
+		return std::make_unique<opengl::GLVertexColorShader>();
+	}
+
+	template<>
+	void VertexColorShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLVertexColorShader>();
+	}
+
 	template<>
 	unique_ptr<TextureShader> TextureShader::load()
 	{
 		return std::make_unique<opengl::GLTextureShader>();
 	}
 
+	template<>
+	void TextureShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLTextureShader>();
+	}
+
+	template<>
+	unique_ptr<TextureArrayShader> TextureArrayShader::load()
+	{
+		return std::make_unique<opengl::GLTextureArrayShader>();
+	}
+
+	template<>
+	void TextureArrayShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLTextureArrayShader>();
+	}
+
 	template<>
 	unique_ptr<SkyboxShader> SkyboxShader::load()
 	{
 		return std::make_unique<opengl::GLSkyboxShader>();
 	}
 
+	template<>
+	void SkyboxShader::prepare()
+	{
+		opengl::prepare_shader<opengl::GLSkyboxShader>();
+	}
+
 	template<>
 	unique_ptr<EnvMapShader> EnvMapShader::load()
 	{
 		return std::make_unique<opengl::GLEnvMapShader>();
 	}
+
+	template<>
+	void EnvMapShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLEnvMapShader>();
+	}
+
+	template<>
+	unique_ptr<VirtualTextureShader> VirtualTextureShader::load()
+	{
+		return std::make_unique<opengl::GLVirtualTextureShader>();
+	}
+
+	template<>
+	void VirtualTextureShader::prepare()
+	{
+		opengl::prepare_fading_shader<opengl::GLVirtualTextureShader>();
+	}
+
+	template<>
+	unique_ptr<VirtualTextureFeedbackShader>
+	VirtualTextureFeedbackShader::load()
+	{
+		return std::make_unique<opengl::GLVirtualTextureFeedbackShader>();
+	}
+
+	template<>
+	void VirtualTextureFeedbackShader::prepare()
+	{
+		opengl::prepare_shader<opengl::GLVirtualTextureFeedbackShader>();
+	}
 }   // namespace glge::renderer::primitive
@@ -1,11 +1,341 @@
 #include "gl_common.h"
+#include "gl_texture.h"
 
 #include <glge/common.h>
 #include <glge/util/util.h>
+#include <glge/renderer/primitives/image_decoder.h>
 #include <glge/renderer/primitives/texture.h>
+#include <glge/renderer/render_stats.h>
+#include <internal/renderer/_texture_container.h>
+#include <internal/util/_compat.h>
+#include <internal/util/_util.h>
 
 #include <SOIL.h>
 
+#include <cstring>
+#include <future>
+#include <mutex>
+
+namespace glge::renderer::opengl
+{
+	using primitive::Image;
+
+	namespace
+	{
+		// Expands luminance images to RGB(A), as the core profile has
+		// no luminance formats
+		void expand_luminance(Image & image)
+		{
+			if (image.channels > 2)
+			{
+				return;
+			}
+
+			const bool alpha = image.channels == 2;
+			const size_t pixel_count = image.width * image.height;
+
+			vector<std::uint8_t> expanded(pixel_count * (alpha ? 4 : 3));
+			auto out = expanded.begin();
+
+			for (size_t i = 0; i < pixel_count; i++)
+			{
+				const std::uint8_t * in =
+					image.pixels.data() + i * image.channels;
+
+				*out++ = in[0];
+				*out++ = in[0];
+				*out++ = in[0];
+				if (alpha)
+				{
+					*out++ = in[1];
+				}
+			}
+
+			image.pixels = std::move(expanded);
+			image.channels = alpha ? 4 : 3;
+		}
+
+		GLenum compressed_format(primitive::BlockFormat format)
+		{
+			return format == primitive::BlockFormat::BC1
+					   ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+					   : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+
+		Image decode_image(const primitive::TextureFileInfo & info,
+						   int force_channels)
+		{
+			// The common formats are decoded natively; SOIL handles the
+			// rest
+			if (auto image = primitive::load_image(
+					info.path, util::safe_cast<int, size_t>(force_channels)))
+			{
+				return std::move(*image);
+			}
+
+			int width = 0, height = 0, channels = 0;
+			unsigned char * data = nullptr;
+
+			{
+				// SOIL reports its result through a global string, so decodes
+				// on worker threads take turns
+				static std::mutex soil_mutex;
+				std::lock_guard lock(soil_mutex);
+
+				data = SOIL_load_image(info.path.c_str(), &width, &height,
+									   &channels, force_channels);
+
+				if (!data)
+				{
+					throw std::runtime_error(EXC_MSG(
+						"Failed to load texture file: " + info.path +
+						"\nSOIL error: " + std::string(SOIL_last_result())));
+				}
+			}
+
+			util::UniqueHandle free_data([] {},
+										 [&] { SOIL_free_image_data(data); });
+
+			Image image;
+			image.width = util::safe_cast<int, size_t>(width);
+			image.height = util::safe_cast<int, size_t>(height);
+			image.channels = util::safe_cast<int, size_t>(
+				force_channels ? force_channels : channels);
+			image.pixels.assign(data, data + image.row_size() * image.height);
+
+			return image;
+		}
+	}   // namespace
+
+	MipChain decode_texture(const primitive::TextureFileInfo & info)
+	{
+		Image image = decode_image(info, SOIL_LOAD_AUTO);
+
+		expand_luminance(image);
+		primitive::make_ntsc_safe(image);
+
+		return primitive::build_mip_chain(std::move(image), info.mip_settings,
+										  &util::ThreadPool::shared());
+	}
+
+	MipChain decode_cubemap_face(const primitive::TextureFileInfo & info)
+	{
+		return primitive::build_mip_chain(decode_image(info, SOIL_LOAD_RGB),
+										  info.mip_settings,
+										  &util::ThreadPool::shared());
+	}
+
+	vector<MipChain>
+	decode_parallel(const vector<const primitive::TextureFileInfo *> & files,
+					MipChain (*decode)(const primitive::TextureFileInfo &),
+					util::ThreadPool & pool)
+	{
+		vector<MipChain> decoded(files.size());
+
+		// Workers waiting on tasks queued behind them could deadlock the
+		// pool, so decode serially when called from one of its workers
+		if (pool.current_worker())
+		{
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				decoded[i] = decode(*files[i]);
+			}
+
+			return decoded;
+		}
+
+		vector<std::future<MipChain>> futures;
+		futures.reserve(files.size());
+
+		for (const auto * file : files)
+		{
+			futures.emplace_back(
+				pool.submit([file, decode] { return decode(*file); }));
+		}
+
+		// Wait for every file before rethrowing, so that no task still
+		// refers to the file info once this returns
+		for (auto & future : futures)
+		{
+			future.wait();
+		}
+
+		for (size_t i = 0; i < futures.size(); i++)
+		{
+			decoded[i] = futures[i].get();
+		}
+
+		return decoded;
+	}
+
+	GLenum image_format(const Image & image)
+	{
+		return image.channels == 4 ? GL_RGBA : GL_RGB;
+	}
+
+	GLenum image_internal_format(const Image & image)
+	{
+		return image.channels == 4 ? GL_RGBA8 : GL_RGB8;
+	}
+
+	void set_texture_parameters(GLenum target)
+	{
+		const GLint wrap = target == GL_TEXTURE_CUBE_MAP
+							   ? GL_CLAMP_TO_EDGE
+							   : GL_REPEAT;
+
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER,
+						GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+
+		if (target == GL_TEXTURE_CUBE_MAP)
+		{
+			glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+		}
+	}
+
+	void upload_level(GLenum target, GLint level, const Image & image,
+					  const void * data)
+	{
+		// Rows of RGB images are not padded to 4 bytes
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		glTexImage2D(
+			target, level,
+			static_cast<GLint>(image_internal_format(image)),
+			util::safe_cast<size_t, GLsizei>(image.width),
+			util::safe_cast<size_t, GLsizei>(image.height), 0,
+			image_format(image), GL_UNSIGNED_BYTE, data);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		stats::record_upload(image.pixels.size());
+	}
+
+	void upload_level_buffered(GLuint PBO, GLenum target, GLint level,
+							   const Image & image)
+	{
+		const size_t size = image.pixels.size();
+
+		// Orphaning the buffer before mapping it lets the driver hand out
+		// fresh storage instead of waiting for the previous transfer to
+		// finish
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size),
+					 nullptr, GL_STREAM_DRAW);
+
+		void * mapped = glMapBufferRange(
+			GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+		if (mapped)
+		{
+			std::memcpy(mapped, image.pixels.data(), size);
+
+			if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+			{
+				upload_level(target, level, image, nullptr);
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				return;
+			}
+		}
+
+		// The mapping failed or its contents were lost; copy straight from
+		// client memory instead
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		upload_level(target, level, image, image.pixels.data());
+	}
+
+	GLuint create_compressed_texture(GLenum target, const string & path,
+									 std::uint64_t & bytes)
+	{
+#if !GLGE_APPLE
+		if (!GLEW_EXT_texture_compression_s3tc)
+		{
+			throw std::runtime_error(
+				EXC_MSG("Precompressed textures require S3TC support"));
+		}
+#endif
+
+		// The file is mapped rather than read, so level data goes straight
+		// from the page cache to the driver
+		const util::MappedFile file(path);
+		const TextureContainer container(file.data(), file.size());
+
+		const size_t expected_faces = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+		if (container.face_count() != expected_faces)
+		{
+			throw std::runtime_error(EXC_MSG(
+				"Texture file " + path + " has " +
+				std::to_string(container.face_count()) + " faces; expected " +
+				std::to_string(expected_faces)));
+		}
+
+		const GLenum format = compressed_format(container.format());
+
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		glBindTexture(target, texture);
+
+		bytes = 0;
+
+		for (size_t face = 0; face < container.face_count(); face++)
+		{
+			const GLenum face_target =
+				target == GL_TEXTURE_CUBE_MAP
+					? static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face)
+					: target;
+
+			for (size_t i = 0; i < container.level_count(); i++)
+			{
+				const auto level = container.level(face, i);
+
+				glCompressedTexImage2D(
+					face_target, static_cast<GLint>(i), format,
+					util::safe_cast<size_t, GLsizei>(level.width),
+					util::safe_cast<size_t, GLsizei>(level.height), 0,
+					util::safe_cast<size_t, GLsizei>(level.size), level.data);
+
+				bytes += level.size;
+				stats::record_upload(level.size);
+			}
+		}
+
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,
+						static_cast<GLint>(container.level_count() - 1));
+		set_texture_parameters(target);
+		glBindTexture(target, 0);
+
+		try
+		{
+			throw_if_gl_error("Failed to upload texture file " + path);
+		}
+		catch (...)
+		{
+			glDeleteTextures(1, &texture);
+			throw;
+		}
+
+		return texture;
+	}
+
+	std::uint64_t mip_chain_bytes(const MipChain & levels)
+	{
+		std::uint64_t total = 0;
+
+		for (const Image & level : levels)
+		{
+			total += static_cast<std::uint64_t>(level.width) *
+					 static_cast<std::uint64_t>(level.height) *
+					 texel_bytes(image_internal_format(level));
+		}
+
+		return total;
+	}
+}   // namespace glge::renderer::opengl
+
 namespace glge::renderer::primitive
 {
 	namespace opengl
@@ -14,37 +344,59 @@ namespace glge::renderer::primitive
 		{
 		private:
 			const GLuint id;
+			std::uint64_t gpu_bytes;
 			bool destroy;
 
-			static GLuint load_texture_file(const TextureFileInfo & info)
+			static GLuint
+			create_texture(const renderer::opengl::MipChain & levels)
 			{
-				GLuint texture = SOIL_load_OGL_texture(
-					info.path.c_str(), SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID,
-					SOIL_FLAG_MIPMAPS | SOIL_FLAG_NTSC_SAFE_RGB |
-						SOIL_FLAG_COMPRESS_TO_DXT | SOIL_FLAG_TEXTURE_REPEATS);
+				GLuint texture = 0;
+				glGenTextures(1, &texture);
+				glBindTexture(GL_TEXTURE_2D, texture);
 
-				if (!texture)
+				for (size_t i = 0; i < levels.size(); i++)
 				{
-					czstring soil_err = SOIL_last_result();
-					throw std::runtime_error(
-						EXC_MSG("Failed to load texture file: " + info.path +
-								"\nSOIL error: " + std::string(soil_err)));
+					renderer::opengl::upload_level(
+						GL_TEXTURE_2D, static_cast<GLint>(i), levels[i],
+						levels[i].pixels.data());
 				}
 
+				renderer::opengl::set_texture_parameters(GL_TEXTURE_2D);
+				glBindTexture(GL_TEXTURE_2D, 0);
+
 				return texture;
 			}
 
 		public:
-			void activate() const override { glBindTexture(GL_TEXTURE_2D, id); }
+			void activate() const override
+			{
+				glBindTexture(GL_TEXTURE_2D, id);
+				renderer::stats::record_texture_bind();
+			}
 
 			GLuint getId() { return id; }
 
+			GLTexture(GLuint id, std::uint64_t gpu_bytes) :
+				id(id), gpu_bytes(gpu_bytes), destroy(true)
+			{
+				renderer::stats::record_allocation(
+					renderer::GPUResource::Texture, gpu_bytes);
+			}
+
+			GLTexture(const renderer::opengl::MipChain & levels) :
+				GLTexture(create_texture(levels),
+						  renderer::opengl::mip_chain_bytes(levels))
+			{
+			}
+
 			GLTexture(const TextureFileInfo & info) :
-				id(load_texture_file(info)), destroy(true)
-			{}
+				GLTexture(renderer::opengl::decode_texture(info))
+			{
+			}
 
 			GLTexture(const GLTexture &) = delete;
-			GLTexture(GLTexture && other) : id(other.id), destroy(other.destroy)
+			GLTexture(GLTexture && other) :
+				id(other.id), gpu_bytes(other.gpu_bytes), destroy(other.destroy)
 			{
 				other.destroy = false;
 			}
@@ -56,6 +408,8 @@ namespace glge::renderer::primitive
 			{
 				if (destroy)
 				{
+					renderer::stats::record_release(
+						renderer::GPUResource::Texture, gpu_bytes);
 					glDeleteTextures(1, &id);
 				}
 			}
@@ -66,4 +420,23 @@ namespace glge::renderer::primitive
 	{
 		return std::make_unique<opengl::GLTexture>(file_info);
 	}
+
+	unique_ptr<Texture>
+	Texture::from_compressed_file(const TextureFileInfo & file_info)
+	{
+		std::uint64_t bytes = 0;
+		GLuint id = renderer::opengl::create_compressed_texture(
+			GL_TEXTURE_2D, file_info.path, bytes);
+
+		return std::make_unique<opengl::GLTexture>(id, bytes);
+	}
 }   // namespace glge::renderer::primitive
+
+namespace glge::renderer::opengl
+{
+	unique_ptr<primitive::Texture> adopt_texture(GLuint id,
+												 std::uint64_t bytes)
+	{
+		return std::make_unique<primitive::opengl::GLTexture>(id, bytes);
+	}
+}   // namespace glge::renderer::opengl
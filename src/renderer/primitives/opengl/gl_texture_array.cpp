@@ -0,0 +1,155 @@
+#include "gl_common.h"
+#include "gl_texture.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/texture_array.h>
+#include <glge/renderer/render_stats.h>
+#include <glge/util/thread_pool.h>
+#include <glge/util/util.h>
+#include <internal/util/_util.h>
+
+namespace glge::renderer::primitive
+{
+	namespace opengl
+	{
+		using renderer::opengl::MipChain;
+
+		class GLTextureArray : public TextureArray
+		{
+		private:
+			const GLuint id;
+			const size_t layers;
+			std::uint64_t gpu_bytes;
+
+			static GLuint create_array(const vector<const MipChain *> & layers)
+			{
+				const MipChain & first = *layers.front();
+
+				GLuint texture = 0;
+				glGenTextures(1, &texture);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+				// Rows of RGB images are not padded to 4 bytes
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+				for (size_t level = 0; level < first.size(); level++)
+				{
+					const Image & shape = first[level];
+					const GLenum format =
+						renderer::opengl::image_format(shape);
+					const GLsizei width =
+						util::safe_cast<size_t, GLsizei>(shape.width);
+					const GLsizei height =
+						util::safe_cast<size_t, GLsizei>(shape.height);
+
+					glTexImage3D(
+						GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level),
+						static_cast<GLint>(
+							renderer::opengl::image_internal_format(shape)),
+						width, height,
+						util::safe_cast<size_t, GLsizei>(layers.size()), 0,
+						format, GL_UNSIGNED_BYTE, nullptr);
+
+					for (size_t layer = 0; layer < layers.size(); layer++)
+					{
+						const Image & image = (*layers[layer])[level];
+
+						glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+										static_cast<GLint>(level), 0, 0,
+										static_cast<GLint>(layer), width,
+										height, 1, format, GL_UNSIGNED_BYTE,
+										image.pixels.data());
+
+						renderer::stats::record_upload(image.pixels.size());
+					}
+				}
+
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+				renderer::opengl::set_texture_parameters(GL_TEXTURE_2D_ARRAY);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+				return texture;
+			}
+
+		public:
+			GLTextureArray(const vector<const MipChain *> & layers) :
+				id(create_array(layers)), layers(layers.size()),
+				gpu_bytes(renderer::opengl::mip_chain_bytes(*layers.front()) *
+						  layers.size())
+			{
+				renderer::stats::record_allocation(
+					renderer::GPUResource::Texture, gpu_bytes);
+			}
+
+			GLTextureArray(const GLTextureArray &) = delete;
+			GLTextureArray(GLTextureArray &&) = delete;
+
+			GLTextureArray & operator=(const GLTextureArray &) = delete;
+			GLTextureArray & operator=(GLTextureArray &&) = delete;
+
+			~GLTextureArray()
+			{
+				renderer::stats::record_release(
+					renderer::GPUResource::Texture, gpu_bytes);
+				glDeleteTextures(1, &id);
+			}
+
+			void activate() const override
+			{
+				glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+				renderer::stats::record_texture_bind();
+			}
+
+			size_t layer_count() const override { return layers; }
+		};
+	}   // namespace opengl
+
+	PackedTextures
+	TextureArray::pack(const vector<TextureFileInfo> & file_info)
+	{
+		vector<const TextureFileInfo *> files;
+		for (const auto & info : file_info)
+		{
+			files.push_back(&info);
+		}
+
+		const vector<renderer::opengl::MipChain> decoded =
+			renderer::opengl::decode_parallel(
+				files, renderer::opengl::decode_texture,
+				util::ThreadPool::shared());
+
+		vector<observer_ptr<const Image>> bases;
+		for (const auto & levels : decoded)
+		{
+			bases.push_back(&levels.front());
+		}
+
+		GLint max_layers = 0;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+
+		PackedTextures packed;
+		packed.layers =
+			plan_texture_layers(bases, static_cast<size_t>(max_layers));
+
+		// Layers are handed out in the order of the textures
+		vector<vector<const renderer::opengl::MipChain *>> arrays;
+		for (size_t i = 0; i < decoded.size(); i++)
+		{
+			const size_t array = packed.layers[i].array;
+			if (array >= arrays.size())
+			{
+				arrays.resize(array + 1);
+			}
+			arrays[array].push_back(&decoded[i]);
+		}
+
+		for (const auto & layers : arrays)
+		{
+			packed.arrays.emplace_back(
+				std::make_unique<opengl::GLTextureArray>(layers));
+		}
+
+		return packed;
+	}
+}   // namespace glge::renderer::primitive
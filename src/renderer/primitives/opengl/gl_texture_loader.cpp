@@ -0,0 +1,316 @@
+#include "gl_common.h"
+#include "gl_texture.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/texture_loader.h>
+#include <glge/util/thread_pool.h>
+#include <glge/util/util.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+namespace glge::renderer::primitive
+{
+	namespace opengl
+	{
+		namespace gl = renderer::opengl;
+
+		namespace
+		{
+			struct LevelUpload
+			{
+				GLenum target;
+				GLint level;
+				Image image;
+			};
+
+			// A decoded texture or cubemap waiting to be uploaded
+			struct UploadJob
+			{
+				GLenum target;
+				vector<LevelUpload> levels;
+				std::uint64_t gpu_bytes;
+				// Takes ownership of the texture object once every level
+				// has been uploaded
+				std::function<void(GLuint, std::uint64_t)> complete;
+
+				GLuint id = 0;
+				size_t next_level = 0;
+			};
+
+			// State shared with decode tasks, which may still be running
+			// when the loader is destroyed
+			struct LoaderState
+			{
+				std::mutex mutex;
+				std::deque<UploadJob> decoded;
+				std::atomic<size_t> outstanding = 0;
+
+				void push(UploadJob && job)
+				{
+					std::lock_guard lock(mutex);
+					decoded.emplace_back(std::move(job));
+				}
+
+				std::optional<UploadJob> pop()
+				{
+					std::lock_guard lock(mutex);
+
+					if (decoded.empty())
+					{
+						return std::nullopt;
+					}
+
+					UploadJob job = std::move(decoded.front());
+					decoded.pop_front();
+
+					return job;
+				}
+			};
+
+			// Results of the six face decodes of a cubemap, the last of
+			// which queues the upload
+			struct CubemapDecode
+			{
+				gl::CubemapFaces faces;
+				std::atomic<size_t> remaining = 6;
+				std::mutex error_mutex;
+				std::exception_ptr error;
+			};
+
+			void add_levels(UploadJob & job, GLenum target,
+							gl::MipChain && levels)
+			{
+				for (size_t i = 0; i < levels.size(); i++)
+				{
+					job.levels.emplace_back(LevelUpload{
+						target, static_cast<GLint>(i), std::move(levels[i])});
+				}
+			}
+		}   // namespace
+
+		class GLTextureLoader : public TextureLoader
+		{
+		private:
+			const size_t frame_budget;
+			util::ThreadPool & pool;
+			std::shared_ptr<LoaderState> state;
+
+			std::optional<UploadJob> current;
+			GLuint PBO;
+
+			void upload(const LevelUpload & upload)
+			{
+				gl::upload_level_buffered(PBO, upload.target, upload.level,
+										  upload.image);
+			}
+
+			void finish(UploadJob & job)
+			{
+				glBindTexture(job.target, job.id);
+				gl::set_texture_parameters(job.target);
+				glBindTexture(job.target, 0);
+
+				const GLuint id = job.id;
+				job.id = 0;
+
+				job.complete(id, job.gpu_bytes);
+				state->outstanding--;
+			}
+
+		public:
+			GLTextureLoader(size_t frame_budget,
+							observer_ptr<util::ThreadPool> pool) :
+				frame_budget(frame_budget),
+				pool(pool ? *pool : util::ThreadPool::shared()),
+				state(std::make_shared<LoaderState>()), PBO(0)
+			{
+				glGenBuffers(1, &PBO);
+			}
+
+			GLTextureLoader(const GLTextureLoader &) = delete;
+			GLTextureLoader(GLTextureLoader &&) = delete;
+
+			GLTextureLoader & operator=(const GLTextureLoader &) = delete;
+			GLTextureLoader & operator=(GLTextureLoader &&) = delete;
+
+			~GLTextureLoader()
+			{
+				// Loads still in progress are abandoned; their futures
+				// report a broken promise
+				if (current && current->id)
+				{
+					glDeleteTextures(1, &current->id);
+				}
+
+				glDeleteBuffers(1, &PBO);
+			}
+
+			std::future<unique_ptr<Texture>>
+			load(const TextureFileInfo & file_info) override
+			{
+				auto promise =
+					std::make_shared<std::promise<unique_ptr<Texture>>>();
+				auto result = promise->get_future();
+
+				state->outstanding++;
+
+				pool.post([state = state, info = file_info, promise] {
+					try
+					{
+						gl::MipChain levels = gl::decode_texture(info);
+
+						UploadJob job;
+						job.target = GL_TEXTURE_2D;
+						job.gpu_bytes = gl::mip_chain_bytes(levels);
+						add_levels(job, GL_TEXTURE_2D, std::move(levels));
+						job.complete = [promise](GLuint id,
+												 std::uint64_t bytes) {
+							promise->set_value(gl::adopt_texture(id, bytes));
+						};
+
+						state->push(std::move(job));
+					}
+					catch (...)
+					{
+						promise->set_exception(std::current_exception());
+						state->outstanding--;
+					}
+				});
+
+				return result;
+			}
+
+			std::future<unique_ptr<Cubemap>>
+			load(const CubemapFileInfo & file_info) override
+			{
+				auto promise =
+					std::make_shared<std::promise<unique_ptr<Cubemap>>>();
+				auto result = promise->get_future();
+
+				state->outstanding++;
+
+				auto decode = std::make_shared<CubemapDecode>();
+				const auto files = gl::cubemap_face_files(file_info);
+
+				// Each face is decoded by its own task; whichever finishes
+				// last queues the whole cubemap for upload
+				for (size_t face = 0; face < files.size(); face++)
+				{
+					pool.post([state = state, info = *files[face], face,
+							   decode, promise] {
+						try
+						{
+							decode->faces[face] =
+								gl::decode_cubemap_face(info);
+						}
+						catch (...)
+						{
+							std::lock_guard lock(decode->error_mutex);
+							if (!decode->error)
+							{
+								decode->error = std::current_exception();
+							}
+						}
+
+						if (decode->remaining.fetch_sub(1) != 1)
+						{
+							return;
+						}
+
+						if (decode->error)
+						{
+							promise->set_exception(decode->error);
+							state->outstanding--;
+							return;
+						}
+
+						UploadJob job;
+						job.target = GL_TEXTURE_CUBE_MAP;
+						job.gpu_bytes = 0;
+
+						for (size_t i = 0; i < decode->faces.size(); i++)
+						{
+							job.gpu_bytes +=
+								gl::mip_chain_bytes(decode->faces[i]);
+							add_levels(job,
+									   static_cast<GLenum>(
+										   GL_TEXTURE_CUBE_MAP_POSITIVE_X + i),
+									   std::move(decode->faces[i]));
+						}
+
+						job.complete = [promise](GLuint id,
+												 std::uint64_t bytes) {
+							promise->set_value(gl::adopt_cubemap(id, bytes));
+						};
+
+						state->push(std::move(job));
+					});
+				}
+
+				return result;
+			}
+
+			size_t update() override
+			{
+				size_t uploaded = 0;
+
+				while (true)
+				{
+					if (!current)
+					{
+						current = state->pop();
+
+						if (!current)
+						{
+							break;
+						}
+					}
+
+					UploadJob & job = *current;
+					const LevelUpload & next = job.levels[job.next_level];
+					const size_t size = next.image.pixels.size();
+
+					if (uploaded > 0 && uploaded + size > frame_budget)
+					{
+						break;
+					}
+
+					if (!job.id)
+					{
+						glGenTextures(1, &job.id);
+					}
+
+					glBindTexture(job.target, job.id);
+					upload(next);
+					glBindTexture(job.target, 0);
+
+					uploaded += size;
+
+					if (++job.next_level == job.levels.size())
+					{
+						finish(job);
+						current.reset();
+					}
+				}
+
+				return uploaded;
+			}
+
+			size_t pending() const override
+			{
+				return state->outstanding.load();
+			}
+		};
+	}   // namespace opengl
+
+	unique_ptr<TextureLoader>
+	TextureLoader::create(size_t frame_budget,
+						  observer_ptr<util::ThreadPool> pool)
+	{
+		return std::make_unique<opengl::GLTextureLoader>(frame_budget, pool);
+	}
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,468 @@
+#include "gl_common.h"
+#include "gl_texture.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/texture_residency.h>
+#include <glge/renderer/render_stats.h>
+#include <glge/util/thread_pool.h>
+#include <glge/util/util.h>
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace glge::renderer::primitive
+{
+	namespace opengl
+	{
+		namespace gl = renderer::opengl;
+
+		namespace
+		{
+			// Counted in the same way as mip_chain_bytes
+			std::uint64_t level_bytes(const Image & level)
+			{
+				return static_cast<std::uint64_t>(level.width) *
+					   static_cast<std::uint64_t>(level.height) *
+					   gl::texel_bytes(gl::image_internal_format(level));
+			}
+
+			// A decode which finished, successfully or not
+			struct DecodeResult
+			{
+				size_t index;
+				gl::MipChain levels;
+				std::exception_ptr error;
+			};
+
+			// State shared with decode tasks, which may still be running
+			// when the manager is destroyed
+			struct DecodeState
+			{
+				std::mutex mutex;
+				std::deque<DecodeResult> finished;
+
+				void push(DecodeResult && result)
+				{
+					std::lock_guard lock(mutex);
+					finished.emplace_back(std::move(result));
+				}
+
+				std::optional<DecodeResult> pop()
+				{
+					std::lock_guard lock(mutex);
+
+					if (finished.empty())
+					{
+						return std::nullopt;
+					}
+
+					DecodeResult result = std::move(finished.front());
+					finished.pop_front();
+
+					return result;
+				}
+			};
+		}   // namespace
+
+		// Texture whose levels from resident_level down to 1x1 are defined;
+		// finer levels have no storage, and are excluded from sampling by
+		// GL_TEXTURE_BASE_LEVEL
+		class GLStreamedTexture : public Texture
+		{
+		private:
+			GLuint id;
+			std::uint64_t gpu_bytes;
+
+		public:
+			// Levels held in system memory, finest first; empty until the
+			// file has been decoded
+			gl::MipChain levels;
+			unsigned resident_level;
+
+			GLStreamedTexture() : id(0), gpu_bytes(0), resident_level(0)
+			{
+				glGenTextures(1, &id);
+			}
+
+			GLStreamedTexture(const GLStreamedTexture &) = delete;
+			GLStreamedTexture(GLStreamedTexture &&) = delete;
+
+			GLStreamedTexture & operator=(const GLStreamedTexture &) = delete;
+			GLStreamedTexture & operator=(GLStreamedTexture &&) = delete;
+
+			~GLStreamedTexture()
+			{
+				renderer::stats::record_release(
+					renderer::GPUResource::Texture, gpu_bytes);
+				glDeleteTextures(1, &id);
+			}
+
+			void activate() const override
+			{
+				glBindTexture(GL_TEXTURE_2D, id);
+				renderer::stats::record_texture_bind();
+			}
+
+			std::uint64_t resident_bytes() const { return gpu_bytes; }
+
+			void set_levels(gl::MipChain && decoded)
+			{
+				levels = std::move(decoded);
+				resident_level = static_cast<unsigned>(levels.size());
+
+				glBindTexture(GL_TEXTURE_2D, id);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+								static_cast<GLint>(levels.size() - 1));
+				gl::set_texture_parameters(GL_TEXTURE_2D);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+
+			// Uploads the next finer level, which becomes the base level
+			void upload_next(GLuint PBO)
+			{
+				const unsigned level = resident_level - 1;
+
+				glBindTexture(GL_TEXTURE_2D, id);
+				gl::upload_level_buffered(PBO, GL_TEXTURE_2D,
+										  static_cast<GLint>(level),
+										  levels[level]);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL,
+								static_cast<GLint>(level));
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				resident_level = level;
+				gpu_bytes += level_bytes(levels[level]);
+				renderer::stats::record_allocation(
+					renderer::GPUResource::Texture, level_bytes(levels[level]));
+			}
+
+			// Raises the base level to the given level, releasing the
+			// storage of the finer levels
+			void evict_to(unsigned target)
+			{
+				glBindTexture(GL_TEXTURE_2D, id);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL,
+								static_cast<GLint>(target));
+
+				for (unsigned level = resident_level; level < target; level++)
+				{
+					// Redefining a level as empty frees its storage
+					glTexImage2D(
+						GL_TEXTURE_2D, static_cast<GLint>(level),
+						static_cast<GLint>(
+							gl::image_internal_format(levels[level])),
+						0, 0, 0, gl::image_format(levels[level]),
+						GL_UNSIGNED_BYTE, nullptr);
+
+					gpu_bytes -= level_bytes(levels[level]);
+					renderer::stats::record_release(
+						renderer::GPUResource::Texture,
+						level_bytes(levels[level]));
+				}
+
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				resident_level = target;
+			}
+		};
+
+		class GLTextureResidency : public TextureResidency
+		{
+		private:
+			struct Entry
+			{
+				unique_ptr<GLStreamedTexture> texture;
+				string path;
+				unsigned tail_level = 0;
+				// Finest level wanted this frame; the tail if not drawn
+				unsigned requested_level = tail_level;
+				float priority = 0.0f;
+			};
+
+			const ResidencySettings settings;
+			util::ThreadPool & pool;
+			std::shared_ptr<DecodeState> state;
+
+			vector<Entry> entries;
+			std::unordered_map<const Texture *, size_t> indices;
+			size_t decoding;
+			std::uint64_t requested_bytes;
+
+			GLuint PBO;
+
+			// Returns false, leaving the decode to be reported, if it failed
+			bool receive(DecodeResult && result)
+			{
+				Entry & entry = entries[result.index];
+				decoding--;
+
+				if (result.error)
+				{
+					return false;
+				}
+
+				const gl::MipChain & levels = result.levels;
+
+				entry.tail_level = static_cast<unsigned>(levels.size() - 1);
+				while (entry.tail_level > 0 &&
+					   std::max(levels[entry.tail_level - 1].width,
+								levels[entry.tail_level - 1].height) <=
+						   settings.tail_size)
+				{
+					entry.tail_level--;
+				}
+
+				entry.requested_level =
+					entry.priority > 0.0f
+						? required_mip_level(levels[0].width,
+											 levels[0].height, entry.priority)
+						: entry.tail_level;
+
+				entry.texture->set_levels(std::move(result.levels));
+
+				return true;
+			}
+
+			vector<ResidencyRequest> build_requests()
+			{
+				vector<ResidencyRequest> requests(entries.size());
+				requested_bytes = 0;
+
+				for (size_t i = 0; i < entries.size(); i++)
+				{
+					const Entry & entry = entries[i];
+					const gl::MipChain & levels = entry.texture->levels;
+					ResidencyRequest & request = requests[i];
+
+					for (const Image & level : levels)
+					{
+						request.level_bytes.push_back(level_bytes(level));
+					}
+
+					// Textures not drawn this frame want only their tails
+					request.tail_level = entry.tail_level;
+					request.requested_level =
+						entry.priority > 0.0f
+							? std::min(entry.requested_level, entry.tail_level)
+							: entry.tail_level;
+					request.priority = entry.priority;
+
+					for (size_t level = request.requested_level;
+						 level < levels.size(); level++)
+					{
+						requested_bytes += request.level_bytes[level];
+					}
+				}
+
+				return requests;
+			}
+
+		public:
+			GLTextureResidency(const ResidencySettings & settings,
+							   observer_ptr<util::ThreadPool> pool) :
+				settings(settings),
+				pool(pool ? *pool : util::ThreadPool::shared()),
+				state(std::make_shared<DecodeState>()), decoding(0),
+				requested_bytes(0), PBO(0)
+			{
+				glGenBuffers(1, &PBO);
+			}
+
+			GLTextureResidency(const GLTextureResidency &) = delete;
+			GLTextureResidency(GLTextureResidency &&) = delete;
+
+			GLTextureResidency &
+			operator=(const GLTextureResidency &) = delete;
+			GLTextureResidency & operator=(GLTextureResidency &&) = delete;
+
+			~GLTextureResidency() { glDeleteBuffers(1, &PBO); }
+
+			Texture & add(const TextureFileInfo & file_info) override
+			{
+				Entry entry;
+				entry.texture = std::make_unique<GLStreamedTexture>();
+				entry.path = file_info.path;
+
+				const size_t index = entries.size();
+				Texture & texture = *entry.texture;
+
+				indices.emplace(&texture, index);
+				entries.emplace_back(std::move(entry));
+				decoding++;
+
+				pool.post([state = state, info = file_info, index] {
+					DecodeResult result{index, {}, nullptr};
+
+					try
+					{
+						result.levels = gl::decode_texture(info);
+					}
+					catch (...)
+					{
+						result.error = std::current_exception();
+					}
+
+					state->push(std::move(result));
+				});
+
+				return texture;
+			}
+
+			void request(const Texture & texture, float screen_size) override
+			{
+				auto iter = indices.find(&texture);
+				if (iter == indices.end())
+				{
+					return;
+				}
+
+				Entry & entry = entries[iter->second];
+				const float pixels = screen_size * settings.viewport_height;
+
+				if (!(pixels > entry.priority))
+				{
+					return;
+				}
+
+				entry.priority = pixels;
+
+				const gl::MipChain & levels = entry.texture->levels;
+				if (!levels.empty())
+				{
+					entry.requested_level = required_mip_level(
+						levels[0].width, levels[0].height, pixels);
+				}
+			}
+
+			size_t update() override
+			{
+				std::exception_ptr error;
+				string failed_path;
+
+				while (auto result = state->pop())
+				{
+					const size_t index = result->index;
+					if (!receive(std::move(*result)) && !error)
+					{
+						error = result->error;
+						failed_path = entries[index].path;
+					}
+				}
+
+				const vector<ResidencyRequest> requests = build_requests();
+				const vector<unsigned> targets =
+					plan_residency(requests, settings.budget_bytes);
+
+				vector<size_t> wanting;
+
+				for (size_t i = 0; i < entries.size(); i++)
+				{
+					GLStreamedTexture & texture = *entries[i].texture;
+
+					if (texture.levels.empty())
+					{
+						continue;
+					}
+
+					if (targets[i] > texture.resident_level)
+					{
+						texture.evict_to(targets[i]);
+					}
+					else if (targets[i] < texture.resident_level)
+					{
+						wanting.push_back(i);
+					}
+				}
+
+				// Textures with nothing resident come first, then those
+				// largest on screen
+				std::stable_sort(
+					wanting.begin(), wanting.end(), [&](size_t a, size_t b) {
+						const auto key = [&](size_t i) {
+							const GLStreamedTexture & texture =
+								*entries[i].texture;
+							return std::make_pair(
+								texture.resident_level ==
+									texture.levels.size(),
+								entries[i].priority);
+						};
+
+						return key(a) > key(b);
+					});
+
+				size_t uploaded = 0;
+
+				for (size_t i : wanting)
+				{
+					GLStreamedTexture & texture = *entries[i].texture;
+
+					while (texture.resident_level > targets[i])
+					{
+						const size_t size =
+							texture.levels[texture.resident_level - 1]
+								.pixels.size();
+
+						if (uploaded > 0 &&
+							uploaded + size > settings.frame_budget)
+						{
+							break;
+						}
+
+						texture.upload_next(PBO);
+						uploaded += size;
+					}
+				}
+
+				// Sizes are reported afresh every frame
+				for (Entry & entry : entries)
+				{
+					entry.priority = 0.0f;
+					entry.requested_level = entry.tail_level;
+				}
+
+				if (error)
+				{
+					try
+					{
+						std::rethrow_exception(error);
+					}
+					catch (const std::exception & e)
+					{
+						throw std::runtime_error(
+							EXC_MSG("Failed to stream texture " + failed_path +
+									"\n" + e.what()));
+					}
+				}
+
+				return uploaded;
+			}
+
+			ResidencyStats statistics() const override
+			{
+				ResidencyStats result;
+
+				for (const Entry & entry : entries)
+				{
+					result.resident_bytes += entry.texture->resident_bytes();
+				}
+
+				result.requested_bytes = requested_bytes;
+				result.budget_bytes = settings.budget_bytes;
+				result.decoding = decoding;
+
+				return result;
+			}
+		};
+	}   // namespace opengl
+
+	unique_ptr<TextureResidency>
+	TextureResidency::create(const ResidencySettings & settings,
+							 observer_ptr<util::ThreadPool> pool)
+	{
+		return std::make_unique<opengl::GLTextureResidency>(settings, pool);
+	}
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,350 @@
+#include "gl_common.h"
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/virtual_texture.h>
+#include <glge/renderer/render_stats.h>
+#include <glge/util/thread_pool.h>
+#include <glge/util/util.h>
+#include <internal/renderer/_page_file.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+namespace glge::renderer::primitive
+{
+	namespace opengl
+	{
+		namespace
+		{
+			// A page read from the page file, waiting for upload
+			struct PageRead
+			{
+				PageId page;
+				vector<std::uint8_t> texels;
+			};
+
+			// State shared with read tasks, which may still be running when
+			// the texture is destroyed
+			struct ReadState
+			{
+				std::mutex mutex;
+				std::deque<PageRead> finished;
+
+				void push(PageRead && read)
+				{
+					std::lock_guard lock(mutex);
+					finished.emplace_back(std::move(read));
+				}
+
+				std::deque<PageRead> take()
+				{
+					std::lock_guard lock(mutex);
+					return std::exchange(finished, {});
+				}
+			};
+
+			bool in_layout(const PageLayout & layout, PageId page)
+			{
+				return page.level < layout.level_count &&
+					   page.x < layout.pages_x(page.level) &&
+					   page.y < layout.pages_y(page.level);
+			}
+		}   // namespace
+
+		class GLVirtualTexture : public VirtualTexture
+		{
+		private:
+			const VirtualTextureSettings settings;
+			util::ThreadPool & pool;
+			const std::shared_ptr<const PageFile> file;
+			std::shared_ptr<ReadState> state;
+
+			PageCache cache;
+			IndirectionTable table;
+
+			// Keys of the pages being read or waiting for upload
+			std::unordered_set<std::uint32_t> loading;
+			std::deque<PageRead> ready;
+			size_t requested;
+
+			GLuint cache_id, indirection_id;
+			std::uint64_t gpu_bytes;
+
+			void upload_page(PageId page, const std::uint8_t * texels,
+							 bool pinned)
+			{
+				const auto insertion = cache.insert(page, pinned);
+				if (!insertion)
+				{
+					return;
+				}
+
+				if (insertion->evicted)
+				{
+					table.unmap(*insertion->evicted);
+				}
+
+				const PageLayout & pages = file->layout();
+				const size_t padded = pages.padded_size();
+				const size_t slot_x = insertion->slot % settings.cache_pages;
+				const size_t slot_y = insertion->slot / settings.cache_pages;
+
+				glBindTexture(GL_TEXTURE_2D, cache_id);
+				glTexSubImage2D(GL_TEXTURE_2D, 0,
+								static_cast<GLint>(slot_x * padded),
+								static_cast<GLint>(slot_y * padded),
+								static_cast<GLsizei>(padded),
+								static_cast<GLsizei>(padded), GL_RGBA,
+								GL_UNSIGNED_BYTE, texels);
+				glBindTexture(GL_TEXTURE_2D, 0);
+				renderer::stats::record_upload(pages.page_bytes());
+
+				table.map(page, slot_x, slot_y);
+			}
+
+			void upload_indirection()
+			{
+				const PageLayout & pages = file->layout();
+
+				glBindTexture(GL_TEXTURE_2D, indirection_id);
+
+				for (size_t level = 0; level < pages.level_count; level++)
+				{
+					if (!table.take_dirty(level))
+					{
+						continue;
+					}
+
+					const auto & entries = table.level(level);
+					glTexSubImage2D(
+						GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+						static_cast<GLsizei>(pages.pages_x(level)),
+						static_cast<GLsizei>(pages.pages_y(level)), GL_RGBA,
+						GL_UNSIGNED_BYTE, entries.data());
+					renderer::stats::record_upload(
+						entries.size() * sizeof(IndirectionTable::Entry));
+				}
+
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+
+		public:
+			GLVirtualTexture(const string & path,
+							 const VirtualTextureSettings & settings) :
+				settings(settings),
+				pool(settings.pool ? *settings.pool
+								   : util::ThreadPool::shared()),
+				file(std::make_shared<const PageFile>(path)),
+				state(std::make_shared<ReadState>()),
+				cache(settings.cache_pages * settings.cache_pages),
+				table(file->layout()), requested(0), cache_id(0),
+				indirection_id(0), gpu_bytes(0)
+			{
+				const PageLayout & pages = file->layout();
+				const size_t coarsest = pages.level_count - 1;
+
+				if (settings.cache_pages == 0 || settings.cache_pages > 256 ||
+					pages.pages_x(coarsest) * pages.pages_y(coarsest) >=
+						cache.capacity())
+				{
+					throw std::invalid_argument(EXC_MSG(
+						"Virtual texture cache is too small for " + path));
+				}
+
+				const size_t cache_size = settings.cache_pages *
+										  pages.padded_size();
+
+				glGenTextures(1, &cache_id);
+				glBindTexture(GL_TEXTURE_2D, cache_id);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8,
+							 static_cast<GLsizei>(cache_size),
+							 static_cast<GLsizei>(cache_size), 0, GL_RGBA,
+							 GL_UNSIGNED_BYTE, nullptr);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+								GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+								GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+								GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+								GL_CLAMP_TO_EDGE);
+				gpu_bytes += cache_size * cache_size * 4;
+
+				// One texel per page, with a level per level of the pages,
+				// read with texelFetch
+				glGenTextures(1, &indirection_id);
+				glBindTexture(GL_TEXTURE_2D, indirection_id);
+				for (size_t level = 0; level < pages.level_count; level++)
+				{
+					glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level),
+								 GL_RGBA8,
+								 static_cast<GLsizei>(pages.pages_x(level)),
+								 static_cast<GLsizei>(pages.pages_y(level)),
+								 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+					gpu_bytes += pages.pages_x(level) * pages.pages_y(level) *
+								 sizeof(IndirectionTable::Entry);
+				}
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+								static_cast<GLint>(coarsest));
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+								GL_NEAREST_MIPMAP_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+								GL_NEAREST);
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				renderer::stats::record_allocation(
+					renderer::GPUResource::Texture, gpu_bytes);
+
+				// The coarsest level covers the whole texture, so that there
+				// is always a page to fall back to
+				for (std::uint32_t y = 0; y < pages.pages_y(coarsest); y++)
+				{
+					for (std::uint32_t x = 0; x < pages.pages_x(coarsest); x++)
+					{
+						const PageId page{
+							static_cast<std::uint32_t>(coarsest), x, y};
+						upload_page(page, file->page(page), true);
+					}
+				}
+
+				upload_indirection();
+			}
+
+			GLVirtualTexture(const GLVirtualTexture &) = delete;
+			GLVirtualTexture(GLVirtualTexture &&) = delete;
+
+			GLVirtualTexture & operator=(const GLVirtualTexture &) = delete;
+			GLVirtualTexture & operator=(GLVirtualTexture &&) = delete;
+
+			~GLVirtualTexture()
+			{
+				renderer::stats::record_release(renderer::GPUResource::Texture,
+												gpu_bytes);
+				glDeleteTextures(1, &indirection_id);
+				glDeleteTextures(1, &cache_id);
+			}
+
+			void activate() const override
+			{
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, indirection_id);
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, cache_id);
+				renderer::stats::record_texture_bind();
+				renderer::stats::record_texture_bind();
+			}
+
+			const PageLayout & layout() const override
+			{
+				return file->layout();
+			}
+
+			size_t cache_pages() const override
+			{
+				return settings.cache_pages;
+			}
+
+			void submit_feedback(const Image & feedback) override
+			{
+				vector<PageId> pages = decode_feedback(feedback);
+				pages.erase(std::remove_if(pages.begin(), pages.end(),
+										   [&](PageId page) {
+											   return !in_layout(
+												   file->layout(), page);
+										   }),
+							pages.end());
+
+				requested = pages.size();
+
+				// Least seen first, so that the most seen pages end up the
+				// most recently used
+				for (auto iter = pages.rbegin(); iter != pages.rend(); ++iter)
+				{
+					cache.find(*iter);
+				}
+
+				for (PageId page : pages)
+				{
+					// Reading more pages than the cache holds would only
+					// evict pages which are still in view
+					if (loading.size() >= cache.capacity())
+					{
+						break;
+					}
+
+					if (cache.contains(page) ||
+						!loading.insert(page.key()).second)
+					{
+						continue;
+					}
+
+					pool.post([state = state, file = file, page] {
+						const size_t size = file->layout().page_bytes();
+						PageRead read{page, vector<std::uint8_t>(size)};
+
+						std::memcpy(read.texels.data(), file->page(page),
+									size);
+						state->push(std::move(read));
+					});
+				}
+			}
+
+			size_t update() override
+			{
+				for (PageRead & read : state->take())
+				{
+					ready.emplace_back(std::move(read));
+				}
+
+				size_t uploaded = 0;
+
+				while (!ready.empty() && uploaded < settings.pages_per_update)
+				{
+					PageRead read = std::move(ready.front());
+					ready.pop_front();
+					loading.erase(read.page.key());
+
+					if (!cache.contains(read.page))
+					{
+						upload_page(read.page, read.texels.data(), false);
+						uploaded++;
+					}
+				}
+
+				upload_indirection();
+
+				if constexpr (debug)
+				{
+					renderer::opengl::throw_if_gl_error(
+						EXC_MSG("OpenGL error updating virtual texture"));
+				}
+
+				return uploaded;
+			}
+
+			VirtualTextureStats statistics() const override
+			{
+				VirtualTextureStats result;
+
+				result.resident_pages = cache.size();
+				result.requested_pages = requested;
+				result.loading_pages = loading.size();
+				result.capacity = cache.capacity();
+
+				return result;
+			}
+		};
+	}   // namespace opengl
+
+	unique_ptr<VirtualTexture>
+	VirtualTexture::from_page_file(const string & path,
+								   const VirtualTextureSettings & settings)
+	{
+		return std::make_unique<opengl::GLVirtualTexture>(path, settings);
+	}
+}   // namespace glge::renderer::primitive
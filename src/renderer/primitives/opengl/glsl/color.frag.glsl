@@ -7,4 +7,11 @@ out vec4 color;
 void main()
 {    
 	color = vec4(in_color, 1.0f);
+
+#ifdef GLGE_FADE
+	if (faded_out())
+	{
+		discard;
+	}
+#endif
 }
\ No newline at end of file
@@ -4,6 +4,8 @@ layout (location = 0) in vec3 in_pos;
 
 uniform mat4 MVP;
 
+invariant gl_Position;
+
 void main()
 {
     gl_Position = MVP * vec4(in_pos.xyz, 1.0);
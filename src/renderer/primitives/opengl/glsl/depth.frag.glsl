@@ -0,0 +1,11 @@
+#version 330 core
+
+void main()
+{
+#ifdef GLGE_FADE
+	if (faded_out())
+	{
+		discard;
+	}
+#endif
+}
@@ -0,0 +1,14 @@
+#version 330 core
+
+layout (location = 0) in vec3 in_pos;
+
+uniform mat4 MVP;
+
+// Must match the position computed by the shading pass exactly, so that
+// the shading pass passes the depth test against the pre-pass depth
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = MVP * vec4(in_pos.xyz, 1.0);
+}
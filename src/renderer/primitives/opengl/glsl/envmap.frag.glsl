@@ -12,4 +12,11 @@ void main()
     vec3 I = normalize(pos - camPos);
     vec3 R = reflect(I, normal);
     color = vec4(texture(skybox, R).rgb, 1.0f);
+
+#ifdef GLGE_FADE
+	if (faded_out())
+	{
+		discard;
+	}
+#endif
 }
\ No newline at end of file
@@ -8,6 +8,8 @@ out vec3 pos;
 uniform mat4 model;
 uniform mat4 MVP;
 
+invariant gl_Position;
+
 void main()
 {
     normal = mat3(transpose(inverse(model))) * in_norm;
@@ -0,0 +1,16 @@
+// Declarations inserted after the #version line of the fade variant
+// of each program that fades; see gl_shader.cpp
+
+// Fraction of pixels drawn, for dithered cross-fades between levels of
+// detail; a negative fade draws the pixels left out by 1 + fade
+uniform float fade;
+
+// Whether fade leaves out this pixel, by a 4x4 ordered dither
+bool faded_out()
+{
+	const int bayer[16] = int[16](0, 8, 2, 10, 12, 4, 14, 6,
+								  3, 11, 1, 9, 15, 7, 13, 5);
+	ivec2 cell = ivec2(gl_FragCoord.xy) & 3;
+	float threshold = (float(bayer[cell.y * 4 + cell.x]) + 0.5f) / 16.0f;
+	return fade >= 0.0f ? threshold >= fade : threshold < 1.0f + fade;
+}
@@ -7,4 +7,11 @@ out vec4 color;
 void main()
 {
     color = vec4((normal.r + 1.0) / 2.0, (normal.g + 1.0) / 2.0, (normal.b + 1.0) / 2.0, 1.0f);
+
+#ifdef GLGE_FADE
+	if (faded_out())
+	{
+		discard;
+	}
+#endif
 }
@@ -7,6 +7,8 @@ out vec3 normal;
 
 uniform mat4 MVP;
 
+invariant gl_Position;
+
 void main()
 {
     // OpenGL maintains the D matrix so you only need to multiply by P, V (aka C inverse), and M
@@ -6,6 +6,8 @@ out vec3 tex_coord;
 
 uniform mat4 MVP;
 
+invariant gl_Position;
+
 void main()
 {
     gl_Position = MVP * vec4(position.x, position.y, position.z, 1.0);
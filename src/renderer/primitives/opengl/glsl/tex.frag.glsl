@@ -9,4 +9,11 @@ uniform sampler2D tex;
 void main()
 {    
 	color = texture(tex, tex_coord);
+
+#ifdef GLGE_FADE
+	if (faded_out())
+	{
+		discard;
+	}
+#endif
 }
\ No newline at end of file
@@ -11,6 +11,8 @@ out vec2 tex_coord;
 
 // Uniform variables can be updated by fetching their location and passing values to that location
 uniform mat4 MVP;
+
+invariant gl_Position;
 uniform mat4 model;
 
 void main()
@@ -0,0 +1,22 @@
+#version 330 core
+
+in vec2 tex_coord;
+
+out vec4 color;
+
+uniform sampler2DArray tex;
+// Layer of the array to sample; a float, as texture() takes the layer as
+// the third texture coordinate
+uniform float layer;
+
+void main()
+{
+	color = texture(tex, vec3(tex_coord, layer));
+
+#ifdef GLGE_FADE
+	if (faded_out())
+	{
+		discard;
+	}
+#endif
+}
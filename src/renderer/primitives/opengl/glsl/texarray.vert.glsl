@@ -0,0 +1,17 @@
+#version 330 core
+
+layout (location = 0) in vec3 in_pos;
+layout (location = 1) in vec3 in_normal;
+layout (location = 2) in vec2 in_uv;
+
+out vec2 tex_coord;
+
+uniform mat4 MVP;
+
+invariant gl_Position;
+
+void main()
+{
+	gl_Position = MVP * vec4(in_pos, 1.0f);
+	tex_coord = in_uv;
+}
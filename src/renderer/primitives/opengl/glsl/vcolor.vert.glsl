@@ -0,0 +1,16 @@
+#version 330 core
+
+layout (location = 0) in vec3 in_pos;
+layout (location = 1) in vec3 in_color;
+
+out vec3 vertex_color;
+
+uniform mat4 MVP;
+
+invariant gl_Position;
+
+void main()
+{
+	gl_Position = MVP * vec4(in_pos, 1.0f);
+	vertex_color = in_color;
+}
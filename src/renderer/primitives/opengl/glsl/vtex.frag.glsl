@@ -0,0 +1,47 @@
+#version 330 core
+
+in vec2 tex_coord;
+
+out vec4 color;
+
+// Cache of pages, each surrounded by a border, cache_pages across
+uniform sampler2D cache;
+// One texel per page of each level, naming the cache slot and level of the
+// finest cached page covering it
+uniform sampler2D indirection;
+// Size of the finest level, in texels
+uniform vec2 virtual_size;
+uniform float page_size;
+uniform float border;
+uniform float cache_pages;
+uniform float max_level;
+
+void main()
+{
+	vec2 uv = clamp(tex_coord, 0.0f, 1.0f);
+	vec2 texel = uv * virtual_size;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5f * log2(max(dot(dx, dx), dot(dy, dy)));
+	int level = int(clamp(floor(lod), 0.0f, max_level));
+
+	ivec2 page = min(ivec2(texel / page_size) >> level,
+					 textureSize(indirection, level) - 1);
+	vec4 entry = round(texelFetch(indirection, page, level) * 255.0f);
+
+	// Position within the cached page, at the level it holds
+	vec2 level_texel = texel / exp2(entry.z);
+	vec2 in_page = min(mod(level_texel, page_size), page_size - 0.5f);
+
+	float padded = page_size + 2.0f * border;
+	vec2 cache_texel = entry.xy * padded + border + in_page;
+
+	color = textureLod(cache, cache_texel / (cache_pages * padded), 0.0f);
+
+#ifdef GLGE_FADE
+	if (faded_out())
+	{
+		discard;
+	}
+#endif
+}
@@ -0,0 +1,29 @@
+#version 330 core
+
+in vec2 tex_coord;
+
+out vec4 color;
+
+// Size of the finest level, in texels
+uniform vec2 virtual_size;
+uniform float page_size;
+uniform float max_level;
+// Added to the level of detail, as the feedback pass is drawn smaller
+// than the screen
+uniform float lod_bias;
+
+// Writes the page needed at each pixel, encoded as by encode_feedback
+void main()
+{
+	vec2 texel = clamp(tex_coord, 0.0f, 1.0f) * virtual_size;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5f * log2(max(dot(dx, dx), dot(dy, dy))) + lod_bias;
+	int level = int(clamp(floor(lod), 0.0f, max_level));
+
+	ivec2 pages = max(ivec2(virtual_size / page_size) >> level, 1);
+	ivec2 page = min(ivec2(texel / page_size) >> level, pages - 1);
+
+	color = vec4(page.x & 255, page.y & 255,
+				 (page.x >> 8) | ((page.y >> 8) << 4), level + 1) / 255.0f;
+}
@@ -9,6 +9,23 @@
 
 namespace glge::renderer::primitive
 {
+	EBOModelData::EBOModelData(Vertices vertices, Normals normals,
+							   TexCoords uvs, Indices indices) :
+		vertices(std::move(vertices)),
+		normals(std::move(normals)), uvs(std::move(uvs)),
+		indices(std::move(indices))
+	{
+		const auto per_vertex = [&](size_t size) {
+			return size == 0 || size == this->vertices.size();
+		};
+
+		if (!per_vertex(this->normals.size()) || !per_vertex(this->uvs.size()))
+		{
+			throw std::invalid_argument(
+				EXC_MSG("Model attributes must have one entry per vertex"));
+		}
+	}
+
 	EBOModelData::EBOModelData(const ModelData & model_data) :
 		EBOModelData(ModelData(model_data))
 	{
@@ -21,6 +38,7 @@ namespace glge::renderer::primitive
 			this->normals = std::move(model_data.normal_data.points);
 			this->uvs = std::move(model_data.uv_data.points);
 			this->indices = std::move(model_data.vertex_data.indices);
+			this->triangle_bvh = std::move(model_data.triangle_bvh);
 		};
 
 		if (model_data.vertex_data.points.size() ==
@@ -64,4 +82,9 @@ namespace glge::renderer::primitive
 				"Failed processing model info - model file may be invalid")));
 		}
 	}
+
+	void EBOModelData::build_triangle_bvh()
+	{
+		triangle_bvh = math::TriangleBVH::from_mesh(vertices, indices);
+	}
 }   // namespace glge::renderer::primitive
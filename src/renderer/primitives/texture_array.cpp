@@ -0,0 +1,50 @@
+#include "glge/renderer/primitives/texture_array.h"
+
+#include <glge/util/util.h>
+
+#include <map>
+#include <tuple>
+
+namespace glge::renderer::primitive
+{
+	vector<TextureLayer>
+	plan_texture_layers(const vector<observer_ptr<const Image>> & bases,
+						size_t max_layers)
+	{
+		if (max_layers == 0)
+		{
+			throw std::invalid_argument(
+				EXC_MSG("Texture arrays must allow at least one layer"));
+		}
+
+		// Group textures by everything that must match within an array;
+		// an ordered map keeps the order of the arrays deterministic
+		std::map<std::tuple<size_t, size_t, size_t>, vector<size_t>> groups;
+		for (size_t i = 0; i < bases.size(); i++)
+		{
+			const Image & base = *bases[i];
+			groups[{base.width, base.height, base.channels}].push_back(i);
+		}
+
+		vector<TextureLayer> layers(bases.size());
+		size_t array = 0;
+
+		for (const auto & group : groups)
+		{
+			const vector<size_t> & members = group.second;
+
+			for (size_t i = 0; i < members.size(); i++)
+			{
+				if (i > 0 && i % max_layers == 0)
+				{
+					array++;
+				}
+				layers[members[i]] = TextureLayer{
+					array, static_cast<unsigned>(i % max_layers)};
+			}
+			array++;
+		}
+
+		return layers;
+	}
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,110 @@
+#include "glge/renderer/primitives/texture_residency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <tuple>
+
+namespace glge::renderer::primitive
+{
+	unsigned required_mip_level(size_t width, size_t height, float pixels)
+	{
+		const size_t size = std::max({width, height, size_t(1)});
+
+		unsigned coarsest = 0;
+		while ((size >> coarsest) > 1)
+		{
+			coarsest++;
+		}
+
+		if (!(pixels >= 1.0f))
+		{
+			return coarsest;
+		}
+
+		const float level = std::floor(
+			std::log2(static_cast<float>(size) / pixels));
+
+		if (!(level > 0.0f))
+		{
+			return 0;
+		}
+
+		return std::min(static_cast<unsigned>(level), coarsest);
+	}
+
+	vector<unsigned> plan_residency(const vector<ResidencyRequest> & requests,
+									std::uint64_t budget)
+	{
+		vector<unsigned> targets(requests.size());
+		std::uint64_t used = 0;
+
+		// Ordered by whether the texture was drawn this frame, then its
+		// distance from the requested level, then its size on screen;
+		// earlier requests win ties
+		using Candidate = std::tuple<bool, unsigned, float, size_t>;
+		const auto lower = [](const Candidate & a, const Candidate & b) {
+			if (std::tie(std::get<0>(a), std::get<1>(a), std::get<2>(a)) !=
+				std::tie(std::get<0>(b), std::get<1>(b), std::get<2>(b)))
+			{
+				return a < b;
+			}
+
+			return std::get<3>(a) > std::get<3>(b);
+		};
+		std::priority_queue<Candidate, vector<Candidate>, decltype(lower)>
+			candidates(lower);
+
+		const auto push = [&](size_t i) {
+			const ResidencyRequest & request = requests[i];
+
+			if (targets[i] > request.requested_level)
+			{
+				candidates.emplace(request.priority > 0.0f,
+								   targets[i] - request.requested_level,
+								   request.priority, i);
+			}
+		};
+
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			const ResidencyRequest & request = requests[i];
+
+			if (request.level_bytes.empty())
+			{
+				continue;
+			}
+
+			const unsigned coarsest =
+				static_cast<unsigned>(request.level_bytes.size() - 1);
+			targets[i] = std::min(request.tail_level, coarsest);
+
+			for (unsigned level = targets[i]; level <= coarsest; level++)
+			{
+				used += request.level_bytes[level];
+			}
+
+			push(i);
+		}
+
+		while (!candidates.empty())
+		{
+			const size_t i = std::get<3>(candidates.top());
+			candidates.pop();
+
+			// Finer levels only grow, so a texture whose next level does
+			// not fit gets no more
+			const std::uint64_t cost = requests[i].level_bytes[targets[i] - 1];
+			if (used + cost > budget)
+			{
+				continue;
+			}
+
+			used += cost;
+			targets[i]--;
+			push(i);
+		}
+
+		return targets;
+	}
+}   // namespace glge::renderer::primitive
@@ -0,0 +1,463 @@
+#include "glge/renderer/primitives/virtual_texture.h"
+
+#include <internal/renderer/_page_file.h>
+#include <internal/util/_util.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace glge::renderer
+{
+	namespace primitive
+	{
+		namespace
+		{
+			bool is_power_of_two(size_t value)
+			{
+				return value != 0 && (value & (value - 1)) == 0;
+			}
+
+			size_t level_extent(size_t extent, size_t level)
+			{
+				return std::max<size_t>(extent >> level, 1);
+			}
+
+			// Copies a page and its border out of a level, repeating the
+			// edge texels past the edges of the level
+			void extract_page(const Image & level, const PageLayout & layout,
+							  PageId page, vector<std::uint8_t> & out)
+			{
+				const size_t padded = layout.padded_size();
+				out.resize(layout.page_bytes());
+
+				const auto clamp = [&](size_t start, size_t i, size_t extent) {
+					const std::ptrdiff_t texel =
+						static_cast<std::ptrdiff_t>(start + i) -
+						static_cast<std::ptrdiff_t>(layout.border);
+
+					return static_cast<size_t>(std::clamp<std::ptrdiff_t>(
+						texel, 0, static_cast<std::ptrdiff_t>(extent) - 1));
+				};
+
+				auto texel_out = out.begin();
+				for (size_t j = 0; j < padded; j++)
+				{
+					const size_t y =
+						clamp(page.y * layout.page_size, j, level.height);
+
+					for (size_t i = 0; i < padded; i++)
+					{
+						const size_t x =
+							clamp(page.x * layout.page_size, i, level.width);
+						const std::uint8_t * texel = level.pixel(x, y);
+
+						*texel_out++ = texel[0];
+						*texel_out++ = texel[1];
+						*texel_out++ = texel[2];
+						*texel_out++ = level.channels == 4 ? texel[3] : 255;
+					}
+				}
+			}
+		}   // namespace
+
+		PageLayout PageLayout::for_image(size_t width, size_t height,
+										 size_t page_size, size_t border)
+		{
+			if (page_size == 0 || width % page_size != 0 ||
+				height % page_size != 0 ||
+				!is_power_of_two(width / page_size) ||
+				!is_power_of_two(height / page_size))
+			{
+				throw std::invalid_argument(EXC_MSG(
+					"Virtual texture sizes must be power of two multiples "
+					"of the page size"));
+			}
+
+			const size_t pages = std::max(width, height) / page_size;
+			if (pages > max_virtual_pages || border > page_size)
+			{
+				throw std::invalid_argument(
+					EXC_MSG("Virtual texture has too many pages, or too "
+							"wide a border"));
+			}
+
+			size_t level_count = 1;
+			while ((std::min(width, height) / page_size) >>
+				   (level_count - 1) > 1)
+			{
+				level_count++;
+			}
+
+			return PageLayout{width, height, page_size, border, level_count};
+		}
+
+		size_t PageLayout::pages_x(size_t level) const
+		{
+			return level_extent(width / page_size, level);
+		}
+
+		size_t PageLayout::pages_y(size_t level) const
+		{
+			return level_extent(height / page_size, level);
+		}
+
+		void write_page_file(const string & path, const vector<Image> & levels,
+							 size_t page_size, size_t border)
+		{
+			if (levels.empty())
+			{
+				throw std::invalid_argument(
+					EXC_MSG("A page file must have at least one level"));
+			}
+
+			const PageLayout layout = PageLayout::for_image(
+				levels[0].width, levels[0].height, page_size, border);
+
+			if (levels.size() < layout.level_count)
+			{
+				throw std::invalid_argument(
+					EXC_MSG("Page file levels do not form a mip chain"));
+			}
+
+			for (size_t i = 0; i < layout.level_count; i++)
+			{
+				if (levels[i].width != level_extent(layout.width, i) ||
+					levels[i].height != level_extent(layout.height, i) ||
+					levels[i].channels < 3)
+				{
+					throw std::invalid_argument(EXC_MSG(
+						"Page file levels must be an RGB(A) mip chain"));
+				}
+			}
+
+			const PageFileHeader header{
+				page_file_magic,
+				page_file_version,
+				util::safe_cast<size_t, std::uint32_t>(layout.width),
+				util::safe_cast<size_t, std::uint32_t>(layout.height),
+				util::safe_cast<size_t, std::uint32_t>(layout.page_size),
+				util::safe_cast<size_t, std::uint32_t>(layout.border),
+				static_cast<std::uint32_t>(layout.level_count),
+				0};
+
+			std::ofstream file = util::open_file_write(path, true, false, true);
+
+			file.write(reinterpret_cast<const char *>(&header),
+					   sizeof(header));
+
+			vector<std::uint8_t> page;
+			for (std::uint32_t level = 0; level < layout.level_count; level++)
+			{
+				for (std::uint32_t y = 0; y < layout.pages_y(level); y++)
+				{
+					for (std::uint32_t x = 0; x < layout.pages_x(level); x++)
+					{
+						extract_page(levels[level], layout,
+									 PageId{level, x, y}, page);
+						file.write(
+							reinterpret_cast<const char *>(page.data()),
+							static_cast<std::streamsize>(page.size()));
+					}
+				}
+			}
+
+			if (!file)
+			{
+				throw std::runtime_error(
+					EXC_MSG("Failed to write page file " + path));
+			}
+		}
+
+		std::array<std::uint8_t, 4> encode_feedback(PageId page)
+		{
+			return {static_cast<std::uint8_t>(page.x),
+					static_cast<std::uint8_t>(page.y),
+					static_cast<std::uint8_t>((page.x >> 8) |
+											  (page.y >> 8) << 4),
+					static_cast<std::uint8_t>(page.level + 1)};
+		}
+
+		vector<PageId> decode_feedback(const Image & feedback)
+		{
+			if (feedback.channels != 4)
+			{
+				throw std::invalid_argument(
+					EXC_MSG("Feedback images must be RGBA"));
+			}
+
+			std::unordered_map<std::uint32_t, std::pair<PageId, size_t>>
+				counts;
+
+			for (size_t i = 0; i < feedback.pixels.size(); i += 4)
+			{
+				const std::uint8_t * pixel = feedback.pixels.data() + i;
+				if (pixel[3] == 0)
+				{
+					continue;
+				}
+
+				const PageId page{
+					static_cast<std::uint32_t>(pixel[3] - 1),
+					static_cast<std::uint32_t>(pixel[0] |
+											   (pixel[2] & 0x0f) << 8),
+					static_cast<std::uint32_t>(pixel[1] |
+											   (pixel[2] >> 4) << 8)};
+
+				auto & count = counts.try_emplace(page.key(), page, 0)
+								   .first->second.second;
+				count++;
+			}
+
+			vector<std::pair<PageId, size_t>> seen;
+			seen.reserve(counts.size());
+			for (const auto & [key, count] : counts)
+			{
+				seen.push_back(count);
+			}
+
+			// Keys break ties, so that the order does not depend on that of
+			// the hash map
+			std::sort(seen.begin(), seen.end(),
+					  [](const auto & a, const auto & b) {
+						  return a.second != b.second
+									 ? a.second > b.second
+									 : a.first.key() < b.first.key();
+					  });
+
+			vector<PageId> pages;
+			pages.reserve(seen.size());
+			for (const auto & [page, count] : seen)
+			{
+				pages.push_back(page);
+			}
+
+			return pages;
+		}
+
+		PageCache::PageCache(size_t capacity) : slots(capacity)
+		{
+			free_slots.reserve(capacity);
+			for (size_t i = capacity; i > 0; i--)
+			{
+				free_slots.push_back(i - 1);
+			}
+		}
+
+		std::optional<size_t> PageCache::find(PageId page)
+		{
+			auto iter = pages.find(page.key());
+			if (iter == pages.end())
+			{
+				return std::nullopt;
+			}
+
+			Slot & slot = slots[iter->second];
+			if (!slot.pinned)
+			{
+				uses.splice(uses.begin(), uses, slot.use);
+			}
+
+			return iter->second;
+		}
+
+		bool PageCache::contains(PageId page) const
+		{
+			return pages.count(page.key()) != 0;
+		}
+
+		std::optional<PageCache::Insertion> PageCache::insert(PageId page,
+															  bool pinned)
+		{
+			Insertion insertion{0, std::nullopt};
+
+			if (!free_slots.empty())
+			{
+				insertion.slot = free_slots.back();
+				free_slots.pop_back();
+			}
+			else if (!uses.empty())
+			{
+				insertion.slot = uses.back();
+				uses.pop_back();
+				insertion.evicted = slots[insertion.slot].page;
+				pages.erase(insertion.evicted->key());
+			}
+			else
+			{
+				return std::nullopt;
+			}
+
+			Slot & slot = slots[insertion.slot];
+			slot.page = page;
+			slot.pinned = pinned;
+
+			if (!pinned)
+			{
+				uses.push_front(insertion.slot);
+				slot.use = uses.begin();
+			}
+
+			pages.emplace(page.key(), insertion.slot);
+
+			return insertion;
+		}
+
+		IndirectionTable::IndirectionTable(const PageLayout & layout) :
+			layout(layout), dirty(layout.level_count, true)
+		{
+			for (size_t level = 0; level < layout.level_count; level++)
+			{
+				levels.emplace_back(layout.pages_x(level) *
+										layout.pages_y(level),
+									Entry{0, 0, 0, 0});
+			}
+		}
+
+		// Calls f with each entry covered by a page, at the page's level
+		// and every finer one
+		template<typename F>
+		void IndirectionTable::for_footprint(PageId page, F && f)
+		{
+			for (size_t level = page.level + 1; level-- > 0;)
+			{
+				const size_t shift = page.level - level;
+				const size_t columns = layout.pages_x(level);
+				const size_t x_end = std::min(
+					static_cast<size_t>(page.x + 1) << shift, columns);
+				const size_t y_end = std::min(
+					static_cast<size_t>(page.y + 1) << shift,
+					layout.pages_y(level));
+
+				for (size_t y = static_cast<size_t>(page.y) << shift;
+					 y < y_end; y++)
+				{
+					for (size_t x = static_cast<size_t>(page.x) << shift;
+						 x < x_end; x++)
+					{
+						f(levels[level][y * columns + x]);
+					}
+				}
+
+				dirty[level] = true;
+			}
+		}
+
+		void IndirectionTable::map(PageId page, size_t slot_x, size_t slot_y)
+		{
+			const Entry mapped{static_cast<std::uint8_t>(slot_x),
+							   static_cast<std::uint8_t>(slot_y),
+							   static_cast<std::uint8_t>(page.level), 255};
+
+			for_footprint(page, [&](Entry & entry) {
+				if (!entry.valid || entry.level >= page.level)
+				{
+					entry = mapped;
+				}
+			});
+		}
+
+		void IndirectionTable::unmap(PageId page)
+		{
+			const Entry replacement =
+				page.level + 1 < layout.level_count
+					? entry(PageId{page.level + 1, page.x / 2, page.y / 2})
+					: Entry{0, 0, 0, 0};
+
+			for_footprint(page, [&](Entry & entry) {
+				if (entry.valid && entry.level == page.level)
+				{
+					entry = replacement;
+				}
+			});
+		}
+
+		IndirectionTable::Entry IndirectionTable::entry(PageId page) const
+		{
+			return levels[page.level][page.y * layout.pages_x(page.level) +
+									  page.x];
+		}
+
+		const vector<IndirectionTable::Entry> &
+		IndirectionTable::level(size_t level) const
+		{
+			return levels[level];
+		}
+
+		bool IndirectionTable::take_dirty(size_t level)
+		{
+			const bool was_dirty = dirty[level];
+			dirty[level] = false;
+
+			return was_dirty;
+		}
+	}   // namespace primitive
+
+	std::uint64_t page_offset(const primitive::PageLayout & layout,
+							  primitive::PageId page)
+	{
+		std::uint64_t pages = 0;
+		for (size_t level = 0; level < page.level; level++)
+		{
+			pages += layout.pages_x(level) * layout.pages_y(level);
+		}
+		pages += page.y * layout.pages_x(page.level) + page.x;
+
+		return sizeof(PageFileHeader) + pages * layout.page_bytes();
+	}
+
+	PageFile::PageFile(const string & path) : file(path)
+	{
+		auto invalid = [&](const string & reason) {
+			return std::runtime_error(
+				EXC_MSG("Invalid page file " + path + ": " + reason));
+		};
+
+		if (file.size() < sizeof(PageFileHeader))
+		{
+			throw invalid("not a page file");
+		}
+
+		const auto * header =
+			reinterpret_cast<const PageFileHeader *>(file.data());
+
+		if (header->magic != page_file_magic)
+		{
+			throw invalid("not a page file");
+		}
+
+		if (header->version != page_file_version)
+		{
+			throw invalid("unsupported version " +
+						  std::to_string(header->version));
+		}
+
+		try
+		{
+			page_layout = primitive::PageLayout::for_image(
+				header->width, header->height, header->page_size,
+				header->border);
+		}
+		catch (const std::invalid_argument &)
+		{
+			throw invalid("bad page layout");
+		}
+
+		if (header->level_count != page_layout.level_count)
+		{
+			throw invalid("bad level count");
+		}
+
+		const primitive::PageId last{
+			static_cast<std::uint32_t>(page_layout.level_count),
+			0, 0};
+		if (file.size() < page_offset(page_layout, last))
+		{
+			throw invalid("truncated pages");
+		}
+	}
+
+	const std::uint8_t * PageFile::page(primitive::PageId page) const
+	{
+		return file.data() + page_offset(page_layout, page);
+	}
+}   // namespace glge::renderer
@@ -3,9 +3,10 @@
 namespace glge::renderer
 {
 	RenderParameters::RenderParameters(const RenderSettings & settings,
-									   mat4 M) :
+									   mat4 M, float fade) :
 		settings(settings),
 		M(M),
-		MVP(settings.camera->intrinsics.get_P() * settings.camera->get_V() * M)
+		MVP(settings.camera->intrinsics.get_P() * settings.camera->get_V() * M),
+		fade(fade)
 	{}
 }   // namespace glge::renderer
@@ -0,0 +1,79 @@
+#include "glge/renderer/render_stats.h"
+
+#include <atomic>
+#include <numeric>
+
+namespace glge::renderer
+{
+	FrameStats & FrameStats::operator+=(const FrameStats & other)
+	{
+		draw_calls += other.draw_calls;
+		triangles += other.triangles;
+		vertices += other.vertices;
+		shader_binds += other.shader_binds;
+		vao_binds += other.vao_binds;
+		texture_binds += other.texture_binds;
+		uniform_uploads += other.uniform_uploads;
+		culled_objects += other.culled_objects;
+		visible_objects += other.visible_objects;
+		bytes_uploaded += other.bytes_uploaded;
+
+		return *this;
+	}
+
+	FrameStats & FrameStats::operator-=(const FrameStats & other)
+	{
+		draw_calls -= other.draw_calls;
+		triangles -= other.triangles;
+		vertices -= other.vertices;
+		shader_binds -= other.shader_binds;
+		vao_binds -= other.vao_binds;
+		texture_binds -= other.texture_binds;
+		uniform_uploads -= other.uniform_uploads;
+		culled_objects -= other.culled_objects;
+		visible_objects -= other.visible_objects;
+		bytes_uploaded -= other.bytes_uploaded;
+
+		return *this;
+	}
+
+	FrameStats operator+(FrameStats a, const FrameStats & b) { return a += b; }
+
+	FrameStats operator-(FrameStats a, const FrameStats & b) { return a -= b; }
+
+	std::uint64_t MemoryStats::total() const
+	{
+		return std::accumulate(bytes.cbegin(), bytes.cend(), std::uint64_t(0));
+	}
+
+	namespace stats
+	{
+		static std::array<std::atomic<std::int64_t>, gpu_resource_count>
+			memory_counters{};
+
+		FrameStats & thread_counters()
+		{
+			thread_local FrameStats counters;
+			return counters;
+		}
+
+		void adjust_memory(GPUResource resource, std::int64_t delta)
+		{
+			memory_counters[static_cast<size_t>(resource)].fetch_add(
+				delta, std::memory_order_relaxed);
+		}
+
+		MemoryStats memory()
+		{
+			MemoryStats snapshot;
+
+			for (size_t i = 0; i < gpu_resource_count; i++)
+			{
+				snapshot.bytes[i] = static_cast<std::uint64_t>(
+					memory_counters[i].load(std::memory_order_relaxed));
+			}
+
+			return snapshot;
+		}
+	}   // namespace stats
+}   // namespace glge::renderer
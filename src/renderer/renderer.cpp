@@ -3,6 +3,12 @@
 #include <glge/renderer/primitives/renderable.h>
 #include <glge/renderer/primitives/shader_program.h>
 #include <glge/renderer/render_settings.h>
+#include <internal/util/_compat.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <typeindex>
 
 namespace glge::renderer
 {
@@ -13,31 +19,184 @@ namespace glge::renderer
 					  const primitive::ShaderInstanceBase & shader_instance,
 					  mat4 M)
 	{
-		render_targets.emplace(typeid(shader_instance.shader),
-							   RenderTarget{target, shader_instance, M});
+		render_targets.push_back(RenderTarget{target, shader_instance, M});
+
+		if constexpr (render_stats_enabled)
+		{
+			frame_stats.visible_objects++;
+		}
+	}
+
+	void Renderer::enqueue(CommandList && commands)
+	{
+		if constexpr (render_stats_enabled)
+		{
+			frame_stats.visible_objects += commands.size();
+		}
+
+		if (render_targets.empty())
+		{
+			render_targets = std::move(commands);
+		}
+		else
+		{
+			render_targets.reserve(render_targets.size() + commands.size());
+			for (const RenderTarget & command : commands)
+			{
+				render_targets.push_back(command);
+			}
+		}
+	}
+
+	namespace
+	{
+		// Sort keys hold the shader's bucket above a quantized view depth
+		constexpr unsigned depth_key_bits = 24;
+		constexpr std::uint64_t depth_key_max =
+			(std::uint64_t(1) << depth_key_bits) - 1;
+
+		// Quantizes depth logarithmically between the clip planes, giving
+		// nearby objects, where overdraw ordering matters most, the most
+		// precision
+		std::uint64_t depth_key(float depth, const CameraIntrinsics & intrinsics)
+		{
+			const float near = std::max(intrinsics.near_distance,
+										std::numeric_limits<float>::min());
+			const float far = std::max(intrinsics.far_distance, near);
+
+			if (!(depth > near) || !(far > near))
+			{
+				return 0;
+			}
+			if (depth >= far)
+			{
+				return depth_key_max;
+			}
+
+			const float t = std::log(depth / near) / std::log(far / near);
+
+			return static_cast<std::uint64_t>(
+				t * static_cast<float>(depth_key_max));
+		}
+	}   // namespace
+
+	void Renderer::sort_targets()
+	{
+		// RenderTarget holds references and cannot be reordered in place,
+		// so sort (key, index) pairs instead; sorting shader types first
+		// keeps the bucket order independent of the order of enqueueing
+		vector<std::type_index> target_shaders;
+		target_shaders.reserve(render_targets.size());
+
+		vector<std::type_index> shader_types;
+
+		for (const RenderTarget & target : render_targets)
+		{
+			const std::type_index shader_type =
+				typeid(target.shader_instance.shader);
+
+			target_shaders.push_back(shader_type);
+
+			if (std::find(shader_types.cbegin(), shader_types.cend(),
+						  shader_type) == shader_types.cend())
+			{
+				shader_types.push_back(shader_type);
+			}
+		}
+
+		std::sort(shader_types.begin(), shader_types.end());
+
+		const bool sort_depth = settings.sort_front_to_back && settings.camera;
+		const mat4 V = sort_depth ? settings.camera->get_V() : mat4(1.0f);
+
+		draw_order.clear();
+		draw_order.reserve(render_targets.size());
+
+		for (size_t i = 0; i < render_targets.size(); i++)
+		{
+			const std::uint64_t bucket = static_cast<std::uint64_t>(
+				std::lower_bound(shader_types.cbegin(), shader_types.cend(),
+								 target_shaders[i]) -
+				shader_types.cbegin());
+
+			std::uint64_t depth = 0;
+
+			if (sort_depth)
+			{
+				// Depth of the target's origin along the view direction
+				const vec4 view_pos = V * render_targets[i].M[3];
+				depth = depth_key(-view_pos.z, settings.camera->intrinsics);
+			}
+
+			draw_order.emplace_back((bucket << depth_key_bits) | depth, i);
+		}
+
+		std::sort(EXECUTION_POLICY_PAR draw_order.begin(), draw_order.end());
 	}
 
 	void Renderer::render()
 	{
-		for (auto iter = render_targets.cbegin(), end = render_targets.cend();
+		[[maybe_unused]] const FrameStats counters_before =
+			render_stats_enabled ? stats::thread_counters() : FrameStats{};
+
+		// Depth keys depend on the camera, so the order is rebuilt per call
+		sort_targets();
+
+		if (settings.depth_prepass_shader)
+		{
+			auto depth_instance = settings.depth_prepass_shader->instance();
+			auto shader_bind = settings.depth_prepass_shader->bind();
+
+			for (const auto & [key, index] : draw_order)
+			{
+				const RenderTarget & current_target = render_targets[index];
+
+				RenderParameters params(settings, current_target.M,
+										current_target.fade);
+
+				depth_instance(params);
+
+				current_target.renderable.render();
+			}
+		}
+
+		for (auto iter = draw_order.cbegin(), end = draw_order.cend();
 			 iter != end;)
 		{
-			auto region_start_iter = iter;
-			auto shader_bind = iter->second.shader_instance.shader.bind();
+			const std::uint64_t bucket = iter->first >> depth_key_bits;
+			auto shader_bind =
+				render_targets[iter->second].shader_instance.shader.bind();
 
-			for (; (iter != end) && (iter->first == region_start_iter->first);
+			for (; (iter != end) && ((iter->first >> depth_key_bits) == bucket);
 				 iter++)
 			{
-				const RenderTarget & current_target = iter->second;
+				const RenderTarget & current_target =
+					render_targets[iter->second];
 
-				RenderParameters params(settings, current_target.M);
+				RenderParameters params(settings, current_target.M,
+										current_target.fade);
 
 				current_target.shader_instance(params);
 
 				current_target.renderable.render();
 			}
 		}
+
+		if constexpr (render_stats_enabled)
+		{
+			frame_stats += stats::thread_counters() - counters_before;
+		}
 	}
 
 	size_t Renderer::target_count() const { return render_targets.size(); }
+
+	void Renderer::record_culled(std::uint64_t count)
+	{
+		if constexpr (render_stats_enabled)
+		{
+			frame_stats.culled_objects += count;
+		}
+	}
+
+	const FrameStats & Renderer::statistics() const { return frame_stats; }
 }   // namespace glge::renderer
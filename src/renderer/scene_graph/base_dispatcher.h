@@ -8,8 +8,11 @@ namespace glge::renderer::scene_graph
 	struct Geometry;
 	struct SceneTransform;
 	struct SceneCamera;
+	struct SceneLOD;
 
-	// TODO use CRTP to optimize choice of dispatcher?
+	// Visitor dispatched on through Node::accept, at the cost of two
+	// virtual calls per node; the traversals in the renderer use visit()
+	// from static_dispatch.h instead
 	class BaseDispatcher
 	{
 	public:
@@ -18,6 +21,7 @@ namespace glge::renderer::scene_graph
 		virtual mat4 dispatch(const SceneTransform & node,
 							  mat4 cur_M) const = 0;
 		virtual mat4 dispatch(const SceneCamera & node, mat4 cur_M) const = 0;
+		virtual mat4 dispatch(const SceneLOD & node, mat4 cur_M) const = 0;
 
 		virtual ~BaseDispatcher() = default;
 	};
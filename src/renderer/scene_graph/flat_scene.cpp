@@ -0,0 +1,233 @@
+#include "flat_scene.h"
+
+#include "geometry.h"
+#include "lod.h"
+#include "scene_camera.h"
+#include "transform.h"
+
+#include <glge/util/util.h>
+#include <internal/util/_util.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace glge::renderer::scene_graph
+{
+	namespace
+	{
+		// Model space bounds of a node which draws
+		std::optional<math::Sphere> drawn_bounds(const Node & node)
+		{
+			if (node.kind == NodeKind::LOD)
+			{
+				return static_cast<const SceneLOD &>(node).model_bounds();
+			}
+
+			return static_cast<const Geometry &>(node).renderable.bounds();
+		}
+	}   // namespace
+
+	FlatScene::FlatScene(const Node & root)
+	{
+		// Children are visited in the same order as by the graph traversal
+		vector<std::pair<observer_ptr<const Node>, std::uint32_t>> pending{
+			{&root, no_parent}};
+
+		while (!pending.empty())
+		{
+			const auto [node_ptr, parent_index] = pending.back();
+			pending.pop_back();
+
+			const auto index =
+				util::safe_cast<size_t, std::uint32_t>(kinds.size());
+			if (index == no_parent)
+			{
+				throw std::length_error(
+					EXC_MSG("Scene has too many nodes to flatten"));
+			}
+
+			const NodeKind kind = node_ptr->kind;
+			parents.push_back(parent_index);
+			kinds.push_back(kind);
+			nodes.push_back(node_ptr);
+			placements.push_back(
+				kind == NodeKind::Transform
+					? &static_cast<const SceneTransform *>(node_ptr)->placement
+					: nullptr);
+
+			if (kind == NodeKind::Camera)
+			{
+				camera_nodes.push_back(index);
+			}
+
+			for (const Node & child : node_ptr->children())
+			{
+				pending.emplace_back(&child, index);
+			}
+		}
+
+		const size_t count = kinds.size();
+
+		versions.assign(count, 0);
+		world_changed.assign(count, 1);
+		locals.assign(count, mat4(1.0f));
+		worlds.assign(count, mat4(1.0f));
+		subtree_bounds.assign(count, NodeBounds{});
+		subtree_ends.resize(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			subtree_ends[i] = static_cast<std::uint32_t>(i + 1);
+			subtree_bounds[i].geometry_count = draws(kinds[i]) ? 1 : 0;
+		}
+
+		// Children follow their parents, so a reverse pass sees every
+		// child before its parent
+		for (size_t i = count - 1; i > 0; i--)
+		{
+			const std::uint32_t parent_index = parents[i];
+
+			subtree_ends[parent_index] =
+				std::max(subtree_ends[parent_index], subtree_ends[i]);
+			subtree_bounds[parent_index].geometry_count +=
+				subtree_bounds[i].geometry_count;
+		}
+	}
+
+	void FlatScene::update_world()
+	{
+		static const mat4 identity(1.0f);
+
+		for (size_t i = 0; i < kinds.size(); i++)
+		{
+			const std::uint32_t parent_index = parents[i];
+			bool changed = stale || (parent_index != no_parent &&
+									 world_changed[parent_index]);
+
+			if (const auto placement = placements[i];
+				placement && (changed || versions[i] != placement->version()))
+			{
+				locals[i] = placement->get_transform();
+				versions[i] = placement->version();
+				changed = true;
+			}
+
+			world_changed[i] = changed;
+			if (!changed)
+			{
+				continue;
+			}
+
+			const mat4 & parent_world =
+				parent_index == no_parent ? identity : worlds[parent_index];
+			worlds[i] = placements[i] ? locals[i] * parent_world
+									  : parent_world;
+		}
+
+		stale = false;
+	}
+
+	void FlatScene::update_bounds()
+	{
+		for (size_t i = 0; i < kinds.size(); i++)
+		{
+			NodeBounds & bounds = subtree_bounds[i];
+			bounds.sphere.reset();
+			bounds.unbounded = false;
+
+			if (!draws(kinds[i]))
+			{
+				continue;
+			}
+
+			if (const auto sphere = drawn_bounds(*nodes[i]))
+			{
+				bounds.sphere = math::transform(worlds[i], *sphere);
+			}
+			else
+			{
+				bounds.unbounded = true;
+			}
+		}
+
+		for (size_t i = kinds.size() - 1; i > 0; i--)
+		{
+			subtree_bounds[parents[i]].enclose(subtree_bounds[i]);
+		}
+	}
+
+	void FlatScene::update_index()
+	{
+		const auto world_bounds =
+			[this](size_t i) -> std::optional<math::Sphere> {
+			if (const auto sphere = drawn_bounds(*nodes[i]))
+			{
+				return math::transform(worlds[i], *sphere);
+			}
+			return std::nullopt;
+		};
+
+		if (!indexed)
+		{
+			vector<math::BVH::Entry> entries;
+			vector<size_t> indexed_nodes;
+			for (size_t i = 0; i < kinds.size(); i++)
+			{
+				if (!draws(kinds[i]))
+				{
+					continue;
+				}
+
+				if (const auto sphere = world_bounds(i))
+				{
+					entries.push_back(math::BVH::Entry{
+						*sphere, static_cast<math::BVH::Item>(i)});
+					indexed_nodes.push_back(i);
+				}
+			}
+
+			index_leaves.assign(kinds.size(), std::nullopt);
+			const auto leaves = geometry_index.build(entries);
+			for (size_t j = 0; j < leaves.size(); j++)
+			{
+				index_leaves[indexed_nodes[j]] = leaves[j];
+			}
+
+			indexed = true;
+			return;
+		}
+
+		// Bounds are compared rather than relying on world_changed, since
+		// renderables such as dynamic models may change their own bounds
+		for (size_t i = 0; i < kinds.size(); i++)
+		{
+			if (!draws(kinds[i]))
+			{
+				continue;
+			}
+
+			const auto sphere = world_bounds(i);
+			auto & leaf = index_leaves[i];
+
+			if (sphere && leaf)
+			{
+				const math::Sphere old = geometry_index.bounds(*leaf);
+				if (old.radius != sphere->radius ||
+					old.origin != sphere->origin)
+				{
+					geometry_index.update(*leaf, *sphere);
+				}
+			}
+			else if (sphere)
+			{
+				leaf = geometry_index.insert(*sphere,
+											 static_cast<math::BVH::Item>(i));
+			}
+			else if (leaf)
+			{
+				geometry_index.remove(*leaf);
+				leaf.reset();
+			}
+		}
+	}
+}   // namespace glge::renderer::scene_graph
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "node.h"
+
+#include <glge/common.h>
+#include <glge/util/bvh.h>
+#include <glge/util/math.h>
+#include <glge/util/motion.h>
+
+#include <cstdint>
+
+namespace glge::renderer::scene_graph
+{
+	// Copy of a scene graph's structure in contiguous arrays, in
+	// depth-first order so that every node follows its parent and the
+	// descendants of a node are the nodes up to its subtree end. World
+	// matrices and bounds are then computed by linear passes over the
+	// arrays, rather than by walking the graph. World matrices are kept
+	// between passes, and only recomputed below placements whose version
+	// changed. Rebuilt whenever nodes are added to or removed from the
+	// graph.
+	class FlatScene
+	{
+	public:
+		// Parent index of the root
+		static constexpr std::uint32_t no_parent = 0xffffffff;
+
+		explicit FlatScene(const Node & root);
+
+		size_t size() const { return kinds.size(); }
+
+		// Recompute the world matrices below every placement changed since
+		// the last call
+		void update_world();
+
+		// Recompute the world space bounds of every subtree; requires
+		// up to date world matrices
+		void update_bounds();
+
+		// Bring the spatial index over bounded geometry up to date, built
+		// by SAH at first and then refit only where geometry moved;
+		// requires up to date world matrices
+		void update_index();
+
+		// Spatial index over the world space bounds of geometry, whose
+		// items are node indices
+		const math::BVH & index() const { return geometry_index; }
+
+		std::uint32_t parent(size_t i) const { return parents[i]; }
+		// One past the index of the last descendant of a node
+		std::uint32_t subtree_end(size_t i) const { return subtree_ends[i]; }
+		NodeKind kind(size_t i) const { return kinds[i]; }
+		const Node & node(size_t i) const { return *nodes[i]; }
+		// Matrix a node applies to its descendants
+		const mat4 & local(size_t i) const { return locals[i]; }
+		// Matrix from a node's model space to world space, including its
+		// local matrix
+		const mat4 & world(size_t i) const { return worlds[i]; }
+		const NodeBounds & bounds(size_t i) const { return subtree_bounds[i]; }
+
+		// Indices of the cameras, so that the active one may be found
+		// without a pass over every node
+		const vector<std::uint32_t> & cameras() const { return camera_nodes; }
+
+	private:
+		vector<std::uint32_t> parents;
+		vector<std::uint32_t> subtree_ends;
+		vector<NodeKind> kinds;
+		vector<observer_ptr<const Node>> nodes;
+		// Placement of each transform, or null for other nodes
+		vector<observer_ptr<const util::Placement>> placements;
+		// Version of each placement the local matrix was read at
+		vector<std::uint64_t> versions;
+		// Whether each world matrix changed in the last update
+		vector<std::uint8_t> world_changed;
+		// Set until the first update computes every world matrix
+		bool stale = true;
+		vector<mat4> locals;
+		vector<mat4> worlds;
+		vector<NodeBounds> subtree_bounds;
+		math::BVH geometry_index;
+		// Leaf of each bounded geometry in the index
+		vector<std::optional<math::BVH::Leaf>> index_leaves;
+		bool indexed = false;
+		vector<std::uint32_t> camera_nodes;
+	};
+}   // namespace glge::renderer::scene_graph
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "node.h"
+#include <glge/renderer/primitives/primitive_data.h>
 #include <glge/renderer/primitives/renderable.h>
 
 namespace glge::renderer::scene_graph
@@ -9,9 +10,13 @@ namespace glge::renderer::scene_graph
 	{
 		const primitive::Renderable & renderable;
 		const primitive::ShaderInstanceBase & shader;
+		// Low-poly stand-in drawn into the occlusion buffer, in the same
+		// model space as the renderable, if this geometry hides others
+		observer_ptr<const primitive::EBOModelData> occluder = nullptr;
 
 		Geometry(primitive::Renderable & renderable,
 				 primitive::ShaderInstanceBase & shader) :
+			Node(NodeKind::Geometry),
 			renderable(renderable),
 			shader(shader)
 		{}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "node.h"
+#include <glge/renderer/camera.h>
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/renderer.h>
+
+#include <algorithm>
+
+namespace glge::renderer::scene_graph
+{
+	struct SceneLOD : public Node
+	{
+		// Levels from finest to coarsest, with non-decreasing errors
+		const vector<DetailLevel> levels;
+		const LODSettings settings;
+
+		// Level drawn since the last switch, and the level it is fading in
+		// over, with the frames it has faded for; set by the first record()
+		mutable std::uint32_t current = 0;
+		mutable std::uint32_t previous = 0;
+		mutable std::uint32_t fade_frame = 0;
+		mutable bool selected = false;
+
+		SceneLOD(vector<DetailLevel> levels, const LODSettings & settings) :
+			Node(NodeKind::LOD), levels(std::move(levels)), settings(settings)
+		{}
+
+		mat4 accept(const BaseDispatcher & dispatcher,
+					mat4 cur_M) const override
+		{
+			return dispatcher.dispatch(*this, cur_M);
+		}
+
+		// Model space bounds of the node, taken from its finest level
+		std::optional<math::Sphere> model_bounds() const
+		{
+			return levels.front().renderable.bounds();
+		}
+
+		// Choose the level to draw as seen from a camera, and record it
+		// along with any level it is fading in over
+		void record(const Camera & camera, float viewport_height,
+					const mat4 & M, CommandList & commands) const
+		{
+			const auto sphere = model_bounds();
+			const math::Sphere world =
+				sphere ? math::transform(M, *sphere)
+					   : math::Sphere{0.0f, vec3(M[3])};
+			const float distance =
+				glm::length(world.origin - camera.placement.get_position()) -
+				world.radius;
+
+			// Errors grow with the largest scale of the world matrix
+			const float scale =
+				std::max({glm::length(vec3(M[0])), glm::length(vec3(M[1])),
+						  glm::length(vec3(M[2]))});
+			const auto pixels = [&](std::uint32_t level) {
+				return camera.pixel_size(levels[level].error * scale,
+										 distance, viewport_height);
+			};
+
+			// Refine while the level's error shows, then coarsen while the
+			// next level's error is well within the limit; the first choice
+			// starts from the coarsest level
+			const auto last = static_cast<std::uint32_t>(levels.size() - 1);
+			std::uint32_t level = selected ? current : last;
+			while (level > 0 && pixels(level) > settings.max_screen_error)
+			{
+				level--;
+			}
+			while (level < last &&
+				   pixels(level + 1) <= settings.max_screen_error *
+											(1.0f - settings.hysteresis))
+			{
+				level++;
+			}
+
+			if (!selected)
+			{
+				selected = true;
+				current = level;
+				fade_frame = settings.fade_frames;
+			}
+			else if (level != current)
+			{
+				previous = current;
+				current = level;
+				fade_frame = 0;
+			}
+
+			const DetailLevel & drawn = levels[current];
+			if (fade_frame >= settings.fade_frames)
+			{
+				commands.push_back(
+					RenderTarget{drawn.renderable, drawn.shader, M});
+				return;
+			}
+
+			// The levels cover complementary pixels, with the new level
+			// covering more each frame
+			fade_frame++;
+			const float fade = static_cast<float>(fade_frame) /
+							   static_cast<float>(settings.fade_frames + 1);
+			const DetailLevel & faded = levels[previous];
+
+			commands.push_back(
+				RenderTarget{drawn.renderable, drawn.shader, M, fade});
+			commands.push_back(
+				RenderTarget{faded.renderable, faded.shader, M, fade - 1.0f});
+		}
+	};
+}   // namespace glge::renderer::scene_graph
@@ -4,14 +4,109 @@
 #include "glge/renderer/scene_graph/scene.h"
 
 #include <glge/common.h>
+#include <glge/renderer/occlusion_culler.h>
+#include <glge/util/math.h>
 
-#include <forward_list>
+#include <cstdint>
+#include <optional>
 
 namespace glge::renderer::scene_graph
 {
+	// Concrete type of a node, so that traversals may dispatch on it
+	// without virtual calls
+	enum class NodeKind : std::uint8_t
+	{
+		Group,
+		Geometry,
+		Transform,
+		Camera,
+		LOD
+	};
+
+	// Whether nodes of a kind draw renderables, so have bounds of their
+	// own and count as geometry when culled
+	constexpr bool draws(NodeKind kind)
+	{
+		return kind == NodeKind::Geometry || kind == NodeKind::LOD;
+	}
+
+	// Bounds of a node and its descendants in world space, recomputed
+	// before each traversal that culls
+	struct NodeBounds
+	{
+		// Sphere enclosing every bounded Geometry in the subtree, if any
+		std::optional<math::Sphere> sphere;
+		// Set if some Geometry in the subtree has no known bounds, so the
+		// subtree may never be culled
+		bool unbounded = false;
+		// Number of Geometry nodes in the subtree
+		size_t geometry_count = 0;
+
+		// Grow to enclose the bounds of a child's subtree; geometry
+		// counts are left to the caller
+		void enclose(const NodeBounds & child)
+		{
+			unbounded = unbounded || child.unbounded;
+
+			if (child.sphere)
+			{
+				sphere = sphere ? math::enclose(*sphere, *child.sphere)
+								: *child.sphere;
+			}
+		}
+	};
+
 	struct Node
 	{
-		std::forward_list<unique_ptr<Node>> children;
+		// Range over the children of a node, most recently added first
+		class Children
+		{
+			observer_ptr<const Node> first;
+
+		public:
+			class iterator
+			{
+				observer_ptr<const Node> node;
+
+			public:
+				explicit iterator(observer_ptr<const Node> node) : node(node)
+				{}
+
+				const Node & operator*() const { return *node; }
+
+				iterator & operator++()
+				{
+					node = node->next_sibling;
+					return *this;
+				}
+
+				bool operator!=(iterator other) const
+				{
+					return node != other.node;
+				}
+			};
+
+			explicit Children(observer_ptr<const Node> first) : first(first)
+			{}
+
+			iterator begin() const { return iterator(first); }
+			iterator end() const { return iterator(nullptr); }
+		};
+
+		const NodeKind kind;
+		// Slot of the node in its Scene's pool for its kind
+		std::uint32_t slot = 0;
+		mutable NodeBounds bounds;
+		// Results of culling kept between traversals for coherent culling:
+		// the frustum plane which last culled the node, and its last
+		// occlusion test
+		mutable std::uint8_t culling_plane = 0;
+		mutable OcclusionCuller::CachedVisibility visibility;
+
+		Node() : kind(NodeKind::Group) {}
+
+		Node(const Node &) = delete;
+		Node & operator=(const Node &) = delete;
 
 		virtual ~Node() = default;
 
@@ -19,5 +114,53 @@ namespace glge::renderer::scene_graph
 		{
 			return dispatcher.dispatch(*this, cur_M);
 		}
+
+		Children children() const { return Children(first_child); }
+		observer_ptr<Node> parent() const { return parent_node; }
+
+		// Link a node, not yet in any graph, as the first child of this
+		void add_child(Node & child)
+		{
+			child.parent_node = this;
+			child.next_sibling = first_child;
+			if (first_child)
+			{
+				first_child->prev_sibling = &child;
+			}
+			first_child = &child;
+		}
+
+		// Detach this node and its descendants from its parent
+		void unlink()
+		{
+			if (prev_sibling)
+			{
+				prev_sibling->next_sibling = next_sibling;
+			}
+			else if (parent_node)
+			{
+				parent_node->first_child = next_sibling;
+			}
+
+			if (next_sibling)
+			{
+				next_sibling->prev_sibling = prev_sibling;
+			}
+
+			parent_node = nullptr;
+			prev_sibling = nullptr;
+			next_sibling = nullptr;
+		}
+
+	protected:
+		explicit Node(NodeKind kind) : kind(kind) {}
+
+	private:
+		friend class NodeStore;
+
+		observer_ptr<Node> parent_node = nullptr;
+		observer_ptr<Node> first_child = nullptr;
+		observer_ptr<Node> prev_sibling = nullptr;
+		observer_ptr<Node> next_sibling = nullptr;
 	};
 }   // namespace glge::renderer::scene_graph
@@ -0,0 +1,92 @@
+#include "node_store.h"
+
+namespace glge::renderer::scene_graph
+{
+	NodeId NodeStore::id_of(const Node & node) const
+	{
+		std::uint32_t generation = 0;
+		switch (node.kind)
+		{
+		case NodeKind::Group:
+			generation = groups.generation(node.slot);
+			break;
+		case NodeKind::Geometry:
+			generation = geometry.generation(node.slot);
+			break;
+		case NodeKind::Transform:
+			generation = transforms.generation(node.slot);
+			break;
+		case NodeKind::Camera:
+			generation = cameras.generation(node.slot);
+			break;
+		case NodeKind::LOD:
+			generation = lods.generation(node.slot);
+			break;
+		}
+
+		return NodeId{static_cast<std::uint8_t>(node.kind), node.slot,
+					  generation};
+	}
+
+	observer_ptr<Node> NodeStore::find(NodeId id)
+	{
+		switch (static_cast<NodeKind>(id.kind))
+		{
+		case NodeKind::Group:
+			return groups.find(id.slot, id.generation);
+		case NodeKind::Geometry:
+			return geometry.find(id.slot, id.generation);
+		case NodeKind::Transform:
+			return transforms.find(id.slot, id.generation);
+		case NodeKind::Camera:
+			return cameras.find(id.slot, id.generation);
+		case NodeKind::LOD:
+			return lods.find(id.slot, id.generation);
+		}
+
+		return nullptr;
+	}
+
+	void NodeStore::remove(Node & node)
+	{
+		node.unlink();
+
+		vector<observer_ptr<Node>> pending{&node};
+		while (!pending.empty())
+		{
+			Node & next = *pending.back();
+			pending.pop_back();
+
+			for (auto child = next.first_child; child;
+				 child = child->next_sibling)
+			{
+				pending.push_back(child);
+			}
+
+			switch (next.kind)
+			{
+			case NodeKind::Group:
+				groups.destroy(next.slot);
+				break;
+			case NodeKind::Geometry:
+				geometry.destroy(next.slot);
+				break;
+			case NodeKind::Transform:
+				transforms.destroy(next.slot);
+				break;
+			case NodeKind::Camera:
+				cameras.destroy(next.slot);
+				break;
+			case NodeKind::LOD:
+				lods.destroy(next.slot);
+				break;
+			}
+		}
+	}
+
+	size_t NodeStore::size() const
+	{
+		return groups.size() + geometry.size() + transforms.size() +
+			   cameras.size() + lods.size();
+	}
+}   // namespace glge::renderer::scene_graph
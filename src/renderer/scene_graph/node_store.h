@@ -0,0 +1,77 @@
+#pragma once
+
+#include "geometry.h"
+#include "lod.h"
+#include "node.h"
+#include "scene_camera.h"
+#include "transform.h"
+
+#include <internal/util/_slab_pool.h>
+
+#include <type_traits>
+
+namespace glge::renderer::scene_graph
+{
+	// Pools holding the nodes of a Scene, one per kind of node, so that
+	// adding a node rarely allocates and removed nodes leave no holes in
+	// the heap
+	class NodeStore
+	{
+	public:
+		// Create a node not yet linked into the graph
+		template<typename T, typename... Args>
+		T & create(Args &&... args)
+		{
+			auto [slot, node] = pool<T>().create(std::forward<Args>(args)...);
+			node.slot = slot;
+			return node;
+		}
+
+		// Reference to a node, valid until the node is removed
+		NodeId id_of(const Node & node) const;
+
+		// Node referred to, or null if it was removed
+		observer_ptr<Node> find(NodeId id);
+
+		// Unlink a node from its parent, then destroy it along with its
+		// descendants
+		void remove(Node & node);
+
+		// Number of nodes in the store
+		size_t size() const;
+
+	private:
+		util::SlabPool<Node> groups;
+		util::SlabPool<Geometry> geometry;
+		util::SlabPool<SceneTransform> transforms;
+		util::SlabPool<SceneCamera> cameras;
+		util::SlabPool<SceneLOD> lods;
+
+		template<typename T>
+		util::SlabPool<T> & pool()
+		{
+			if constexpr (std::is_same_v<T, Node>)
+			{
+				return groups;
+			}
+			else if constexpr (std::is_same_v<T, Geometry>)
+			{
+				return geometry;
+			}
+			else if constexpr (std::is_same_v<T, SceneTransform>)
+			{
+				return transforms;
+			}
+			else if constexpr (std::is_same_v<T, SceneCamera>)
+			{
+				return cameras;
+			}
+			else
+			{
+				static_assert(std::is_same_v<T, SceneLOD>,
+							  "Not a kind of node");
+				return lods;
+			}
+		}
+	};
+}   // namespace glge::renderer::scene_graph
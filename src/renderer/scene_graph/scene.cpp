@@ -1,64 +1,196 @@
 #include "glge/renderer/scene_graph/scene.h"
 
+#include "flat_scene.h"
 #include "geometry.h"
+#include "lod.h"
 #include "node.h"
+#include "node_store.h"
 #include "scene_camera.h"
 #include "transform.h"
 
+#include <glge/util/util.h>
+
 namespace glge::renderer::scene_graph
 {
-	NodeHandle::NodeHandle(observer_ptr<Node> parent,
-						   Node & node,
-						   Scene & scene) :
-		parent(parent),
-		node(node), scene(scene)
+	NodeHandle::NodeHandle(NodeId id, Scene & scene) : id(id), scene(scene)
 	{}
 
+	Node & NodeHandle::get() const
+	{
+		const auto node = scene.nodes->find(id);
+		if (!node)
+		{
+			throw std::logic_error(
+				EXC_MSG("NodeHandle refers to a removed node"));
+		}
+
+		return *node;
+	}
+
+	bool NodeHandle::valid() const { return scene.nodes->find(id); }
+
+	void NodeHandle::remove()
+	{
+		Node & node = get();
+		if (&node == scene.root)
+		{
+			throw std::logic_error(
+				EXC_MSG("The root of a scene cannot be removed"));
+		}
+
+		scene.structure_changed();
+		scene.nodes->remove(node);
+	}
+
 	NodeHandle NodeHandle::add_geometry(primitive::Renderable & renderable,
 										primitive::ShaderInstanceBase & shader)
 	{
-		auto & new_node_ptr = node.children.emplace_front(
-			std::make_unique<Geometry>(renderable, shader));
+		Node & node = get();
+		scene.structure_changed();
+
+		auto & new_node =
+			scene.nodes->create<Geometry>(renderable, shader);
+		node.add_child(new_node);
 
-		return NodeHandle(&node, *new_node_ptr, scene);
+		return NodeHandle(scene.nodes->id_of(new_node), scene);
+	}
+
+	NodeHandle NodeHandle::add_lod(vector<DetailLevel> levels,
+								   const LODSettings & settings)
+	{
+		if (levels.empty())
+		{
+			throw std::invalid_argument(
+				EXC_MSG("LOD nodes need at least one level"));
+		}
+
+		for (size_t i = 0; i < levels.size(); i++)
+		{
+			if (!(levels[i].error >= 0.0f) ||
+				(i > 0 && levels[i].error < levels[i - 1].error))
+			{
+				throw std::invalid_argument(EXC_MSG(
+					"LOD errors must be non-negative and non-decreasing"));
+			}
+		}
+
+		if (!(settings.max_screen_error > 0.0f) ||
+			!(settings.hysteresis >= 0.0f && settings.hysteresis < 1.0f))
+		{
+			throw std::invalid_argument(
+				EXC_MSG("LOD settings are out of range"));
+		}
+
+		Node & node = get();
+		scene.structure_changed();
+
+		auto & new_node =
+			scene.nodes->create<SceneLOD>(std::move(levels), settings);
+		node.add_child(new_node);
+
+		return NodeHandle(scene.nodes->id_of(new_node), scene);
 	}
 
 	NodeHandle NodeHandle::add_transform(const util::Placement & placement)
 	{
-		auto & new_node_ptr = node.children.emplace_front(
-			std::make_unique<SceneTransform>(placement));
+		Node & node = get();
+		scene.structure_changed();
+
+		auto & new_node = scene.nodes->create<SceneTransform>(placement);
+		node.add_child(new_node);
 
-		return NodeHandle(&node, *new_node_ptr, scene);
+		return NodeHandle(scene.nodes->id_of(new_node), scene);
 	}
 
 	CameraHandle NodeHandle::add_camera(const CameraIntrinsics & intrinsics)
 	{
-		auto & new_node_ptr = node.children.emplace_front(
-			std::make_unique<SceneCamera>(intrinsics));
+		Node & node = get();
+		scene.structure_changed();
+
+		auto & new_node = scene.nodes->create<SceneCamera>(intrinsics);
+		node.add_child(new_node);
 
-		return CameraHandle(&node, static_cast<SceneCamera &>(*new_node_ptr),
-							scene);
+		return CameraHandle(scene.nodes->id_of(new_node), scene);
 	}
 
-	CameraHandle::CameraHandle(observer_ptr<Node> parent,
-							   SceneCamera & node,
-							   Scene & scene) :
-		NodeHandle(parent, static_cast<Node &>(node), scene)
+	void NodeHandle::set_occluder(const primitive::EBOModelData & mesh)
+	{
+		Node & node = get();
+		if (node.kind != NodeKind::Geometry)
+		{
+			throw std::logic_error(
+				EXC_MSG("Only geometry nodes may be occluders"));
+		}
+
+		static_cast<Geometry &>(node).occluder = &mesh;
+	}
+
+	CameraHandle::CameraHandle(NodeId id, Scene & scene) :
+		NodeHandle(id, scene)
 	{}
 
 	void CameraHandle::activate()
 	{
-		static_cast<SceneCamera &>(node).active = true;
+		static_cast<SceneCamera &>(get()).active = true;
 	}
 
 	Scene::Scene() :
-		root(std::make_unique<Node>()), settings(nullptr, false, false)
+		nodes(std::make_unique<NodeStore>()),
+		root(&nodes->create<Node>()), settings(nullptr, false, false)
 	{}
 
+	void Scene::structure_changed() { flat.reset(); }
+
+	FlatScene & Scene::flattened() const
+	{
+		if (!flat)
+		{
+			flat = std::make_unique<FlatScene>(*root);
+		}
+
+		return *flat;
+	}
+
+	FlatScene & Scene::indexed() const
+	{
+		FlatScene & flat_scene = flattened();
+		flat_scene.update_world();
+		flat_scene.update_index();
+
+		return flat_scene;
+	}
+
+	std::optional<NodeHandle> Scene::pick(const math::Ray & ray)
+	{
+		const FlatScene & flat_scene = indexed();
+
+		if (const auto hit = flat_scene.index().raycast(ray))
+		{
+			return NodeHandle(nodes->id_of(flat_scene.node(hit->item)),
+							  *this);
+		}
+
+		return std::nullopt;
+	}
+
+	vector<NodeHandle> Scene::overlapping(math::Sphere sphere)
+	{
+		const FlatScene & flat_scene = indexed();
+
+		vector<NodeHandle> found;
+		flat_scene.index().query(sphere, [&](math::BVH::Item item) {
+			found.emplace_back(nodes->id_of(flat_scene.node(item)), *this);
+		});
+
+		return found;
+	}
+
 	NodeHandle Scene::get_root_handle()
 	{
-		return NodeHandle(nullptr, *root, *this);
+		return NodeHandle(nodes->id_of(*root), *this);
 	}
 
+	size_t Scene::node_count() const { return nodes->size(); }
+
 	Scene::~Scene() = default;
 }   // namespace glge::renderer::scene_graph
@@ -11,7 +11,7 @@ namespace glge::renderer::scene_graph
 		bool active = false;
 
 		SceneCamera(const CameraIntrinsics & intrinsics) :
-			camera_intrinsics(intrinsics)
+			Node(NodeKind::Camera), camera_intrinsics(intrinsics)
 		{}
 
 		mat4 accept(const BaseDispatcher & dispatcher,
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "geometry.h"
+#include "lod.h"
+#include "node.h"
+#include "scene_camera.h"
+#include "transform.h"
+
+namespace glge::renderer::scene_graph
+{
+	// Statically dispatched counterpart of Node::accept; calls the
+	// dispatch overload of a visitor for the concrete type of a node,
+	// chosen by its kind, so that the call may be inlined. Visitors need
+	// the same overloads as a BaseDispatcher, but not its virtual calls.
+	template<typename Visitor>
+	mat4 visit(const Node & node, const Visitor & visitor, mat4 cur_M)
+	{
+		switch (node.kind)
+		{
+		case NodeKind::Geometry:
+			return visitor.dispatch(static_cast<const Geometry &>(node),
+									cur_M);
+		case NodeKind::Transform:
+			return visitor.dispatch(static_cast<const SceneTransform &>(node),
+									cur_M);
+		case NodeKind::Camera:
+			return visitor.dispatch(static_cast<const SceneCamera &>(node),
+									cur_M);
+		case NodeKind::LOD:
+			return visitor.dispatch(static_cast<const SceneLOD &>(node),
+									cur_M);
+		case NodeKind::Group:
+			break;
+		}
+
+		return visitor.dispatch(node, cur_M);
+	}
+}   // namespace glge::renderer::scene_graph
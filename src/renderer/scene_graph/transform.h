@@ -2,13 +2,18 @@
 
 #include "node.h"
 
+#include <glge/util/motion.h>
+
+#include <cstdint>
+
 namespace glge::renderer::scene_graph
 {
 	struct SceneTransform : public Node
 	{
 		const util::Placement & placement;
 
-		SceneTransform(const util::Placement & placement) : placement(placement)
+		SceneTransform(const util::Placement & placement) :
+			Node(NodeKind::Transform), placement(placement)
 		{}
 
 		mat4 accept(const BaseDispatcher & dispatcher,
@@ -16,5 +21,29 @@ namespace glge::renderer::scene_graph
 		{
 			return dispatcher.dispatch(*this, cur_M);
 		}
+
+		// World matrix applied below this node, recomputed only if the
+		// parent's world matrix changed (as marked by changed) or the
+		// placement's version moved on since it was last computed. Sets
+		// changed if recomputed, so that descendants follow.
+		const mat4 & update_world(const mat4 & parent_world,
+								  bool & changed) const
+		{
+			if (changed || !world_valid ||
+				world_version != placement.version())
+			{
+				world = placement.get_transform() * parent_world;
+				world_version = placement.version();
+				world_valid = true;
+				changed = true;
+			}
+
+			return world;
+		}
+
+	private:
+		mutable mat4 world = mat4(1.0f);
+		mutable std::uint64_t world_version = 0;
+		mutable bool world_valid = false;
 	};
 }   // namespace glge::renderer::scene_graph
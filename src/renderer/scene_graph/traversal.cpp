@@ -1,77 +1,698 @@
 #include "glge/renderer/scene_graph/scene.h"
 
+#include <glge/renderer/occlusion_culler.h>
+#include <glge/renderer/primitives/debug_draw.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/primitives/texture_residency.h>
 #include <glge/renderer/renderer.h>
+#include <glge/util/thread_pool.h>
 #include <glge/util/util.h>
 
-#include "base_dispatcher.h"
-#include "geometry.h"
-#include "scene_camera.h"
-#include "transform.h"
+#include "flat_scene.h"
+#include "static_dispatch.h"
 
-#include <stack>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <optional>
 #include <tuple>
 
 namespace glge::renderer::scene_graph
 {
-	class RenderingSceneDispatcher : public BaseDispatcher
+	namespace
 	{
-		Renderer & renderer;
+		// Node, world matrix of its parent, whether that matrix changed
+		// since the last traversal, and the frustum planes its parent's
+		// bounds did not lie wholly inside
+		using StateTuple = std::tuple<observer_ptr<const Node>, mat4, bool,
+									  math::PlaneMask>;
 
-	public:
-		explicit RenderingSceneDispatcher(Renderer & renderer) :
-			renderer(renderer)
-		{}
+		// Number of nodes a traversal keeps pending before handing the
+		// oldest (and so typically largest) subtree to another worker
+		constexpr size_t split_threshold = 32;
 
-		mat4 dispatch(const Node &, mat4 cur_M) const override { return cur_M; }
+		// Whether a node is visited before another by a depth-first
+		// traversal, which visits the children of a node in the order they
+		// were added
+		bool visited_before(const Node & a, const Node & b)
+		{
+			vector<observer_ptr<const Node>> a_path, b_path;
+			for (auto node = &a; node; node = node->parent())
+			{
+				a_path.push_back(node);
+			}
+			for (auto node = &b; node; node = node->parent())
+			{
+				b_path.push_back(node);
+			}
+
+			// Walk down from the root until the paths part
+			auto a_it = a_path.rbegin(), b_it = b_path.rbegin();
+			while (a_it != a_path.rend() && b_it != b_path.rend() &&
+				   *a_it == *b_it)
+			{
+				++a_it;
+				++b_it;
+			}
+
+			// An ancestor is visited before its descendants
+			if (a_it == a_path.rend() || b_it == b_path.rend())
+			{
+				return a_it == a_path.rend() && b_it != b_path.rend();
+			}
+
+			// Siblings are listed most recently added first
+			const auto parent = (*a_it)->parent();
+			if (!parent)
+			{
+				return false;
+			}
+			for (const Node & sibling : parent->children())
+			{
+				if (&sibling == *b_it)
+				{
+					return true;
+				}
+				if (&sibling == *a_it)
+				{
+					return false;
+				}
+			}
+			return false;
+		}
+
+		// Active camera found by a traversal; if several cameras are
+		// active, the first visited is used, whichever worker reaches it
+		struct CameraSlot
+		{
+			std::mutex mutex;
+			unique_ptr<Camera> camera;
+			observer_ptr<const SceneCamera> node = nullptr;
+
+			void offer(const SceneCamera & scene_camera, const mat4 & M)
+			{
+				std::lock_guard lock(mutex);
+				if (!node || visited_before(scene_camera, *node))
+				{
+					camera = scene_camera.get_camera(M);
+					node = &scene_camera;
+				}
+			}
+		};
+
+		// LOD nodes reached by a traversal, with their world matrices; their
+		// levels are chosen once the traversal has found the camera
+		using LODList = vector<std::pair<observer_ptr<const SceneLOD>, mat4>>;
 
-		mat4 dispatch(const Geometry & node, mat4 cur_M) const override
+		class RenderingSceneDispatcher
 		{
-			renderer.enqueue(node.renderable, node.shader, cur_M);
-			return cur_M;
+			CommandList & commands;
+			LODList & lods;
+			CameraSlot & camera_slot;
+			bool & changed;
+
+		public:
+			RenderingSceneDispatcher(CommandList & commands, LODList & lods,
+									 CameraSlot & camera_slot,
+									 bool & changed) :
+				commands(commands),
+				lods(lods), camera_slot(camera_slot), changed(changed)
+			{}
+
+			mat4 dispatch(const Node &, mat4 cur_M) const
+			{
+				return cur_M;
+			}
+
+			mat4 dispatch(const Geometry & node, mat4 cur_M) const
+			{
+				commands.push_back(
+					RenderTarget{node.renderable, node.shader, cur_M});
+				return cur_M;
+			}
+
+			mat4 dispatch(const SceneLOD & node, mat4 cur_M) const
+			{
+				lods.emplace_back(&node, cur_M);
+				return cur_M;
+			}
+
+			mat4 dispatch(const SceneTransform & transform,
+						  mat4 cur_M) const
+			{
+				return transform.update_world(cur_M, changed);
+			}
+
+			mat4 dispatch(const SceneCamera & scene_camera,
+						  mat4 cur_M) const
+			{
+				if (scene_camera.active)
+				{
+					camera_slot.offer(scene_camera, cur_M);
+				}
+				return cur_M;
+			}
+		};
+
+		// Geometry drawn into the occlusion buffer, with its world matrix
+		using Occluders = vector<std::pair<observer_ptr<const Geometry>, mat4>>;
+
+		// Computes the world space bounds of each node as it is first
+		// visited, and finds the active camera and the occluders
+		class BoundingSceneDispatcher
+		{
+			CameraSlot & camera_slot;
+			Occluders & occluders;
+			bool & changed;
+
+		public:
+			BoundingSceneDispatcher(CameraSlot & camera_slot,
+									Occluders & occluders, bool & changed) :
+				camera_slot(camera_slot),
+				occluders(occluders), changed(changed)
+			{}
+
+			mat4 dispatch(const Node & node, mat4 cur_M) const
+			{
+				node.bounds = NodeBounds{};
+				return cur_M;
+			}
+
+			mat4 dispatch(const Geometry & node, mat4 cur_M) const
+			{
+				node.bounds = NodeBounds{};
+				node.bounds.geometry_count = 1;
+
+				if (const auto bounds = node.renderable.bounds())
+				{
+					node.bounds.sphere = math::transform(cur_M, *bounds);
+				}
+				else
+				{
+					node.bounds.unbounded = true;
+				}
+
+				if (node.occluder)
+				{
+					occluders.emplace_back(&node, cur_M);
+				}
+
+				return cur_M;
+			}
+
+			mat4 dispatch(const SceneLOD & node, mat4 cur_M) const
+			{
+				node.bounds = NodeBounds{};
+				node.bounds.geometry_count = 1;
+
+				if (const auto bounds = node.model_bounds())
+				{
+					node.bounds.sphere = math::transform(cur_M, *bounds);
+				}
+				else
+				{
+					node.bounds.unbounded = true;
+				}
+
+				return cur_M;
+			}
+
+			mat4 dispatch(const SceneTransform & transform,
+						  mat4 cur_M) const
+			{
+				transform.bounds = NodeBounds{};
+				return transform.update_world(cur_M, changed);
+			}
+
+			mat4 dispatch(const SceneCamera & scene_camera,
+						  mat4 cur_M) const
+			{
+				scene_camera.bounds = NodeBounds{};
+				if (scene_camera.active)
+				{
+					camera_slot.offer(scene_camera, cur_M);
+				}
+				return cur_M;
+			}
+		};
+
+		// Computes Node::bounds for every node, children before their
+		// parents, so that each subtree's bounds enclose its descendants'
+		void compute_bounds(const Node & root, CameraSlot & camera_slot,
+							Occluders & occluders)
+		{
+			struct Entry
+			{
+				observer_ptr<const Node> node;
+				mat4 M;
+				bool changed;
+				bool expanded;
+			};
+
+			bool changed = false;
+			BoundingSceneDispatcher dispatcher(camera_slot, occluders, changed);
+			vector<Entry> nodes{Entry{&root, mat4(1.0f), false, false}};
+
+			while (!nodes.empty())
+			{
+				const Entry entry = nodes.back();
+
+				if (!entry.expanded)
+				{
+					nodes.back().expanded = true;
+
+					changed = entry.changed;
+					const mat4 new_M = visit(*entry.node, dispatcher, entry.M);
+					for (const Node & child : entry.node->children())
+					{
+						nodes.push_back(Entry{&child, new_M, changed, false});
+					}
+					continue;
+				}
+
+				nodes.pop_back();
+
+				NodeBounds & bounds = entry.node->bounds;
+				for (const Node & child : entry.node->children())
+				{
+					bounds.geometry_count += child.bounds.geometry_count;
+					bounds.enclose(child.bounds);
+				}
+			}
 		}
 
-		mat4 dispatch(const SceneTransform & transform,
-					  mat4 cur_M) const override
+		// Reports the size on screen of each texture drawn by the commands,
+		// estimated from the bounds of the objects drawing them
+		void request_textures(const CommandList & commands,
+							  const Camera & camera,
+							  primitive::TextureResidency & residency)
 		{
-			return transform.placement.transform * cur_M;
+			for (const RenderTarget & command : commands)
+			{
+				const auto texture = command.shader_instance.sampled_texture();
+				if (!texture)
+				{
+					continue;
+				}
+
+				const auto bounds = command.renderable.bounds();
+				const float size =
+					bounds ? camera.screen_size(math::transform(command.M,
+																*bounds))
+						   : std::numeric_limits<float>::infinity();
+
+				residency.request(*texture, size);
+			}
 		}
 
-		mat4 dispatch(const SceneCamera & scene_camera,
-					  mat4 cur_M) const override
+		// Color of bounding spheres drawn for debugging
+		const vec3 bounding_sphere_color(1.0f, 1.0f, 0.0f);
+
+		// Draws the world space bounds of each object drawn by the commands
+		void draw_bounds(const CommandList & commands,
+						 primitive::DebugDraw & debug_draw)
 		{
-			if (scene_camera.active)
+			for (const RenderTarget & command : commands)
 			{
-				renderer.settings.camera = scene_camera.get_camera(cur_M);
+				if (const auto bounds = command.renderable.bounds())
+				{
+					debug_draw.sphere(math::transform(command.M, *bounds),
+									  bounding_sphere_color);
+				}
 			}
-			return cur_M;
 		}
-	};
 
-	Renderer Scene::prepare_renderer() const
-	{
-		using StateTuple = std::tuple<observer_ptr<const Node>, mat4>;
+		// Depth-first traversal that spills subtrees to a thread pool once
+		// a worker has enough pending work; each worker records into its
+		// own CommandList, merged into the Renderer at the end
+		class SceneTraversal
+		{
+			const SceneSettings & settings;
+			const bool parallel;
+			observer_ptr<util::ThreadPool> pool = nullptr;
 
-		std::stack<StateTuple> nodes;
+			CommandList caller_commands;
+			vector<CommandList> worker_commands;
+			LODList caller_lods;
+			vector<LODList> worker_lods;
+			CameraSlot camera_slot;
 
-		nodes.emplace(root.get(), mat4(1.0f));
+			// Frustum of the active camera, if culling
+			std::optional<math::Frustum> frustum;
+			// Culler holding the drawn occluders, if culling occluded nodes
+			observer_ptr<const OcclusionCuller> occlusion = nullptr;
+			std::atomic<std::uint64_t> culled = 0;
 
-		Renderer renderer;
-		RenderingSceneDispatcher dispatcher(renderer);
+			std::atomic<size_t> pending = 0;
+			std::mutex done_mutex;
+			std::condition_variable done;
+			std::exception_ptr error;
 
-		while (!nodes.empty())
-		{
-			StateTuple state = nodes.top();
-			nodes.pop();
+			void spawn(StateTuple state)
+			{
+				if (!pool)
+				{
+					pool = settings.thread_pool ? settings.thread_pool
+												: &util::ThreadPool::shared();
+					worker_commands.resize(pool->size());
+					worker_lods.resize(pool->size());
+				}
+
+				pending++;
+
+				pool->post([this, state] {
+					try
+					{
+						const size_t worker = *pool->current_worker();
+						traverse(state, worker_commands[worker],
+								 worker_lods[worker]);
+					}
+					catch (...)
+					{
+						std::lock_guard lock(done_mutex);
+						error = std::current_exception();
+					}
+
+					std::lock_guard lock(done_mutex);
+					if (--pending == 0)
+					{
+						done.notify_all();
+					}
+				});
+			}
+
+			// Whether a whole subtree may be skipped; subtrees with no
+			// geometry never draw anything, so are always skipped
+			bool outside_frustum(const NodeBounds & bounds) const
+			{
+				return !bounds.unbounded &&
+					   (!bounds.sphere ||
+						!math::contains(*frustum, *bounds.sphere));
+			}
+
+			// Coherent culling starts from the plane which last culled the
+			// node, and narrows the planes left to test for its children
+			bool outside_frustum(const Node & node, const NodeBounds & bounds,
+								 math::PlaneMask & planes) const
+			{
+				if (!settings.coherent_culling)
+				{
+					return outside_frustum(bounds);
+				}
+
+				return !bounds.unbounded &&
+					   (!bounds.sphere ||
+						!math::contains(*frustum, *bounds.sphere, planes,
+										node.culling_plane));
+			}
+
+			bool occluded(const Node & node, const NodeBounds & bounds) const
+			{
+				if (!occlusion || bounds.unbounded || !bounds.sphere)
+				{
+					return false;
+				}
+
+				const math::Sphere & sphere = *bounds.sphere;
+				return settings.coherent_culling
+						   ? !occlusion->visible(sphere, node.visibility)
+						   : !occlusion->visible(sphere);
+			}
+
+			bool skipped(const Node & node, const NodeBounds & bounds,
+						 math::PlaneMask & planes) const
+			{
+				return (frustum && outside_frustum(node, bounds, planes)) ||
+					   occluded(node, bounds);
+			}
+
+			// Draws the occluders into the culler, skipping those outside
+			// the frustum, once the camera is known
+			template<typename F>
+			void draw_occluders(F && for_each_occluder)
+			{
+				OcclusionCuller & culler = *settings.occlusion_culler;
+				culler.begin(*camera_slot.camera);
+
+				for_each_occluder([&](const Geometry & geometry, const mat4 & M,
+									  const NodeBounds & bounds) {
+					if (!frustum || !outside_frustum(bounds))
+					{
+						culler.add_occluder(*geometry.occluder, M);
+					}
+				});
+
+				culler.rasterize();
+				occlusion = &culler;
+			}
+
+			void traverse(StateTuple state, CommandList & commands,
+						  LODList & lods)
+			{
+				std::deque<StateTuple> nodes{state};
+
+				bool changed = false;
+				RenderingSceneDispatcher dispatcher(commands, lods,
+													camera_slot, changed);
+
+				while (!nodes.empty())
+				{
+					if (parallel && nodes.size() > split_threshold)
+					{
+						spawn(nodes.front());
+						nodes.pop_front();
+					}
+
+					auto [node_ptr, cur_M, parent_changed, planes] =
+						nodes.back();
+					nodes.pop_back();
+
+					if (skipped(*node_ptr, node_ptr->bounds, planes))
+					{
+						culled += node_ptr->bounds.geometry_count;
+						continue;
+					}
+
+					changed = parent_changed;
+					mat4 new_M = visit(*node_ptr, dispatcher, cur_M);
+
+					for (const Node & child : node_ptr->children())
+					{
+						nodes.emplace_back(&child, new_M, changed, planes);
+					}
+				}
+			}
+
+		public:
+			// Traversal from within a worker of the pool must stay serial,
+			// since waiting on its own queue could deadlock
+			explicit SceneTraversal(const SceneSettings & settings) :
+				settings(settings),
+				parallel(settings.parallel_traversal &&
+						 !(settings.thread_pool ? *settings.thread_pool
+												: util::ThreadPool::shared())
+							  .current_worker())
+			{}
 
-			auto [node_ptr, cur_M] = state;
+			void run(const Node & root, Renderer & renderer)
+			{
+				if (settings.enable_VF_culling || settings.occlusion_culler)
+				{
+					Occluders occluders;
+					compute_bounds(root, camera_slot, occluders);
+
+					if (settings.enable_VF_culling && camera_slot.camera)
+					{
+						frustum.emplace(camera_slot.camera->get_view_frustum());
+					}
+
+					if (settings.occlusion_culler && camera_slot.camera)
+					{
+						draw_occluders([&](auto && draw) {
+							for (const auto & [geometry, M] : occluders)
+							{
+								draw(*geometry, M, geometry->bounds);
+							}
+						});
+					}
+				}
+
+				traverse(StateTuple(&root, mat4(1.0f), false, math::all_planes),
+						 caller_commands, caller_lods);
+
+				{
+					std::unique_lock lock(done_mutex);
+					done.wait(lock, [this] { return pending == 0; });
+				}
+
+				if (error)
+				{
+					std::rethrow_exception(error);
+				}
+
+				finish(renderer);
+			}
+
+			void run(FlatScene & flat, Renderer & renderer)
+			{
+				flat.update_world();
+
+				for (const std::uint32_t camera : flat.cameras())
+				{
+					const auto & scene_camera =
+						static_cast<const SceneCamera &>(flat.node(camera));
+					if (scene_camera.active)
+					{
+						camera_slot.offer(scene_camera, flat.world(camera));
+						break;
+					}
+				}
+
+				if ((settings.enable_VF_culling || settings.occlusion_culler) &&
+					camera_slot.camera)
+				{
+					flat.update_bounds();
+				}
+
+				if (settings.enable_VF_culling && camera_slot.camera)
+				{
+					frustum.emplace(camera_slot.camera->get_view_frustum());
+				}
+
+				if (settings.occlusion_culler && camera_slot.camera)
+				{
+					draw_occluders([&](auto && draw) {
+						for (size_t i = 0; i < flat.size(); i++)
+						{
+							if (flat.kind(i) != NodeKind::Geometry)
+							{
+								continue;
+							}
+
+							const auto & geometry =
+								static_cast<const Geometry &>(flat.node(i));
+							if (geometry.occluder)
+							{
+								draw(geometry, flat.world(i), flat.bounds(i));
+							}
+						}
+					});
+				}
+
+				// Ends of the subtrees enclosing the current node, with the
+				// frustum planes left to test within each
+				vector<std::pair<std::uint32_t, math::PlaneMask>> enclosing;
+
+				for (size_t i = 0; i < flat.size();)
+				{
+					while (!enclosing.empty() && enclosing.back().first <= i)
+					{
+						enclosing.pop_back();
+					}
+
+					const math::PlaneMask inherited =
+						enclosing.empty() ? math::all_planes
+										  : enclosing.back().second;
+					math::PlaneMask planes = inherited;
+					if (skipped(flat.node(i), flat.bounds(i), planes))
+					{
+						culled += flat.bounds(i).geometry_count;
+						i = flat.subtree_end(i);
+						continue;
+					}
+
+					if (planes != inherited && flat.subtree_end(i) > i + 1)
+					{
+						enclosing.emplace_back(flat.subtree_end(i), planes);
+					}
+
+					if (flat.kind(i) == NodeKind::Geometry)
+					{
+						const auto & geometry =
+							static_cast<const Geometry &>(flat.node(i));
+						caller_commands.push_back(RenderTarget{
+							geometry.renderable, geometry.shader,
+							flat.world(i)});
+					}
+					else if (flat.kind(i) == NodeKind::LOD)
+					{
+						caller_lods.emplace_back(
+							&static_cast<const SceneLOD &>(flat.node(i)),
+							flat.world(i));
+					}
 
-			mat4 new_M = node_ptr->accept(dispatcher, cur_M);
+					i++;
+				}
 
-			std::for_each(node_ptr->children.cbegin(),
-						  node_ptr->children.cend(),
-						  [&](const unique_ptr<Node> & node) {
-							  nodes.emplace(node.get(), new_M);
-						  });
+				finish(renderer);
+			}
+
+			void record_lods(const LODList & lods)
+			{
+				for (const auto & [lod, M] : lods)
+				{
+					lod->record(*camera_slot.camera, settings.viewport_height,
+								M, caller_commands);
+				}
+			}
+
+			// Reports and enqueues the commands recorded by a traversal
+			void finish(Renderer & renderer)
+			{
+				if (camera_slot.camera)
+				{
+					record_lods(caller_lods);
+					for (const LODList & lods : worker_lods)
+					{
+						record_lods(lods);
+					}
+				}
+
+				if (settings.texture_residency && camera_slot.camera)
+				{
+					request_textures(caller_commands, *camera_slot.camera,
+									 *settings.texture_residency);
+					for (const CommandList & commands : worker_commands)
+					{
+						request_textures(commands, *camera_slot.camera,
+										 *settings.texture_residency);
+					}
+				}
+
+				if (settings.draw_bounding_spheres && settings.debug_draw)
+				{
+					draw_bounds(caller_commands, *settings.debug_draw);
+					for (const CommandList & commands : worker_commands)
+					{
+						draw_bounds(commands, *settings.debug_draw);
+					}
+				}
+
+				renderer.record_culled(culled);
+				renderer.enqueue(std::move(caller_commands));
+				for (CommandList & commands : worker_commands)
+				{
+					renderer.enqueue(std::move(commands));
+				}
+
+				renderer.settings.camera = std::move(camera_slot.camera);
+			}
+		};
+	}   // namespace
+
+	Renderer Scene::prepare_renderer() const
+	{
+		Renderer renderer;
+
+		if (settings.flat_traversal)
+		{
+			SceneTraversal(settings).run(flattened(), renderer);
+		}
+		else
+		{
+			SceneTraversal(settings).run(*root, renderer);
 		}
 
 		if (!renderer.settings.camera)
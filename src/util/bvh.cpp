@@ -0,0 +1,456 @@
+#include "glge/util/bvh.h"
+
+#include <glge/util/util.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace glge::math
+{
+	namespace
+	{
+		// Number of bins candidate SAH splits are chosen between
+		constexpr size_t sah_bins = 16;
+
+		bool overlaps(const AABB & a, const AABB & b)
+		{
+			return glm::all(glm::lessThanEqual(a.min, b.max)) &&
+				   glm::all(glm::lessThanEqual(b.min, a.max));
+		}
+	}   // namespace
+
+	vector<BVH::Leaf> BVH::build(const vector<Entry> & entries)
+	{
+		clear();
+
+		vector<Leaf> leaves;
+		leaves.reserve(entries.size());
+		nodes.reserve(entries.size() * 2);
+
+		for (const Entry & entry : entries)
+		{
+			const std::uint32_t leaf = allocate();
+			nodes[leaf] = Node{bounding_box(entry.bounds), entry.bounds,
+							   no_node, no_node, no_node, entry.item};
+			leaves.push_back(leaf);
+		}
+
+		leaf_count = entries.size();
+		if (!leaves.empty())
+		{
+			vector<std::uint32_t> order(leaves);
+			root = build_range(order.data(), order.data() + order.size());
+		}
+
+		return leaves;
+	}
+
+	std::uint32_t BVH::build_range(std::uint32_t * first,
+								   std::uint32_t * last)
+	{
+		const size_t count = static_cast<size_t>(last - first);
+		if (count == 1)
+		{
+			return *first;
+		}
+
+		AABB centroids{nodes[*first].sphere.origin,
+					   nodes[*first].sphere.origin};
+		for (auto leaf = first; leaf != last; ++leaf)
+		{
+			const vec3 origin = nodes[*leaf].sphere.origin;
+			centroids = enclose(centroids, AABB{origin, origin});
+		}
+
+		const vec3 extent = centroids.max - centroids.min;
+		const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0
+						 : extent.y >= extent.z                       ? 1
+																	  : 2;
+
+		std::uint32_t * middle = first + count / 2;
+
+		if (extent[axis] > 0.0f)
+		{
+			// Bin the leaves by centroid, then pick the boundary between
+			// bins with the least SAH cost
+			const auto bin_of = [&](std::uint32_t leaf) {
+				const float offset =
+					(nodes[leaf].sphere.origin[axis] - centroids.min[axis]) /
+					extent[axis];
+				return std::min(static_cast<size_t>(offset * sah_bins),
+								sah_bins - 1);
+			};
+
+			std::array<std::optional<AABB>, sah_bins> boxes;
+			std::array<size_t, sah_bins> counts{};
+			for (auto leaf = first; leaf != last; ++leaf)
+			{
+				const size_t bin = bin_of(*leaf);
+				const AABB & box = nodes[*leaf].box;
+				boxes[bin] = boxes[bin] ? enclose(*boxes[bin], box) : box;
+				counts[bin]++;
+			}
+
+			// Area and count of the leaves right of each boundary
+			std::array<float, sah_bins> right_area{};
+			std::array<size_t, sah_bins> right_count{};
+			std::optional<AABB> right;
+			size_t right_total = 0;
+			for (size_t bin = sah_bins - 1; bin > 0; bin--)
+			{
+				if (boxes[bin])
+				{
+					right = right ? enclose(*right, *boxes[bin]) : *boxes[bin];
+				}
+				right_total += counts[bin];
+				right_area[bin] = right ? surface_area(*right) : 0.0f;
+				right_count[bin] = right_total;
+			}
+
+			std::optional<AABB> left;
+			size_t left_total = 0;
+			size_t best_split = 0;
+			float best_cost = std::numeric_limits<float>::infinity();
+			for (size_t bin = 1; bin < sah_bins; bin++)
+			{
+				if (boxes[bin - 1])
+				{
+					left = left ? enclose(*left, *boxes[bin - 1])
+								: *boxes[bin - 1];
+				}
+				left_total += counts[bin - 1];
+
+				if (left_total == 0 || right_count[bin] == 0)
+				{
+					continue;
+				}
+
+				const float cost =
+					surface_area(*left) * static_cast<float>(left_total) +
+					right_area[bin] * static_cast<float>(right_count[bin]);
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_split = bin;
+				}
+			}
+
+			if (best_split > 0)
+			{
+				middle = std::partition(first, last, [&](std::uint32_t leaf) {
+					return bin_of(leaf) < best_split;
+				});
+			}
+		}
+
+		// Leaves sharing a centroid are split evenly
+		if (middle == first || middle == last || extent[axis] <= 0.0f)
+		{
+			middle = first + count / 2;
+			std::nth_element(first, middle, last,
+							 [&](std::uint32_t a, std::uint32_t b) {
+								 return nodes[a].sphere.origin[axis] <
+										nodes[b].sphere.origin[axis];
+							 });
+		}
+
+		const std::uint32_t left = build_range(first, middle);
+		const std::uint32_t right = build_range(middle, last);
+
+		const std::uint32_t node = allocate();
+		nodes[node] = Node{enclose(nodes[left].box, nodes[right].box),
+						   Sphere{0.0f, vec3(0.0f)},
+						   no_node,
+						   left,
+						   right,
+						   0};
+		nodes[left].parent = node;
+		nodes[right].parent = node;
+
+		return node;
+	}
+
+	BVH::Leaf BVH::insert(Sphere bounds, Item item)
+	{
+		const std::uint32_t leaf = allocate();
+		nodes[leaf] = Node{bounding_box(bounds), bounds, no_node,
+						   no_node, no_node, item};
+
+		insert_leaf(leaf);
+		leaf_count++;
+
+		return leaf;
+	}
+
+	void BVH::update(Leaf leaf, Sphere bounds)
+	{
+		const AABB box = bounding_box(bounds);
+		nodes[leaf].sphere = bounds;
+
+		// Refitting after a jump would stretch every box on the way up
+		if (!overlaps(box, nodes[leaf].box))
+		{
+			remove_leaf(leaf);
+			nodes[leaf].box = box;
+			insert_leaf(leaf);
+			return;
+		}
+
+		nodes[leaf].box = box;
+		refit(nodes[leaf].parent);
+	}
+
+	void BVH::remove(Leaf leaf)
+	{
+		if (leaf >= nodes.size() || !nodes[leaf].leaf())
+		{
+			throw std::invalid_argument(EXC_MSG("Not a leaf of the BVH"));
+		}
+
+		remove_leaf(leaf);
+		release(leaf);
+		leaf_count--;
+	}
+
+	void BVH::clear()
+	{
+		nodes.clear();
+		free_nodes.clear();
+		root = no_node;
+		leaf_count = 0;
+	}
+
+	float BVH::cost() const
+	{
+		if (root == no_node || nodes[root].leaf())
+		{
+			return 0.0f;
+		}
+
+		float area = 0.0f;
+		LocalStack<std::uint32_t> pending;
+		pending.push(root);
+
+		while (!pending.empty())
+		{
+			const Node & node = nodes[pending.pop()];
+			if (!node.leaf())
+			{
+				area += surface_area(node.box);
+				pending.push(node.left);
+				pending.push(node.right);
+			}
+		}
+
+		return area / surface_area(nodes[root].box);
+	}
+
+	std::uint32_t BVH::allocate()
+	{
+		if (!free_nodes.empty())
+		{
+			const std::uint32_t node = free_nodes.back();
+			free_nodes.pop_back();
+			return node;
+		}
+
+		if (nodes.size() >= no_node)
+		{
+			throw std::length_error(EXC_MSG("BVH has too many nodes"));
+		}
+
+		nodes.emplace_back();
+		return static_cast<std::uint32_t>(nodes.size() - 1);
+	}
+
+	void BVH::release(std::uint32_t node)
+	{
+		// Marked as an inner node, so that stale leaf handles are caught
+		nodes[node].left = 0;
+		free_nodes.push_back(node);
+	}
+
+	void BVH::insert_leaf(std::uint32_t leaf)
+	{
+		if (root == no_node)
+		{
+			root = leaf;
+			nodes[leaf].parent = no_node;
+			return;
+		}
+
+		const AABB box = nodes[leaf].box;
+		const float area = surface_area(box);
+
+		// Branch and bound search for the sibling adding least area,
+		// counting the growth of every ancestor of each candidate
+		struct Candidate
+		{
+			std::uint32_t node;
+			float inherited;
+		};
+
+		std::uint32_t best = root;
+		float best_cost = surface_area(enclose(nodes[root].box, box));
+
+		LocalStack<Candidate> pending;
+		pending.push(Candidate{root, 0.0f});
+
+		while (!pending.empty())
+		{
+			const Candidate candidate = pending.pop();
+			const Node & node = nodes[candidate.node];
+
+			const float direct = surface_area(enclose(node.box, box));
+			const float cost = direct + candidate.inherited;
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best = candidate.node;
+			}
+
+			if (node.leaf())
+			{
+				continue;
+			}
+
+			const float inherited =
+				candidate.inherited + direct - surface_area(node.box);
+			if (area + inherited < best_cost)
+			{
+				pending.push(Candidate{node.left, inherited});
+				pending.push(Candidate{node.right, inherited});
+			}
+		}
+
+		const std::uint32_t old_parent = nodes[best].parent;
+		const std::uint32_t new_parent = allocate();
+		nodes[new_parent] = Node{enclose(nodes[best].box, box),
+								 Sphere{0.0f, vec3(0.0f)},
+								 old_parent,
+								 best,
+								 leaf,
+								 0};
+		nodes[best].parent = new_parent;
+		nodes[leaf].parent = new_parent;
+
+		if (old_parent == no_node)
+		{
+			root = new_parent;
+		}
+		else
+		{
+			replace_child(old_parent, best, new_parent);
+		}
+
+		refit(old_parent);
+	}
+
+	void BVH::remove_leaf(std::uint32_t leaf)
+	{
+		if (leaf == root)
+		{
+			root = no_node;
+			return;
+		}
+
+		const std::uint32_t parent = nodes[leaf].parent;
+		const std::uint32_t grandparent = nodes[parent].parent;
+		const std::uint32_t sibling = nodes[parent].left == leaf
+										  ? nodes[parent].right
+										  : nodes[parent].left;
+
+		nodes[sibling].parent = grandparent;
+		if (grandparent == no_node)
+		{
+			root = sibling;
+		}
+		else
+		{
+			replace_child(grandparent, parent, sibling);
+		}
+
+		release(parent);
+		refit(grandparent);
+	}
+
+	void BVH::replace_child(std::uint32_t parent, std::uint32_t old_child,
+							std::uint32_t new_child)
+	{
+		if (nodes[parent].left == old_child)
+		{
+			nodes[parent].left = new_child;
+		}
+		else
+		{
+			nodes[parent].right = new_child;
+		}
+	}
+
+	void BVH::refit(std::uint32_t node)
+	{
+		while (node != no_node)
+		{
+			Node & inner = nodes[node];
+			inner.box = enclose(nodes[inner.left].box, nodes[inner.right].box);
+			rotate(node);
+
+			node = inner.parent;
+		}
+	}
+
+	void BVH::rotate(std::uint32_t node)
+	{
+		// Swapping a child with a grandchild on the other side only
+		// changes the box of the grandchild's parent, so the best swap is
+		// the one shrinking that box most
+		const std::uint32_t b = nodes[node].left;
+		const std::uint32_t c = nodes[node].right;
+
+		float best_gain = 0.0f;
+		std::uint32_t swap_child = no_node, swap_grandchild = no_node;
+
+		const auto consider = [&](std::uint32_t child, std::uint32_t other) {
+			const Node & inner = nodes[other];
+			if (inner.leaf())
+			{
+				return;
+			}
+
+			const float area = surface_area(inner.box);
+			const std::uint32_t grandchildren[2] = {inner.left, inner.right};
+			for (int i = 0; i < 2; i++)
+			{
+				const std::uint32_t kept = grandchildren[1 - i];
+				const float gain =
+					area -
+					surface_area(enclose(nodes[child].box, nodes[kept].box));
+				if (gain > best_gain)
+				{
+					best_gain = gain;
+					swap_child = child;
+					swap_grandchild = grandchildren[i];
+				}
+			}
+		};
+
+		consider(b, c);
+		consider(c, b);
+
+		if (swap_child == no_node)
+		{
+			return;
+		}
+
+		const std::uint32_t other = swap_child == b ? c : b;
+
+		replace_child(node, swap_child, swap_grandchild);
+		nodes[swap_grandchild].parent = node;
+
+		replace_child(other, swap_grandchild, swap_child);
+		nodes[swap_child].parent = other;
+
+		Node & parent = nodes[other];
+		parent.box = enclose(nodes[parent.left].box, nodes[parent.right].box);
+	}
+}   // namespace glge::math
@@ -0,0 +1,130 @@
+#include <internal/util/_compat.h>
+
+#include <glge/common.h>
+#include <glge/util/util.h>
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace glge::util
+{
+#if _WIN32
+	MappedFile::MappedFile(const string & path)
+	{
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+								  nullptr, OPEN_EXISTING,
+								  FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error(EXC_MSG("Failed to open file " + path));
+		}
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size))
+		{
+			CloseHandle(file);
+			throw std::runtime_error(
+				EXC_MSG("Failed to get size of file " + path));
+		}
+
+		length = static_cast<size_t>(file_size.QuadPart);
+
+		if (length == 0)
+		{
+			CloseHandle(file);
+			return;
+		}
+
+		HANDLE mapping =
+			CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		// The view keeps the mapping and file open once created
+		CloseHandle(file);
+
+		if (!mapping)
+		{
+			throw std::runtime_error(EXC_MSG("Failed to map file " + path));
+		}
+
+		bytes = static_cast<const std::uint8_t *>(
+			MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		CloseHandle(mapping);
+
+		if (!bytes)
+		{
+			throw std::runtime_error(EXC_MSG("Failed to map file " + path));
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (bytes)
+		{
+			UnmapViewOfFile(bytes);
+		}
+	}
+#else
+	MappedFile::MappedFile(const string & path)
+	{
+		int file = open(path.c_str(), O_RDONLY);
+
+		if (file < 0)
+		{
+			throw std::runtime_error(EXC_MSG("Failed to open file " + path));
+		}
+
+		struct stat file_stat;
+		if (fstat(file, &file_stat) != 0)
+		{
+			close(file);
+			throw std::runtime_error(
+				EXC_MSG("Failed to get size of file " + path));
+		}
+
+		length = static_cast<size_t>(file_stat.st_size);
+
+		// Zero-length mappings are invalid
+		if (length == 0)
+		{
+			close(file);
+			return;
+		}
+
+		void * mapping =
+			mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+
+		// The mapping keeps the file open once created
+		close(file);
+
+		if (mapping == MAP_FAILED)
+		{
+			throw std::runtime_error(EXC_MSG("Failed to map file " + path));
+		}
+
+		bytes = static_cast<const std::uint8_t *>(mapping);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (bytes)
+		{
+			munmap(const_cast<std::uint8_t *>(bytes), length);
+		}
+	}
+#endif
+
+	MappedFile::MappedFile(MappedFile && other) noexcept :
+		bytes(other.bytes), length(other.length)
+	{
+		other.bytes = nullptr;
+		other.length = 0;
+	}
+}   // namespace glge::util
@@ -1,8 +1,11 @@
 #include "glge/util/heightmap.h"
 
+#include <glge/util/util.h>
 #include <internal/util/_compat.h>
 #include <internal/util/_util.h>
 
+#include <algorithm>
+
 namespace glge::util
 {
 	vector<unsigned int> heightmap_indices(size_t width, size_t height)
@@ -53,7 +56,7 @@ namespace glge::util
 
 			vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
 
-			normals.at(indices.at(i + 0)) = normal;
+			normals.at(indices.at(i + 0)) += normal;
 			normals.at(indices.at(i + 1)) += normal;
 			normals.at(indices.at(i + 2)) += normal;
 		}
@@ -65,6 +68,96 @@ namespace glge::util
 		return normals;
 	}
 
+	std::pair<size_t, size_t>
+	update_heightmap_normals(const vector<vec3> & heightmap, size_t width,
+							 size_t height, size_t x_begin, size_t z_begin,
+							 size_t x_end, size_t z_end,
+							 vector<vec3> & normals)
+	{
+		if (heightmap.size() != width * height ||
+			normals.size() != heightmap.size())
+		{
+			throw std::invalid_argument(
+				EXC_MSG("Heightmap and normals do not match the dimensions"));
+		}
+
+		if (x_end > width || z_end > height)
+		{
+			throw std::out_of_range(
+				EXC_MSG("Edited region lies outside the heightmap"));
+		}
+
+		if (x_begin >= x_end || z_begin >= z_end)
+		{
+			return {0, 0};
+		}
+
+		// Points sharing a triangle with a moved point, whose normals change
+		const size_t x0 = x_begin > 0 ? x_begin - 1 : 0;
+		const size_t z0 = z_begin > 0 ? z_begin - 1 : 0;
+		const size_t x1 = std::min(x_end + 1, width);
+		const size_t z1 = std::min(z_end + 1, height);
+
+		const auto changed = [&](size_t index) {
+			const size_t x = index % width, z = index / width;
+			return x >= x0 && x < x1 && z >= z0 && z < z1;
+		};
+
+		for (size_t z = z0; z < z1; z++)
+		{
+			for (size_t x = x0; x < x1; x++)
+			{
+				normals[z * width + x] = vec3(0.0f);
+			}
+		}
+
+		const auto add_triangle = [&](size_t i0, size_t i1, size_t i2) {
+			const vec3 v0 = heightmap[i0];
+			const vec3 v1 = heightmap[i1];
+			const vec3 v2 = heightmap[i2];
+
+			const vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+
+			for (size_t index : {i0, i1, i2})
+			{
+				if (changed(index))
+				{
+					normals[index] += normal;
+				}
+			}
+		};
+
+		// Every quad touching a changed point, in heightmap_indices order
+		const size_t quad_x0 = x0 > 0 ? x0 - 1 : 0;
+		const size_t quad_z0 = z0 > 0 ? z0 - 1 : 0;
+		const size_t quad_x1 = std::min(x1, width - 1);
+		const size_t quad_z1 = std::min(z1, height - 1);
+
+		for (size_t z = quad_z0; z < quad_z1; z++)
+		{
+			for (size_t x = quad_x0; x < quad_x1; x++)
+			{
+				const size_t vertex_num = z * width + x;
+
+				add_triangle(vertex_num, vertex_num + width + 1,
+							 vertex_num + 1);
+				add_triangle(vertex_num, vertex_num + width,
+							 vertex_num + width + 1);
+			}
+		}
+
+		for (size_t z = z0; z < z1; z++)
+		{
+			for (size_t x = x0; x < x1; x++)
+			{
+				vec3 & normal = normals[z * width + x];
+				normal = glm::normalize(normal);
+			}
+		}
+
+		return {z0 * width + x0, (z1 - 1) * width + x1};
+	}
+
 	vector<vec2> heightmap_uvs(size_t width, size_t height)
 	{
 		vector<vec2> uvs(width * height);
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <numeric>
 
 namespace glge::math
@@ -45,6 +46,202 @@ namespace glge::math
 			   contains(frustum.top, sphere);
 	}
 
+	bool contains(const Frustum & frustum, Sphere sphere, PlaneMask & mask,
+				  std::uint8_t & last_failed)
+	{
+		const std::array<const Plane *, 6> planes{
+			&frustum.near,  &frustum.far,    &frustum.left,
+			&frustum.right, &frustum.bottom, &frustum.top};
+
+		// Starting from the plane which last failed, wrapping around
+		for (size_t i = 0; i < planes.size() && mask; i++)
+		{
+			const size_t index = (last_failed + i) % planes.size();
+			const PlaneMask bit = PlaneMask(1u << index);
+			if (!(mask & bit))
+			{
+				continue;
+			}
+
+			const float distance = planes[index]->distance_from(sphere.origin);
+			if (distance <= -sphere.radius)
+			{
+				last_failed = static_cast<std::uint8_t>(index);
+				return false;
+			}
+
+			if (distance >= sphere.radius)
+			{
+				mask = PlaneMask(mask & ~bit);
+			}
+		}
+
+		return true;
+	}
+
+	Sphere bounding_sphere(const vector<vec3> & points)
+	{
+		if (points.empty())
+		{
+			return Sphere{0.0f, vec3(0.0f)};
+		}
+
+		vec3 low = points.front(), high = points.front();
+		for (const vec3 & point : points)
+		{
+			low = glm::min(low, point);
+			high = glm::max(high, point);
+		}
+
+		const vec3 center = (low + high) / 2.0f;
+
+		float radius_sq = 0.0f;
+		for (const vec3 & point : points)
+		{
+			radius_sq = std::max(radius_sq, glm::dot(point - center,
+													  point - center));
+		}
+
+		return Sphere{std::sqrt(radius_sq), center};
+	}
+
+	Sphere enclose(Sphere a, Sphere b)
+	{
+		const vec3 offset = b.origin - a.origin;
+		const float distance = glm::length(offset);
+
+		// One sphere may already lie within the other
+		if (distance + b.radius <= a.radius)
+		{
+			return a;
+		}
+		if (distance + a.radius <= b.radius)
+		{
+			return b;
+		}
+
+		const float radius = (distance + a.radius + b.radius) / 2.0f;
+		return Sphere{radius, a.origin + offset * ((radius - a.radius) /
+												   distance)};
+	}
+
+	Sphere transform(const mat4 & M, Sphere sphere)
+	{
+		const float scale = std::sqrt(
+			std::max({glm::dot(vec3(M[0]), vec3(M[0])),
+					  glm::dot(vec3(M[1]), vec3(M[1])),
+					  glm::dot(vec3(M[2]), vec3(M[2]))}));
+
+		return Sphere{sphere.radius * scale,
+					  vec3(M * vec4(sphere.origin, 1.0f))};
+	}
+
+	AABB bounding_box(Sphere sphere)
+	{
+		return AABB{sphere.origin - sphere.radius,
+					sphere.origin + sphere.radius};
+	}
+
+	AABB enclose(const AABB & a, const AABB & b)
+	{
+		return AABB{glm::min(a.min, b.min), glm::max(a.max, b.max)};
+	}
+
+	float surface_area(const AABB & box)
+	{
+		const vec3 size = box.max - box.min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	bool contains(const AABB & outer, const AABB & inner)
+	{
+		return glm::all(glm::lessThanEqual(outer.min, inner.min)) &&
+			   glm::all(glm::lessThanEqual(inner.max, outer.max));
+	}
+
+	// Whether any of a box lies on the inside of a plane, tested with the
+	// corner furthest along the plane's normal
+	static bool contains(const Plane & plane, const AABB & box)
+	{
+		const vec3 corner(plane.normal.x > 0.0f ? box.max.x : box.min.x,
+						  plane.normal.y > 0.0f ? box.max.y : box.min.y,
+						  plane.normal.z > 0.0f ? box.max.z : box.min.z);
+
+		return plane.distance_from(corner) >= 0.0f;
+	}
+
+	bool contains(const Frustum & frustum, const AABB & box)
+	{
+		return contains(frustum.near, box) && contains(frustum.far, box) &&
+			   contains(frustum.left, box) && contains(frustum.right, box) &&
+			   contains(frustum.bottom, box) && contains(frustum.top, box);
+	}
+
+	bool intersects(Sphere a, Sphere b)
+	{
+		const vec3 offset = b.origin - a.origin;
+		const float reach = a.radius + b.radius;
+
+		return glm::dot(offset, offset) <= reach * reach;
+	}
+
+	bool intersects(const AABB & box, Sphere sphere)
+	{
+		const vec3 offset =
+			glm::clamp(sphere.origin, box.min, box.max) - sphere.origin;
+
+		return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+	}
+
+	std::optional<float> intersect(const Ray & ray, Sphere sphere)
+	{
+		const vec3 offset = ray.origin - sphere.origin;
+		const float c =
+			glm::dot(offset, offset) - sphere.radius * sphere.radius;
+		if (c <= 0.0f)
+		{
+			return 0.0f;
+		}
+
+		// Solve |offset + t * direction|^2 = radius^2 for the nearer t
+		const float b = glm::dot(offset, ray.direction);
+		const float discriminant = b * b - c;
+		if (b > 0.0f || discriminant < 0.0f)
+		{
+			return std::nullopt;
+		}
+
+		return -b - std::sqrt(discriminant);
+	}
+
+	std::optional<float> intersect(const Ray & ray, const AABB & box)
+	{
+		// Clip the ray against the slab between each pair of faces
+		float near = 0.0f;
+		float far = std::numeric_limits<float>::infinity();
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float inverse = 1.0f / ray.direction[axis];
+			float t0 = (box.min[axis] - ray.origin[axis]) * inverse;
+			float t1 = (box.max[axis] - ray.origin[axis]) * inverse;
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+
+			// Parallel rays give NaN within the slab, which is skipped
+			near = t0 > near ? t0 : near;
+			far = t1 < far ? t1 : far;
+			if (near > far)
+			{
+				return std::nullopt;
+			}
+		}
+
+		return near;
+	}
+
 	// Geometric basis matrix for a Cubic bezier curve - universally constant
 	const mat4 BezierCurve::basis = mat4(vec4{-1, 3, -3, 1},
 										 vec4{3, -6, 3, 0},
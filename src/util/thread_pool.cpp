@@ -0,0 +1,155 @@
+#include "glge/util/thread_pool.h"
+
+#include <algorithm>
+
+namespace glge::util
+{
+	namespace
+	{
+		struct WorkerIdentity
+		{
+			observer_ptr<const ThreadPool> pool = nullptr;
+			size_t index = 0;
+		};
+
+		thread_local WorkerIdentity worker_identity;
+	}   // namespace
+
+	ThreadPool::ThreadPool(size_t thread_count)
+	{
+		thread_count = std::max<size_t>(thread_count, 1);
+
+		workers.reserve(thread_count);
+		for (size_t i = 0; i < thread_count; i++)
+		{
+			workers.emplace_back(std::make_unique<Worker>());
+		}
+
+		threads.reserve(thread_count);
+		for (size_t i = 0; i < thread_count; i++)
+		{
+			threads.emplace_back([this, i] { run(i); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(sleep_mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+
+		for (auto & thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	ThreadPool & ThreadPool::shared()
+	{
+		static ThreadPool pool(
+			std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1);
+		return pool;
+	}
+
+	size_t ThreadPool::size() const { return workers.size(); }
+
+	std::optional<size_t> ThreadPool::current_worker() const
+	{
+		if (worker_identity.pool == this)
+		{
+			return worker_identity.index;
+		}
+
+		return std::nullopt;
+	}
+
+	void ThreadPool::post(Task task)
+	{
+		// Workers push to their own queue; other threads spread tasks
+		// across all queues
+		size_t index = current_worker().value_or(
+			next_queue.fetch_add(1, std::memory_order_relaxed) %
+			workers.size());
+
+		{
+			Worker & worker = *workers[index];
+			std::lock_guard lock(worker.mutex);
+			worker.tasks.emplace_back(std::move(task));
+		}
+
+		{
+			std::lock_guard lock(sleep_mutex);
+			queued++;
+		}
+		wake.notify_one();
+	}
+
+	bool ThreadPool::try_pop(size_t index, Task & task)
+	{
+		auto take = [&](size_t victim, bool own) {
+			Worker & worker = *workers[victim];
+			std::lock_guard lock(worker.mutex);
+
+			if (worker.tasks.empty())
+			{
+				return false;
+			}
+
+			if (own)
+			{
+				task = std::move(worker.tasks.back());
+				worker.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(worker.tasks.front());
+				worker.tasks.pop_front();
+			}
+
+			return true;
+		};
+
+		bool found = take(index, true);
+
+		for (size_t i = 1; !found && i < workers.size(); i++)
+		{
+			found = take((index + i) % workers.size(), false);
+		}
+
+		if (found)
+		{
+			std::lock_guard lock(sleep_mutex);
+			queued--;
+		}
+
+		return found;
+	}
+
+	void ThreadPool::run(size_t index)
+	{
+		worker_identity = WorkerIdentity{this, index};
+
+		Task task;
+
+		while (true)
+		{
+			if (try_pop(index, task))
+			{
+				task();
+				task = nullptr;
+				continue;
+			}
+
+			std::unique_lock lock(sleep_mutex);
+
+			if (queued == 0 && stopping)
+			{
+				return;
+			}
+
+			wake.wait(lock, [this] { return queued > 0 || stopping; });
+		}
+	}
+}   // namespace glge::util
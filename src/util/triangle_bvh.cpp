@@ -0,0 +1,382 @@
+#include "glge/util/triangle_bvh.h"
+
+#include <glge/util/util.h>
+#include <internal/util/_compat.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace glge::math
+{
+	namespace
+	{
+		// Number of bins candidate SAH splits are chosen between
+		constexpr size_t sah_bins = 16;
+
+		// Leaves hold at most this many triangles, as counts are packed
+		// into 4 bits
+		constexpr size_t max_leaf_size = 15;
+
+		// Cost of visiting a node, relative to testing a triangle
+		constexpr float traversal_cost = 1.0f;
+
+		std::uint32_t leaf_triangles(size_t first, size_t count)
+		{
+			return static_cast<std::uint32_t>(first << 4 | count);
+		}
+
+		AABB triangle_box(const TriangleBVH::Triangle & triangle)
+		{
+			return AABB{glm::min(triangle.a, glm::min(triangle.b, triangle.c)),
+						glm::max(triangle.a, glm::max(triangle.b, triangle.c))};
+		}
+
+		vec3 centroid(const AABB & box) { return (box.min + box.max) * 0.5f; }
+
+		// Ray with its reciprocal direction, for repeated slab tests
+		struct PreparedRay
+		{
+			vec3 origin;
+			vec3 direction;
+			vec3 inverse;
+		};
+
+		// Tests whether a ray enters a node's box no further than a limit
+		bool enters(const PreparedRay & ray, const TriangleBVH::Node & node,
+					float limit)
+		{
+			float near = 0.0f;
+			float far = limit;
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				const float inverse = ray.inverse[axis];
+				float t0 = (node.min[axis] - ray.origin[axis]) * inverse;
+				float t1 = (node.max[axis] - ray.origin[axis]) * inverse;
+				if (t0 > t1)
+				{
+					std::swap(t0, t1);
+				}
+
+				// Parallel rays give NaN within the slab, which is skipped
+				near = t0 > near ? t0 : near;
+				far = t1 < far ? t1 : far;
+				if (near > far)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Moller-Trumbore, accepting hits from either side
+		std::optional<TriangleBVH::Hit>
+		intersect_triangle(const PreparedRay & ray,
+						   const TriangleBVH::Triangle & triangle)
+		{
+			const vec3 ab = triangle.b - triangle.a;
+			const vec3 ac = triangle.c - triangle.a;
+			const vec3 p = glm::cross(ray.direction, ac);
+			const float determinant = glm::dot(ab, p);
+
+			if (std::abs(determinant) < std::numeric_limits<float>::epsilon())
+			{
+				return std::nullopt;
+			}
+
+			const float inverse = 1.0f / determinant;
+			const vec3 offset = ray.origin - triangle.a;
+			const float u = glm::dot(offset, p) * inverse;
+			if (u < 0.0f || u > 1.0f)
+			{
+				return std::nullopt;
+			}
+
+			const vec3 q = glm::cross(offset, ab);
+			const float v = glm::dot(ray.direction, q) * inverse;
+			if (v < 0.0f || u + v > 1.0f)
+			{
+				return std::nullopt;
+			}
+
+			const float distance = glm::dot(ac, q) * inverse;
+			if (distance < 0.0f)
+			{
+				return std::nullopt;
+			}
+
+			return TriangleBVH::Hit{triangle.id, distance, vec2(u, v)};
+		}
+	}   // namespace
+
+	TriangleBVH::TriangleBVH(vector<Triangle> mesh_triangles)
+	{
+		if (mesh_triangles.empty())
+		{
+			return;
+		}
+
+		if (mesh_triangles.size() >= (size_t(1) << 28))
+		{
+			throw std::length_error(
+				EXC_MSG("Mesh has too many triangles for a TriangleBVH"));
+		}
+
+		vector<AABB> boxes;
+		vector<std::uint32_t> order;
+		boxes.reserve(mesh_triangles.size());
+		order.reserve(mesh_triangles.size());
+
+		for (const Triangle & triangle : mesh_triangles)
+		{
+			order.push_back(static_cast<std::uint32_t>(boxes.size()));
+			boxes.push_back(triangle_box(triangle));
+		}
+
+		nodes.reserve(mesh_triangles.size());
+		build_range(order, boxes, 0, order.size());
+
+		triangles.reserve(order.size());
+		for (const std::uint32_t index : order)
+		{
+			triangles.push_back(mesh_triangles[index]);
+		}
+	}
+
+	TriangleBVH::TriangleBVH(vector<Node> nodes, vector<Triangle> triangles) :
+		nodes(std::move(nodes)), triangles(std::move(triangles))
+	{
+		const auto invalid = [] {
+			return std::invalid_argument(
+				EXC_MSG("Nodes do not form a TriangleBVH"));
+		};
+
+		if (this->nodes.empty() != this->triangles.empty() ||
+			(!this->nodes.empty() && this->nodes[0].skip != this->nodes.size()))
+		{
+			throw invalid();
+		}
+
+		// Every search must move forward and stay within the nodes
+		for (size_t i = 0; i < this->nodes.size(); i++)
+		{
+			const Node & node = this->nodes[i];
+			const size_t first = node.triangles >> 4;
+			const size_t count = node.triangles & 0xf;
+
+			if (node.skip <= i || node.skip > this->nodes.size() ||
+				(node.triangles != 0 &&
+				 (count == 0 || first + count > this->triangles.size())) ||
+				(node.triangles == 0 && i + 1 >= this->nodes.size()))
+			{
+				throw invalid();
+			}
+		}
+	}
+
+	void TriangleBVH::build_range(vector<std::uint32_t> & order,
+								  const vector<AABB> & boxes, size_t first,
+								  size_t last)
+	{
+		const size_t node = nodes.size();
+		nodes.emplace_back();
+
+		AABB box = boxes[order[first]];
+		AABB centroids{centroid(box), centroid(box)};
+		for (size_t i = first; i < last; i++)
+		{
+			const AABB & item = boxes[order[i]];
+			const vec3 center = centroid(item);
+			box = enclose(box, item);
+			centroids = enclose(centroids, AABB{center, center});
+		}
+
+		nodes[node].min = box.min;
+		nodes[node].max = box.max;
+
+		const size_t count = last - first;
+		const vec3 extent = centroids.max - centroids.min;
+		const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0
+						 : extent.y >= extent.z                       ? 1
+																	  : 2;
+
+		size_t middle = first + count / 2;
+		float split_cost = std::numeric_limits<float>::infinity();
+
+		if (count > 1 && extent[axis] > 0.0f)
+		{
+			const auto bin_of = [&](std::uint32_t index) {
+				const float offset =
+					(centroid(boxes[index])[axis] - centroids.min[axis]) /
+					extent[axis];
+				return std::min(static_cast<size_t>(offset * sah_bins),
+								sah_bins - 1);
+			};
+
+			std::array<std::optional<AABB>, sah_bins> bins;
+			std::array<size_t, sah_bins> counts{};
+			for (size_t i = first; i < last; i++)
+			{
+				const size_t bin = bin_of(order[i]);
+				const AABB & item = boxes[order[i]];
+				bins[bin] = bins[bin] ? enclose(*bins[bin], item) : item;
+				counts[bin]++;
+			}
+
+			// Area and count of the triangles right of each boundary
+			std::array<float, sah_bins> right_area{};
+			std::array<size_t, sah_bins> right_count{};
+			std::optional<AABB> right;
+			size_t right_total = 0;
+			for (size_t bin = sah_bins - 1; bin > 0; bin--)
+			{
+				if (bins[bin])
+				{
+					right = right ? enclose(*right, *bins[bin]) : *bins[bin];
+				}
+				right_total += counts[bin];
+				right_area[bin] = right ? surface_area(*right) : 0.0f;
+				right_count[bin] = right_total;
+			}
+
+			std::optional<AABB> left;
+			size_t left_total = 0;
+			size_t best_split = 0;
+			for (size_t bin = 1; bin < sah_bins; bin++)
+			{
+				if (bins[bin - 1])
+				{
+					left = left ? enclose(*left, *bins[bin - 1])
+								: *bins[bin - 1];
+				}
+				left_total += counts[bin - 1];
+
+				if (left_total == 0 || right_count[bin] == 0)
+				{
+					continue;
+				}
+
+				const float cost =
+					surface_area(*left) * static_cast<float>(left_total) +
+					right_area[bin] * static_cast<float>(right_count[bin]);
+				if (cost < split_cost)
+				{
+					split_cost = cost;
+					best_split = bin;
+				}
+			}
+
+			const float area = surface_area(box);
+			split_cost = area > 0.0f
+							 ? traversal_cost + split_cost / area
+							 : traversal_cost + static_cast<float>(count);
+
+			if (best_split > 0)
+			{
+				middle = static_cast<size_t>(
+					std::partition(order.begin() + first,
+								   order.begin() + last,
+								   [&](std::uint32_t index) {
+									   return bin_of(index) < best_split;
+								   }) -
+					order.begin());
+			}
+		}
+
+		// Ranges are kept whole when testing all of their triangles costs
+		// no more than splitting them
+		if (count == 1 ||
+			(count <= max_leaf_size && static_cast<float>(count) <= split_cost))
+		{
+			nodes[node].triangles = leaf_triangles(first, count);
+			nodes[node].skip = static_cast<std::uint32_t>(nodes.size());
+			return;
+		}
+
+		// Triangles sharing a centroid are split evenly
+		if (middle == first || middle == last || extent[axis] <= 0.0f)
+		{
+			middle = first + count / 2;
+			std::nth_element(order.begin() + first, order.begin() + middle,
+							 order.begin() + last,
+							 [&](std::uint32_t a, std::uint32_t b) {
+								 return centroid(boxes[a])[axis] <
+										centroid(boxes[b])[axis];
+							 });
+		}
+
+		build_range(order, boxes, first, middle);
+		build_range(order, boxes, middle, last);
+
+		nodes[node].triangles = 0;
+		nodes[node].skip = static_cast<std::uint32_t>(nodes.size());
+	}
+
+	std::optional<TriangleBVH::Hit>
+	TriangleBVH::intersect(const Ray & ray, float max_distance) const
+	{
+		const PreparedRay prepared{ray.origin, ray.direction,
+								   1.0f / ray.direction};
+
+		std::optional<Hit> nearest;
+		float limit = max_distance;
+
+		// Missed subtrees and finished leaves both resume at their skip
+		size_t index = 0;
+		while (index < nodes.size())
+		{
+			const Node & node = nodes[index];
+			if (!enters(prepared, node, limit))
+			{
+				index = node.skip;
+				continue;
+			}
+
+			if (node.triangles == 0)
+			{
+				index++;
+				continue;
+			}
+
+			const size_t first = node.triangles >> 4;
+			const size_t last = first + (node.triangles & 0xf);
+			for (size_t i = first; i < last; i++)
+			{
+				const auto hit = intersect_triangle(prepared, triangles[i]);
+				if (hit && hit->distance <= limit)
+				{
+					limit = hit->distance;
+					nearest = hit;
+				}
+			}
+
+			index = node.skip;
+		}
+
+		return nearest;
+	}
+
+	vector<std::optional<TriangleBVH::Hit>>
+	TriangleBVH::intersect(const vector<Ray> & rays, float max_distance) const
+	{
+		vector<std::optional<Hit>> hits(rays.size());
+		std::transform(EXECUTION_POLICY_PAR rays.cbegin(), rays.cend(),
+					   hits.begin(), [&](const Ray & ray) {
+						   return intersect(ray, max_distance);
+					   });
+
+		return hits;
+	}
+
+	std::optional<AABB> TriangleBVH::bounds() const
+	{
+		if (nodes.empty())
+		{
+			return std::nullopt;
+		}
+
+		return AABB{nodes[0].min, nodes[0].max};
+	}
+}   // namespace glge::math
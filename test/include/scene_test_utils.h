@@ -0,0 +1,43 @@
+/// <summary>
+/// Stub renderables and shaders for testing scene traversal without a
+/// rendering context.
+/// </summary>
+/// \file scene_test_utils.h
+
+#pragma once
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+
+#include <optional>
+
+namespace glge::test
+{
+	/// <summary>Renderable with a unit bounding sphere.</summary>
+	class BoundedRenderable : public renderer::primitive::Renderable
+	{
+	public:
+		void render() const override {}
+
+		std::optional<math::Sphere> bounds() const override
+		{
+			return math::Sphere{1.0f, vec3(0.0f)};
+		}
+	};
+
+	/// <summary>Shader which does nothing.</summary>
+	class NullShader : public renderer::primitive::ShaderBase
+	{
+	public:
+		util::UniqueHandle bind() override { return util::UniqueHandle(); }
+	};
+
+	/// <summary>Instance of a NullShader.</summary>
+	struct NullInstance : public renderer::primitive::ShaderInstanceBase
+	{
+		using ShaderInstanceBase::ShaderInstanceBase;
+
+		void operator()(const renderer::RenderParameters &) const override {}
+	};
+}   // namespace glge::test
@@ -69,7 +69,7 @@ namespace glge::test
 	{
 		for (int i = 0; i < 4; i++)
 		{
-			if (!vec_eq(a[i], a[i]))
+			if (!vec_eq(a[i], b[i]))
 			{
 				return false;
 			}
@@ -1,8 +1,11 @@
 #include <glge/renderer/primitives/cubemap.h>
+#include <glge/renderer/primitives/texture_loader.h>
 #include <glge/renderer/renderer.h>
 
 #include "ogl_test_utils.h"
 
+#include <chrono>
+
 using namespace glge::renderer::primitive;
 
 namespace glge::test::opengl::cases
@@ -13,16 +16,32 @@ namespace glge::test::opengl::cases
 	public:
 		/// \test Tests that a Cubemap can be loaded into VRAM from
 		/// a set of files on disk.
-		void test_load()
+		void test_load() { Cubemap::from_file(test_files); }
+
+		/// \test Tests that a Cubemap can be loaded through a
+		/// TextureLoader.
+		void test_load_async()
 		{
-			Cubemap::from_file(
-				CubemapFileInfo{"./resources/cubemaps/test_up.tga",
-								"./resources/cubemaps/test_dn.tga",
-								"./resources/cubemaps/test_lf.tga",
-								"./resources/cubemaps/test_rt.tga",
-								"./resources/cubemaps/test_ft.tga",
-								"./resources/cubemaps/test_bk.tga"});
+			auto loader = TextureLoader::create();
+			auto cubemap = loader->load(test_files);
+
+			while (cubemap.wait_for(std::chrono::milliseconds(1)) !=
+				   std::future_status::ready)
+			{
+				loader->update();
+			}
+
+			test_assert(cubemap.get() != nullptr);
+			test_equal(size_t(0), loader->pending());
 		}
+
+	private:
+		const CubemapFileInfo test_files{"./resources/cubemaps/test_up.tga",
+										 "./resources/cubemaps/test_dn.tga",
+										 "./resources/cubemaps/test_lf.tga",
+										 "./resources/cubemaps/test_rt.tga",
+										 "./resources/cubemaps/test_ft.tga",
+										 "./resources/cubemaps/test_bk.tga"};
 	};
 }   // namespace glge::test::opengl::cases
 
@@ -33,4 +52,5 @@ int main()
 	using namespace glge::test::opengl::cases;
 
 	Test::run(&CubemapLoadTest::test_load);
+	Test::run(&CubemapLoadTest::test_load_async);
 }
@@ -1,5 +1,7 @@
+#include <glge/renderer/primitives/dynamic_model.h>
 #include <glge/renderer/primitives/model.h>
 #include <glge/renderer/renderer.h>
+#include <glge/util/heightmap.h>
 
 #include "ogl_test_utils.h"
 
@@ -18,6 +20,64 @@ namespace glge::test::opengl::cases
 			Model::from_file(ModelFileInfo{"./resources/models/test.obj",
 										   ModelFiletype::Auto});
 		}
+
+		/// \test Tests that a DynamicModel built from a heightmap can have
+		/// its points and normals updated in place after an edit.
+		void test_dynamic()
+		{
+			const size_t width = 8, height = 8;
+
+			vector<vec3> heightmap(width * height);
+			for (size_t i = 0; i < heightmap.size(); i++)
+			{
+				heightmap[i] = vec3(static_cast<float>(i % width), 0.0f,
+									static_cast<float>(i / width));
+			}
+
+			const auto grid = util::heightmap_indices(width, height);
+			auto normals = util::heightmap_normals(heightmap, grid);
+			const auto uvs = util::heightmap_uvs(width, height);
+
+			Indices indices(grid.size());
+			for (size_t i = 0; i < grid.size(); i++)
+			{
+				indices[i] = model_parser::Index(grid[i]);
+			}
+
+			const EBOModelData data(
+				Vertices(heightmap.cbegin(), heightmap.cend()),
+				Normals(normals.cbegin(), normals.cend()),
+				TexCoords(uvs.cbegin(), uvs.cend()), indices);
+
+			auto model = DynamicModel::from_data(data);
+			test_equal(width * height, model->vertex_count());
+			model->render();
+
+			// Raise a single point well above the rest of the terrain
+			const size_t raised = 3 * width + 4;
+			heightmap[raised].y = 20.0f;
+			model->update_vertices(raised, &heightmap[raised], 1);
+
+			const auto [first, last] = util::update_heightmap_normals(
+				heightmap, width, height, 4, 3, 5, 4, normals);
+			model->update_normals(first, &normals[first], last - first);
+
+			const math::Sphere bounds = *model->bounds();
+			test_assert(glm::length(heightmap[raised] - bounds.origin) <=
+							bounds.radius + 1e-4f,
+						"Bounds did not grow to the raised point");
+
+			// Each render after an update moves on to the next copy
+			for (size_t i = 0; i < DynamicModel::default_buffer_count + 1;
+				 i++)
+			{
+				model->render();
+				model->update_uvs(0, {vec2(0.0f)});
+			}
+
+			test_fails(
+				[&] { model->update_vertices(width * height, {vec3()}); });
+		}
 	};
 
 }   // namespace glge::test::opengl::cases
@@ -28,4 +88,5 @@ int main()
 	using glge::test::opengl::cases::ModelLoadTest;
 
 	Test::run(&ModelLoadTest::test_load);
+	Test::run(&ModelLoadTest::test_dynamic);
 }
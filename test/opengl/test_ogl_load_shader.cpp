@@ -4,6 +4,9 @@
 
 #include "ogl_test_utils.h"
 
+#include <filesystem>
+#include <fstream>
+
 namespace glge::test::opengl::cases
 {
 	using namespace glge::renderer::primitive;
@@ -22,6 +25,11 @@ namespace glge::test::opengl::cases
 			auto texture_shader = TextureShader::load();
 			auto skybox_shader = SkyboxShader::load();
 			auto envmap_shader = EnvMapShader::load();
+			auto depth_shader = DepthShader::load();
+			auto texture_array_shader = TextureArrayShader::load();
+			auto virtual_texture_shader = VirtualTextureShader::load();
+			auto feedback_shader = VirtualTextureFeedbackShader::load();
+			auto vertex_color_shader = VertexColorShader::load();
 		}
 
 		/// \test Tests that the shaders can be instanced after loading.
@@ -50,6 +58,61 @@ namespace glge::test::opengl::cases
 			auto skybox_instance = skybox_shader->instance(*cubemap_ptr);
 			auto envmap_instance = envmap_shader->instance(*cubemap_ptr);
 		}
+
+		/// \test Tests that a ShaderManager can build a batch of shaders
+		/// together, and returns the loaded shaders afterwards.
+		void test_manager_load_all()
+		{
+			ShaderManager manager;
+
+			manager.load_all<NormalShader, ColorShader, TextureShader,
+							 SkyboxShader, EnvMapShader, DepthShader,
+							 TextureArrayShader, VirtualTextureShader,
+							 VirtualTextureFeedbackShader, VertexColorShader>();
+
+			ColorShader & color_shader = manager.get<ColorShader>();
+			test_assert(&color_shader == &manager.load<ColorShader>(),
+						"Loading a loaded shader created a new shader");
+
+			auto color_instance =
+				color_shader.instance(vec3(1.0f, 1.0f, 1.0f));
+		}
+
+		/// \test Tests that shaders load with the program binary cache
+		/// enabled, both when populating it and when reading from it, and
+		/// that corrupted cache entries fall back to compiling from source.
+		void test_program_cache()
+		{
+			namespace fs = std::filesystem;
+
+			const fs::path cache_dir = "./shader_cache";
+			fs::remove_all(cache_dir);
+
+			glge::renderer::configure_shader_cache(cache_dir.string());
+			glge::util::UniqueHandle disable_cache(
+				[] {}, [] { glge::renderer::configure_shader_cache(""); });
+
+			ColorShader::load();
+			ColorShader::load();
+
+			size_t entry_count = 0;
+			for (const auto & entry : fs::directory_iterator(cache_dir))
+			{
+				entry_count++;
+
+				// Keep the header but corrupt the binary itself
+				fs::resize_file(entry.path(), fs::file_size(entry.path()) / 2);
+			}
+
+			// Drivers without binary formats leave the cache empty
+			test_assert(entry_count <= 1, "Expected one cache entry");
+
+			auto color_shader = ColorShader::load();
+			auto color_instance =
+				color_shader->instance(vec3(1.0f, 1.0f, 1.0f));
+
+			fs::remove_all(cache_dir);
+		}
 	};
 }   // namespace glge::test::opengl::cases
 
@@ -60,4 +123,6 @@ int main()
 
 	Test::run(&ShaderTest::test_load);
 	Test::run(&ShaderTest::test_instance);
+	Test::run(&ShaderTest::test_manager_load_all);
+	Test::run(&ShaderTest::test_program_cache);
 }
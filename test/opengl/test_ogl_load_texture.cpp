@@ -1,12 +1,47 @@
+#include <glge/renderer/primitives/compressed_texture.h>
+#include <glge/renderer/primitives/cubemap.h>
 #include <glge/renderer/primitives/texture.h>
+#include <glge/renderer/primitives/texture_array.h>
+#include <glge/renderer/primitives/texture_loader.h>
+#include <glge/renderer/primitives/texture_residency.h>
+#include <glge/renderer/primitives/virtual_texture.h>
 #include <glge/renderer/renderer.h>
 
 #include "ogl_test_utils.h"
 
+#include <chrono>
+#include <cstdio>
+
 using namespace glge::renderer::primitive;
 
 namespace glge::test::opengl::cases
 {
+	// Writes a precompressed texture file with generated contents
+	static void write_test_file(czstring path, size_t faces)
+	{
+		Image image;
+		image.width = 64;
+		image.height = 32;
+		image.channels = 3;
+		image.pixels.resize(image.row_size() * image.height);
+
+		for (size_t i = 0; i < image.pixels.size(); i++)
+		{
+			image.pixels[i] = static_cast<std::uint8_t>(i * 7);
+		}
+
+		write_compressed_texture(
+			path, vector<vector<Image>>(faces, build_mip_chain(image)),
+			BlockFormat::BC1);
+	}
+
+	template<typename T>
+	static bool is_ready(const std::future<T> & future)
+	{
+		return future.wait_for(std::chrono::milliseconds(1)) ==
+			   std::future_status::ready;
+	}
+
     /// <summary>Context for Texture load tests.</summary>
 	class TextureLoadTest : public OGLTest
 	{
@@ -18,6 +53,199 @@ namespace glge::test::opengl::cases
 			Texture::from_file(
 				TextureFileInfo{"./resources/textures/test.png"});
 		}
+
+		/// \test Tests whether a Texture can be loaded from a
+		/// precompressed texture file.
+		void test_load_compressed()
+		{
+			constexpr auto path = "./resources/textures/test.gltx";
+			write_test_file(path, 1);
+
+			Texture::from_compressed_file(TextureFileInfo{path});
+			std::remove(path);
+		}
+
+		/// \test Tests that a precompressed cubemap file is rejected when
+		/// loaded as a Texture.
+		void test_load_compressed_faces()
+		{
+			constexpr auto path = "./resources/textures/cubemap.gltx";
+			write_test_file(path, 6);
+
+			test_throws(
+				[&] { Texture::from_compressed_file(TextureFileInfo{path}); });
+			Cubemap::from_compressed_file(TextureFileInfo{path});
+			std::remove(path);
+		}
+
+		/// \test Tests that textures of the same size and format are packed
+		/// into the layers of a single TextureArray.
+		void test_pack_array()
+		{
+			const TextureFileInfo file{"./resources/textures/test.png"};
+
+			PackedTextures packed = TextureArray::pack({file, file, file});
+
+			test_equal(size_t(1), packed.arrays.size());
+			test_equal(size_t(3), packed.arrays[0]->layer_count());
+			test_equal(size_t(3), packed.layers.size());
+
+			for (unsigned i = 0; i < 3; i++)
+			{
+				test_equal(size_t(0), packed.layers[i].array);
+				test_equal(i, packed.layers[i].layer);
+			}
+		}
+
+		/// \test Tests that a TextureLoader loads a Texture over several
+		/// updates when its budget is smaller than the texture.
+		void test_load_async()
+		{
+			auto loader = TextureLoader::create(1);
+
+			auto texture = loader->load(
+				TextureFileInfo{"./resources/textures/test.png"});
+			test_equal(size_t(1), loader->pending());
+
+			size_t uploading_updates = 0;
+
+			while (!is_ready(texture))
+			{
+				if (loader->update() > 0)
+				{
+					uploading_updates++;
+				}
+			}
+
+			test_assert(texture.get() != nullptr);
+			test_assert(uploading_updates > 1,
+						"Expected one mip level uploaded per update");
+			test_equal(size_t(0), loader->pending());
+		}
+
+		/// \test Tests that a TextureLoader reports failure to decode a
+		/// file through the returned future.
+		void test_load_async_missing()
+		{
+			auto loader = TextureLoader::create();
+
+			auto texture = loader->load(
+				TextureFileInfo{"./resources/textures/missing.png"});
+
+			while (!is_ready(texture))
+			{
+				loader->update();
+			}
+
+			test_throws([&] { texture.get(); });
+			test_equal(size_t(0), loader->pending());
+		}
+
+		/// \test Tests that a TextureResidency streams in the levels
+		/// requested for a texture and evicts them once it is no longer
+		/// drawn.
+		void test_residency()
+		{
+			auto residency = TextureResidency::create();
+
+			Texture & texture = residency->add(
+				TextureFileInfo{"./resources/textures/test.png"});
+			test_equal(size_t(1), residency->statistics().decoding);
+
+			while (residency->statistics().decoding > 0)
+			{
+				residency->update();
+			}
+
+			// Only the mip tail, 56x56 down to 1x1, is resident at first
+			const auto tail = residency->statistics();
+			test_assert(tail.resident_bytes > 0, "Mip tail not uploaded");
+			test_equal(tail.requested_bytes, tail.resident_bytes);
+
+			// Drawn across the whole image, every level is needed
+			do
+			{
+				residency->request(texture, 1.0f);
+			} while (residency->update() > 0);
+
+			// RGB levels of 225x225, 112x112, 56x56, ... down to 1x1
+			const auto full = residency->statistics();
+			test_equal(std::uint64_t(202032), full.requested_bytes);
+			test_equal(full.requested_bytes, full.resident_bytes);
+
+			residency->update();
+			test_equal(tail.resident_bytes,
+					   residency->statistics().resident_bytes);
+		}
+
+		/// \test Tests that a TextureResidency reports failure to decode a
+		/// file from update().
+		void test_residency_missing()
+		{
+			auto residency = TextureResidency::create();
+			residency->add(
+				TextureFileInfo{"./resources/textures/missing.png"});
+
+			bool thrown = false;
+			while (!thrown && residency->statistics().decoding > 0)
+			{
+				try
+				{
+					residency->update();
+				}
+				catch (const std::runtime_error &)
+				{
+					thrown = true;
+				}
+			}
+
+			test_assert(thrown, "Decode failure not reported");
+		}
+
+		/// \test Tests that a VirtualTexture caches its coarsest pages on
+		/// load, and uploads the pages seen by feedback.
+		void test_virtual_texture()
+		{
+			constexpr auto path = "./resources/textures/test.glvp";
+
+			Image image;
+			image.width = 256;
+			image.height = 128;
+			image.pixels.assign(image.width * image.height * 4, 200);
+			write_page_file(path, build_mip_chain(image), 64, 4);
+
+			VirtualTextureSettings settings;
+			settings.cache_pages = 4;
+			auto texture = VirtualTexture::from_page_file(path, settings);
+
+			// Coarsest level is 128x64, two pages
+			test_equal(size_t(2), texture->statistics().resident_pages);
+			test_equal(size_t(16), texture->statistics().capacity);
+
+			Image feedback;
+			feedback.width = 2;
+			feedback.height = 1;
+			for (const PageId page : {PageId{0, 3, 1}, PageId{1, 1, 0}})
+			{
+				const auto pixel = encode_feedback(page);
+				feedback.pixels.insert(feedback.pixels.end(), pixel.begin(),
+									   pixel.end());
+			}
+
+			texture->submit_feedback(feedback);
+			test_equal(size_t(2), texture->statistics().requested_pages);
+			test_equal(size_t(1), texture->statistics().loading_pages);
+
+			while (texture->statistics().loading_pages > 0)
+			{
+				texture->update();
+			}
+
+			test_equal(size_t(3), texture->statistics().resident_pages);
+
+			texture.reset();
+			std::remove(path);
+		}
 	};
 }   // namespace glge::test::opengl::cases
 
@@ -28,4 +256,12 @@ int main()
 	using glge::test::opengl::cases::TextureLoadTest;
 
 	Test::run(&TextureLoadTest::test_load);
+	Test::run(&TextureLoadTest::test_load_compressed);
+	Test::run(&TextureLoadTest::test_load_compressed_faces);
+	Test::run(&TextureLoadTest::test_pack_array);
+	Test::run(&TextureLoadTest::test_load_async);
+	Test::run(&TextureLoadTest::test_load_async_missing);
+	Test::run(&TextureLoadTest::test_residency);
+	Test::run(&TextureLoadTest::test_residency_missing);
+	Test::run(&TextureLoadTest::test_virtual_texture);
 }
@@ -0,0 +1,111 @@
+#include <glge/renderer/primitives/framebuffer.h>
+#include <glge/renderer/primitives/model.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/renderer.h>
+#include <glge/renderer/scene_graph/scene.h>
+
+#include "ogl_test_utils.h"
+
+namespace glge::test::opengl::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+	using namespace glge::renderer::scene_graph;
+
+	/// <summary>
+	/// Context for offscreen rendering tests.
+	/// </summary>
+	class OffscreenTest : public OGLTest
+	{
+	private:
+		static constexpr size_t width = 64;
+		static constexpr size_t height = 48;
+
+	public:
+		/// \test Tests that a Scene can be rendered into a Framebuffer larger
+		/// than the default surface and read back synchronously.
+		void test_render_and_read()
+		{
+			auto framebuffer = Framebuffer::from_size(width, height);
+
+			auto color_shader = ColorShader::load();
+			auto color_instance =
+				color_shader->instance(vec3(1.0f, 0.0f, 0.0f));
+
+			auto model = Model::from_file(
+				ModelFileInfo{"./resources/models/test.obj"});
+
+			Scene scene;
+
+			auto root_handle = scene.get_root_handle();
+			root_handle.add_geometry(*model, color_instance);
+			auto camera_handle = root_handle.add_camera(CameraIntrinsics());
+			camera_handle.activate();
+
+			framebuffer->clear(vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+			{
+				auto fb_bind = framebuffer->bind();
+
+				auto renderer = scene.prepare_renderer();
+				renderer.render();
+			}
+
+			Image image = framebuffer->read();
+
+			test_equal(width, image.width);
+			test_equal(height, image.height);
+			test_equal(width * height * 4, image.pixels.size());
+		}
+
+		/// \test Tests that asynchronous readback returns frames in the
+		/// order they were requested, including when the ring overflows.
+		void test_async_readback()
+		{
+			constexpr size_t frame_count = 5;
+
+			auto framebuffer = Framebuffer::from_size(width, height);
+			auto readback = AsyncReadback::create(width, height, 2);
+
+			for (size_t i = 0; i < frame_count; i++)
+			{
+				framebuffer->clear(
+					vec4(static_cast<float>(i) / 255.0f, 0.0f, 0.0f, 1.0f));
+				readback->request(*framebuffer);
+			}
+
+			test_equal(frame_count, readback->pending());
+
+			for (size_t i = 0; i < frame_count; i++)
+			{
+				Image image = readback->wait();
+
+				test_equal(width, image.width);
+				test_equal(static_cast<int>(i),
+						   static_cast<int>(image.pixel(width / 2, 0)[0]));
+			}
+
+			test_equal(size_t(0), readback->pending());
+			test_assert(!readback->poll().has_value());
+		}
+
+		/// \test Tests that a readback rejects framebuffers of another size.
+		void test_size_mismatch()
+		{
+			auto framebuffer = Framebuffer::from_size(width, height);
+			auto readback = AsyncReadback::create(width * 2, height);
+
+			test_throws([&] { readback->request(*framebuffer); });
+		}
+	};
+}   // namespace glge::test::opengl::cases
+
+int main()
+{
+	using glge::test::Test;
+	using glge::test::opengl::cases::OffscreenTest;
+
+	Test::run(&OffscreenTest::test_render_and_read);
+	Test::run(&OffscreenTest::test_async_readback);
+	Test::run(&OffscreenTest::test_size_mismatch);
+}
@@ -1,5 +1,6 @@
 #include <glge/renderer/primitives/shader_program.h>
 #include <glge/renderer/primitives/texture.h>
+#include <glge/renderer/primitives/texture_array.h>
 #include <glge/renderer/render_settings.h>
 #include <glge/renderer/renderer.h>
 #include <glge/util/motion.h>
@@ -37,6 +38,36 @@ namespace glge::test::opengl::cases
 				texture_instance(params);
 			}
 		}
+
+		/// \test Tests that draws with different layers of the same
+		/// TextureArray bind the array only once.
+		void test_texture_array()
+		{
+			auto shader = TextureArrayShader::load();
+
+			const TextureFileInfo file{"./resources/textures/test.png"};
+			PackedTextures packed = TextureArray::pack({file, file});
+
+			auto first = shader->instance(*packed.arrays[0], 0u);
+			auto second = shader->instance(*packed.arrays[0], 1u);
+
+			RenderSettings settings{std::make_unique<Camera>(
+				CameraIntrinsics{}, util::Placement{})};
+			RenderParameters params(settings, mat4());
+
+			const FrameStats before = stats::thread_counters();
+
+			{
+				auto shader_bind = shader->bind();
+
+				first(params);
+				second(params);
+			}
+
+			const FrameStats delta = stats::thread_counters() - before;
+			test_equal(std::uint64_t(render_stats_enabled ? 1 : 0),
+					   delta.texture_binds);
+		}
 	};
 }   // namespace glge::test::opengl::cases
 
@@ -46,4 +77,5 @@ int main()
     using glge::test::Test;
     using glge::test::opengl::cases::ShaderParameterizationTest;
     Test::run(&ShaderParameterizationTest::test_load);
+    Test::run(&ShaderParameterizationTest::test_texture_array);
 }
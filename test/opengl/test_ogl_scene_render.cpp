@@ -1,3 +1,4 @@
+#include <glge/renderer/primitives/debug_draw.h>
 #include <glge/renderer/primitives/model.h>
 #include <glge/renderer/primitives/shader_program.h>
 #include <glge/renderer/render_settings.h>
@@ -38,6 +39,65 @@ namespace glge::test::opengl::cases
 
 			auto renderer = scene.prepare_renderer();
 
+			renderer.render();
+		}
+
+        /// \test Tests whether a Scene can be successfully rendered with a
+        /// depth pre-pass.
+		void test_render_depth_prepass()
+		{
+			auto depth_shader = DepthShader::load();
+			auto color_shader = ColorShader::load();
+			auto color_instance =
+				color_shader->instance(vec3(1.0f, 0.0f, 0.0f));
+
+			auto model = Model::from_file(
+				ModelFileInfo{"./resources/models/test.obj"});
+
+			Scene scene;
+
+			auto root_handle = scene.get_root_handle();
+			root_handle.add_geometry(*model, color_instance);
+			auto camera_handle = root_handle.add_camera(CameraIntrinsics());
+			camera_handle.activate();
+
+			auto renderer = scene.prepare_renderer();
+			renderer.settings.depth_prepass_shader = depth_shader.get();
+
+			renderer.render();
+		}
+
+        /// \test Tests whether bounding spheres of a Scene are batched
+        /// into a DebugDraw and rendered with it.
+		void test_render_bounding_spheres()
+		{
+			auto color_shader = ColorShader::load();
+			auto color_instance =
+				color_shader->instance(vec3(1.0f, 0.0f, 0.0f));
+			auto line_shader = VertexColorShader::load();
+			auto line_instance = line_shader->instance();
+
+			auto model = Model::from_file(
+				ModelFileInfo{"./resources/models/test.obj"});
+			auto debug_draw = DebugDraw::create();
+
+			Scene scene;
+			scene.settings.draw_bounding_spheres = true;
+			scene.settings.debug_draw = debug_draw.get();
+
+			auto root_handle = scene.get_root_handle();
+			root_handle.add_geometry(*model, color_instance);
+			root_handle.add_geometry(*model, color_instance);
+			auto camera_handle = root_handle.add_camera(CameraIntrinsics());
+			camera_handle.activate();
+
+			auto renderer = scene.prepare_renderer();
+			test_equal(size_t(6), debug_draw->batch(DebugPrimitive::LineLoop)
+									  .indices.size() / 25);
+
+			debug_draw->frustum(mat4(1.0f), vec3(0.0f, 1.0f, 0.0f));
+			renderer.enqueue(*debug_draw, line_instance, mat4(1.0f));
+
 			renderer.render();
 		}
 	};
@@ -50,4 +110,6 @@ int main()
     using glge::test::opengl::cases::SceneRenderTest;
 
 	Test::run(&SceneRenderTest::test_render);
+	Test::run(&SceneRenderTest::test_render_depth_prepass);
+	Test::run(&SceneRenderTest::test_render_bounding_spheres);
 }
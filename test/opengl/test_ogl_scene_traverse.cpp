@@ -3,6 +3,7 @@
 #include <glge/renderer/render_settings.h>
 #include <glge/renderer/renderer.h>
 #include <glge/renderer/scene_graph/scene.h>
+#include <glge/util/thread_pool.h>
 
 #include "ogl_test_utils.h"
 
@@ -43,6 +44,52 @@ namespace glge::test::opengl::cases
 			test_assert(renderer.target_count() == 1,
 						"Expected number of targets was not met");
 		}
+
+        /// \test Tests that parallel traversal of a Scene large enough to
+        /// be split across workers records every target exactly once.
+		void test_traverse_parallel()
+		{
+			constexpr size_t branch_count = 64;
+			constexpr size_t leaf_count = 64;
+
+			auto color_shader = ColorShader::load();
+			auto color_instance =
+				color_shader->instance(vec3(1.0f, 0.0f, 0.0f));
+
+			auto model = Model::from_file(ModelFileInfo{
+				"./resources/models/test.obj", ModelFiletype::Auto});
+
+			util::Placement placement{mat4(1.0f)};
+
+			Scene scene;
+
+			auto root_handle = scene.get_root_handle();
+			for (size_t i = 0; i < branch_count; i++)
+			{
+				auto branch_handle = root_handle.add_transform(placement);
+				for (size_t j = 0; j < leaf_count; j++)
+				{
+					branch_handle.add_geometry(*model, color_instance);
+				}
+			}
+			auto camera_handle = root_handle.add_camera(CameraIntrinsics());
+			camera_handle.activate();
+
+			util::ThreadPool pool(4);
+			scene.settings.thread_pool = &pool;
+
+			auto renderer = scene.prepare_renderer();
+
+			test_equal(branch_count * leaf_count, renderer.target_count());
+			test_assert(renderer.settings.camera != nullptr,
+						"Active camera was not found");
+
+			scene.settings.parallel_traversal = false;
+			auto serial_renderer = scene.prepare_renderer();
+
+			test_equal(renderer.target_count(),
+					   serial_renderer.target_count());
+		}
 	};
 }   // namespace glge::test::opengl::cases
 
@@ -53,4 +100,5 @@ int main()
     using glge::test::opengl::cases::SceneTraverseTest;
 
     Test::run(&SceneTraverseTest::test_traverse);
+    Test::run(&SceneTraverseTest::test_traverse_parallel);
 }
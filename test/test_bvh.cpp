@@ -0,0 +1,195 @@
+#include <glge/util/bvh.h>
+
+#include "test_utils.h"
+
+#include <algorithm>
+#include <random>
+
+namespace glge::test::cases
+{
+	using namespace glge::math;
+
+	/// <summary>
+	/// Set of spheres searched both through a BVH and by brute force.
+	/// </summary>
+	struct Field
+	{
+		std::mt19937 rng{7};
+		vector<std::optional<Sphere>> spheres;
+		vector<BVH::Leaf> leaves;
+		BVH bvh;
+
+		Sphere random_sphere()
+		{
+			std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+			std::uniform_real_distribution<float> radius(0.1f, 3.0f);
+			return Sphere{radius(rng),
+						  vec3(position(rng), position(rng), position(rng))};
+		}
+
+		template<typename Test>
+		vector<BVH::Item> brute_force(Test && test) const
+		{
+			vector<BVH::Item> found;
+			for (size_t i = 0; i < spheres.size(); i++)
+			{
+				if (spheres[i] && test(*spheres[i]))
+				{
+					found.push_back(static_cast<BVH::Item>(i));
+				}
+			}
+			return found;
+		}
+
+		// Checks every kind of query against brute force
+		void check(const char * stage)
+		{
+			for (int i = 0; i < 20; i++)
+			{
+				const Sphere probe = random_sphere();
+				const Sphere big{probe.radius * 5.0f, probe.origin};
+
+				vector<BVH::Item> found;
+				bvh.query(big, [&](BVH::Item item) { found.push_back(item); });
+				std::sort(found.begin(), found.end());
+
+				test_assert(found == brute_force([&](Sphere sphere) {
+								return intersects(sphere, big);
+							}),
+							string("Sphere query differs ") + stage);
+
+				const Ray ray{probe.origin,
+							  glm::normalize(random_sphere().origin)};
+				const auto hit = bvh.raycast(ray);
+
+				std::optional<float> nearest;
+				for (const auto & sphere : spheres)
+				{
+					const auto distance =
+						sphere ? intersect(ray, *sphere) : std::nullopt;
+					if (distance && (!nearest || *distance < *nearest))
+					{
+						nearest = distance;
+					}
+				}
+
+				test_assert(hit.has_value() == nearest.has_value() &&
+								(!hit || float_eq(*nearest, hit->distance)),
+							string("Ray query differs ") + stage);
+			}
+
+			const Frustum frustum({Plane(vec3(0, 0, 10), vec3(0, 0, -1)),
+								   Plane(vec3(0, 0, -30), vec3(0, 0, 1)),
+								   Plane(vec3(-20, 0, 0), vec3(1, 0, 0)),
+								   Plane(vec3(15, 0, 0), vec3(-1, 0, 0)),
+								   Plane(vec3(0, -5, 0), vec3(0, 1, 0)),
+								   Plane(vec3(0, 25, 0), vec3(0, -1, 0))});
+
+			vector<BVH::Item> visible;
+			bvh.query(frustum,
+					  [&](BVH::Item item) { visible.push_back(item); });
+			std::sort(visible.begin(), visible.end());
+
+			test_assert(visible == brute_force([&](Sphere sphere) {
+							return contains(frustum, sphere);
+						}),
+						string("Frustum query differs ") + stage);
+		}
+	};
+
+	/// \test Tests that queries of built, grown, updated and shrunk trees
+	/// match searches by brute force.
+	void test_queries()
+	{
+		Field field;
+
+		vector<BVH::Entry> entries;
+		for (BVH::Item i = 0; i < 500; i++)
+		{
+			const Sphere sphere = field.random_sphere();
+			field.spheres.push_back(sphere);
+			entries.push_back(BVH::Entry{sphere, i});
+		}
+
+		field.leaves = field.bvh.build(entries);
+		test_equal(size_t(500), field.bvh.size());
+		field.check("after build");
+
+		for (BVH::Item i = 500; i < 700; i++)
+		{
+			const Sphere sphere = field.random_sphere();
+			field.spheres.push_back(sphere);
+			field.leaves.push_back(field.bvh.insert(sphere, i));
+		}
+		field.check("after insertion");
+
+		// Small moves are refit; large ones reinserted
+		std::uniform_real_distribution<float> nudge(-1.0f, 1.0f);
+		for (size_t i = 0; i < field.spheres.size(); i += 3)
+		{
+			Sphere sphere = *field.spheres[i];
+			sphere.origin += vec3(nudge(field.rng), nudge(field.rng),
+								  nudge(field.rng));
+			if (i % 2 == 0)
+			{
+				sphere = field.random_sphere();
+			}
+
+			field.spheres[i] = sphere;
+			field.bvh.update(field.leaves[i], sphere);
+			test_equal(BVH::Item(i), field.bvh.item(field.leaves[i]));
+		}
+		field.check("after updates");
+
+		for (size_t i = 0; i < field.spheres.size(); i += 4)
+		{
+			field.bvh.remove(field.leaves[i]);
+			field.spheres[i].reset();
+		}
+		test_equal(size_t(525), field.bvh.size());
+		field.check("after removal");
+
+		field.bvh.clear();
+		test_equal(size_t(0), field.bvh.size());
+		test_assert(!field.bvh.raycast(Ray{vec3(0), vec3(1, 0, 0)}));
+	}
+
+	/// \test Tests that SAH builds, and trees grown by insertion with
+	/// rotations, keep their boxes small.
+	void test_quality()
+	{
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+		vector<BVH::Entry> entries;
+		for (BVH::Item i = 0; i < 2000; i++)
+		{
+			entries.push_back(BVH::Entry{
+				Sphere{0.5f, vec3(position(rng), position(rng), 0.0f)}, i});
+		}
+
+		BVH built;
+		built.build(entries);
+
+		BVH grown;
+		for (const BVH::Entry & entry : entries)
+		{
+			grown.insert(entry.bounds, entry.item);
+		}
+
+		// A tree of boxes no smaller than their parents would cost about
+		// one root area per inner node, so thousands here
+		test_assert(built.cost() < 20.0f, "SAH build is poor");
+		test_assert(grown.cost() < 1.5f * built.cost(),
+					"Inserted tree is much worse than SAH build");
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_queries);
+	Test::run(test_quality);
+}
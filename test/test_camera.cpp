@@ -2,6 +2,8 @@
 
 #include "test_utils.h"
 
+#include <cmath>
+
 namespace glge::test::cases
 {
 	using namespace glge::renderer;
@@ -48,14 +50,15 @@ namespace glge::test::cases
 			auto rotation_matrix = glm::toMat4(
 				glm::angleAxis(glm::radians(90.0f), vec3(0.0f, 1.0f, 0.0f)));
 
-			cam.placement.transform = rotation_matrix * cam.placement.transform;
+			cam.placement.set_transform(rotation_matrix *
+										cam.placement.get_transform());
 
-			cam.placement.transform =
+			cam.placement.set_transform(
 				glm::translate(vec3(-5.0f, 3.0f, -10.0f)) *
-				cam.placement.transform;
+				cam.placement.get_transform());
 
-			test_assert(
-				mat4_eq(glm::inverse(cam.placement.transform), cam.get_V()),
+			test_assert(mat4_eq(glm::inverse(cam.placement.get_transform()),
+								cam.get_V()),
 				"V matrix was not equal to transform inverse");
 		}
 
@@ -64,70 +67,73 @@ namespace glge::test::cases
 		{
 			auto frustum = cam.get_view_frustum();
 
-			math::Plane expected_near(vec3(0.0f, 0.0f, 0.1f),
-									  vec3(0.0f, 0.0f, 1.0f));
-
-			test_assert(expected_near == frustum.near,
+			// The projection looks down the negative z axis
+			test_assert(vec_eq(vec3(0.0f, 0.0f, -1.0f), frustum.near.normal),
+						"Near plane was incorrect");
+			test_assert(float_eq(-0.1f, frustum.near.distance_from(vec3(0.0f))),
 						"Near plane was incorrect");
 
-			math::Plane expected_far(vec3(0.0f, 0.0f, 10000.0f),
-									 vec3(0.0f, 0.0f, -1.0f));
-
-			test_assert(expected_far == frustum.far, "Far plane was incorrect");
-
-			auto near_center = cam.placement.get_position() +
-							   cam.placement.get_forward_direction() *
-								   cam.intrinsics.near_distance;
-
-			// Compute direction vector to the near-right corner of the frustum
-			auto right_corner = glm::normalize(
-				near_center + cam.placement.get_right_direction() *
-								  cam.intrinsics.near_dimensions().x / 2.0f);
-
-			// Compute normal vector by crossing with camera up-vector; inverse
-			// to point towards inside of frustum
-			auto right_normal =
-				-glm::cross(cam.placement.get_up_direction(), right_corner);
-
-			math::Plane expected_right(vec3(0.0f, 0.0f, 0.0f), right_normal);
-
-			test_assert(expected_right == frustum.right,
-						"Right plane was incorrect");
-
-			auto left_corner = glm::normalize(
-				near_center - cam.placement.get_right_direction() *
-								  cam.intrinsics.near_dimensions().x / 2.0f);
+			test_assert(vec_eq(vec3(0.0f, 0.0f, 1.0f), frustum.far.normal),
+						"Far plane was incorrect");
+			test_assert(float_eq(0.0f, frustum.far.distance_from(
+										   vec3(0.0f, 0.0f, -10000.0f))),
+						"Far plane was incorrect");
 
-			auto left_normal =
-				glm::cross(cam.placement.get_up_direction(), left_corner);
+			// Side planes pass through the camera, and meet the near plane
+			// at the edges of the near clip plane
+			const vec2 half = cam.intrinsics.near_dimensions() / 2.0f;
+			const vec3 near_corner(half.x, half.y, -0.1f);
 
-			math::Plane expected_left(vec3(0.0f, 0.0f, 0.0f), left_normal);
+			for (const math::Plane & plane :
+				 {frustum.left, frustum.right, frustum.bottom, frustum.top})
+			{
+				test_assert(float_eq(0.0f, plane.distance_from(vec3(0.0f))),
+							"Side plane did not pass through the camera");
+			}
 
-			test_assert(expected_left == frustum.left,
+			test_assert(
+				float_eq(0.0f, frustum.right.distance_from(near_corner)),
+				"Right plane was incorrect");
+			test_assert(float_eq(0.0f, frustum.top.distance_from(near_corner)),
+						"Top plane was incorrect");
+			test_assert(float_eq(0.0f, frustum.left.distance_from(
+										   near_corner * vec3(-1, 1, 1))),
 						"Left plane was incorrect");
+			test_assert(float_eq(0.0f, frustum.bottom.distance_from(
+										   near_corner * vec3(1, -1, 1))),
+						"Bottom plane was incorrect");
 
-			auto top_corner = glm::normalize(
-				near_center + cam.placement.get_up_direction() *
-								  cam.intrinsics.near_dimensions().y / 2.0f);
-
-			auto top_normal =
-				glm::cross(cam.placement.get_right_direction(), top_corner);
-
-			math::Plane expected_top(vec3(0.0f, 0.0f, 0.0f), top_normal);
-
-			test_assert(expected_top == frustum.top, "Top plane was incorrect");
-
-			auto bottom_corner = glm::normalize(
-				near_center - cam.placement.get_up_direction() *
-								  cam.intrinsics.near_dimensions().y / 2.0f);
-
-			auto bottom_normal =
-				-glm::cross(cam.placement.get_right_direction(), bottom_corner);
-
-			math::Plane expected_bottom(vec3(0.0f, 0.0f, 0.0f), bottom_normal);
+			test_assert(
+				math::contains(frustum, math::Sphere{0.1f, vec3(0, 0, -5)}),
+				"Sphere in front of the camera was outside the frustum");
+			test_assert(
+				!math::contains(frustum, math::Sphere{0.1f, vec3(0, 0, 5)}),
+				"Sphere behind the camera was inside the frustum");
+			test_assert(
+				!math::contains(frustum, math::Sphere{0.1f, vec3(20, 0, -5)}),
+				"Sphere right of the frustum was inside it");
+		}
 
-			test_assert(expected_bottom == frustum.bottom,
-						"Bottom plane was incorrect");
+		/// \test Tests the estimate of the size of a sphere in the image.
+		void test_screen_size()
+		{
+			// At this distance, the image is exactly 2 units high
+			const float distance =
+				1.0f / math::tan(cam.intrinsics.v_fov / 2.0f);
+
+			const float size =
+				cam.screen_size(math::Sphere{0.5f, vec3(0, 0, distance)});
+			test_assert(float_eq(0.5f, size), "Screen size was incorrect");
+
+			const float behind =
+				cam.screen_size(math::Sphere{0.5f, vec3(0, 0, -distance)});
+			test_assert(float_eq(size, behind),
+						"Screen size depended on direction");
+
+			const float inside =
+				cam.screen_size(math::Sphere{1.0f, vec3(0.0f)});
+			test_assert(std::isinf(inside),
+						"Camera inside sphere should be infinitely large");
 		}
 	};
 
@@ -148,4 +154,5 @@ int main()
 	Test::run(&CameraTest::test_V_matrix_trivial, cam);
 	Test::run(&CameraTest::test_V_matrix, cam);
 	Test::run(&CameraTest::test_view_frustum, cam);
+	Test::run(&CameraTest::test_screen_size, cam);
 }
@@ -0,0 +1,214 @@
+#include <glge/renderer/primitives/compressed_texture.h>
+#include <internal/renderer/_texture_container.h>
+#include <internal/util/_compat.h>
+
+#include "test_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+
+	constexpr auto texture_filepath = "./compressed_texture.gltx";
+
+	static Image gradient_image(size_t width, size_t height, size_t channels)
+	{
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.channels = channels;
+		image.pixels.resize(image.row_size() * height);
+
+		for (size_t y = 0; y < height; y++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				std::uint8_t * pixel =
+					image.pixels.data() + y * image.row_size() + x * channels;
+
+				pixel[0] = static_cast<std::uint8_t>(x * 255 / width);
+				pixel[1] = static_cast<std::uint8_t>(y * 255 / height);
+				pixel[2] = 128;
+				if (channels == 4)
+				{
+					pixel[3] =
+						static_cast<std::uint8_t>(255 - x * 255 / width);
+				}
+			}
+		}
+
+		return image;
+	}
+
+	// Largest difference of any channel between an image and its
+	// decompressed RGBA version
+	static int max_error(const Image & original, const Image & decompressed)
+	{
+		int error = 0;
+
+		for (size_t y = 0; y < original.height; y++)
+		{
+			for (size_t x = 0; x < original.width; x++)
+			{
+				for (size_t c = 0; c < 4; c++)
+				{
+					const int expected =
+						c < original.channels ? original.pixel(x, y)[c] : 255;
+					const int actual = decompressed.pixel(x, y)[c];
+					error = std::max(error, std::abs(expected - actual));
+				}
+			}
+		}
+
+		return error;
+	}
+
+	/// \test Tests that compressed sizes count partial blocks as whole
+	/// blocks.
+	void test_compressed_size()
+	{
+		test_equal(size_t(8), compressed_size(BlockFormat::BC1, 1, 1));
+		test_equal(size_t(16), compressed_size(BlockFormat::BC3, 4, 4));
+		test_equal(size_t(4 * 8), compressed_size(BlockFormat::BC1, 5, 5));
+		test_equal(size_t(16 * 16),
+				   compressed_size(BlockFormat::BC3, 16, 13));
+	}
+
+	/// \test Tests that a solid color survives BC1 compression exactly
+	/// when it is representable in 5:6:5.
+	void test_bc1_solid()
+	{
+		Image image;
+		image.width = 4;
+		image.height = 4;
+		image.channels = 3;
+		for (size_t i = 0; i < 16; i++)
+		{
+			image.pixels.insert(image.pixels.end(), {255, 0, 255});
+		}
+
+		const auto blocks = compress_image(image, BlockFormat::BC1);
+		test_equal(size_t(8), blocks.size());
+
+		const Image result =
+			decompress_image(blocks.data(), 4, 4, BlockFormat::BC1);
+		test_equal(0, max_error(image, result));
+	}
+
+	/// \test Tests that smooth gradients survive compression closely,
+	/// including images whose sizes are not multiples of the block size.
+	void test_gradient()
+	{
+		for (BlockFormat format : {BlockFormat::BC1, BlockFormat::BC3})
+		{
+			const size_t channels = format == BlockFormat::BC3 ? 4 : 3;
+			const Image image = gradient_image(37, 22, channels);
+
+			const auto blocks = compress_image(image, format);
+			test_equal(compressed_size(format, 37, 22), blocks.size());
+
+			// Red and green vary independently within each block, which a
+			// single line of colors can only approximate
+			const Image result =
+				decompress_image(blocks.data(), 37, 22, format);
+			test_assert(max_error(image, result) <= 24,
+						"Compression error too large");
+		}
+	}
+
+	/// \test Tests that a written texture file can be mapped and read back
+	/// with every level at an aligned offset.
+	void test_write_read()
+	{
+		vector<vector<Image>> faces(
+			6, build_mip_chain(gradient_image(16, 8, 4)));
+		write_compressed_texture(texture_filepath, faces, BlockFormat::BC3);
+
+		{
+			const util::MappedFile file(texture_filepath);
+			const TextureContainer container(file.data(), file.size());
+
+			test_assert(container.format() == BlockFormat::BC3);
+			test_equal(size_t(6), container.face_count());
+			test_equal(size_t(5), container.level_count());
+
+			for (size_t face = 0; face < 6; face++)
+			{
+				for (size_t i = 0; i < container.level_count(); i++)
+				{
+					const auto level = container.level(face, i);
+					const Image & expected = faces[face][i];
+
+					test_equal(expected.width, level.width);
+					test_equal(expected.height, level.height);
+					test_equal(size_t(0),
+							   static_cast<size_t>(level.data - file.data()) %
+								   texture_container_alignment);
+
+					const auto blocks =
+						compress_image(expected, BlockFormat::BC3);
+					test_assert(std::equal(blocks.cbegin(), blocks.cend(),
+										   level.data,
+										   level.data + level.size),
+								"Level data does not match");
+				}
+			}
+		}
+
+		std::remove(texture_filepath);
+	}
+
+	/// \test Tests that truncated or foreign files are rejected.
+	void test_invalid()
+	{
+		vector<vector<Image>> faces{build_mip_chain(gradient_image(8, 8, 3))};
+		write_compressed_texture(texture_filepath, faces, BlockFormat::BC1);
+
+		{
+			const util::MappedFile file(texture_filepath);
+
+			test_throws([&] {
+				TextureContainer(file.data(), file.size() - 1);
+			});
+
+			vector<std::uint8_t> corrupt(file.data(),
+										 file.data() + file.size());
+			corrupt[0] ^= 0xff;
+
+			test_throws([&] {
+				TextureContainer(corrupt.data(), corrupt.size());
+			});
+		}
+
+		std::remove(texture_filepath);
+	}
+
+	/// \test Tests that faces with different sizes cannot be written.
+	void test_mismatched_faces()
+	{
+		vector<vector<Image>> faces(
+			6, build_mip_chain(gradient_image(8, 8, 3)));
+		faces[3] = build_mip_chain(gradient_image(4, 4, 3));
+
+		test_fails([&] {
+			write_compressed_texture(texture_filepath, faces,
+									 BlockFormat::BC1);
+		});
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_compressed_size);
+	Test::run(test_bc1_solid);
+	Test::run(test_gradient);
+	Test::run(test_write_read);
+	Test::run(test_invalid);
+	Test::run(test_mismatched_faces);
+}
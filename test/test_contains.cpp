@@ -2,6 +2,8 @@
 
 #include "test_utils.h"
 
+#include <cmath>
+
 namespace glge::test::cases
 {
 	using namespace glge::math;
@@ -46,6 +48,170 @@ namespace glge::test::cases
 					"Sphere should not be inside frustum");
 	}
 
+	/// \test Tests coherent tests of spheres against a Frustum, with plane
+	/// masks and the last plane failed.
+	void test_frustum_coherent()
+	{
+		Frustum f({Plane(vec3(0, 0, -2), vec3(0, 0, 1)),
+				   Plane(vec3(0, 0, 2), vec3(0, 0, -1)),
+				   Plane(vec3(2, 0, 0), vec3(-1, 0, 0)),
+				   Plane(vec3(-2, 0, 0), vec3(1, 0, 0)),
+				   Plane(vec3(0, 2, 0), vec3(0, -1, 0)),
+				   Plane(vec3(0, -2, 0), vec3(0, 1, 0))});
+
+		// Every sphere agrees with testing all planes
+		for (float x = -4.0f; x <= 4.0f; x += 0.5f)
+		{
+			for (float radius : {0.25f, 1.0f, 3.0f})
+			{
+				const Sphere sphere{radius, vec3(x, x * 0.5f, -x)};
+				PlaneMask mask = all_planes;
+				std::uint8_t last_failed = 0;
+				test_assert(contains(f, sphere) ==
+								contains(f, sphere, mask, last_failed),
+							"Coherent test should match the full test");
+			}
+		}
+
+		PlaneMask mask = all_planes;
+		std::uint8_t last_failed = 0;
+		test_assert(!contains(f, Sphere{1.0f, vec3(0, 4, 0)}, mask,
+							  last_failed),
+					"Sphere should not be inside frustum");
+		test_equal(std::uint8_t(4), last_failed);
+
+		// Planes wholly containing the sphere are cleared, leaving the one
+		// it straddles
+		mask = all_planes;
+		test_assert(contains(f, Sphere{1.0f, vec3(1.5f, 0, 0)}, mask,
+							 last_failed),
+					"Sphere should be inside frustum");
+		test_equal(PlaneMask(1u << 2), mask);
+
+		// Planes missing from the mask are not tested
+		mask = PlaneMask(1u << 5);
+		test_assert(contains(f, Sphere{1.0f, vec3(0, 0, 9)}, mask,
+							 last_failed),
+					"Masked planes should not be tested");
+		mask = 0;
+		test_assert(contains(f, Sphere{1.0f, vec3(9, 9, 9)}, mask,
+							 last_failed),
+					"Spheres should pass an empty mask");
+	}
+
+	/// \test Tests computing and transforming bounding spheres.
+	void test_bounding_sphere()
+	{
+		const Sphere sphere = bounding_sphere(
+			{vec3(1, 0, 0), vec3(3, 2, 0), vec3(2, 1, 4), vec3(1, 2, 4)});
+
+		test_assert(vec_eq(vec3(2, 1, 2), sphere.origin),
+					"Sphere should be centered on the bounding box");
+		test_assert(float_eq(std::sqrt(6.0f), sphere.radius),
+					"Sphere should reach the furthest point");
+
+		const Sphere empty = bounding_sphere({});
+		test_assert(float_eq(0.0f, empty.radius), "Empty sphere had radius");
+
+		const mat4 M = glm::translate(vec3(1, 0, -1)) *
+					   glm::scale(vec3(2.0f, 0.5f, 1.0f));
+		const Sphere moved = transform(M, sphere);
+
+		test_assert(vec_eq(vec3(5, 0.5f, 1), moved.origin),
+					"Transformed sphere origin was incorrect");
+		test_assert(float_eq(2.0f * std::sqrt(6.0f), moved.radius),
+					"Radius should scale by the largest scale factor");
+	}
+
+	/// \test Tests computing the sphere enclosing two spheres.
+	void test_enclose()
+	{
+		const Sphere a{1.0f, vec3(0, 0, 0)}, b{2.0f, vec3(4, 0, 0)};
+
+		const Sphere both = enclose(a, b);
+		test_assert(vec_eq(vec3(2.5f, 0, 0), both.origin),
+					"Enclosing sphere origin was incorrect");
+		test_assert(float_eq(3.5f, both.radius),
+					"Enclosing sphere radius was incorrect");
+		test_assert(vec_eq(both.origin, enclose(b, a).origin),
+					"Enclosing sphere depends on order");
+
+		const Sphere inner{0.5f, vec3(4.5f, 0, 0)};
+		test_assert(float_eq(b.radius, enclose(inner, b).radius),
+					"Enclosed sphere should not grow the outer sphere");
+		test_assert(float_eq(b.radius, enclose(b, inner).radius),
+					"Enclosed sphere should not grow the outer sphere");
+	}
+
+	/// \test Tests boxes against frustums, boxes and spheres.
+	void test_boxes()
+	{
+		const AABB box = bounding_box(Sphere{1.0f, vec3(1, 2, 3)});
+		test_assert(vec_eq(vec3(0, 1, 2), box.min) &&
+						vec_eq(vec3(2, 3, 4), box.max),
+					"Bounding box of sphere was incorrect");
+		test_assert(float_eq(24.0f, surface_area(box)),
+					"Surface area was incorrect");
+
+		const AABB both = enclose(box, AABB{vec3(-1, 0, 0), vec3(0, 1, 1)});
+		test_assert(vec_eq(vec3(-1, 0, 0), both.min) &&
+						vec_eq(vec3(2, 3, 4), both.max),
+					"Enclosing box was incorrect");
+		test_assert(contains(both, box) && !contains(box, both),
+					"Box containment was incorrect");
+
+		test_assert(intersects(box, Sphere{1.1f, vec3(3, 2, 3)}),
+					"Touching sphere should intersect box");
+		test_assert(!intersects(box, Sphere{1.0f, vec3(3, 4, 5)}),
+					"Sphere beyond the corner should miss box");
+		test_assert(!intersects(Sphere{1.0f, vec3(0)}, Sphere{1.0f, vec3(3)}),
+					"Distant spheres should not intersect");
+		test_assert(
+			intersects(Sphere{1.0f, vec3(0)}, Sphere{1.5f, vec3(2, 0, 0)}),
+			"Overlapping spheres should intersect");
+
+		// Unit cube frustum around the origin
+		const Frustum f({Plane(vec3(0, 0, 1), vec3(0, 0, -1)),
+						 Plane(vec3(0, 0, -1), vec3(0, 0, 1)),
+						 Plane(vec3(-1, 0, 0), vec3(1, 0, 0)),
+						 Plane(vec3(1, 0, 0), vec3(-1, 0, 0)),
+						 Plane(vec3(0, -1, 0), vec3(0, 1, 0)),
+						 Plane(vec3(0, 1, 0), vec3(0, -1, 0))});
+
+		test_assert(contains(f, AABB{vec3(0.5f), vec3(3.0f)}),
+					"Box partly inside frustum should count as inside");
+		test_assert(!contains(f, AABB{vec3(1.5f, 0, 0), vec3(3, 1, 1)}),
+					"Box outside frustum should not be inside");
+	}
+
+	/// \test Tests casting rays against spheres and boxes.
+	void test_rays()
+	{
+		const Ray ray{vec3(0, 0, -5), vec3(0, 0, 1)};
+
+		const auto sphere_hit = intersect(ray, Sphere{1.0f, vec3(0, 0, 2)});
+		test_assert(sphere_hit && float_eq(6.0f, *sphere_hit),
+					"Ray should enter sphere at its near side");
+		test_assert(!intersect(ray, Sphere{1.0f, vec3(0, 2, 2)}),
+					"Ray should miss offset sphere");
+		test_assert(!intersect(ray, Sphere{1.0f, vec3(0, 0, -8)}),
+					"Ray should miss sphere behind it");
+		test_assert(float_eq(0.0f, *intersect(ray, Sphere{1, vec3(0, 0, -5)})),
+					"Ray starting inside sphere should hit at 0");
+
+		const AABB box{vec3(-1, -1, 1), vec3(1, 1, 3)};
+		const auto box_hit = intersect(ray, box);
+		test_assert(box_hit && float_eq(6.0f, *box_hit),
+					"Ray should enter box at its near face");
+		test_assert(!intersect(Ray{vec3(0, 2, -5), vec3(0, 0, 1)}, box),
+					"Parallel ray should miss box");
+		test_assert(!intersect(Ray{vec3(0, 0, 5), vec3(0, 0, 1)}, box),
+					"Ray should miss box behind it");
+
+		const Ray diagonal{vec3(-3, -3, 0), glm::normalize(vec3(1, 1, 0))};
+		test_assert(intersect(diagonal, AABB{vec3(-1), vec3(1)}).has_value(),
+					"Diagonal ray should hit box");
+	}
 }   // namespace glge::test::cases
 
 
@@ -56,4 +222,9 @@ int main()
 
 	Test::run(test_plane);
 	Test::run(test_frustum);
+	Test::run(test_frustum_coherent);
+	Test::run(test_bounding_sphere);
+	Test::run(test_enclose);
+	Test::run(test_boxes);
+	Test::run(test_rays);
 }
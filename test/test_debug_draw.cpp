@@ -0,0 +1,131 @@
+#include <glge/renderer/primitives/debug_draw.h>
+
+#include "test_utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer::primitive;
+
+	// Batcher which only collects lines
+	class CollectingDraw : public DebugDraw
+	{
+	public:
+		void render() const override {}
+
+		std::uint64_t changes() const { return generation(); }
+	};
+
+	static size_t polyline_count(const DebugBatch & batch)
+	{
+		return static_cast<size_t>(std::count(batch.indices.cbegin(),
+											  batch.indices.cend(),
+											  DebugDraw::restart_index));
+	}
+
+	/// \test Tests that each kind of line is collected into its own batch.
+	void test_batches()
+	{
+		CollectingDraw draw;
+		const vec3 red(1.0f, 0.0f, 0.0f);
+
+		draw.line(vec3(0.0f), vec3(1.0f), red);
+		draw.strip({vec3(0.0f), vec3(1.0f), vec3(2.0f)}, red);
+		draw.strip({vec3(3.0f), vec3(4.0f)}, red);
+		draw.loop({vec3(0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f)},
+				  red);
+
+		// Polylines of a single point draw nothing
+		draw.strip({vec3(5.0f)}, red);
+
+		const DebugBatch & lines = draw.batch(DebugPrimitive::Lines);
+		test_equal(size_t(2), lines.vertices.size());
+		test_assert(lines.indices.empty());
+		test_assert(vec_eq(red, lines.vertices[1].color));
+
+		// Indices restart at zero for each batch
+		const DebugBatch & strips = draw.batch(DebugPrimitive::LineStrip);
+		const vector<std::uint32_t> expected{
+			0, 1, 2, DebugDraw::restart_index, 3, 4,
+			DebugDraw::restart_index};
+		test_assert(strips.indices == expected, "Unexpected strip indices");
+		test_assert(vec_eq(vec3(4.0f), strips.vertices[4].position));
+
+		const DebugBatch & loops = draw.batch(DebugPrimitive::LineLoop);
+		test_equal(size_t(3), loops.vertices.size());
+		test_equal(size_t(1), polyline_count(loops));
+
+		test_equal(size_t(10), draw.vertex_count());
+
+		const auto before = draw.changes();
+		draw.clear();
+		test_equal(size_t(0), draw.vertex_count());
+		test_assert(draw.changes() != before, "Clearing was not recorded");
+	}
+
+	/// \test Tests that spheres are drawn as three circles on the sphere.
+	void test_sphere()
+	{
+		CollectingDraw draw;
+		const math::Sphere sphere{2.0f, vec3(1.0f, 2.0f, 3.0f)};
+
+		draw.sphere(sphere, vec3(1.0f), 16);
+
+		const DebugBatch & loops = draw.batch(DebugPrimitive::LineLoop);
+		test_equal(size_t(3), polyline_count(loops));
+		test_equal(size_t(48), loops.vertices.size());
+
+		for (const DebugVertex & vertex : loops.vertices)
+		{
+			test_assert(float_eq(sphere.radius,
+								 glm::length(vertex.position - sphere.origin)),
+						"Circle point not on the sphere");
+		}
+
+		test_fails([&] { draw.sphere(sphere, vec3(1.0f), 2); });
+	}
+
+	/// \test Tests that boxes and frustums are drawn with all twelve
+	/// edges.
+	void test_box()
+	{
+		CollectingDraw draw;
+
+		draw.box(vec3(-1.0f, -2.0f, -3.0f), vec3(1.0f, 2.0f, 3.0f), vec3(1.0f));
+
+		const DebugBatch & lines = draw.batch(DebugPrimitive::Lines);
+		const DebugBatch & loops = draw.batch(DebugPrimitive::LineLoop);
+		test_equal(size_t(8), lines.vertices.size());
+		test_equal(size_t(2), polyline_count(loops));
+		test_assert(vec_eq(vec3(-1.0f, -2.0f, -3.0f),
+						   loops.vertices[0].position));
+		test_assert(vec_eq(vec3(1.0f, 2.0f, 3.0f),
+						   loops.vertices[6].position));
+
+		draw.clear();
+
+		// An orthographic projection maps the box back onto clip space
+		const mat4 projection =
+			glm::ortho(-1.0f, 1.0f, -2.0f, 2.0f, 3.0f, -3.0f);
+		draw.frustum(projection, vec3(1.0f));
+
+		for (const DebugVertex & vertex : loops.vertices)
+		{
+			test_assert(float_eq(1.0f, std::abs(vertex.position.x)));
+			test_assert(float_eq(2.0f, std::abs(vertex.position.y)));
+			test_assert(float_eq(3.0f, std::abs(vertex.position.z)));
+		}
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_batches);
+	Test::run(test_sphere);
+	Test::run(test_box);
+}
@@ -0,0 +1,68 @@
+#include <internal/renderer/_dirty_ranges.h>
+
+#include "test_utils.h"
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+
+	/// \test Tests that overlapping and adjacent ranges are merged, and
+	/// that ranges are kept in order.
+	void test_merge()
+	{
+		DirtyRanges ranges;
+
+		ranges.add(10, 20);
+		ranges.add(30, 40);
+		ranges.add(0, 5);
+		ranges.add(7, 7);
+
+		const vector<DirtyRange> apart{{0, 5}, {10, 20}, {30, 40}};
+		test_assert(ranges.ranges() == apart, "Unexpected separate ranges");
+		test_equal(size_t(25), ranges.element_count());
+
+		// Touching the end of one range and overlapping the next
+		ranges.add(20, 32);
+		ranges.add(5, 6);
+
+		const vector<DirtyRange> merged{{0, 6}, {10, 40}};
+		test_assert(ranges.ranges() == merged, "Unexpected merged ranges");
+
+		// Covering every range
+		ranges.add(0, 50);
+		test_equal(size_t(1), ranges.ranges().size());
+		test_equal(size_t(50), ranges.element_count());
+
+		ranges.clear();
+		test_assert(ranges.empty());
+	}
+
+	/// \test Tests that the closest ranges are joined once there are too
+	/// many.
+	void test_limit()
+	{
+		DirtyRanges ranges(2);
+
+		ranges.add(0, 1);
+		ranges.add(10, 11);
+		ranges.add(13, 14);
+
+		const vector<DirtyRange> joined{{0, 1}, {10, 14}};
+		test_assert(ranges.ranges() == joined, "Closest ranges not joined");
+
+		ranges.add(100, 101);
+		const vector<DirtyRange> rejoined{{0, 14}, {100, 101}};
+		test_assert(ranges.ranges() == rejoined, "Closest ranges not joined");
+
+		test_fails([] { DirtyRanges none(0); });
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_merge);
+	Test::run(test_limit);
+}
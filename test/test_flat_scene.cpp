@@ -0,0 +1,342 @@
+#include <glge/renderer/camera.h>
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/scene_graph/scene.h>
+#include <glge/util/thread_pool.h>
+
+#include "scene_test_utils.h"
+#include "test_utils.h"
+
+#include <algorithm>
+#include <deque>
+#include <tuple>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+	using namespace glge::renderer::scene_graph;
+
+	/// <summary>
+	/// Instance of a NullShader recording the Model matrix of each object
+	/// drawn with it.
+	/// </summary>
+	struct RecordingInstance : public ShaderInstanceBase
+	{
+		vector<mat4> & log;
+
+		RecordingInstance(ShaderBase & shader, vector<mat4> & log) :
+			ShaderInstanceBase(shader), log(log)
+		{}
+
+		void operator()(const RenderParameters & params) const override
+		{
+			log.push_back(params.M);
+		}
+	};
+
+	// Renders a scene, returning the Model matrices drawn in a fixed order
+	static vector<mat4> draw(const Scene & scene, vector<mat4> & log)
+	{
+		log.clear();
+		scene.prepare_renderer().render();
+
+		auto drawn = log;
+		std::sort(drawn.begin(), drawn.end(),
+				  [](const mat4 & a, const mat4 & b) {
+					  return std::make_tuple(a[3].x, a[3].y, a[3].z) <
+							 std::make_tuple(b[3].x, b[3].y, b[3].z);
+				  });
+		return drawn;
+	}
+
+	static bool same_matrices(const vector<mat4> & a, const vector<mat4> & b)
+	{
+		return a.size() == b.size() &&
+			   std::equal(a.cbegin(), a.cend(), b.cbegin(), mat4_eq);
+	}
+
+	/// \test Tests that flattened traversal draws the same objects with
+	/// the same matrices as traversal of the graph, with and without
+	/// culling, and follows changes to placements and the graph.
+	void test_matches_graph()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		vector<mat4> log;
+		RecordingInstance instance(shader, log);
+
+		// Each level is rotated and moved, so that the order in which
+		// matrices are applied matters
+		std::deque<util::Placement> placements;
+		const auto placement = [&](float angle, vec3 offset) -> auto & {
+			return placements.emplace_back(
+				glm::translate(mat4(1.0f), offset) *
+				glm::toMat4(glm::angleAxis(angle, vec3(0.0f, 1.0f, 0.0f))));
+		};
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+
+		for (int i = 0; i < 4; i++)
+		{
+			auto branch = root.add_transform(
+				placement(0.3f * i, vec3(i * 3.0f, 0.0f, -10.0f)));
+			branch.add_geometry(bounded, instance);
+
+			auto twig = branch.add_transform(
+				placement(0.5f, vec3(1.0f, 2.0f, -4.0f * i)));
+			twig.add_geometry(bounded, instance);
+			twig.add_geometry(bounded, instance);
+		}
+
+		root.add_camera(CameraIntrinsics{math::Degrees(60.0f), 1.0f, 0.1f,
+										 100.0f})
+			.activate();
+
+		const auto compare = [&](const char * message) {
+			scene.settings.flat_traversal = false;
+			const auto graph = draw(scene, log);
+			scene.settings.flat_traversal = true;
+			const auto flat = draw(scene, log);
+
+			test_assert(same_matrices(graph, flat), message);
+			return flat.size();
+		};
+
+		test_equal(size_t(12), compare("Flattened matrices differ"));
+
+		scene.settings.enable_VF_culling = true;
+		const size_t visible = compare("Flattened culling differs");
+		test_assert(visible > 0 && visible < 12,
+					"Scene should be partly culled");
+
+		placements.front().set_transform(
+			glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, 10.0f)));
+		compare("Flattened traversal missed a moved placement");
+
+		// Adding nodes rebuilds the flattened scene
+		root.add_transform(placement(0.0f, vec3(0.0f, 0.0f, -5.0f)))
+			.add_geometry(bounded, instance);
+		scene.settings.enable_VF_culling = false;
+		test_equal(size_t(13), compare("Flattened scene was not rebuilt"));
+	}
+
+	/// \test Tests that world matrices are cached between traversals, and
+	/// recomputed below a placement once its transform is replaced.
+	void test_cached_world()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		vector<mat4> log;
+		RecordingInstance instance(shader, log);
+
+		util::Placement outer(glm::translate(mat4(1.0f), vec3(1.0f, 0, 0)));
+		util::Placement inner(glm::translate(mat4(1.0f), vec3(0, 2.0f, 0)));
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+		auto outer_node = root.add_transform(outer);
+		outer_node.add_geometry(bounded, instance);
+		outer_node.add_transform(inner).add_geometry(bounded, instance);
+		root.add_camera(CameraIntrinsics{math::Degrees(60.0f), 1.0f, 0.1f,
+										 100.0f})
+			.activate();
+
+		for (const bool flat : {false, true})
+		{
+			scene.settings.flat_traversal = flat;
+			outer.set_transform(glm::translate(mat4(1.0f), vec3(1.0f, 0, 0)));
+			const auto before = draw(scene, log);
+			test_equal(size_t(2), before.size());
+
+			test_assert(same_matrices(before, draw(scene, log)),
+						"Cached world matrices changed");
+
+			outer = util::Placement(
+				glm::translate(mat4(1.0f), vec3(5.0f, 0, 0)));
+			const auto after = draw(scene, log);
+			test_assert(mat4_eq(outer.get_transform(), after[0]),
+						"Changed placement was not followed");
+			test_assert(mat4_eq(inner.get_transform() * outer.get_transform(),
+								after[1]),
+						"Change was not propagated to descendants");
+		}
+	}
+
+	/// \test Tests that removed subtrees are no longer drawn, and that
+	/// handles to removed nodes are detected as stale.
+	void test_remove_nodes()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		vector<mat4> log;
+		RecordingInstance instance(shader, log);
+		util::Placement placement;
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+		root.add_camera(CameraIntrinsics{math::Degrees(60.0f), 1.0f, 0.1f,
+										 100.0f})
+			.activate();
+		root.add_geometry(bounded, instance);
+
+		const size_t base_count = scene.node_count();
+
+		for (int cell = 0; cell < 3; cell++)
+		{
+			auto transform = root.add_transform(placement);
+			auto leaf = transform.add_geometry(bounded, instance);
+			transform.add_transform(placement).add_geometry(bounded,
+															 instance);
+
+			for (const bool flat : {false, true})
+			{
+				scene.settings.flat_traversal = flat;
+				test_equal(size_t(3), draw(scene, log).size());
+			}
+
+			// Streaming the cell out leaves nothing behind
+			transform.remove();
+			test_equal(base_count, scene.node_count());
+			test_assert(!transform.valid() && !leaf.valid(),
+						"Removed nodes are still valid");
+			test_fails([&] { leaf.add_geometry(bounded, instance); });
+			test_fails([&] { transform.remove(); });
+
+			for (const bool flat : {false, true})
+			{
+				scene.settings.flat_traversal = flat;
+				test_equal(size_t(1), draw(scene, log).size());
+			}
+		}
+
+		test_assert(root.valid());
+		test_fails([&] { root.remove(); });
+	}
+
+	/// \test Tests picking geometry with rays from the camera, and
+	/// finding geometry near a point, as placements move.
+	void test_pick()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		vector<mat4> log;
+		RecordingInstance instance(shader, log);
+
+		util::Placement near(glm::translate(mat4(1.0f), vec3(0, 0, -10)));
+		util::Placement far(glm::translate(mat4(1.0f), vec3(0, 0, -20)));
+		util::Placement side(glm::translate(mat4(1.0f), vec3(5, 0, -10)));
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+		auto near_node = root.add_transform(near);
+		near_node.add_geometry(bounded, instance);
+		root.add_transform(far).add_geometry(bounded, instance);
+		root.add_transform(side).add_geometry(bounded, instance);
+
+		const Camera camera(CameraIntrinsics{math::Degrees(60.0f), 1.0f,
+											 0.1f, 100.0f},
+							util::Placement());
+		const math::Ray center = camera.get_ray(100.0f, 100.0f, 50.0f, 50.0f);
+		test_assert(vec_eq(vec3(0, 0, -1), center.direction),
+					"Center ray should look down the camera's view");
+
+		// The nearest of the two geometries in line is picked
+		const auto picked = scene.pick(center);
+		test_assert(picked.has_value(), "Ray missed the geometry");
+		near_node.remove();
+		test_assert(!picked->valid(), "Picked the wrong geometry");
+
+		test_assert(scene.pick(center).has_value(),
+					"Ray missed the geometry behind");
+		test_assert(!scene.pick(math::Ray{vec3(0), vec3(0, 0, 1)}),
+					"Ray behind the camera hit geometry");
+
+		test_equal(size_t(1),
+				   scene.overlapping(math::Sphere{1.0f, vec3(5, 0, -12)})
+					   .size());
+
+		// The index follows moved placements
+		side.set_transform(glm::translate(mat4(1.0f), vec3(0, 0, -15)));
+		test_equal(size_t(0),
+				   scene.overlapping(math::Sphere{1.0f, vec3(5, 0, -12)})
+					   .size());
+		test_equal(size_t(2),
+				   scene.overlapping(math::Sphere{5.0f, vec3(0, 0, -17)})
+					   .size());
+	}
+
+	/// \test Tests that when several cameras are active, every traversal
+	/// uses the first visited, and that traversal started from a worker
+	/// of the shared pool does not wait on the pool.
+	void test_camera_order()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		vector<mat4> log;
+		RecordingInstance instance(shader, log);
+
+		std::deque<util::Placement> placements;
+		const auto placement = [&](vec3 offset) -> auto & {
+			return placements.emplace_back(
+				glm::translate(mat4(1.0f), offset));
+		};
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+		const CameraIntrinsics intrinsics{math::Degrees(60.0f), 1.0f, 0.1f,
+										  100.0f};
+
+		// Enough geometry ahead of each camera to be split between workers
+		for (int branch = 0; branch < 3; branch++)
+		{
+			auto parent = root.add_transform(
+				placement(vec3(float(branch), 0.0f, 0.0f)));
+			for (int i = 0; i < 100; i++)
+			{
+				parent.add_geometry(bounded, instance);
+			}
+			parent.add_transform(placement(vec3(0.0f, 1.0f, 0.0f)))
+				.add_camera(intrinsics)
+				.activate();
+		}
+
+		const auto camera_x = [&] {
+			return scene.prepare_renderer()
+				.settings.camera->placement.get_position()
+				.x;
+		};
+
+		for (const bool flat : {false, true})
+		{
+			for (const bool culling : {false, true})
+			{
+				scene.settings.flat_traversal = flat;
+				scene.settings.enable_VF_culling = culling;
+				test_assert(float_eq(0.0f, camera_x()),
+							"First camera visited should be active");
+			}
+		}
+
+		scene.settings.flat_traversal = false;
+		scene.settings.parallel_traversal = true;
+		scene.settings.thread_pool = nullptr;
+		const float x =
+			util::ThreadPool::shared().submit([&] { return camera_x(); }).get();
+		test_assert(float_eq(0.0f, x),
+					"Traversal from a shared pool worker should finish");
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_matches_graph);
+	Test::run(test_cached_world);
+	Test::run(test_remove_nodes);
+	Test::run(test_pick);
+	Test::run(test_camera_order);
+}
@@ -43,6 +43,62 @@ namespace glge::test::cases
 		std::for_each(normals.cbegin(), normals.cend(), check_fn);
 	}
 
+	/// \test Tests that normals updated in place after an edit match those
+	/// recomputed for the whole heightmap.
+	void test_update_normals()
+	{
+		const size_t width = 7, height = 6;
+
+		vector<vec3> heightmap(width * height);
+		for (size_t z = 0; z < height; z++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				const float height_at =
+					static_cast<float>((x * 7 + z * 13) % 5) * 0.25f;
+				heightmap[z * width + x] = vec3(
+					static_cast<float>(x), height_at, static_cast<float>(z));
+			}
+		}
+
+		const auto indices = heightmap_indices(width, height);
+		auto normals = heightmap_normals(heightmap, indices);
+		const auto before = normals;
+
+		for (size_t z = 2; z < 4; z++)
+		{
+			for (size_t x = 0; x < 3; x++)
+			{
+				heightmap[z * width + x].y += 2.0f;
+			}
+		}
+
+		const auto [first, last] =
+			update_heightmap_normals(heightmap, width, height, 0, 2, 3, 4,
+									 normals);
+		const auto expected = heightmap_normals(heightmap, indices);
+
+		test_equal(1 * width + 0, first);
+		test_equal(4 * width + 4, last);
+
+		for (size_t i = 0; i < normals.size(); i++)
+		{
+			test_assert(normals[i] == expected[i],
+						"Updated normal differs from full recomputation");
+
+			if (i < first || i >= last)
+			{
+				test_assert(normals[i] == before[i],
+							"Normal outside the changed range was written");
+			}
+		}
+
+		test_fails([&] {
+			update_heightmap_normals(heightmap, width, height, 0, 0,
+									 width + 1, 1, normals);
+		});
+	}
+
 	/// \test Tests that the correct number of valid uvs is returned
 	/// by glge::util::heightmap_uvs.
 	void test_uvs()
@@ -72,5 +128,6 @@ int main()
 
 	Test::run(test_indices);
 	Test::run(test_normals);
+	Test::run(test_update_normals);
 	Test::run(test_uvs);
 }
@@ -0,0 +1,320 @@
+#include <glge/renderer/primitives/image_decoder.h>
+
+#include "test_utils.h"
+
+#include <cstdlib>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+
+	using Bytes = vector<std::uint8_t>;
+
+	// FNV-1a hash of the pixels of an image, to compare decoded files
+	// against reference hashes
+	static std::uint32_t pixel_hash(const Image & image)
+	{
+		std::uint32_t hash = 2166136261u;
+		for (std::uint8_t byte : image.pixels)
+		{
+			hash = (hash ^ byte) * 16777619u;
+		}
+
+		return hash;
+	}
+
+	// Pixel values which differ in every channel and from pixel to pixel
+	static std::uint8_t pattern(size_t x, size_t y, size_t c)
+	{
+		return static_cast<std::uint8_t>(x * 37 + y * 91 + c * 53 + 7);
+	}
+
+	static Bytes tga_header(std::uint8_t type, size_t width, size_t height,
+							std::uint8_t bits, bool top_first)
+	{
+		Bytes header(18);
+		header[2] = type;
+		header[12] = static_cast<std::uint8_t>(width);
+		header[13] = static_cast<std::uint8_t>(width >> 8);
+		header[14] = static_cast<std::uint8_t>(height);
+		header[15] = static_cast<std::uint8_t>(height >> 8);
+		header[16] = bits;
+		header[17] = top_first ? 0x20 : 0;
+
+		return header;
+	}
+
+	// Uncompressed TGA file holding the pattern in BGR(A) order; row y
+	// of the pattern is the y-th row shown from the top
+	static Bytes pattern_tga(size_t width, size_t height, size_t channels,
+							 bool top_first)
+	{
+		Bytes file = tga_header(2, width, height,
+								static_cast<std::uint8_t>(channels * 8),
+								top_first);
+
+		for (size_t row = 0; row < height; row++)
+		{
+			const size_t y = top_first ? row : height - 1 - row;
+
+			for (size_t x = 0; x < width; x++)
+			{
+				file.push_back(pattern(x, y, 2));
+				file.push_back(pattern(x, y, 1));
+				file.push_back(pattern(x, y, 0));
+				if (channels == 4)
+				{
+					file.push_back(pattern(x, y, 3));
+				}
+			}
+		}
+
+		return file;
+	}
+
+	static void test_pattern(const Image & image, size_t width,
+							 size_t height, size_t channels)
+	{
+		test_equal(width, image.width);
+		test_equal(height, image.height);
+		test_equal(channels, image.channels);
+
+		for (size_t y = 0; y < height; y++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				for (size_t c = 0; c < channels; c++)
+				{
+					test_equal(pattern(x, y, c), image.pixel(x, y)[c]);
+				}
+			}
+		}
+	}
+
+	static void append_be32(Bytes & bytes, std::uint32_t value)
+	{
+		for (int shift = 24; shift >= 0; shift -= 8)
+		{
+			bytes.push_back(static_cast<std::uint8_t>(value >> shift));
+		}
+	}
+
+	static void append_chunk(Bytes & file, czstring type, const Bytes & body)
+	{
+		append_be32(file, static_cast<std::uint32_t>(body.size()));
+		file.insert(file.end(), type, type + 4);
+		file.insert(file.end(), body.cbegin(), body.cend());
+		// Checksums are not verified
+		append_be32(file, 0);
+	}
+
+	static std::uint8_t paeth(int a, int b, int c)
+	{
+		const int p = a + b - c;
+		const int pa = std::abs(p - a), pb = std::abs(p - b),
+				  pc = std::abs(p - c);
+
+		return static_cast<std::uint8_t>(pa <= pb && pa <= pc ? a
+										 : pb <= pc			  ? b
+															  : c);
+	}
+
+	// PNG file holding the RGB pattern, with row y filtered with filter
+	// type y % 5 and the image data stored in uncompressed deflate blocks
+	// of at most block_size bytes
+	static Bytes pattern_png(size_t width, size_t height, size_t block_size)
+	{
+		const size_t row_size = width * 3;
+		Bytes filtered;
+
+		for (size_t y = 0; y < height; y++)
+		{
+			const auto value = [&](size_t i, size_t row) -> int {
+				return row < height ? pattern(i / 3, row, i % 3) : 0;
+			};
+			const size_t up = y == 0 ? height : y - 1;
+			const std::uint8_t filter = static_cast<std::uint8_t>(y % 5);
+
+			filtered.push_back(filter);
+			for (size_t i = 0; i < row_size; i++)
+			{
+				const int a = i >= 3 ? value(i - 3, y) : 0;
+				const int b = value(i, up);
+				const int c = i >= 3 ? value(i - 3, up) : 0;
+				const int predictor = filter == 1   ? a
+									  : filter == 2 ? b
+									  : filter == 3 ? (a + b) / 2
+									  : filter == 4 ? paeth(a, b, c)
+													: 0;
+
+				filtered.push_back(
+					static_cast<std::uint8_t>(value(i, y) - predictor));
+			}
+		}
+
+		// zlib header, then stored blocks, then an unchecked checksum
+		Bytes zlib{0x78, 0x01};
+		for (size_t start = 0; start < filtered.size(); start += block_size)
+		{
+			const size_t length =
+				std::min(block_size, filtered.size() - start);
+
+			zlib.push_back(start + length == filtered.size() ? 1 : 0);
+			zlib.push_back(static_cast<std::uint8_t>(length));
+			zlib.push_back(static_cast<std::uint8_t>(length >> 8));
+			zlib.push_back(static_cast<std::uint8_t>(~length));
+			zlib.push_back(static_cast<std::uint8_t>(~length >> 8));
+			zlib.insert(zlib.end(), filtered.cbegin() + start,
+						filtered.cbegin() + start + length);
+		}
+		append_be32(zlib, 0);
+
+		Bytes header;
+		append_be32(header, static_cast<std::uint32_t>(width));
+		append_be32(header, static_cast<std::uint32_t>(height));
+		header.insert(header.end(), {8, 2, 0, 0, 0});
+
+		Bytes file{137, 80, 78, 71, 13, 10, 26, 10};
+		append_chunk(file, "IHDR", header);
+
+		// Image data split across two chunks must be joined
+		const size_t split = zlib.size() / 2;
+		append_chunk(file, "IDAT", Bytes(zlib.cbegin(), zlib.cbegin() + split));
+		append_chunk(file, "IDAT", Bytes(zlib.cbegin() + split, zlib.cend()));
+		append_chunk(file, "IEND", {});
+
+		return file;
+	}
+
+	/// \test Tests that uncompressed TGA files decode in either row order,
+	/// with long rows to cover the vectorized swizzles and their tails.
+	void test_tga_uncompressed()
+	{
+		for (size_t channels : {3, 4})
+		{
+			for (bool top_first : {false, true})
+			{
+				const Bytes file = pattern_tga(37, 5, channels, top_first);
+				const auto image = decode_tga(file.data(), file.size());
+
+				test_assert(image.has_value(), "TGA file not decoded");
+				test_pattern(*image, 37, 5, channels);
+			}
+		}
+	}
+
+	/// \test Tests that run-length encoded TGA files decode, including
+	/// packets which continue from one row to the next.
+	void test_tga_rle()
+	{
+		Bytes file = tga_header(10, 3, 2, 24, true);
+
+		// Raw packet of 2 pixels, then a run of 4 pixels across the rows
+		file.insert(file.end(), {0x01, 1, 2, 3, 4, 5, 6, 0x83, 7, 8, 9});
+
+		const auto image = decode_tga(file.data(), file.size());
+		test_assert(image.has_value(), "TGA file not decoded");
+
+		const Bytes expected{3, 2, 1, 6, 5, 4, 9, 8, 7,
+							 9, 8, 7, 9, 8, 7, 9, 8, 7};
+		test_assert(image->pixels == expected, "Wrong pixels decoded");
+
+		file.pop_back();
+		test_throws([&] { decode_tga(file.data(), file.size()); });
+	}
+
+	/// \test Tests that channels are added or removed on request.
+	void test_tga_channels()
+	{
+		const Bytes file = pattern_tga(4, 4, 4, true);
+
+		const auto rgb = decode_tga(file.data(), file.size(), 3);
+		test_pattern(*rgb, 4, 4, 3);
+
+		const auto gray = decode_tga(file.data(), file.size(), 1);
+		test_equal(size_t(1), gray->channels);
+
+		Bytes gray_file = tga_header(3, 2, 1, 8, true);
+		gray_file.insert(gray_file.end(), {10, 20});
+
+		const auto rgba =
+			decode_tga(gray_file.data(), gray_file.size(), 4);
+		const Bytes expected{10, 10, 10, 255, 20, 20, 20, 255};
+		test_assert(rgba->pixels == expected, "Wrong gray expansion");
+
+		test_fails([&] { decode_tga(file.data(), file.size(), 5); });
+	}
+
+	/// \test Tests that TGA variants which are not handled natively are
+	/// reported as such rather than misdecoded.
+	void test_tga_unsupported()
+	{
+		Bytes file = tga_header(2, 2, 2, 16, true);
+		file.resize(file.size() + 8);
+
+		test_assert(!decode_tga(file.data(), file.size()).has_value(),
+					"16-bit TGA file decoded");
+	}
+
+	/// \test Tests that PNG files decode with every filter type and image
+	/// data in several stored blocks and chunks.
+	void test_png_filters()
+	{
+		const Bytes file = pattern_png(21, 10, 100);
+		const auto image = decode_png(file.data(), file.size());
+
+		test_assert(image.has_value(), "PNG file not decoded");
+		test_pattern(*image, 21, 10, 3);
+
+		const Bytes truncated(file.cbegin(), file.cend() - 40);
+		test_throws([&] { decode_png(truncated.data(), truncated.size()); });
+	}
+
+	/// \test Tests that interlaced PNG files are left to the fallback
+	/// decoder.
+	void test_png_unsupported()
+	{
+		Bytes file = pattern_png(4, 4, 1000);
+
+		// The interlace method is the last byte of the header chunk
+		file[8 + 8 + 12] = 1;
+		test_assert(!decode_png(file.data(), file.size()).has_value(),
+					"Interlaced PNG file decoded");
+	}
+
+	/// \test Tests that the test resources decode to the same pixels as a
+	/// reference decoder, including Huffman-coded image data, palettes and
+	/// run-length encoded cubemap faces.
+	void test_resources()
+	{
+		const auto png = load_image("./resources/textures/test.png");
+		test_assert(png.has_value(), "PNG file not decoded");
+		test_equal(size_t(225), png->width);
+		test_equal(size_t(225), png->height);
+		test_equal(size_t(3), png->channels);
+		test_equal(std::uint32_t(0x49f08da0), pixel_hash(*png));
+
+		const auto tga = load_image("./resources/cubemaps/test_bk.tga", 3);
+		test_assert(tga.has_value(), "TGA file not decoded");
+		test_equal(size_t(512), tga->width);
+		test_equal(size_t(512), tga->height);
+		test_equal(std::uint32_t(0x7215e569), pixel_hash(*tga));
+
+		test_throws([] { load_image("./resources/textures/missing.png"); });
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_tga_uncompressed);
+	Test::run(test_tga_rle);
+	Test::run(test_tga_channels);
+	Test::run(test_tga_unsupported);
+	Test::run(test_png_filters);
+	Test::run(test_png_unsupported);
+	Test::run(test_resources);
+}
@@ -0,0 +1,208 @@
+#include <glge/renderer/primitives/image.h>
+#include <glge/renderer/primitives/image_decoder.h>
+#include <glge/util/thread_pool.h>
+
+#include "test_utils.h"
+
+#include <algorithm>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+
+	constexpr std::array<MipFilter, 3> filters{
+		MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos};
+
+	static Image solid_image(size_t width, size_t height, size_t channels,
+							 std::uint8_t value)
+	{
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.channels = channels;
+		image.pixels.assign(image.row_size() * height, value);
+
+		return image;
+	}
+
+	static Image noise_image(size_t width, size_t height, size_t channels)
+	{
+		Image image = solid_image(width, height, channels, 0);
+
+		std::uint32_t state = test_rand_seed;
+		for (auto & value : image.pixels)
+		{
+			state = state * 1664525u + 1013904223u;
+			value = static_cast<std::uint8_t>(state >> 24);
+		}
+
+		return image;
+	}
+
+	/// \test Tests that chains halve each level, rounding down, until 1x1.
+	void test_sizes()
+	{
+		for (MipFilter filter : filters)
+		{
+			const auto chain =
+				build_mip_chain(noise_image(37, 6, 3), MipSettings{filter});
+
+			const vector<std::pair<size_t, size_t>> sizes{
+				{37, 6}, {18, 3}, {9, 1}, {4, 1}, {2, 1}, {1, 1}};
+			test_equal(sizes.size(), chain.size());
+
+			for (size_t i = 0; i < sizes.size(); i++)
+			{
+				test_equal(sizes[i].first, chain[i].width);
+				test_equal(sizes[i].second, chain[i].height);
+				test_equal(size_t(3), chain[i].channels);
+			}
+		}
+	}
+
+	/// \test Tests that the box filter averages each 2x2 block, rounding
+	/// halves up.
+	void test_box_average()
+	{
+		Image image = solid_image(2, 2, 1, 0);
+		image.pixels = {10, 21, 30, 40};
+
+		const auto chain = build_mip_chain(image);
+		test_equal(size_t(2), chain.size());
+		test_equal(std::uint8_t(25), chain[1].pixels[0]);
+	}
+
+	/// \test Tests that every filter preserves a solid color, so that
+	/// their weights are normalized, including at the edges.
+	void test_solid()
+	{
+		for (MipFilter filter : filters)
+		{
+			for (bool srgb : {false, true})
+			{
+				const auto chain = build_mip_chain(
+					solid_image(13, 9, 4, 77), MipSettings{filter, srgb});
+
+				for (const Image & level : chain)
+				{
+					for (std::uint8_t value : level.pixels)
+					{
+						test_equal(std::uint8_t(77), value);
+					}
+				}
+			}
+		}
+	}
+
+	/// \test Tests that sRGB colors are averaged in linear space, while
+	/// alpha is not.
+	void test_srgb()
+	{
+		Image image = solid_image(2, 1, 2, 0);
+		image.pixels = {0, 0, 255, 255};
+
+		const auto plain = build_mip_chain(image);
+		test_equal(std::uint8_t(128), plain[1].pixels[0]);
+		test_equal(std::uint8_t(128), plain[1].pixels[1]);
+
+		const auto srgb = build_mip_chain(image, MipSettings{MipFilter::Box,
+															 true});
+		test_equal(std::uint8_t(188), srgb[1].pixels[0]);
+		test_equal(std::uint8_t(128), srgb[1].pixels[1]);
+	}
+
+	/// \test Tests that chains built in parallel match those built
+	/// serially, and that building from a worker of the pool does not
+	/// deadlock it.
+	void test_parallel()
+	{
+		util::ThreadPool pool(3);
+
+		vector<Image> faces;
+		for (size_t i = 0; i < 6; i++)
+		{
+			faces.emplace_back(noise_image(300, 200 + i, 4));
+		}
+
+		for (MipFilter filter : filters)
+		{
+			const MipSettings settings{filter, true};
+
+			const auto serial = build_mip_chains(faces, settings);
+			const auto parallel = build_mip_chains(faces, settings, &pool);
+
+			test_equal(faces.size(), parallel.size());
+			for (size_t i = 0; i < faces.size(); i++)
+			{
+				test_equal(serial[i].size(), parallel[i].size());
+
+				for (size_t level = 0; level < serial[i].size(); level++)
+				{
+					test_assert(serial[i][level].pixels ==
+									parallel[i][level].pixels,
+								"Parallel chain differs");
+				}
+			}
+		}
+
+		auto nested = pool.submit([&] {
+			return build_mip_chain(faces[0], MipSettings{}, &pool).size();
+		});
+		test_equal(size_t(9), nested.get());
+	}
+
+	/// \test Tests that colors are remapped as SOIL remapped them, with
+	/// alpha untouched, and that an image loaded as the texture converter loads
+	/// it gives the same texels as when loaded as a texture at run time.
+	void test_ntsc_safe()
+	{
+		Image ends = solid_image(2, 1, 4, 0);
+		ends.pixels = {0, 128, 255, 0, 255, 0, 128, 255};
+		make_ntsc_safe(ends);
+		// SOIL's scale truncates, so black lands just below 16
+		const vector<std::uint8_t> remapped{15, 125, 235, 0,
+											235, 15, 125, 255};
+		test_assert(ends.pixels == remapped, "Colors remapped wrongly");
+
+		// At run time the file's channels are kept; the converter forces
+		// RGBA
+		auto texture = load_image("./resources/textures/test.png");
+		auto converted = load_image("./resources/textures/test.png", 4);
+		test_assert(texture && converted, "Test texture not decoded");
+		make_ntsc_safe(*texture);
+		make_ntsc_safe(*converted);
+
+		test_equal(size_t(3), texture->channels);
+		for (size_t y = 0; y < texture->height; y++)
+		{
+			for (size_t x = 0; x < texture->width; x++)
+			{
+				test_assert(std::equal(texture->pixel(x, y),
+									   texture->pixel(x, y) + 3,
+									   converted->pixel(x, y)),
+							"Converted texels differ");
+			}
+		}
+	}
+
+	/// \test Tests that empty images are rejected.
+	void test_invalid()
+	{
+		test_fails([] { build_mip_chain(solid_image(0, 4, 3, 0)); });
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_sizes);
+	Test::run(test_box_average);
+	Test::run(test_solid);
+	Test::run(test_srgb);
+	Test::run(test_parallel);
+	Test::run(test_ntsc_safe);
+	Test::run(test_invalid);
+}
@@ -41,7 +41,8 @@ namespace glge::test::cases
 			auto rotation_matrix = glm::toMat4(
 				glm::angleAxis(glm::radians(90.0f), vec3(0.0f, 1.0f, 0.0f)));
 
-			placement.transform = rotation_matrix * placement.transform;
+			placement.set_transform(rotation_matrix *
+									placement.get_transform());
 
 			test_assert(
 				vec_eq(vec3(0.0f, 0.0f, 0.0f), placement.get_position()),
@@ -59,8 +60,8 @@ namespace glge::test::cases
 
 			// Test translation
 
-			placement.transform =
-				glm::translate(vec3(-5.0f, 3.0f, 8.0f)) * placement.transform;
+			placement.set_transform(glm::translate(vec3(-5.0f, 3.0f, 8.0f)) *
+									placement.get_transform());
 
 			test_assert(
 				vec_eq(vec3(-5.0f, 3.0f, 8.0f), placement.get_position()),
@@ -0,0 +1,343 @@
+#include <glge/renderer/occlusion_culler.h>
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/scene_graph/scene.h>
+#include <glge/util/thread_pool.h>
+
+#include "scene_test_utils.h"
+#include "test_utils.h"
+
+#include <cmath>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+	using namespace glge::renderer::scene_graph;
+	using model_parser::Index;
+	using model_parser::Vertex;
+
+	/// <summary>
+	/// Square of a given half size facing +z, centered on the origin.
+	/// </summary>
+	EBOModelData square(float half_size)
+	{
+		return EBOModelData(
+			Vertices{Vertex(vec3(-half_size, -half_size, 0.0f)),
+					 Vertex(vec3(half_size, -half_size, 0.0f)),
+					 Vertex(vec3(half_size, half_size, 0.0f)),
+					 Vertex(vec3(-half_size, half_size, 0.0f))},
+			Normals{}, TexCoords{},
+			Indices{Index(0), Index(1), Index(2), Index(0), Index(2),
+					Index(3)});
+	}
+
+	/// <summary>Camera at the origin, looking down -z.</summary>
+	Camera camera()
+	{
+		return Camera(
+			CameraIntrinsics{math::Degrees(60.0f), 2.0f, 0.1f, 100.0f},
+			util::Placement(mat4(1.0f)));
+	}
+
+	/// <summary>
+	/// Check the depth drawn at every pixel against rays cast through the
+	/// centers of the pixels onto the plane of a square.
+	/// </summary>
+	void check_depth(const OcclusionCuller & culler, const mat4 & M,
+					 float half_size)
+	{
+		const Camera view = camera();
+		const mat4 inverse = glm::inverse(M);
+		const float width = static_cast<float>(culler.width());
+		const float height = static_cast<float>(culler.height());
+
+		for (size_t y = 0; y < culler.height(); y++)
+		{
+			for (size_t x = 0; x < culler.width(); x++)
+			{
+				const math::Ray ray =
+					view.get_ray(width, height, static_cast<float>(x) + 0.5f,
+								 static_cast<float>(y) + 0.5f);
+
+				// The ray in the square's space, meeting its plane z = 0
+				const vec3 origin = vec3(inverse * vec4(ray.origin, 1.0f));
+				const vec3 direction =
+					vec3(inverse * vec4(ray.direction, 0.0f));
+				const float t = -origin.z / direction.z;
+				const vec3 hit = origin + direction * t;
+				const vec3 world_hit = ray.origin + ray.direction * t;
+
+				// Pixels whose centers are near the edges may go either way
+				const float margin = half_size - std::max(std::abs(hit.x),
+														  std::abs(hit.y));
+				if (std::abs(margin) < 0.05f)
+				{
+					continue;
+				}
+
+				const float depth = culler.depth(x, y);
+				if (t > 0.0f && margin > 0.0f && -world_hit.z > 0.1f)
+				{
+					test_assert(std::abs(depth + world_hit.z) <
+									1e-3f * -world_hit.z,
+								"Depth should match the square's");
+				}
+				else
+				{
+					test_assert(std::isinf(depth),
+								"Nothing should be drawn beside the square");
+				}
+			}
+		}
+	}
+
+	/// \test Tests that occluders are drawn at the depths found by rays
+	/// through each pixel, including occluders cut by the near plane.
+	void test_depth()
+	{
+		OcclusionCuller culler(128, 64);
+		const EBOModelData wall = square(5.0f);
+
+		const mat4 ahead = glm::translate(mat4(1.0f), vec3(1, 2, -10));
+		culler.begin(camera());
+		culler.add_occluder(wall, ahead);
+		culler.rasterize();
+		test_equal(size_t(2), culler.triangle_count());
+		check_depth(culler, ahead, 5.0f);
+
+		// A floor under the camera, reaching behind it
+		const mat4 floor =
+			glm::translate(mat4(1.0f), vec3(0, -1, 0)) *
+			glm::toMat4(glm::angleAxis(-1.5707963f, vec3(1, 0, 0)));
+		const EBOModelData ground = square(50.0f);
+
+		culler.begin(camera());
+		culler.add_occluder(ground, floor);
+		culler.rasterize();
+		test_assert(culler.triangle_count() > 2,
+					"Clipping by the near plane should split triangles");
+		check_depth(culler, floor, 50.0f);
+	}
+
+	/// \test Tests which spheres are found hidden behind a wall.
+	void test_visibility()
+	{
+		OcclusionCuller culler(128, 64);
+		const EBOModelData wall = square(5.0f);
+
+		culler.begin(camera());
+		culler.add_occluder(wall,
+							glm::translate(mat4(1.0f), vec3(0, 0, -10)));
+
+		const math::Sphere behind{1.0f, vec3(0, 0, -20)};
+		test_assert(culler.visible(behind),
+					"Spheres should be visible until occluders are drawn");
+
+		culler.rasterize();
+
+		test_assert(!culler.visible(behind), "Sphere behind wall is hidden");
+		test_assert(!culler.visible(math::Sphere{4.0f, vec3(0, 0, -30)}),
+					"Large sphere wholly behind wall is hidden");
+		test_assert(culler.visible(math::Sphere{1.0f, vec3(0, 0, -5)}),
+					"Sphere in front of wall is visible");
+		test_assert(culler.visible(math::Sphere{1.0f, vec3(15, 0, -20)}),
+					"Sphere beside wall is visible");
+		test_assert(culler.visible(math::Sphere{1.0f, vec3(10, 0, -20)}),
+					"Sphere behind wall's edge is visible");
+		test_assert(culler.visible(math::Sphere{6.0f, vec3(0, 0, -15)}),
+					"Sphere reaching through wall is visible");
+		test_assert(culler.visible(math::Sphere{1.0f, vec3(0, 0, 0.5f)}),
+					"Sphere around the camera is visible");
+	}
+
+	/// \test Tests that cached results are reused only while the camera
+	/// and the tested sphere keep still, and for a limited run of frames.
+	void test_reuse()
+	{
+		OcclusionCuller culler(128, 64);
+		culler.reuse_limits.frames = 3;
+		const EBOModelData wall = square(5.0f);
+		const mat4 ahead = glm::translate(mat4(1.0f), vec3(0, 0, -10));
+
+		const auto draw = [&](const Camera & view, bool occluded) {
+			culler.begin(view);
+			if (occluded)
+			{
+				culler.add_occluder(wall, ahead);
+			}
+			culler.rasterize();
+		};
+
+		const math::Sphere behind{1.0f, vec3(0, 0, -20)};
+		OcclusionCuller::CachedVisibility cache;
+
+		draw(camera(), true);
+		test_assert(!culler.visible(behind, cache),
+					"Sphere behind wall is hidden");
+
+		// The wall is gone, but the camera has not moved
+		draw(camera(), false);
+		test_assert(!culler.visible(behind, cache),
+					"Result should be reused while the camera keeps still");
+		test_assert(culler.visible(math::Sphere{1.0f, vec3(0, 0, -21)},
+								   cache),
+					"Results should not be reused for moved spheres");
+
+		draw(camera(), true);
+		test_assert(culler.visible(math::Sphere{1.0f, vec3(0, 0, -21)},
+								   cache),
+					"Result should be reused within the run of frames");
+
+		draw(camera(), true);
+		test_assert(!culler.visible(math::Sphere{1.0f, vec3(0, 0, -21)},
+									cache),
+					"Results should expire after the run of frames");
+
+		// Moving the camera past the limits drops results at once
+		Camera moved = camera();
+		moved.placement = util::Placement(
+			glm::translate(mat4(1.0f), vec3(0.5f, 0.0f, 0.0f)));
+		draw(moved, false);
+		test_assert(culler.visible(math::Sphere{1.0f, vec3(0, 0, -21)},
+								   cache),
+					"Results should expire once the camera moves");
+	}
+
+	/// \test Tests that a cache shared by two cullers, such as those of
+	/// two views of a scene, never hands one culler's result to the other.
+	void test_shared_cache()
+	{
+		OcclusionCuller walled(128, 64), open(128, 64);
+		const EBOModelData wall = square(5.0f);
+
+		walled.begin(camera());
+		walled.add_occluder(wall,
+							glm::translate(mat4(1.0f), vec3(0, 0, -10)));
+		walled.rasterize();
+
+		open.begin(camera());
+		open.rasterize();
+
+		const math::Sphere behind{1.0f, vec3(0, 0, -20)};
+		OcclusionCuller::CachedVisibility cache;
+
+		for (int frame = 0; frame < 2; frame++)
+		{
+			test_assert(!walled.visible(behind, cache),
+						"Sphere behind wall is hidden");
+			test_assert(open.visible(behind, cache),
+						"Result of another culler should not be reused");
+		}
+	}
+
+	/// \test Tests that drawing on worker threads matches drawing on one.
+	void test_parallel()
+	{
+		util::ThreadPool pool(4);
+		OcclusionCuller culler(128, 64, &pool);
+		const EBOModelData wall = square(3.0f);
+
+		const auto draw = [&] {
+			culler.begin(camera());
+			for (int i = 0; i < 6; i++)
+			{
+				culler.add_occluder(
+					wall, glm::translate(mat4(1.0f),
+										 vec3(i * 3.0f - 8.0f, i - 3.0f,
+											  -10.0f - i)));
+			}
+			culler.rasterize();
+		};
+
+		// Drawn serially from a worker, which must not wait on the pool
+		pool.submit(draw).get();
+		vector<float> serial;
+		for (size_t y = 0; y < culler.height(); y++)
+		{
+			for (size_t x = 0; x < culler.width(); x++)
+			{
+				serial.push_back(culler.depth(x, y));
+			}
+		}
+
+		draw();
+		for (size_t y = 0; y < culler.height(); y++)
+		{
+			for (size_t x = 0; x < culler.width(); x++)
+			{
+				test_assert(serial[y * culler.width() + x] ==
+								culler.depth(x, y),
+							"Parallel drawing should match serial drawing");
+			}
+		}
+
+		test_fails([] { OcclusionCuller(100, 64); },
+				   "Partial tiles should be rejected");
+	}
+
+	/// \test Tests that scenes skip geometry hidden behind occluders, in
+	/// both graph and flattened traversal.
+	void test_scene()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		NullInstance instance(shader);
+		const EBOModelData wall = square(4.0f);
+
+		// A wall in front of the camera, hiding one of two objects behind
+		// it
+		const util::Placement wall_placement{
+			glm::translate(mat4(1.0f), vec3(0, 0, -10))};
+		const util::Placement hidden{
+			glm::translate(mat4(1.0f), vec3(0, 0, -20))};
+		const util::Placement shown{
+			glm::translate(mat4(1.0f), vec3(12, 0, -20))};
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+
+		root.add_transform(wall_placement)
+			.add_geometry(bounded, instance)
+			.set_occluder(wall);
+		root.add_transform(hidden).add_geometry(bounded, instance);
+		root.add_transform(shown).add_geometry(bounded, instance);
+		root.add_camera(CameraIntrinsics{math::Degrees(60.0f), 2.0f, 0.1f,
+										 100.0f})
+			.activate();
+
+		test_fails([&] { root.set_occluder(wall); },
+				   "Only geometry may occlude");
+
+		test_equal(size_t(3), scene.prepare_renderer().target_count());
+
+		OcclusionCuller culler(128, 64);
+		scene.settings.occlusion_culler = &culler;
+
+		auto culled = scene.prepare_renderer();
+		test_equal(size_t(2), culled.target_count());
+		if constexpr (render_stats_enabled)
+		{
+			test_equal(std::uint64_t(1), culled.statistics().culled_objects);
+		}
+
+		scene.settings.flat_traversal = true;
+		test_equal(size_t(2), scene.prepare_renderer().target_count());
+
+		scene.settings.enable_VF_culling = true;
+		test_equal(size_t(2), scene.prepare_renderer().target_count());
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_depth);
+	Test::run(test_visibility);
+	Test::run(test_reuse);
+	Test::run(test_shared_cache);
+	Test::run(test_parallel);
+	Test::run(test_scene);
+}
@@ -63,6 +63,37 @@ namespace glge::test::cases
 			}
 		}
 	};
+
+	/// \test Tests that a model's triangle BVH is stored in packed files
+	/// when built, and left out otherwise.
+	void test_write_read_bvh()
+	{
+		constexpr auto bvh_filepath = "./resources/models/bvh.pck";
+
+		ModelData data = ModelData::from_file(
+			ModelFileInfo{"./resources/models/test.obj", ModelFiletype::Auto});
+
+		write_packed_file(bvh_filepath, data);
+		test_assert(!ModelData::from_file(
+						 ModelFileInfo{bvh_filepath, ModelFiletype::Auto})
+						 .triangle_bvh,
+					"No BVH should be read back unless one was built");
+
+		data.build_triangle_bvh();
+		write_packed_file(bvh_filepath, data);
+
+		const ModelData packed_data = ModelData::from_file(
+			ModelFileInfo{bvh_filepath, ModelFiletype::Auto});
+		std::remove(bvh_filepath);
+
+		test_assert(packed_data.triangle_bvh.has_value());
+		test_assert(vector_eq(data.vertex_data.indices,
+							  packed_data.vertex_data.indices));
+		test_assert(vector_eq(data.triangle_bvh->get_nodes(),
+							  packed_data.triangle_bvh->get_nodes()));
+		test_assert(vector_eq(data.triangle_bvh->get_triangles(),
+							  packed_data.triangle_bvh->get_triangles()));
+	}
 }   // namespace glge::test::cases
 
 
@@ -72,4 +103,5 @@ int main()
 	using namespace glge::test::cases;
 
 	Test::run(&PackedModelTest::test_write_read);
+	Test::run(test_write_read_bvh);
 }
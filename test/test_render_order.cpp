@@ -0,0 +1,165 @@
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/renderer.h>
+
+#include "test_utils.h"
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+
+	/// <summary>
+	/// Renderable that records the order in which targets are drawn.
+	/// </summary>
+	class RecordingRenderable : public Renderable
+	{
+		vector<int> & log;
+		int id;
+
+	public:
+		RecordingRenderable(vector<int> & log, int id) : log(log), id(id) {}
+
+		void render() const override { log.push_back(id); }
+	};
+
+	/// <summary>
+	/// Shader that records how many times it is bound.
+	/// </summary>
+	template<int N>
+	class CountingShader : public ShaderBase
+	{
+	public:
+		int binds = 0;
+
+		util::UniqueHandle bind() override
+		{
+			return util::UniqueHandle([&] { binds++; }, [] {});
+		}
+	};
+
+	/// <summary>
+	/// Instance of a CountingShader with no parameters.
+	/// </summary>
+	struct EmptyInstance : public ShaderInstanceBase
+	{
+		using ShaderInstanceBase::ShaderInstanceBase;
+
+		void operator()(const RenderParameters &) const override {}
+	};
+
+	/// <summary>
+	/// Construct a Model matrix placing an object in front of the default
+	/// camera at the given distance.
+	/// </summary>
+	/// <param name="distance">Distance from the camera.</param>
+	/// <returns>Translation matrix.</returns>
+	mat4 at_distance(float distance)
+	{
+		return glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -distance));
+	}
+
+	/// <summary>
+	/// Construct a Renderer using a camera at the origin.
+	/// </summary>
+	/// <returns>Renderer with no targets.</returns>
+	Renderer make_renderer()
+	{
+		Renderer renderer;
+		renderer.settings.camera = std::make_unique<Camera>(
+			CameraIntrinsics{math::Degrees(45.0f), 16.0f / 9.0f, 0.1f,
+							 1000.0f},
+			util::Placement{mat4(1.0f)});
+		return renderer;
+	}
+
+	/// \test Tests that targets are grouped by shader, each shader is bound
+	/// once, and targets within a group are drawn front to back.
+	void test_front_to_back()
+	{
+		vector<int> log;
+		RecordingRenderable near(log, 0), mid(log, 1), far(log, 2),
+			other(log, 3);
+
+		CountingShader<0> shader_a;
+		CountingShader<1> shader_b;
+		EmptyInstance instance_a(shader_a), instance_b(shader_b);
+
+		Renderer renderer = make_renderer();
+		renderer.enqueue(far, instance_a, at_distance(500.0f));
+		renderer.enqueue(other, instance_b, at_distance(2.0f));
+		renderer.enqueue(near, instance_a, at_distance(1.0f));
+		renderer.enqueue(mid, instance_a, at_distance(20.0f));
+
+		renderer.render();
+
+		test_equal(1, shader_a.binds);
+		test_equal(1, shader_b.binds);
+		test_equal(size_t(4), log.size());
+
+		auto near_pos = std::find(log.cbegin(), log.cend(), 0);
+		auto mid_pos = std::find(log.cbegin(), log.cend(), 1);
+		auto far_pos = std::find(log.cbegin(), log.cend(), 2);
+
+		test_assert(near_pos < mid_pos && mid_pos < far_pos,
+					"Targets were not drawn front to back");
+		test_assert(far_pos - near_pos == 2,
+					"Targets using the same shader were not grouped");
+	}
+
+	/// \test Tests that targets keep the order they were added in when
+	/// front to back sorting is disabled.
+	void test_insertion_order()
+	{
+		vector<int> log;
+		RecordingRenderable far(log, 0), near(log, 1);
+
+		CountingShader<0> shader;
+		EmptyInstance instance(shader);
+
+		Renderer renderer = make_renderer();
+		renderer.settings.sort_front_to_back = false;
+		renderer.enqueue(far, instance, at_distance(100.0f));
+		renderer.enqueue(near, instance, at_distance(1.0f));
+
+		renderer.render();
+
+		test_assert(log == vector<int>{0, 1},
+					"Targets were not drawn in insertion order");
+	}
+
+	/// \test Tests that a CommandList is merged into a Renderer.
+	void test_enqueue_list()
+	{
+		vector<int> log;
+		RecordingRenderable a(log, 0), b(log, 1), c(log, 2);
+
+		CountingShader<0> shader;
+		EmptyInstance instance(shader);
+
+		Renderer renderer = make_renderer();
+		renderer.enqueue(a, instance, at_distance(1.0f));
+
+		CommandList commands;
+		commands.push_back(RenderTarget{b, instance, at_distance(2.0f)});
+		commands.push_back(RenderTarget{c, instance, at_distance(3.0f)});
+		renderer.enqueue(std::move(commands));
+
+		test_equal(size_t(3), renderer.target_count());
+
+		renderer.render();
+
+		test_assert(log == vector<int>{0, 1, 2},
+					"Merged targets were not drawn");
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using glge::test::Test;
+	using namespace glge::test::cases;
+
+	Test::run(test_front_to_back);
+	Test::run(test_insertion_order);
+	Test::run(test_enqueue_list);
+}
@@ -0,0 +1,103 @@
+#include <glge/renderer/render_stats.h>
+
+#include "test_utils.h"
+
+#include <thread>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+
+	/// \test Tests that recording functions update the calling thread's
+	/// counters only when statistics are enabled.
+	void test_record()
+	{
+		const FrameStats before = stats::thread_counters();
+
+		stats::record_draw(36, 12);
+		stats::record_draw(3, 1);
+		stats::record_shader_bind();
+		stats::record_vao_bind();
+		stats::record_texture_bind();
+		stats::record_uniform_upload();
+		stats::record_upload(256);
+
+		const FrameStats delta = stats::thread_counters() - before;
+		const std::uint64_t on = render_stats_enabled ? 1 : 0;
+
+		test_equal(2 * on, delta.draw_calls);
+		test_equal(39 * on, delta.vertices);
+		test_equal(13 * on, delta.triangles);
+		test_equal(on, delta.shader_binds);
+		test_equal(on, delta.vao_binds);
+		test_equal(on, delta.texture_binds);
+		test_equal(on, delta.uniform_uploads);
+		test_equal(256 * on, delta.bytes_uploaded);
+	}
+
+	/// \test Tests that frame counters are kept separately for each thread.
+	void test_thread_local()
+	{
+		const FrameStats before = stats::thread_counters();
+
+		std::thread worker([] { stats::record_draw(3, 1); });
+		worker.join();
+
+		const FrameStats delta = stats::thread_counters() - before;
+		test_equal(std::uint64_t(0), delta.draw_calls);
+	}
+
+	/// \test Tests that FrameStats arithmetic is counter-wise.
+	void test_arithmetic()
+	{
+		FrameStats a, b;
+		a.draw_calls = 5;
+		a.culled_objects = 2;
+		b.draw_calls = 3;
+		b.visible_objects = 7;
+
+		FrameStats sum = a + b;
+		test_equal(std::uint64_t(8), sum.draw_calls);
+		test_equal(std::uint64_t(2), sum.culled_objects);
+		test_equal(std::uint64_t(7), sum.visible_objects);
+
+		FrameStats diff = sum - b;
+		test_equal(std::uint64_t(5), diff.draw_calls);
+		test_equal(std::uint64_t(0), diff.visible_objects);
+	}
+
+	/// \test Tests that GPU memory is tracked per resource type and returns
+	/// to its previous value when released.
+	void test_memory()
+	{
+		const MemoryStats before = stats::memory();
+		const std::uint64_t on = render_stats_enabled ? 1 : 0;
+
+		stats::record_allocation(GPUResource::Texture, 1024);
+		stats::record_allocation(GPUResource::Model, 64);
+
+		MemoryStats during = stats::memory();
+		test_equal(before[GPUResource::Texture] + 1024 * on,
+				   during[GPUResource::Texture]);
+		test_equal(before[GPUResource::Model] + 64 * on,
+				   during[GPUResource::Model]);
+		test_equal(before.total() + 1088 * on, during.total());
+
+		stats::record_release(GPUResource::Texture, 1024);
+		stats::record_release(GPUResource::Model, 64);
+
+		MemoryStats after = stats::memory();
+		test_equal(before.total(), after.total());
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using glge::test::Test;
+	using namespace glge::test::cases;
+
+	Test::run(test_record);
+	Test::run(test_thread_local);
+	Test::run(test_arithmetic);
+	Test::run(test_memory);
+}
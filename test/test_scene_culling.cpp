@@ -0,0 +1,189 @@
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/scene_graph/scene.h>
+
+#include "scene_test_utils.h"
+#include "test_utils.h"
+
+#include <cmath>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+	using namespace glge::renderer::scene_graph;
+
+	/// <summary>Renderable with no known bounds.</summary>
+	class UnboundedRenderable : public Renderable
+	{
+	public:
+		void render() const override {}
+	};
+
+	/// \test Tests that subtrees outside the view frustum are skipped as a
+	/// whole, and that the geometry skipped is counted.
+	void test_cull_subtrees()
+	{
+		BoundedRenderable bounded;
+		UnboundedRenderable unbounded;
+		NullShader shader;
+		NullInstance instance(shader);
+
+		// The camera looks down -z from the origin
+		const util::Placement ahead{
+			glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -10.0f))};
+		const util::Placement behind{
+			glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, 10.0f))};
+		const util::Placement beside{
+			glm::translate(mat4(1.0f), vec3(4.0f, 0.0f, 0.0f))};
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+
+		auto visible = root.add_transform(ahead);
+		for (size_t i = 0; i < 3; i++)
+		{
+			visible.add_geometry(bounded, instance);
+		}
+
+		// Culled as a whole at its outer node
+		auto hidden = root.add_transform(behind);
+		hidden.add_geometry(bounded, instance);
+		for (size_t i = 0; i < 3; i++)
+		{
+			hidden.add_transform(beside).add_geometry(bounded, instance);
+		}
+
+		// Geometry with no bounds keeps its subtree from being culled as a
+		// whole, though bounded geometry within it is still culled
+		auto unknown = root.add_transform(behind);
+		unknown.add_geometry(bounded, instance);
+		unknown.add_geometry(unbounded, instance);
+
+		root.add_camera(CameraIntrinsics{math::Degrees(45.0f), 16.0f / 9.0f,
+										 0.1f, 1000.0f})
+			.activate();
+
+		const size_t total = 9;
+
+		auto unculled = scene.prepare_renderer();
+		test_equal(total, unculled.target_count());
+
+		scene.settings.enable_VF_culling = true;
+		auto culled = scene.prepare_renderer();
+		test_equal(size_t(4), culled.target_count());
+
+		if constexpr (render_stats_enabled)
+		{
+			test_equal(std::uint64_t(4),
+					   culled.statistics().visible_objects);
+			test_equal(std::uint64_t(5), culled.statistics().culled_objects);
+		}
+	}
+
+	/// \test Tests that culling follows transforms changed between
+	/// traversals.
+	void test_cull_moved()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		NullInstance instance(shader);
+
+		util::Placement placement{
+			glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -10.0f))};
+
+		Scene scene;
+		scene.settings.enable_VF_culling = true;
+
+		auto root = scene.get_root_handle();
+		root.add_transform(placement).add_geometry(bounded, instance);
+		root.add_camera(CameraIntrinsics{math::Degrees(45.0f), 1.0f, 0.1f,
+										 100.0f})
+			.activate();
+
+		test_equal(size_t(1), scene.prepare_renderer().target_count());
+
+		// Past the far plane
+		placement.set_transform(
+			glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -200.0f)));
+		test_equal(size_t(0), scene.prepare_renderer().target_count());
+
+		// Straddling the left plane
+		placement.set_transform(
+			glm::translate(mat4(1.0f), vec3(-4.5f, 0.0f, -10.0f)));
+		test_equal(size_t(1), scene.prepare_renderer().target_count());
+	}
+
+	/// \test Tests that coherent culling culls the same geometry as
+	/// testing every plane, as the camera turns between traversals.
+	void test_cull_coherent()
+	{
+		BoundedRenderable bounded;
+		NullShader shader;
+		NullInstance instance(shader);
+
+		Scene scene;
+		auto root = scene.get_root_handle();
+
+		// Rings of nested groups around the camera, so that parents lie
+		// wholly inside some planes and straddle others
+		vector<util::Placement> placements;
+		placements.reserve(64);
+		for (size_t ring = 0; ring < 4; ring++)
+		{
+			for (size_t i = 0; i < 16; i++)
+			{
+				const float angle = static_cast<float>(i) * 0.3927f;
+				const float distance = 5.0f + static_cast<float>(ring) * 10.0f;
+				placements.emplace_back(glm::translate(
+					mat4(1.0f), vec3(std::cos(angle) * distance, 0.0f,
+									 std::sin(angle) * distance)));
+			}
+		}
+
+		for (size_t i = 0; i < placements.size(); i++)
+		{
+			auto group = root.add_transform(placements[i]);
+			for (size_t j = 0; j < 3; j++)
+			{
+				group.add_transform(placements[(i + j * 7) % 16])
+					.add_geometry(bounded, instance);
+			}
+		}
+
+		util::Placement heading{mat4(1.0f)};
+		root.add_transform(heading)
+			.add_camera(CameraIntrinsics{math::Degrees(45.0f), 1.5f, 0.1f,
+										 40.0f})
+			.activate();
+
+		scene.settings.enable_VF_culling = true;
+		for (size_t turn = 0; turn < 24; turn++)
+		{
+			heading.set_transform(glm::toMat4(glm::angleAxis(
+				static_cast<float>(turn) * 0.27f, vec3(0.0f, 1.0f, 0.0f))));
+
+			for (const bool flat : {false, true})
+			{
+				scene.settings.flat_traversal = flat;
+
+				scene.settings.coherent_culling = false;
+				const size_t expected = scene.prepare_renderer().target_count();
+				scene.settings.coherent_culling = true;
+				test_equal(expected, scene.prepare_renderer().target_count());
+				test_assert(expected > 0 && expected < 3 * placements.size(),
+							"Camera should see some but not all geometry");
+			}
+		}
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_cull_subtrees);
+	Test::run(test_cull_moved);
+	Test::run(test_cull_coherent);
+}
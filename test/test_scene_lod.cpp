@@ -0,0 +1,237 @@
+#include <glge/renderer/primitives/renderable.h>
+#include <glge/renderer/primitives/shader_program.h>
+#include <glge/renderer/scene_graph/scene.h>
+
+#include "scene_test_utils.h"
+#include "test_utils.h"
+
+#include <cmath>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+	using namespace glge::renderer::scene_graph;
+
+	/// <summary>
+	/// Renderable with a unit bounding sphere, counting how often it is
+	/// drawn.
+	/// </summary>
+	class CountingRenderable : public Renderable
+	{
+	public:
+		mutable size_t draws = 0;
+
+		void render() const override { draws++; }
+
+		std::optional<math::Sphere> bounds() const override
+		{
+			return math::Sphere{1.0f, vec3(0.0f)};
+		}
+	};
+
+	/// <summary>Instance of a NullShader recording the last fade.</summary>
+	struct FadeInstance : public ShaderInstanceBase
+	{
+		using ShaderInstanceBase::ShaderInstanceBase;
+
+		mutable float fade = 0.0f;
+
+		void operator()(const RenderParameters & render) const override
+		{
+			fade = render.fade;
+		}
+	};
+
+	/// <summary>
+	/// Scene holding a LOD node of three levels ahead of a camera at the
+	/// origin, with a viewport 1000 pixels high.
+	/// </summary>
+	/// With a 60 degree field of view, an error e at a distance d from
+	/// the node's bounds covers 1000 * e / (1.1547 * d) pixels.
+	struct LODScene
+	{
+		CountingRenderable renderables[3];
+		NullShader shader;
+		FadeInstance instances[3] = {FadeInstance(shader),
+									 FadeInstance(shader),
+									 FadeInstance(shader)};
+		util::Placement placement{mat4(1.0f)};
+		Scene scene;
+		NodeHandle lod;
+
+		explicit LODScene(const LODSettings & settings) :
+			lod(scene.get_root_handle()
+					.add_transform(placement)
+					.add_lod({DetailLevel{renderables[0], instances[0], 0.0f},
+							  DetailLevel{renderables[1], instances[1], 0.1f},
+							  DetailLevel{renderables[2], instances[2], 1.0f}},
+							 settings))
+		{
+			scene.get_root_handle()
+				.add_camera(CameraIntrinsics{math::Degrees(60.0f), 1.0f, 0.1f,
+											 10000.0f})
+				.activate();
+			scene.settings.viewport_height = 1000.0f;
+		}
+
+		/// <summary>
+		/// Draw a frame with the node's bounds at a distance from the
+		/// camera, returning the level drawn alone, or -1 if several or
+		/// none were drawn.
+		/// </summary>
+		int draw(float distance)
+		{
+			placement.set_transform(glm::translate(
+				mat4(1.0f), vec3(0.0f, 0.0f, -(distance + 1.0f))));
+
+			for (auto & renderable : renderables)
+			{
+				renderable.draws = 0;
+			}
+
+			scene.prepare_renderer().render();
+
+			int drawn = -1;
+			for (int i = 0; i < 3; i++)
+			{
+				if (renderables[i].draws == 0)
+				{
+					continue;
+				}
+				if (drawn >= 0)
+				{
+					return -1;
+				}
+				drawn = i;
+			}
+
+			return drawn;
+		}
+	};
+
+	/// \test Tests that LOD nodes draw the coarsest level whose error on
+	/// screen is within the limit, in graph and flattened traversal.
+	void test_select()
+	{
+		for (const bool flat : {false, true})
+		{
+			LODScene lods(LODSettings{});
+			lods.scene.settings.flat_traversal = flat;
+
+			// Level 1 shows 1.73 pixels of error
+			test_equal(0, lods.draw(50.0f));
+			// Level 1 shows 0.43 pixels, level 2 4.3 pixels
+			test_equal(1, lods.draw(200.0f));
+			// Level 2 shows 0.43 pixels
+			test_equal(2, lods.draw(2000.0f));
+			test_equal(0, lods.draw(10.0f));
+			test_assert(lods.instances[0].fade == 1.0f,
+						"Levels should be drawn whole without fading");
+
+			// Scaling the node scales its errors
+			lods.draw(200.0f);
+			mat4 scaled(4.0f);
+			scaled[3] = vec4(0.0f, 0.0f, -201.0f, 1.0f);
+			lods.placement.set_transform(scaled);
+			lods.renderables[0].draws = 0;
+			lods.scene.prepare_renderer().render();
+			test_equal(size_t(1), lods.renderables[0].draws);
+		}
+	}
+
+	/// \test Tests that levels switch to coarser levels only once their
+	/// error is well within the limit.
+	void test_hysteresis()
+	{
+		LODScene lods(LODSettings{1.0f, 0.25f, 0});
+
+		// Level 1 shows 0.9 pixels of error at this distance, within the
+		// limit but not by the hysteresis
+		const float between = 96.2f;
+
+		test_equal(0, lods.draw(50.0f));
+		test_equal(0, lods.draw(between));
+		test_equal(1, lods.draw(200.0f));
+		test_equal(1, lods.draw(between));
+		test_equal(0, lods.draw(50.0f));
+	}
+
+	/// \test Tests that new levels are faded in over the old by
+	/// complementary dithers.
+	void test_fade()
+	{
+		LODScene lods(LODSettings{1.0f, 0.25f, 3});
+
+		test_equal(0, lods.draw(50.0f));
+
+		for (int frame = 1; frame <= 3; frame++)
+		{
+			test_equal(-1, lods.draw(200.0f));
+			test_equal(size_t(1), lods.renderables[0].draws);
+			test_equal(size_t(1), lods.renderables[1].draws);
+
+			const float fade = static_cast<float>(frame) / 4.0f;
+			test_assert(float_eq(fade, lods.instances[1].fade),
+						"New level should cover more pixels each frame");
+			test_assert(float_eq(fade - 1.0f, lods.instances[0].fade),
+						"Old level should cover the pixels left out");
+		}
+
+		test_equal(1, lods.draw(200.0f));
+		test_assert(lods.instances[1].fade == 1.0f,
+					"Faded in level should be drawn whole");
+	}
+
+	/// \test Tests that LOD nodes are culled and picked by their finest
+	/// level's bounds, and that bad levels are rejected.
+	void test_cull_and_validate()
+	{
+		LODScene lods(LODSettings{});
+		lods.scene.settings.enable_VF_culling = true;
+
+		test_equal(0, lods.draw(50.0f));
+
+		lods.placement.set_transform(
+			glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, 50.0f)));
+		auto culled = lods.scene.prepare_renderer();
+		test_equal(size_t(0), culled.target_count());
+		if constexpr (render_stats_enabled)
+		{
+			test_equal(std::uint64_t(1), culled.statistics().culled_objects);
+		}
+
+		const auto picked = lods.scene.pick(
+			math::Ray{vec3(0.0f), vec3(0.0f, 0.0f, 1.0f)});
+		test_assert(picked.has_value(), "LOD node should be picked");
+
+		auto root = lods.scene.get_root_handle();
+		CountingRenderable renderable;
+		FadeInstance instance(lods.shader);
+
+		test_fails([&] { root.add_lod({}); }, "Empty LOD should be rejected");
+		test_fails(
+			[&] {
+				root.add_lod({DetailLevel{renderable, instance, 1.0f},
+							  DetailLevel{renderable, instance, 0.5f}});
+			},
+			"Decreasing errors should be rejected");
+		test_fails(
+			[&] {
+				root.add_lod({DetailLevel{renderable, instance, 0.0f}},
+							 LODSettings{1.0f, 1.0f, 0});
+			},
+			"Hysteresis of 1 should be rejected");
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_select);
+	Test::run(test_hysteresis);
+	Test::run(test_fade);
+	Test::run(test_cull_and_validate);
+}
@@ -0,0 +1,100 @@
+#include <internal/util/_slab_pool.h>
+
+#include "test_utils.h"
+
+namespace glge::test::cases
+{
+	using util::SlabPool;
+
+	/// <summary>Object counting how many of its kind are alive.</summary>
+	struct Counted
+	{
+		static inline int alive = 0;
+		int value;
+
+		explicit Counted(int value) : value(value) { alive++; }
+		~Counted() { alive--; }
+	};
+
+	/// \test Tests that freed slots are reused, and that references to
+	/// them are then detected as stale.
+	void test_generations()
+	{
+		SlabPool<Counted> pool;
+
+		const auto [first, first_object] = pool.create(1);
+		const auto [second, second_object] = pool.create(2);
+		test_equal(1, first_object.value);
+		test_equal(2, second_object.value);
+		test_equal(size_t(2), pool.size());
+
+		const auto generation = pool.generation(first);
+		test_assert(pool.find(first, generation) == &first_object);
+
+		pool.destroy(first);
+		test_equal(1, Counted::alive);
+		test_assert(!pool.live(first));
+		test_assert(!pool.find(first, generation),
+					"Stale reference was not detected");
+
+		// The freed slot is reused, under a new generation
+		const auto [reused, reused_object] = pool.create(3);
+		test_equal(first, reused);
+		test_assert(!pool.find(first, generation),
+					"Reused slot was found through a stale reference");
+		test_assert(pool.find(reused, pool.generation(reused)) ==
+					&reused_object);
+
+		test_fails([&] { pool.destroy(first + 10); });
+	}
+
+	/// \test Tests that churning through objects keeps to the slabs
+	/// already allocated, and that objects never move.
+	void test_reuse()
+	{
+		{
+			SlabPool<Counted> pool;
+			vector<std::uint32_t> slots;
+
+			for (int i = 0; i < 1000; i++)
+			{
+				slots.push_back(pool.create(i).first);
+			}
+
+			const size_t capacity = pool.capacity();
+			test_assert(capacity >= 1000 &&
+							capacity < 1000 + SlabPool<Counted>::slab_size,
+						"Slabs were over-allocated");
+
+			const auto & kept = *pool.find(slots.back(),
+										   pool.generation(slots.back()));
+
+			for (int round = 0; round < 10; round++)
+			{
+				for (size_t i = 0; i + 1 < slots.size(); i++)
+				{
+					pool.destroy(slots[i]);
+				}
+				for (size_t i = 0; i + 1 < slots.size(); i++)
+				{
+					slots[i] = pool.create(round).first;
+				}
+			}
+
+			test_equal(capacity, pool.capacity());
+			test_equal(size_t(1000), pool.size());
+			test_equal(999, kept.value);
+		}
+
+		test_equal(0, Counted::alive);
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_generations);
+	Test::run(test_reuse);
+}
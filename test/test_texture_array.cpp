@@ -0,0 +1,82 @@
+#include <glge/renderer/primitives/texture_array.h>
+
+#include "test_utils.h"
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+
+	static Image shape(size_t width, size_t height, size_t channels)
+	{
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.channels = channels;
+		return image;
+	}
+
+	static vector<observer_ptr<const Image>>
+	pointers(const vector<Image> & images)
+	{
+		vector<observer_ptr<const Image>> bases;
+		for (const Image & image : images)
+		{
+			bases.push_back(&image);
+		}
+		return bases;
+	}
+
+	static void test_layer(const TextureLayer & layer, size_t array,
+						   unsigned index)
+	{
+		test_equal(array, layer.array);
+		test_equal(index, layer.layer);
+	}
+
+	/// \test Tests that textures share arrays only with textures of the
+	/// same size and channels, ordered by size and channels.
+	void test_groups()
+	{
+		const vector<Image> images{shape(64, 64, 4), shape(32, 32, 4),
+								   shape(64, 64, 3), shape(64, 64, 4),
+								   shape(32, 32, 4)};
+
+		const auto layers = plan_texture_layers(pointers(images), 16);
+		test_equal(images.size(), layers.size());
+
+		test_layer(layers[1], 0, 0);
+		test_layer(layers[4], 0, 1);
+		test_layer(layers[2], 1, 0);
+		test_layer(layers[0], 2, 0);
+		test_layer(layers[3], 2, 1);
+	}
+
+	/// \test Tests that groups larger than the layer limit are split over
+	/// several arrays, and that a limit of 0 is rejected.
+	void test_limit()
+	{
+		const vector<Image> images(5, shape(16, 16, 4));
+
+		const auto layers = plan_texture_layers(pointers(images), 2);
+		test_layer(layers[0], 0, 0);
+		test_layer(layers[1], 0, 1);
+		test_layer(layers[2], 1, 0);
+		test_layer(layers[3], 1, 1);
+		test_layer(layers[4], 2, 0);
+
+		test_equal(size_t(0), plan_texture_layers({}, 4).size());
+
+		test_fails([&] { plan_texture_layers(pointers(images), 0); },
+				   "Layer limit of 0 should be rejected");
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_groups);
+	Test::run(test_limit);
+}
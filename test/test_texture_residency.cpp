@@ -0,0 +1,122 @@
+#include <glge/renderer/primitives/texture_residency.h>
+
+#include "test_utils.h"
+
+#include <limits>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+
+	// Request for a square texture of the given size, with RGBA levels
+	static ResidencyRequest square(size_t size, unsigned tail_level,
+								   unsigned requested_level, float priority)
+	{
+		ResidencyRequest request{{}, tail_level, requested_level, priority};
+
+		for (; size > 0; size /= 2)
+		{
+			request.level_bytes.push_back(size * size * 4);
+		}
+
+		return request;
+	}
+
+	/// \test Tests that levels are chosen for about one texel per pixel.
+	void test_required_level()
+	{
+		test_equal(0u, required_mip_level(256, 256, 256.0f));
+		test_equal(0u, required_mip_level(256, 256, 300.0f));
+		test_equal(1u, required_mip_level(256, 256, 128.0f));
+		test_equal(0u, required_mip_level(256, 256, 200.0f));
+		test_equal(1u, required_mip_level(256, 256, 100.0f));
+		test_equal(3u, required_mip_level(256, 64, 32.0f));
+		test_equal(0u, required_mip_level(
+						   256, 256, std::numeric_limits<float>::infinity()));
+
+		// Objects smaller than a pixel, or not drawn, need only the 1x1
+		// level
+		test_equal(8u, required_mip_level(256, 256, 0.25f));
+		test_equal(8u, required_mip_level(256, 256, 0.0f));
+		test_equal(8u, required_mip_level(256, 100, 0.0f));
+	}
+
+	/// \test Tests that every requested level is kept when the budget
+	/// allows it.
+	void test_plan_fits()
+	{
+		const vector<ResidencyRequest> requests{square(256, 4, 0, 500.0f),
+												square(128, 3, 2, 32.0f)};
+
+		const auto targets = plan_residency(requests, 1024 * 1024);
+		test_equal(size_t(2), targets.size());
+		test_equal(0u, targets[0]);
+		test_equal(2u, targets[1]);
+	}
+
+	/// \test Tests that the budget is shared by distance from the requested
+	/// level, and that textures not drawn keep only their tails.
+	void test_plan_budget()
+	{
+		// The undrawn texture requests only its tail, as TextureResidency
+		// requests for textures not drawn this frame
+		const vector<ResidencyRequest> requests{
+			square(256, 4, 0, 500.0f), square(256, 4, 2, 100.0f),
+			square(256, 4, 4, 0.0f)};
+
+		// Tails hold 16x16 down to 1x1 for each texture
+		std::uint64_t tails = 0;
+		for (unsigned level = 4; level < 9; level++)
+		{
+			tails += requests[0].level_bytes[level];
+		}
+		tails *= 3;
+
+		// Room for levels 3 to 1 of one texture, and 3 and 2 of the other
+		const std::uint64_t budget = tails + 32 * 32 * 4 * 2 +
+									 64 * 64 * 4 * 2 + 128 * 128 * 4;
+
+		const auto targets = plan_residency(requests, budget);
+		test_equal(1u, targets[0]);
+		test_equal(2u, targets[1]);
+		test_equal(4u, targets[2]);
+
+		// With room to spare, each texture gets exactly the levels it
+		// requested
+		const auto ample =
+			plan_residency(requests, std::numeric_limits<std::uint64_t>::max());
+		test_equal(0u, ample[0]);
+		test_equal(2u, ample[1]);
+		test_equal(4u, ample[2]);
+
+		// Tails are kept even when they exceed the budget
+		const auto starved = plan_residency(requests, 0);
+		for (unsigned target : starved)
+		{
+			test_equal(4u, target);
+		}
+	}
+
+	/// \test Tests that textures still decoding are skipped.
+	void test_plan_empty()
+	{
+		const vector<ResidencyRequest> requests{
+			ResidencyRequest{{}, 0, 0, 10.0f}, square(4, 0, 0, 10.0f)};
+
+		const auto targets = plan_residency(requests, 1024);
+		test_equal(0u, targets[0]);
+		test_equal(0u, targets[1]);
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_required_level);
+	Test::run(test_plan_fits);
+	Test::run(test_plan_budget);
+	Test::run(test_plan_empty);
+}
@@ -0,0 +1,107 @@
+#include <glge/util/thread_pool.h>
+
+#include "test_utils.h"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace glge::test::cases
+{
+	using namespace glge::util;
+
+	/// \test Tests that a ThreadPool runs every posted task before it is
+	/// destroyed.
+	void test_post()
+	{
+		std::atomic<int> count = 0;
+
+		{
+			ThreadPool pool(4);
+
+			for (int i = 0; i < 1000; i++)
+			{
+				pool.post([&] { count++; });
+			}
+		}
+
+		test_equal(1000, count.load());
+	}
+
+	/// \test Tests that submit returns the result of the task, and that
+	/// tasks run on the pool's workers.
+	void test_submit()
+	{
+		ThreadPool pool(2);
+
+		test_assert(!pool.current_worker());
+
+		auto result = pool.submit([&] {
+			auto worker = pool.current_worker();
+			test_assert(worker.has_value());
+			test_assert(*worker < pool.size());
+			return 42;
+		});
+
+		test_equal(42, result.get());
+	}
+
+	/// \test Tests that exceptions thrown by submitted tasks are stored in
+	/// the returned future.
+	void test_submit_throws()
+	{
+		ThreadPool pool(1);
+
+		auto result =
+			pool.submit([]() -> int { throw std::runtime_error("fail"); });
+
+		test_throws([&] { result.get(); });
+	}
+
+	/// \test Tests that tasks posted recursively from workers all run.
+	void test_recursive_post()
+	{
+		std::atomic<int> count = 0;
+
+		{
+			ThreadPool pool(4);
+
+			std::function<void(int)> split = [&](int depth) {
+				count++;
+				if (depth > 0)
+				{
+					pool.post([&, depth] { split(depth - 1); });
+					pool.post([&, depth] { split(depth - 1); });
+				}
+			};
+
+			pool.post([&] { split(9); });
+
+			while (count.load() < 1023)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		test_equal(1023, count.load());
+	}
+
+	/// \test Tests that a ThreadPool always has at least one worker.
+	void test_size()
+	{
+		ThreadPool pool(0);
+		test_equal(size_t(1), pool.size());
+		test_assert(ThreadPool::shared().size() >= 1);
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using glge::test::Test;
+	using namespace glge::test::cases;
+
+	Test::run(test_post);
+	Test::run(test_submit);
+	Test::run(test_submit_throws);
+	Test::run(test_recursive_post);
+	Test::run(test_size);
+}
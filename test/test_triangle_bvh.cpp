@@ -0,0 +1,186 @@
+#include <glge/renderer/primitives/primitive_data.h>
+#include <glge/util/triangle_bvh.h>
+
+#include "test_utils.h"
+
+#include <random>
+
+namespace glge::test::cases
+{
+	using namespace glge::math;
+	using namespace glge::model_parser;
+	using namespace glge::renderer::primitive;
+
+	/// <summary>
+	/// Intersect a ray with a triangle through its plane, independently of
+	/// the tree's own test.
+	/// </summary>
+	std::optional<float> intersect_plane(const Ray & ray, vec3 a, vec3 b,
+										 vec3 c)
+	{
+		const vec3 normal = glm::cross(b - a, c - a);
+		const float facing = glm::dot(ray.direction, normal);
+		if (std::abs(facing) < 1e-9f)
+		{
+			return std::nullopt;
+		}
+
+		const float distance = glm::dot(a - ray.origin, normal) / facing;
+		const vec3 point = ray.origin + ray.direction * distance;
+
+		// The point is inside if it is on the inner side of every edge
+		const auto inside = [&](vec3 from, vec3 to) {
+			return glm::dot(glm::cross(to - from, point - from), normal) >=
+				   0.0f;
+		};
+
+		if (distance < 0.0f || !inside(a, b) || !inside(b, c) ||
+			!inside(c, a))
+		{
+			return std::nullopt;
+		}
+
+		return distance;
+	}
+
+	/// <summary>
+	/// Rays from around a box towards random points within it.
+	/// </summary>
+	vector<Ray> random_rays(const AABB & box, size_t count)
+	{
+		std::mt19937 rng(11);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		const vec3 size = box.max - box.min;
+		const float reach = glm::length(size) * 2.0f;
+
+		vector<Ray> rays;
+		for (size_t i = 0; i < count; i++)
+		{
+			const vec3 target =
+				box.min + size * vec3(unit(rng), unit(rng), unit(rng));
+			const vec3 outward = glm::normalize(
+				vec3(unit(rng), unit(rng), unit(rng)) - vec3(0.5f));
+
+			rays.push_back(Ray{target + outward * reach, -outward});
+		}
+
+		return rays;
+	}
+
+	/// \test Tests that rays cast through the tree find the nearest of the
+	/// mesh's triangles found by brute force, and where on it they hit.
+	void test_rays()
+	{
+		EBOModelData data(ModelData::from_file(
+			ModelFileInfo{"./resources/models/test.obj", ModelFiletype::Auto}));
+		data.build_triangle_bvh();
+		const TriangleBVH & bvh = *data.triangle_bvh;
+
+		test_equal(data.indices.size() / 3, bvh.get_triangles().size());
+		test_assert(bvh.get_nodes().size() < bvh.get_triangles().size(),
+					"Leaves should hold several triangles");
+
+		const vector<Ray> rays = random_rays(*bvh.bounds(), 500);
+		const auto batch = bvh.intersect(rays);
+
+		size_t hit_count = 0;
+		for (size_t i = 0; i < rays.size(); i++)
+		{
+			const Ray & ray = rays[i];
+
+			std::optional<float> nearest;
+			for (size_t index = 0; index < data.indices.size(); index += 3)
+			{
+				const auto distance = intersect_plane(
+					ray, data.vertices[data.indices[index]],
+					data.vertices[data.indices[index + 1]],
+					data.vertices[data.indices[index + 2]]);
+				if (distance && (!nearest || *distance < *nearest))
+				{
+					nearest = distance;
+				}
+			}
+
+			const auto hit = bvh.intersect(ray);
+			test_assert(hit.has_value() == nearest.has_value(),
+						"Tree and brute force disagree on a hit");
+			test_assert(hit.has_value() == batch[i].has_value() &&
+							(!hit || (hit->triangle == batch[i]->triangle &&
+									  hit->distance == batch[i]->distance)),
+						"Batched rays should match single rays");
+
+			if (!hit)
+			{
+				continue;
+			}
+
+			hit_count++;
+			test_assert(std::abs(hit->distance - *nearest) <
+							1e-4f * (1.0f + *nearest),
+						"Tree should find the nearest triangle");
+
+			// The hit's triangle and weights give back the point hit
+			const size_t index = hit->triangle * 3;
+			const vec3 a = data.vertices[data.indices[index]];
+			const vec3 b = data.vertices[data.indices[index + 1]];
+			const vec3 c = data.vertices[data.indices[index + 2]];
+			const vec3 point = a + (b - a) * hit->barycentric.x +
+							   (c - a) * hit->barycentric.y;
+
+			test_assert(glm::length(point - (ray.origin + ray.direction *
+															  hit->distance)) <
+							1e-3f * (1.0f + hit->distance),
+						"Hit should lie on its triangle");
+
+			test_assert(!bvh.intersect(ray, hit->distance * 0.5f),
+						"Hits beyond the maximum distance should be ignored");
+		}
+
+		test_assert(hit_count > rays.size() / 4, "Too few rays hit the mesh");
+	}
+
+	/// \test Tests that trees rebuilt from their nodes answer alike, and
+	/// that nodes not forming a tree are rejected.
+	void test_from_nodes()
+	{
+		ModelData data = ModelData::from_file(
+			ModelFileInfo{"./resources/models/test.obj", ModelFiletype::Auto});
+		data.build_triangle_bvh();
+		const TriangleBVH & bvh = *data.triangle_bvh;
+
+		const TriangleBVH copy(bvh.get_nodes(), bvh.get_triangles());
+		for (const Ray & ray : random_rays(*bvh.bounds(), 100))
+		{
+			const auto expected = bvh.intersect(ray);
+			const auto actual = copy.intersect(ray);
+			test_assert(expected.has_value() == actual.has_value() &&
+							(!expected ||
+							 expected->triangle == actual->triangle),
+						"Rebuilt tree should answer alike");
+		}
+
+		auto looping = bvh.get_nodes();
+		looping.back().skip = 0;
+		test_fails([&] { TriangleBVH(looping, bvh.get_triangles()); },
+				   "Backward skips should be rejected");
+
+		auto overrunning = bvh.get_nodes();
+		overrunning.back().triangles =
+			static_cast<std::uint32_t>(bvh.get_triangles().size() << 4 | 1);
+		test_fails([&] { TriangleBVH(overrunning, bvh.get_triangles()); },
+				   "Leaves past the triangles should be rejected");
+
+		test_assert(!TriangleBVH().intersect(Ray{vec3(0), vec3(1, 0, 0)}));
+		test_assert(!TriangleBVH().bounds());
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_rays);
+	Test::run(test_from_nodes);
+}
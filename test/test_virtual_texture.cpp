@@ -0,0 +1,264 @@
+#include <glge/renderer/primitives/virtual_texture.h>
+#include <internal/renderer/_page_file.h>
+#include <internal/util/_compat.h>
+#include <internal/util/_util.h>
+
+#include "test_utils.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace glge::test::cases
+{
+	using namespace glge::renderer;
+	using namespace glge::renderer::primitive;
+
+	constexpr auto page_filepath = "./virtual_texture.glvp";
+
+	// RGB image whose texels encode their own position
+	static Image position_image(size_t width, size_t height)
+	{
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.channels = 3;
+		image.pixels.resize(image.row_size() * height);
+
+		for (size_t y = 0; y < height; y++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				std::uint8_t * pixel =
+					image.pixels.data() + y * image.row_size() + x * 3;
+
+				pixel[0] = static_cast<std::uint8_t>(x);
+				pixel[1] = static_cast<std::uint8_t>(y);
+				pixel[2] = static_cast<std::uint8_t>(width);
+			}
+		}
+
+		return image;
+	}
+
+	/// \test Tests that layouts count the pages and levels of an image.
+	void test_layout()
+	{
+		const PageLayout layout = PageLayout::for_image(512, 128, 32, 2);
+
+		test_equal(size_t(3), layout.level_count);
+		test_equal(size_t(16), layout.pages_x(0));
+		test_equal(size_t(4), layout.pages_y(0));
+		test_equal(size_t(4), layout.pages_x(2));
+		test_equal(size_t(1), layout.pages_y(2));
+		test_equal(size_t(36), layout.padded_size());
+		test_equal(size_t(36 * 36 * 4), layout.page_bytes());
+
+		test_equal(size_t(1), PageLayout::for_image(64, 64, 64, 0).level_count);
+
+		test_fails([] { PageLayout::for_image(96, 64, 32, 2); });
+		test_fails([] { PageLayout::for_image(100, 64, 32, 2); });
+		test_fails([] { PageLayout::for_image(64, 64, 0, 0); });
+	}
+
+	/// \test Tests that a written page file holds every page with its
+	/// border, repeating the texels at the edges of each level.
+	void test_write_read()
+	{
+		const auto levels = build_mip_chain(position_image(64, 32));
+		write_page_file(page_filepath, levels, 16, 2);
+
+		{
+			const PageFile file(page_filepath);
+			const PageLayout & layout = file.layout();
+
+			test_equal(size_t(64), layout.width);
+			test_equal(size_t(32), layout.height);
+			test_equal(size_t(2), layout.level_count);
+
+			// Second page of the second row of the finest level
+			const std::uint8_t * page = file.page(PageId{0, 1, 1});
+			const size_t row = layout.padded_size() * 4;
+
+			// First texel of the border is one page and one row in, less
+			// the border
+			test_equal(14, static_cast<int>(page[0]));
+			test_equal(14, static_cast<int>(page[1]));
+			test_equal(64, static_cast<int>(page[2]));
+			test_equal(255, static_cast<int>(page[3]));
+
+			// First texel of the page itself
+			const std::uint8_t * first = page + 2 * row + 2 * 4;
+			test_equal(16, static_cast<int>(first[0]));
+			test_equal(16, static_cast<int>(first[1]));
+
+			// Top right page of the finest level, whose border is clamped
+			const std::uint8_t * corner = file.page(PageId{0, 3, 1}) +
+										  (layout.padded_size() - 1) * row +
+										  (layout.padded_size() - 1) * 4;
+			test_equal(63, static_cast<int>(corner[0]));
+			test_equal(31, static_cast<int>(corner[1]));
+
+			// Pages of the coarser level follow those of the finest
+			const PageId coarse{1, 1, 0};
+			test_assert(std::memcmp(file.page(coarse) + 2 * row + 2 * 4,
+									levels[1].pixel(16, 0), 3) == 0,
+						"Coarse page does not match its level");
+		}
+
+		std::remove(page_filepath);
+	}
+
+	/// \test Tests that truncated or foreign page files are rejected.
+	void test_invalid()
+	{
+		write_page_file(page_filepath,
+						build_mip_chain(position_image(32, 32)), 16, 2);
+
+		{
+			const util::MappedFile file(page_filepath);
+			vector<std::uint8_t> contents(file.data(),
+										  file.data() + file.size());
+
+			const auto write_contents = [&](size_t size) {
+				const string path = string(page_filepath) + ".bad";
+				auto out = util::open_file_write(path, true, false, true);
+				out.write(reinterpret_cast<const char *>(contents.data()),
+						  static_cast<std::streamsize>(size));
+				return path;
+			};
+
+			const string truncated = write_contents(contents.size() - 1);
+			test_throws([&] { PageFile{truncated}; });
+
+			contents[0] ^= 0xff;
+			const string foreign = write_contents(contents.size());
+			test_throws([&] { PageFile{foreign}; });
+
+			std::remove(truncated.c_str());
+		}
+
+		// Levels must form a mip chain
+		test_fails([] {
+			write_page_file(page_filepath, {position_image(32, 32)}, 16, 2);
+		});
+
+		std::remove(page_filepath);
+	}
+
+	/// \test Tests that the least recently used unpinned page is evicted.
+	void test_cache()
+	{
+		PageCache cache(3);
+
+		const PageId pinned{2, 0, 0}, a{0, 0, 0}, b{0, 1, 0}, c{0, 0, 1};
+
+		test_assert(!cache.insert(pinned, true)->evicted);
+		test_assert(!cache.insert(a)->evicted);
+		const size_t b_slot = cache.insert(b)->slot;
+		test_equal(size_t(3), cache.size());
+
+		// Using a leaves b as the least recently used
+		test_assert(cache.find(a).has_value());
+		const auto insertion = cache.insert(c);
+		test_assert(insertion.has_value());
+		test_assert(insertion->evicted == b);
+		test_equal(b_slot, insertion->slot);
+		test_assert(!cache.contains(b));
+		test_assert(!cache.find(b).has_value());
+
+		// Pinned pages stay, however old
+		test_assert(cache.insert(b)->evicted == a);
+		test_assert(cache.insert(a)->evicted == c);
+		test_assert(cache.contains(pinned));
+
+		PageCache full(1);
+		full.insert(pinned, true);
+		test_assert(!full.insert(a).has_value());
+	}
+
+	/// \test Tests that entries name the finest cached page covering them,
+	/// and fall back to coarser pages when pages are evicted.
+	void test_indirection()
+	{
+		const PageLayout layout = PageLayout::for_image(64, 64, 16, 0);
+		IndirectionTable table(layout);
+
+		for (size_t level = 0; level < layout.level_count; level++)
+		{
+			test_assert(table.take_dirty(level));
+		}
+
+		const PageId coarse{2, 0, 0}, mid{1, 1, 0}, fine{0, 3, 1};
+
+		table.map(coarse, 0, 0);
+		table.map(fine, 2, 0);
+		table.map(mid, 1, 0);
+
+		test_assert(table.take_dirty(0));
+		test_assert(table.take_dirty(2));
+		test_assert(!table.take_dirty(2));
+
+		// The finer page keeps its entry when the coarser one is mapped
+		test_equal(2, static_cast<int>(table.entry(fine).slot_x));
+		test_equal(1, static_cast<int>(table.entry(mid).slot_x));
+		test_equal(1, static_cast<int>(table.entry(PageId{0, 2, 0}).level));
+		test_equal(1, static_cast<int>(table.entry(PageId{0, 2, 1}).level));
+		test_equal(2, static_cast<int>(table.entry(PageId{0, 0, 0}).level));
+		test_equal(255, static_cast<int>(table.entry(PageId{1, 0, 1}).valid));
+
+		table.unmap(mid);
+		test_equal(0, static_cast<int>(table.entry(fine).level));
+		test_equal(2, static_cast<int>(table.entry(PageId{0, 2, 0}).level));
+		test_equal(2, static_cast<int>(table.entry(mid).level));
+
+		table.unmap(coarse);
+		test_equal(0, static_cast<int>(table.entry(coarse).valid));
+		test_equal(0, static_cast<int>(table.entry(PageId{0, 0, 0}).valid));
+		test_equal(255, static_cast<int>(table.entry(fine).valid));
+	}
+
+	/// \test Tests that feedback pixels decode to the pages encoded, most
+	/// seen first, ignoring cleared pixels.
+	void test_feedback()
+	{
+		const PageId a{0, 300, 2049}, b{3, 7, 1};
+
+		Image feedback;
+		feedback.width = 4;
+		feedback.height = 2;
+		feedback.pixels.assign(feedback.width * feedback.height * 4, 0);
+
+		const auto put = [&](size_t i, PageId page) {
+			const auto pixel = encode_feedback(page);
+			std::copy(pixel.begin(), pixel.end(),
+					  feedback.pixels.begin() + i * 4);
+		};
+
+		put(0, b);
+		put(2, a);
+		put(3, a);
+		put(7, b);
+		put(5, a);
+
+		const auto pages = decode_feedback(feedback);
+		test_equal(size_t(2), pages.size());
+		test_assert(pages[0] == a);
+		test_assert(pages[1] == b);
+
+		feedback.channels = 3;
+		test_fails([&] { decode_feedback(feedback); });
+	}
+}   // namespace glge::test::cases
+
+int main()
+{
+	using namespace glge::test::cases;
+	using glge::test::Test;
+
+	Test::run(test_layout);
+	Test::run(test_write_read);
+	Test::run(test_invalid);
+	Test::run(test_cache);
+	Test::run(test_indirection);
+	Test::run(test_feedback);
+}
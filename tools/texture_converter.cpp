@@ -0,0 +1,247 @@
+/// <summary>Offline converter to glge's precompressed texture files.</summary>
+///
+/// Decodes image files, builds their mip chains, compresses every level
+/// and writes the result with write_compressed_texture, so that textures
+/// can be loaded at run time without decoding or compressing. With
+/// --pages, the mip chain is instead cut into the pages of a virtual
+/// texture and written with write_page_file. As when textures are loaded
+/// from image files at run time, the colors of 2D textures are remapped
+/// with make_ntsc_safe first, so converted files hold the same texels.
+///
+/// Usage:
+///
+///     glge_texture_converter [options] input output
+///     glge_texture_converter [options] --cubemap right left top bottom
+///         back front output
+///
+/// Options:
+///
+///     --bc1, --bc3      Block format; if not given, BC3 is used for images
+///                       with any transparent pixels and BC1 otherwise.
+///     --filter NAME     Mip filter: box (default), kaiser or lanczos.
+///     --srgb            Filter color channels in linear space, for images
+///                       holding sRGB colors.
+///     --pages SIZE      Write a virtual texture page file with pages of
+///                       SIZE texels across, instead of compressing.
+///
+/// \file texture_converter.cpp
+
+#include <glge/common.h>
+#include <glge/renderer/primitives/compressed_texture.h>
+#include <glge/renderer/primitives/image_decoder.h>
+#include <glge/renderer/primitives/virtual_texture.h>
+#include <glge/util/thread_pool.h>
+#include <glge/util/util.h>
+
+#include <SOIL.h>
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+
+using namespace glge;
+using namespace glge::renderer::primitive;
+
+namespace
+{
+	// Decodes with the same decoders as textures loaded at run time
+	Image read_image(const string & path)
+	{
+		if (auto image = load_image(path, 4))
+		{
+			return std::move(*image);
+		}
+
+		int width = 0, height = 0, channels = 0;
+		unsigned char * data = SOIL_load_image(path.c_str(), &width, &height,
+											   &channels, SOIL_LOAD_RGBA);
+
+		if (!data)
+		{
+			throw std::runtime_error(EXC_MSG("Failed to load " + path + ": " +
+											 SOIL_last_result()));
+		}
+
+		Image image;
+		image.width = static_cast<size_t>(width);
+		image.height = static_cast<size_t>(height);
+		image.channels = 4;
+		image.pixels.assign(data, data + image.row_size() * image.height);
+
+		SOIL_free_image_data(data);
+
+		return image;
+	}
+
+	bool has_transparency(const Image & image)
+	{
+		for (size_t i = 3; i < image.pixels.size(); i += 4)
+		{
+			if (image.pixels[i] != 255)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Drops the alpha channel of an RGBA image
+	Image to_rgb(const Image & image)
+	{
+		Image result;
+		result.width = image.width;
+		result.height = image.height;
+		result.channels = 3;
+		result.pixels.reserve(result.row_size() * result.height);
+
+		for (size_t i = 0; i < image.pixels.size(); i += 4)
+		{
+			result.pixels.insert(result.pixels.end(),
+								 image.pixels.begin() +
+									 static_cast<std::ptrdiff_t>(i),
+								 image.pixels.begin() +
+									 static_cast<std::ptrdiff_t>(i + 3));
+		}
+
+		return result;
+	}
+
+	int usage()
+	{
+		std::cerr << "Usage:\n"
+					 "  glge_texture_converter [options] input output\n"
+					 "  glge_texture_converter [options] --cubemap "
+					 "right left top bottom back front output\n"
+					 "Options:\n"
+					 "  --bc1 | --bc3\n"
+					 "  --filter box | kaiser | lanczos\n"
+					 "  --srgb\n"
+					 "  --pages SIZE\n";
+		return 1;
+	}
+}   // namespace
+
+int main(int argc, char ** argv)
+{
+	vector<string> args(argv + 1, argv + argc);
+	std::optional<BlockFormat> format;
+	MipSettings mip_settings;
+	bool cubemap = false;
+	size_t page_size = 0;
+
+	while (!args.empty() && args.front().rfind("--", 0) == 0)
+	{
+		if (args.front() == "--bc1")
+		{
+			format = BlockFormat::BC1;
+		}
+		else if (args.front() == "--bc3")
+		{
+			format = BlockFormat::BC3;
+		}
+		else if (args.front() == "--cubemap")
+		{
+			cubemap = true;
+		}
+		else if (args.front() == "--srgb")
+		{
+			mip_settings.srgb = true;
+		}
+		else if (args.front() == "--pages" && args.size() > 1)
+		{
+			args.erase(args.begin());
+
+			try
+			{
+				page_size = std::stoul(args.front());
+			}
+			catch (const std::exception &)
+			{
+				return usage();
+			}
+		}
+		else if (args.front() == "--filter" && args.size() > 1)
+		{
+			args.erase(args.begin());
+
+			if (args.front() == "box")
+			{
+				mip_settings.filter = MipFilter::Box;
+			}
+			else if (args.front() == "kaiser")
+			{
+				mip_settings.filter = MipFilter::Kaiser;
+			}
+			else if (args.front() == "lanczos")
+			{
+				mip_settings.filter = MipFilter::Lanczos;
+			}
+			else
+			{
+				return usage();
+			}
+		}
+		else
+		{
+			return usage();
+		}
+
+		args.erase(args.begin());
+	}
+
+	if (args.size() != (cubemap ? 7u : 2u) || (cubemap && page_size > 0))
+	{
+		return usage();
+	}
+
+	try
+	{
+		vector<Image> images;
+		std::transform(args.cbegin(), args.cend() - 1,
+					   std::back_inserter(images), read_image);
+
+		// Textures loaded at run time are remapped to NTSC safe colors,
+		// but cubemaps are not
+		if (!cubemap)
+		{
+			make_ntsc_safe(images.front());
+		}
+
+		if (page_size > 0)
+		{
+			write_page_file(args.back(),
+							build_mip_chain(std::move(images.front()),
+											mip_settings),
+							page_size);
+			return 0;
+		}
+
+		if (!format)
+		{
+			format = std::any_of(images.cbegin(), images.cend(),
+								 has_transparency)
+						 ? BlockFormat::BC3
+						 : BlockFormat::BC1;
+		}
+
+		if (*format == BlockFormat::BC1)
+		{
+			std::transform(images.cbegin(), images.cend(), images.begin(),
+						   to_rgb);
+		}
+
+		// Faces and their rows are filtered in parallel
+		const vector<vector<Image>> faces = build_mip_chains(
+			std::move(images), mip_settings, &util::ThreadPool::shared());
+
+		write_compressed_texture(args.back(), faces, *format);
+	}
+	catch (const std::exception & e)
+	{
+		util::print_nested_exception(e);
+		return 1;
+	}
+
+	return 0;
+}